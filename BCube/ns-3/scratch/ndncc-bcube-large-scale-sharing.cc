@@ -62,7 +62,6 @@ main (int argc, char *argv[])
 {
 	int simulation_time = 60;
 	//int no_flow = 2;	//number of DATA flows, at most 8 (we have 16 servers)
-	srand(time(0));
   // setting default parameters for PointToPoint links and channels
   Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("50"));
   Config::SetDefault ("ns3::ndn::fw::Nacks::EnableNACKs", BooleanValue (true));
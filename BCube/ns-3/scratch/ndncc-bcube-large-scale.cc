@@ -24,6 +24,9 @@
 #include "ns3/ndnSIM-module.h"
 #include "ns3/log.h"
 
+#include <ns3/ndnSIM/utils/tracers/ndn-l3-rate-tracer.h>
+#include <ns3/ndnSIM/utils/tracers/ndn-app-delay-tracer.h>
+
 #include <cstdio>
 #include <set>
 #include <ctime>
@@ -58,29 +61,37 @@ EnqueuePacket (std::string str, Ptr<const Packet> packet)
 		packet_sent ++;
 }
 
-int 
-main (int argc, char *argv[])
-{
-	int simulation_time = 400;
-	//int no_flow = 2;	//number of DATA flows, at most 8 (we have 16 servers)
-	srand(time(0));
-  // setting default parameters for PointToPoint links and channels
-  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("50"));
-  Config::SetDefault ("ns3::ndn::fw::Nacks::EnableNACKs", BooleanValue (true));
-  Config::SetDefault ("ns3::ndn::Limits::LimitsDeltaRate::UpdateInterval", StringValue ("1.0")); 
-  Config::SetDefault ("ns3::ndn::ConsumerOm::DataFeedback", StringValue ("1000"));
-  Config::SetDefault ("ns3::ndn::ConsumerOm::NackFeedback", StringValue ("1.5"));
-  Config::SetDefault ("ns3::ndn::ConsumerOm::LimitInterval", StringValue ("1.0"));
-  Config::SetDefault ("ns3::ndn::ConsumerOm::InitLimit", StringValue ("10.0"));
+int simulation_time = 400;
+bool ecn = false;	//mark Data at queues and react to marks at consumers, instead of only NACKs
+std::string saveSnapshot;	//warm-up run: write converged state at snapshotTime and stop
+double snapshotTime = 200;
+std::string loadSnapshot;	//sweep run: start from a warm-start snapshot
+std::string rateTrace = "ndncc-bcube-large-scale-rate-trace.txt";	//per-face rates, empty to disable
+std::string delayTrace = "ndncc-bcube-large-scale-delay-trace.txt";	//Interest-Data delay quantiles, empty to disable
+//int no_flow = 2;	//number of DATA flows, at most 8 (we have 16 servers)
 
-  // Read optional command-line parameters (e.g., enable visualizer with ./waf --run=<> --visualize
-  CommandLine cmd;
-  cmd.Parse (argc, argv);
-	
+//One complete simulation. With replications, each run is executed in its own process
+static void
+RunScenario (uint32_t run)
+{
 	//Read topology from BCube
 	AnnotatedTopologyReader topologyReader ("", 25);
   topologyReader.SetFileName ("src/ndnSIM/examples/topologies/bcube-4-3.txt");
   topologyReader.Read ();
+
+  if (ecn)
+  {
+  	//replace DropTail queues of all links with CE-marking queues
+  	for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node ++)
+  	{
+  		for (uint32_t i = 0; i < (*node)->GetNDevices (); i ++)
+  		{
+  			Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> ((*node)->GetDevice (i));
+  			if (device != 0)
+  				device->SetQueue (CreateObject<CeMarkingQueue> ());
+  		}
+  	}
+  }
   
   // Install NDN stack on all nodes
   ndn::StackHelper ndnHelper;
@@ -128,6 +139,19 @@ main (int argc, char *argv[])
   //Calculate global routing
   ndnGlobalRoutingHelper.CalculateAllPossibleRoutes ();
   //ndnGlobalRoutingHelper.CalculateRoutes ();
+
+  if (!saveSnapshot.empty ())
+  	ndn::WarmStartHelper::SaveAt (Seconds (snapshotTime), saveSnapshot);
+  if (!loadSnapshot.empty ())
+  	ndn::WarmStartHelper::Load (loadSnapshot);
+  
+  //with replications, every run writes its own copy of the traces (merged by ReplicationRunner)
+  boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<ndn::L3RateTracer> > > rateTracers;
+  boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<ndn::AppDelayTracer> > > delayTracers;
+  if (!rateTrace.empty ())
+  	rateTracers = ndn::L3RateTracer::InstallAll (ndn::ReplicationRunner::GetTraceFileName (rateTrace), Seconds (1.0));
+  if (!delayTrace.empty ())
+  	delayTracers = ndn::AppDelayTracer::InstallAll (ndn::ReplicationRunner::GetTraceFileName (delayTrace), Seconds (1.0));
   
   Config::Connect("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Drop", MakeCallback (&DropPacket));
   Config::Connect("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Enqueue", MakeCallback (&EnqueuePacket));
@@ -139,7 +163,52 @@ main (int argc, char *argv[])
   Simulator::Run ();
   Simulator::Destroy ();
   	
-  NS_LOG_UNCOND("Total_packet="<<packet_sent<<" packet_loss="<<packet_loss<<" loss_ratio="<<packet_loss*100/packet_sent<<"%");
-  	
-  return 0;
+  NS_LOG_UNCOND("Run="<<run<<" Total_packet="<<packet_sent<<" packet_loss="<<packet_loss<<" loss_ratio="<<packet_loss*100/packet_sent<<"%");
+}
+
+int 
+main (int argc, char *argv[])
+{
+  // setting default parameters for PointToPoint links and channels
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("50"));
+  Config::SetDefault ("ns3::ndn::fw::Nacks::EnableNACKs", BooleanValue (true));
+  Config::SetDefault ("ns3::ndn::Limits::LimitsDeltaRate::UpdateInterval", StringValue ("1.0")); 
+  Config::SetDefault ("ns3::ndn::ConsumerOm::DataFeedback", StringValue ("1000"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::NackFeedback", StringValue ("1.5"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::LimitInterval", StringValue ("1.0"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::InitLimit", StringValue ("10.0"));
+
+  uint32_t replications = 1;
+
+  // Read optional command-line parameters (e.g., enable visualizer with ./waf --run=<> --visualize
+  CommandLine cmd;
+  cmd.AddValue ("replications", "Number of independent runs, starting from --RngRun (executed in parallel)", replications);
+  cmd.AddValue ("ecn", "Mark Data at link queues (CeMarkingQueue) and enable ECN feedback of consumers", ecn);
+  cmd.AddValue ("simulationTime", "Simulation time (s)", simulation_time);
+  cmd.AddValue ("saveSnapshot", "Write warm-start snapshot to the file at --snapshotTime and stop", saveSnapshot);
+  cmd.AddValue ("snapshotTime", "When consumers are suspended to take the warm-start snapshot (s)", snapshotTime);
+  cmd.AddValue ("loadSnapshot", "Start from the warm-start snapshot in the file", loadSnapshot);
+  cmd.AddValue ("rateTrace", "File for ndn::L3RateTracer output (empty to disable)", rateTrace);
+  cmd.AddValue ("delayTrace", "File for ndn::AppDelayTracer delay quantiles (empty to disable)", delayTrace);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (!saveSnapshot.empty () && replications > 1, "Warm-start snapshot should be taken by a single run");
+
+  if (ecn)
+  	Config::SetDefault ("ns3::ndn::ConsumerOm::EcnFeedback", BooleanValue (true));
+
+  if (replications <= 1)
+  {
+  	RunScenario (RngSeedManager::GetRun ());
+  	return 0;
+  }
+
+  ndn::ReplicationRunner runner;
+  runner.SetReplications (replications);
+  runner.SetFirstRun (RngSeedManager::GetRun ());
+  if (!rateTrace.empty ())
+  	runner.AddTraceFile (rateTrace);
+  if (!delayTrace.empty ())
+  	runner.AddTraceFile (delayTrace);
+  return runner.Run (MakeCallback (&RunScenario)) == 0 ? 0 : 1;
 }
@@ -64,7 +64,9 @@ main (int argc, char *argv[])
   Config::SetDefault ("ns3::ndn::ConsumerOm::InitLimit", StringValue ("10.0"));
 
   // Read optional command-line parameters (e.g., enable visualizer with ./waf --run=<> --visualize
+  std::string failureTrace;
   CommandLine cmd;
+  cmd.AddValue ("failureTrace", "File with link failures (<time> <down|up> <node> <node>), replaces the rate-limit failure of router-P2 at 50s", failureTrace);
   cmd.Parse (argc, argv);
 
   // Creating nodes
@@ -122,7 +124,15 @@ main (int argc, char *argv[])
   producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
   producerHelper.Install (nodes.Get (4)); 
   
-  Simulator::Schedule(Seconds(50), SetLinkFailure, nodes, facecontainer);
+  if (failureTrace.empty ())
+    Simulator::Schedule(Seconds(50), SetLinkFailure, nodes, facecontainer);
+  else
+    {
+      Names::Add ("router", nodes.Get (2));
+      Names::Add ("P1", nodes.Get (3));
+      Names::Add ("P2", nodes.Get (4));
+      ndn::LinkControlHelper::ScheduleFromFile (failureTrace);
+    }
   
   
 
@@ -0,0 +1,226 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+// tcp-incast-bcube-4-1.cc TCP incast on BCube(4,1) with shallow buffers: N servers send
+// one block each to S00 at the same time. Compares TCP NewReno with DCTCP (--dctcp)
+// by flow completion times, as the TCP baseline of the BitTorrent/NDN comparison
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+static const uint16_t port = 5000;
+static const uint16_t pppIpv4Protocol = 0x0021;  //PPP protocol number of IPv4 frames
+
+uint32_t blockSize = 256000;   //bytes sent by each sender
+Time startTime = Seconds (1.0);
+
+std::map<Ipv4Address, uint32_t> bytesReceived;
+std::map<Ipv4Address, Time> completionTime;
+uint32_t packetsMarked = 0;
+uint32_t packetsDropped = 0;
+
+static void
+SinkRx (Ptr<const Packet> packet, const Address &from)
+{
+  Ipv4Address source = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
+  uint32_t &received = bytesReceived[source];
+  received += packet->GetSize ();
+  if (received >= blockSize && completionTime.find (source) == completionTime.end ())
+    completionTime[source] = Simulator::Now () - startTime;
+}
+
+// Set CE codepoint of ECN-capable IPv4 packets, the switch side of DCTCP
+static bool
+MarkIpv4 (Ptr<Packet> packet)
+{
+  Ipv4Header ipv4;
+  if (Node::ChecksumEnabled ())
+    ipv4.EnableChecksum ();
+  packet->RemoveHeader (ipv4);
+
+  bool marked = false;
+  if (ipv4.GetEcn () == Ipv4Header::ECT0 || ipv4.GetEcn () == Ipv4Header::ECT1)
+    {
+      ipv4.SetEcn (Ipv4Header::CE);
+      marked = true;
+    }
+
+  packet->AddHeader (ipv4);
+  return marked;
+}
+
+static void
+QueueMark (std::string context, Ptr<const Packet> packet)
+{
+  packetsMarked ++;
+}
+
+static void
+QueueDrop (std::string context, Ptr<const Packet> packet)
+{
+  packetsDropped ++;
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool dctcp = false;
+  uint32_t senders = 8;
+  uint32_t buffer = 20;     //packets per link queue
+  uint32_t threshold = 5;   //marking threshold K, packets
+  uint32_t segmentSize = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("dctcp", "Use DCTCP: ECN-capable TCP reacting to the fraction of marks, and marking queues", dctcp);
+  cmd.AddValue ("senders", "Number of servers sending to S00 at the same time (at most 15)", senders);
+  cmd.AddValue ("blockSize", "Bytes sent by each sender", blockSize);
+  cmd.AddValue ("buffer", "Size of link queues, packets", buffer);
+  cmd.AddValue ("threshold", "Marking threshold of link queues with --dctcp, packets", threshold);
+  cmd.AddValue ("segmentSize", "TCP segment size, bytes", segmentSize);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (senders == 0 || senders > 15, "BCube(4,1) has 15 servers besides the receiver");
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpNewReno"));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (segmentSize));
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", BooleanValue (dctcp));
+  Config::SetDefault ("ns3::TcpNewReno::Dctcp", BooleanValue (dctcp));
+
+  //Read topology from BCube
+  AnnotatedTopologyReader topologyReader ("", 25);
+  topologyReader.SetFileName ("src/ndnSIM/examples/topologies/bcube-4-1.txt");
+  NodeContainer nodes = topologyReader.Read ();
+
+  //replace the queues of all links with shallow ones (marking ones for DCTCP)
+  ObjectFactory queueFactory;
+  queueFactory.SetTypeId (dctcp ? "ns3::CeMarkingQueue" : "ns3::DropTailQueue");
+  queueFactory.Set ("MaxPackets", UintegerValue (buffer));
+  if (dctcp)
+    {
+      queueFactory.Set ("MarkingThreshold", UintegerValue (threshold));
+      CeMarkingQueue::SetMarker (pppIpv4Protocol, MakeCallback (&MarkIpv4));
+    }
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node ++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); i ++)
+        {
+          Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> ((*node)->GetDevice (i));
+          if (device != 0)
+            device->SetQueue (queueFactory.Create<Queue> ());
+        }
+    }
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  //Note: topologyReader only supports /24 netmask. So #nodes are limited!!!
+  topologyReader.AssignIpv4Addresses ("10.1.1.0");
+
+  //Turn on global static routing
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  //Receiver S00
+  Ptr<Node> receiver = Names::Find<Node> ("S00");
+  Ipv4Address receiverAddress = receiver->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (receiver);
+  sinkApps.Start (Seconds (0.0));
+  sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&SinkRx));
+
+  //Senders: servers in the order S01, S02, ..., S33
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (receiverAddress, port));
+  source.SetAttribute ("MaxBytes", UintegerValue (blockSize));
+  std::vector<std::string> senderNames;
+  for (uint32_t i = 1; i <= senders; i ++)
+    {
+      std::string name = "S";
+      name += '0' + i / 4;
+      name += '0' + i % 4;
+      senderNames.push_back (name);
+      ApplicationContainer sourceApps = source.Install (Names::Find<Node> (name));
+      sourceApps.Start (startTime);
+    }
+
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Drop", MakeCallback (&QueueDrop));
+  if (dctcp)
+    Config::Connect ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/$ns3::CeMarkingQueue/Mark",
+                     MakeCallback (&QueueMark));
+
+  Simulator::Stop (Seconds (100.0));
+  Simulator::Run ();
+
+  //Report flow completion times
+  std::cout << "# " << (dctcp ? "DCTCP" : "NewReno") << ", " << senders << " senders x " << blockSize
+            << " bytes, buffer " << buffer << " packets" << (dctcp ? ", K " : "");
+  if (dctcp)
+    std::cout << threshold;
+  std::cout << std::endl;
+  std::cout << "Sender\tFCT(s)" << std::endl;
+
+  std::vector<double> fcts;
+  uint32_t unfinished = 0;
+  for (uint32_t i = 0; i < senderNames.size (); i ++)
+    {
+      //servers have one interface per BCube level, the flow may come from any of them
+      Ptr<Ipv4> ipv4 = Names::Find<Node> (senderNames[i])->GetObject<Ipv4> ();
+      std::map<Ipv4Address, Time>::iterator fct = completionTime.end ();
+      for (uint32_t j = 1; j < ipv4->GetNInterfaces () && fct == completionTime.end (); j ++)
+        fct = completionTime.find (ipv4->GetAddress (j, 0).GetLocal ());
+      std::cout << senderNames[i] << "\t";
+      if (fct != completionTime.end ())
+        {
+          fcts.push_back (fct->second.ToDouble (Time::S));
+          std::cout << fcts.back () << std::endl;
+        }
+      else
+        {
+          unfinished ++;
+          std::cout << "unfinished" << std::endl;
+        }
+    }
+
+  if (!fcts.empty ())
+    {
+      std::sort (fcts.begin (), fcts.end ());
+      double sum = 0;
+      for (uint32_t i = 0; i < fcts.size (); i ++)
+        sum += fcts[i];
+      std::cout << "Mean FCT(s): " << sum / fcts.size () << std::endl
+                << "Median FCT(s): " << fcts[fcts.size () / 2] << std::endl
+                << "Max FCT(s): " << fcts.back () << std::endl;
+    }
+  std::cout << "Unfinished flows: " << unfinished << std::endl
+            << "Queue drops: " << packetsDropped << std::endl
+            << "Queue marks: " << packetsMarked << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
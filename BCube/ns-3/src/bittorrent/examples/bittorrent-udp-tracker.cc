@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include "ns3/BitTorrentTracker.h"
+#include "ns3/BitTorrentClient.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace bittorrent;
+
+/*
+ * This example measures the bootstrap of a swarm, i.e., the time until all clients of a flash crowd have received
+ * their first peer list from the tracker, with the HTTP and the UDP tracker protocol.
+ *
+ * The tracker sits in the hub of a star, the clients on the spokes. The simulation stops as soon as every client
+ * has received a tracker response. Besides the bootstrap time, the example reports the processing cost of the
+ * tracker itself, i.e., the processor and wall-clock time spent in its socket handlers (see
+ * BitTorrentTracker::GetProcessingCpuTime). Compare, e.g.:
+ *
+ *   ./waf --run "bittorrent-udp-tracker --clients=4096 --udp=0 --torrent=..."
+ *   ./waf --run "bittorrent-udp-tracker --clients=4096 --udp=1 --torrent=..."
+ */
+
+static uint32_t g_clients = 0;
+static uint32_t g_bootstrapped = 0;
+static std::vector<bool> g_responded;
+
+static void
+TrackerResponseReceived (uint32_t client)
+{
+  if (g_responded[client])
+    {
+      return;
+    }
+
+  g_responded[client] = true;
+  if (++g_bootstrapped == g_clients)
+    {
+      Simulator::Stop ();
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t clients = 4096;
+  bool udp = true;
+  double arrivalPeriod = 10.0;
+  std::string torrentFolder = "input/bittorrent/torrent-data";
+  std::string torrentFile = "input/bittorrent/torrent-data/100MB-full.dat.torrent";
+
+  CommandLine cmd;
+  cmd.AddValue ("clients", "Number of clients", clients);
+  cmd.AddValue ("udp", "Use the UDP tracker protocol (BEP 15) instead of HTTP", udp);
+  cmd.AddValue ("arrivalPeriod", "Period (in seconds) over which the clients join the swarm", arrivalPeriod);
+  cmd.AddValue ("folder", "Folder of the shared data", torrentFolder);
+  cmd.AddValue ("torrent", "The .torrent file of the shared data", torrentFile);
+  cmd.Parse (argc, argv);
+
+  // Step 1: Build a star with the tracker in the hub
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointStarHelper star (clients, pointToPoint);
+
+  InternetStackHelper stack;
+  star.InstallStack (stack);
+  star.AssignIpv4Addresses (Ipv4AddressHelper ("10.0.0.0", "255.255.255.252"));
+
+  // The tracker is reached at the hub's address on the first spoke; route everything through the hub
+  Ipv4StaticRoutingHelper staticRouting;
+  for (uint32_t i = 0; i < clients; ++i)
+    {
+      Ptr<Ipv4> ipv4 = star.GetSpokeNode (i)->GetObject<Ipv4> ();
+      staticRouting.GetStaticRouting (ipv4)->SetDefaultRoute (star.GetHubIpv4Address (i), 1);
+    }
+
+  // Step 2: Install the tracker; the protocol has to be set before adding the torrent (see BitTorrentTracker::SetUdpEnabled)
+  Ptr<BitTorrentTracker> tracker = Create<BitTorrentTracker> ();
+  tracker->SetUdpEnabled (udp);
+  tracker->AssignStreams (0);
+  star.GetHub ()->AddApplication (tracker);
+  Ptr<Torrent> sharedTorrent = tracker->AddTorrent (torrentFolder, torrentFile);
+
+  // Step 3: Install the clients, arriving uniformly over the arrival period
+  g_clients = clients;
+  g_responded.assign (clients, false);
+  for (uint32_t i = 0; i < clients; ++i)
+    {
+      Ptr<BitTorrentClient> client = Create<BitTorrentClient> ();
+      client->SetTorrent (sharedTorrent);
+      client->SetStartTime (Seconds (arrivalPeriod * i / clients));
+      star.GetSpokeNode (i)->AddApplication (client);
+      client->RegisterCallbackTrackerResponseReceivedEvent (MakeBoundCallback (&TrackerResponseReceived, i));
+    }
+
+  // Step 4: Run until all clients have bootstrapped, but at most until all clients have reannounced several times
+  Simulator::Stop (Seconds (arrivalPeriod + 5 * tracker->GetUpdateInterval ().GetSeconds ()));
+  SystemWallClockMs wallClock;
+  wallClock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = wallClock.End ();
+
+  std::cout << (udp ? "UDP" : "HTTP") << " tracker: " << g_bootstrapped << "/" << clients << " clients bootstrapped after "
+            << Simulator::Now ().GetSeconds () << " s (simulated), " << elapsed << " ms (wall clock)" << std::endl;
+  std::cout << (udp ? "UDP" : "HTTP") << " tracker: " << tracker->GetRequestsHandled () << " requests handled in "
+            << tracker->GetProcessingCpuTime ().GetMicroSeconds () << " us (CPU), "
+            << tracker->GetProcessingWallTime ().GetMicroSeconds () << " us (wall clock)" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
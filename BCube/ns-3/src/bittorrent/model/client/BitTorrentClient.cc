@@ -74,6 +74,7 @@ BitTorrentClient::BitTorrentClient ()
   m_pieceTimeout = Seconds (30);
 
   m_checkDownloadedData = false;
+  m_virtualPayload = false;
 
   m_downloadCompleted = false;
 
@@ -484,6 +485,12 @@ void BitTorrentClient::SetCheckDownloadedData (bool checkDownloadedData)
   m_checkDownloadedData = checkDownloadedData;
 }
 
+void BitTorrentClient::SetVirtualPayload (bool virtualPayload)
+{
+  CHANGED_OPTION ("virtual_payload", m_virtualPayload, virtualPayload);
+  m_virtualPayload = virtualPayload;
+}
+
 void BitTorrentClient::SetPieceComplete (uint32_t pieceIndex)
 {
   m_bitfield[pieceIndex / 8] |= (1 << (7 - (pieceIndex % 8)));
@@ -20,9 +20,11 @@
 
 #include "BitTorrentPacket.h"
 
+#include "ns3/BitTorrentDefines.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace ns3 {
@@ -239,18 +241,12 @@ void BitTorrentBitfieldMessage::SetBitFieldSize (uint32_t bitFieldSize)
 
 void BitTorrentBitfieldMessage::CopyBitFieldFrom (const std::vector<uint8_t>* sourceField)
 {
-  for (uint8_t i = 0; i < m_bitFieldSize; ++i)
-    {
-      m_bitField[i] = (*sourceField)[i];
-    }
+  std::copy (sourceField->begin (), sourceField->begin () + m_bitFieldSize, m_bitField);
 }
 
 void BitTorrentBitfieldMessage::CopyBitFieldTo (std::vector<uint8_t>* targetField) const
 {
-  for (uint8_t i = 0; i < m_bitFieldSize; ++i)
-    {
-      (*targetField)[i] = m_bitField[i];
-    }
+  std::copy (m_bitField, m_bitField + m_bitFieldSize, targetField->begin ());
 }
 
 void BitTorrentBitfieldMessage::Serialize (Buffer::Iterator start) const
@@ -521,5 +517,123 @@ std::string BitTorrentExtensionMessage::GetContent () const
   return result;
 }
 
+/************************************************************************************************/
+/**************************************** BitTorrentMessageParser *******************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentMessageParser);
+
+BitTorrentMessageParser::BitTorrentMessageParser ()
+{
+  m_size = 0;
+  m_nextMessageHeader = false;
+  m_nextMessageComplete = false;
+}
+
+BitTorrentMessageParser::~BitTorrentMessageParser ()
+{
+}
+
+void BitTorrentMessageParser::Serialize (Buffer::Iterator start) const
+{
+  NS_FATAL_ERROR ("BitTorrentMessageParser can only be used to peek at received messages");
+}
+
+uint32_t BitTorrentMessageParser::Deserialize (Buffer::Iterator start)
+{
+  m_messages.clear ();
+  m_size = 0;
+  m_nextMessageHeader = false;
+  m_nextMessageComplete = false;
+
+  uint32_t remaining = start.GetSize ();
+  while (remaining >= BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH)
+    {
+      Message message;
+      message.m_length = start.ReadNtohU32 ();
+      message.m_fields[0] = message.m_fields[1] = message.m_fields[2] = 0;
+      remaining -= BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH;
+
+      // Step 1: Keep-alive messages consist of the length header only
+      if (message.m_length == 0)
+        {
+          message.m_type = BitTorrentTypeHeader::KEEP_ALIVE;
+          m_messages.push_back (message);
+          m_size += BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH;
+          continue;
+        }
+
+      if (remaining == 0)
+        {
+          break;
+        }
+      message.m_type = static_cast<BitTorrentTypeHeader::BitTorrentMessageType> (start.ReadU8 ());
+
+      // Step 2: Determine the fields of the message; stop at messages with payload, which are handled by the receiver
+      uint32_t fields;
+      switch (message.m_type)
+        {
+        case BitTorrentTypeHeader::CHOKE:
+        case BitTorrentTypeHeader::UNCHOKE:
+        case BitTorrentTypeHeader::INTERESTED:
+        case BitTorrentTypeHeader::NOT_INTERESTED:
+          fields = 0;
+          break;
+        case BitTorrentTypeHeader::HAVE:
+          fields = 1;
+          break;
+        case BitTorrentTypeHeader::REQUEST:
+        case BitTorrentTypeHeader::CANCEL:
+          fields = 3;
+          break;
+        case BitTorrentTypeHeader::PORT:
+          fields = 0;             // The listen port is a 16-bit field, see below
+          break;
+        default:
+          m_nextMessage = message;
+          m_nextMessageHeader = true;
+          m_nextMessageComplete = remaining >= message.m_length;
+          return m_size;
+        }
+
+      if (remaining < message.m_length)
+        {
+          break;
+        }
+
+      // Step 3: Read the fields, if the message is long enough, and skip anything else
+      uint32_t read = 1;
+      if (message.m_length >= read + 4 * fields)
+        {
+          for (uint32_t i = 0; i < fields; ++i)
+            {
+              message.m_fields[i] = start.ReadNtohU32 ();
+            }
+          read += 4 * fields;
+        }
+      if (message.m_type == BitTorrentTypeHeader::PORT && message.m_length >= read + 2)
+        {
+          message.m_fields[0] = start.ReadNtohU16 ();
+          read += 2;
+        }
+      start.Next (message.m_length - read);
+
+      m_messages.push_back (message);
+      m_size += BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + message.m_length;
+      remaining -= message.m_length;
+    }
+
+  return m_size;
+}
+
+TypeId BitTorrentMessageParser::GetTypeId ()
+{
+
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentMessageParser").SetParent<Header> ()
+    .AddConstructor<BitTorrentMessageParser> ();
+
+  return tid;
+}
+
 } // ns bittorrent
 } // ns ns3
@@ -23,6 +23,8 @@
 
 #include "ns3/header.h"
 
+#include <vector>
+
 namespace ns3 {
 namespace bittorrent {
 
@@ -871,6 +873,108 @@ private:
   }
 };
 
+/************************************************************************************************/
+/**************************************** BitTorrentMessageParser *******************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief Parser for the Peer Wire messages at the beginning of a received stream.
+ *
+ * This class is meant to be used with Packet::PeekHeader on the buffer collecting the received stream. It walks the
+ * buffer with a single Buffer::Iterator and decodes all complete messages without payload (keep-alive, CHOKE, UNCHOKE,
+ * INTERESTED, NOT_INTERESTED, HAVE, REQUEST, CANCEL and PORT) at the beginning of the stream, without modifying the packet.
+ * The receiver can then handle these messages and remove them from the stream with a single Packet::RemoveAtStart call,
+ * instead of removing length, type and message headers one by one.
+ *
+ * The parser stops at the first incomplete message or at the first message with payload (BITFIELD, PIECE, EXTENDED
+ * or unknown), whose length and type are available through GetNextMessage if they have already been received.
+ */
+class BitTorrentMessageParser : public Header
+{
+public:
+  // A Peer Wire message without payload
+  struct Message
+  {
+    BitTorrentTypeHeader::BitTorrentMessageType m_type;
+    uint32_t m_length;         // The length as given in the length header (0 for keep-alive messages)
+    uint32_t m_fields[3];      // The piece index, block offset and block length (HAVE: piece index, PORT: listen port)
+  };
+
+// Fields
+private:
+  std::vector<Message> m_messages;   // The complete messages without payload at the beginning of the stream
+  uint32_t m_size;                   // The number of bytes of these messages, including their length headers
+  Message m_nextMessage;             // The length and type of the message following these messages
+  bool m_nextMessageHeader;          // Whether the length and type of the next message have been received
+  bool m_nextMessageComplete;        // Whether the next message has been received completely
+
+// Constructors etc.
+public:
+  BitTorrentMessageParser ();
+  ~BitTorrentMessageParser ();
+  static TypeId GetTypeId (void);
+
+// Getters
+public:
+  /**
+   * @returns the complete messages without payload at the beginning of the stream, in the order of reception.
+   */
+  const std::vector<Message>& GetMessages () const
+  {
+    return m_messages;
+  }
+
+  /**
+   * @returns true, if the length and type of the message following the messages returned by GetMessages have been received.
+   */
+  bool HasNextMessage () const
+  {
+    return m_nextMessageHeader;
+  }
+
+  /**
+   * @returns true, if the message following the messages returned by GetMessages has been received completely.
+   */
+  bool IsNextMessageComplete () const
+  {
+    return m_nextMessageComplete;
+  }
+
+  /**
+   * @returns the length and type of the message following the messages returned by GetMessages (no fields are set).
+   */
+  const Message& GetNextMessage () const
+  {
+    return m_nextMessage;
+  }
+
+// (De-)Serialization
+public:
+  /**
+   * \brief Not supported, the parser can only be used to peek at received messages.
+   */
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return m_size;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
 } // ns bittorrent
 } // ns ns3
 
@@ -30,6 +30,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/socket.h"
 
 #include <map>
@@ -50,7 +51,8 @@ class Peer;
  * This class implements the "traditional" HTTP-tracker based method to discover and connect to peers in a BitTorrent swarm.
  * It uses a simplified HTTP client implementation provided by the BitTorrentHttpClient class
  * to communicate with both internal (i.e., ns-3 based) and external BitTorrent trackers
- * using the standardized HTTP-based BitTorrent Tracker protocol.
+ * using the standardized HTTP-based BitTorrent Tracker protocol. Trackers with a udp:// announce URL
+ * are contacted via the UDP tracker protocol (<a href="http://www.bittorrent.org/beps/bep_0015.html" target="_blank">BEP 15</a>) instead.
  *
  * This class implements several methods commonly used in BitTorrent peer discovery mechanisms and applies them to the tracker-based approach.
  * These methods can, however, be overridden in derived classes to implement other peer discovery mechanisms.
@@ -94,6 +96,16 @@ protected:
 
   std::string        m_trackerId;                      // The id we were assigned by the tracker; used for subsequent tracker contacts
 
+  // Swarm participant retrieval via UDP tracker
+  Ptr<Socket>        m_udpTrackerSocket;               // The socket used to contact a UDP tracker
+  Address            m_udpTrackerAddress;              // The address of the UDP tracker
+  uint64_t           m_udpConnectionId;                // The connection id handed out by the UDP tracker
+  Time               m_udpConnectionIdExpiry;          // The time after which a new connection id has to be requested
+  uint32_t           m_udpTransactionId;               // The transaction id of the pending request; 0 if there is none
+  TrackerContactReason m_udpEvent;                     // The reason of the pending announce
+  uint16_t           m_udpNumwant;                     // The numwant of the pending announce
+  Ptr<UniformRandomVariable> m_udpTransactionRandom;   // The stream the transaction ids are drawn from
+
   uint8_t            m_clientUpdateCycles;             // The number of tracker contact cycles of which we want to keep returned clients in our list (i.e., a ring buffer)
   uint8_t            m_currentClientUpdateCycle;       // The current tracker contact cycle
 
@@ -331,6 +343,11 @@ protected:
    */
   void TrackerResponseEvent (Ptr<Socket> socket);
 
+  /**
+   * \brief Listen for responses from a UDP tracker, i.e., connect and announce responses.
+   */
+  void UdpTrackerResponseEvent (Ptr<Socket> socket);
+
   /**
    * \brief Handle timeouts for the peer discovery mechanism.
    *
@@ -362,7 +379,19 @@ protected:
   bool ContactTrackerWrapper (TrackerContactReason reason, uint16_t aNumwant, bool closeCurrentConnection);
 
   /**
-   * \brief Abort an ongoing connection with the HTTP-based tracker.
+   * \brief Announce to a UDP tracker (BEP 15), first requesting a connection id if the current one has expired.
+   *
+   * Parameters as for ContactTracker; additional parameters are not supported by the UDP tracker protocol.
+   */
+  bool ContactUdpTracker (TrackerContactReason event, uint16_t numwant, bool closeCurrentConnection);
+
+  /**
+   * \brief Send out the next request of the pending UDP tracker contact, i.e., a connect or an announce request.
+   */
+  void SendUdpTrackerRequest ();
+
+  /**
+   * \brief Abort an ongoing connection with the HTTP-based tracker or an ongoing request to a UDP tracker.
    */
   void CancelCurrentTrackerRequest ();
 
@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "PieceAvailability.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+namespace bittorrent {
+
+namespace {
+
+// The wire format has the first piece in the high bit of a byte, the words in the low bit
+inline uint8_t
+ReverseBits (uint8_t b)
+{
+  b = ((b & 0xF0) >> 4) | ((b & 0x0F) << 4);
+  b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+  b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+  return b;
+}
+
+inline uint32_t
+LowestBit (uint64_t word)
+{
+  return __builtin_ctzll (word);
+}
+
+} // namespace
+
+PieceAvailability::PieceAvailability ()
+  : m_maxAvailability (0)
+{
+}
+
+void PieceAvailability::Initialize (uint32_t numberOfPieces, uint16_t maxAvailability)
+{
+  m_maxAvailability = maxAvailability;
+  m_counts.assign (numberOfPieces, 0);
+  m_completed.assign (numberOfPieces, false);
+  Rebuild ();
+}
+
+void PieceAvailability::SetMaxAvailability (uint16_t maxAvailability)
+{
+  m_maxAvailability = maxAvailability;
+  Rebuild ();
+}
+
+void PieceAvailability::ToWords (const std::vector<uint8_t> &bitfield, Words &words) const
+{
+  uint32_t numberOfPieces = m_counts.size ();
+  words.assign ((numberOfPieces + 63) / 64, 0);
+
+  uint32_t bytes = std::min<uint32_t> (bitfield.size (), (numberOfPieces + 7) / 8);
+  for (uint32_t i = 0; i < bytes; ++i)
+    {
+      words[i / 8] |= static_cast<uint64_t> (ReverseBits (bitfield[i])) << (8 * (i % 8));
+    }
+
+  // Spare bits of the last byte must be cleared by the peer, but do not count on that
+  if (numberOfPieces % 64 != 0)
+    {
+      words.back () &= (static_cast<uint64_t> (1) << (numberOfPieces % 64)) - 1;
+    }
+}
+
+void PieceAvailability::Update (Words &counted, const Words &announced)
+{
+  counted.resize ((m_counts.size () + 63) / 64, 0);
+
+  for (uint32_t w = 0; w < counted.size (); ++w)
+    {
+      uint64_t now = w < announced.size () ? announced[w] : 0;
+      if (now == counted[w])
+        {
+          continue;
+        }
+
+      uint64_t added = now & ~counted[w];
+      uint64_t removed = counted[w] & ~now;
+      while (added != 0)
+        {
+          Increment (w * 64 + LowestBit (added));
+          added &= added - 1;
+        }
+      while (removed != 0)
+        {
+          Decrement (w * 64 + LowestBit (removed));
+          removed &= removed - 1;
+        }
+      counted[w] = now;
+    }
+}
+
+bool PieceAvailability::Add (Words &counted, uint32_t pieceIndex)
+{
+  if (pieceIndex >= m_counts.size ())
+    {
+      return false;
+    }
+
+  counted.resize ((m_counts.size () + 63) / 64, 0);
+  uint64_t bit = static_cast<uint64_t> (1) << (pieceIndex % 64);
+  if (counted[pieceIndex / 64] & bit)
+    {
+      return false;
+    }
+
+  counted[pieceIndex / 64] |= bit;
+  Increment (pieceIndex);
+  return true;
+}
+
+void PieceAvailability::SetCompleted (uint32_t pieceIndex)
+{
+  if (m_completed[pieceIndex])
+    {
+      return;
+    }
+
+  for (uint16_t bucket = GetBucket (pieceIndex); bucket <= m_maxAvailability; ++bucket)
+    {
+      MoveUp (pieceIndex, bucket);
+    }
+  m_completed[pieceIndex] = true;
+}
+
+uint16_t PieceAvailability::GetBucket (uint32_t pieceIndex) const
+{
+  if (m_completed[pieceIndex])
+    {
+      return m_maxAvailability + 1;
+    }
+  return std::min (m_counts[pieceIndex], m_maxAvailability);
+}
+
+uint32_t PieceAvailability::Count (const Words &words)
+{
+  uint32_t count = 0;
+  for (Words::const_iterator it = words.begin (); it != words.end (); ++it)
+    {
+      count += __builtin_popcountll (*it);
+    }
+  return count;
+}
+
+void PieceAvailability::Increment (uint32_t pieceIndex)
+{
+  uint16_t count = m_counts[pieceIndex];
+  if (count == std::numeric_limits<uint16_t>::max ())
+    {
+      return;
+    }
+
+  m_counts[pieceIndex] = count + 1;
+  if (!m_completed[pieceIndex] && count < m_maxAvailability)
+    {
+      MoveUp (pieceIndex, count);
+    }
+}
+
+void PieceAvailability::Decrement (uint32_t pieceIndex)
+{
+  uint16_t count = m_counts[pieceIndex];
+  if (count == 0)
+    {
+      return;
+    }
+
+  m_counts[pieceIndex] = count - 1;
+  if (!m_completed[pieceIndex] && count <= m_maxAvailability)
+    {
+      MoveDown (pieceIndex, count);
+    }
+}
+
+void PieceAvailability::MoveUp (uint32_t pieceIndex, uint16_t bucket)
+{
+  // The last position of the bucket becomes the first position of the next bucket
+  uint32_t last = m_bucketStarts[bucket + 1] - 1;
+  Swap (pieceIndex, last);
+  m_bucketStarts[bucket + 1] = last;
+}
+
+void PieceAvailability::MoveDown (uint32_t pieceIndex, uint16_t bucket)
+{
+  // The first position of the bucket becomes the last position of the previous bucket
+  uint32_t first = m_bucketStarts[bucket];
+  Swap (pieceIndex, first);
+  m_bucketStarts[bucket] = first + 1;
+}
+
+void PieceAvailability::Swap (uint32_t pieceIndex, uint32_t position)
+{
+  uint32_t other = m_pieces[position];
+  uint32_t oldPosition = m_positions[pieceIndex];
+
+  m_pieces[position] = pieceIndex;
+  m_pieces[oldPosition] = other;
+  m_positions[pieceIndex] = position;
+  m_positions[other] = oldPosition;
+}
+
+void PieceAvailability::Rebuild ()
+{
+  // Counting sort of the pieces by bucket; pieces of the same bucket are in ascending order
+  uint32_t numberOfPieces = m_counts.size ();
+  m_bucketStarts.assign (m_maxAvailability + 3, 0);
+  for (uint32_t i = 0; i < numberOfPieces; ++i)
+    {
+      m_bucketStarts[GetBucket (i) + 1]++;
+    }
+  for (uint32_t bucket = 1; bucket < m_bucketStarts.size (); ++bucket)
+    {
+      m_bucketStarts[bucket] += m_bucketStarts[bucket - 1];
+    }
+
+  std::vector<uint32_t> next (m_bucketStarts.begin (), m_bucketStarts.end () - 1);
+  m_pieces.resize (numberOfPieces);
+  m_positions.resize (numberOfPieces);
+  for (uint32_t i = 0; i < numberOfPieces; ++i)
+    {
+      uint32_t position = next[GetBucket (i)]++;
+      m_pieces[position] = i;
+      m_positions[i] = position;
+    }
+}
+
+} // ns bittorrent
+} // ns ns3
@@ -27,7 +27,7 @@
 #include "ns3/random-variable.h"
 
 #include <list>
-#include <set>
+#include <map>
 #include <utility>
 #include <vector>
 
@@ -40,35 +40,23 @@ NS_OBJECT_ENSURE_REGISTERED (RarestFirstPartSelectionStrategy);
 RarestFirstPartSelectionStrategy::RarestFirstPartSelectionStrategy (Ptr<BitTorrentClient> myClient) : PartSelectionStrategyBase (myClient)
 {
   // Step 1: Initialize the data structures used to determine the entropy of the pieces in the swarm
-  m_piecesByRarity = new std::set<uint32_t>[m_myClient->GetMaxPeers () + 2];
-  m_raritiesByPiece.resize (m_myClient->GetTorrent ()->GetNumberOfPieces ());
+  m_availability.Initialize (m_myClient->GetTorrent ()->GetNumberOfPieces (), m_myClient->GetMaxPeers ());
 
   // Step 2: Iterate through the pieces and see whether they are available locally (i.e., finished) or not
   for (uint32_t i = 0; i < m_myClient->GetTorrent ()->GetNumberOfPieces (); ++i)
     {
-      // Step 2a: If the piece is in the list of needed pieces, it is obviously not available locally and, hence, needed
-      if (m_neededPieces.find (i) != m_neededPieces.end ())
+      // Step 2a: If the piece is not in the list of needed pieces, it is available locally
+      // (Else, it is needed and nothing else has to be done)
+      if (m_neededPieces.find (i) == m_neededPieces.end ())
         {
-          m_piecesByRarity[0].insert (i);
-          m_raritiesByPiece[i] = 0;
-        }
-      // Step 2b: Else, it is available locally and nothing else has to be done
-      else
-        {
-          m_piecesByRarity[m_myClient->GetMaxPeers () + 1].insert (i);
-          m_raritiesByPiece[i] = m_myClient->GetMaxPeers () + 1;
+          m_availability.SetCompleted (i);
         }
     }
 }
 
 RarestFirstPartSelectionStrategy::~RarestFirstPartSelectionStrategy ()
 {
-  for (uint16_t i = 0; i < m_myClient->GetMaxPeers () + 2; ++i)
-    {
-      m_piecesByRarity[i].clear ();
-    }
-  delete[] m_piecesByRarity;
-  m_raritiesByPiece.clear ();
+  m_announcedPieces.clear ();
 }
 
 void RarestFirstPartSelectionStrategy::DoInitialize ()
@@ -86,36 +74,14 @@ void RarestFirstPartSelectionStrategy::DoInitialize ()
 
 void RarestFirstPartSelectionStrategy::ProcessPeerBitfieldReceivedEvent (Ptr<Peer> peer)
 {
-  // Step 1: Gather all the pieces we have to move because the newly-connected peer has them
-  std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > > *toMove = new std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >[m_myClient->GetMaxPeers ()];
-  for (uint16_t i = 0; i <= m_myClient->GetMaxPeers () - 1; ++i)
-    {
-      std::set<uint32_t>::iterator it = m_piecesByRarity[i].begin ();
-      for (; it != m_piecesByRarity[i].end (); ++it)
-        {
-          if (peer->HasPiece (*it))
-            {
-              toMove[i].push_back (std::pair<uint16_t, std::set<uint32_t>::iterator > (i, it));
-            }
-        }
-    }
+  // Step 1: Count the pieces announced by the peer that are not yet counted for it, 64 pieces at a time
+  PieceAvailability::Words announced;
+  m_availability.ToWords (*peer->GetBitfield (), announced);
+  m_availability.Update (m_announcedPieces[peer], announced);
 
-  // Step 2: Now, move the pieces to move
-  for (uint16_t i = 0; i <= m_myClient->GetMaxPeers () - 1; ++i)
-    {
-      std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >::const_iterator it2 = toMove[i].begin ();
-      for (; it2 != toMove[i].end (); ++it2)
-        {
-          std::pair<uint16_t, std::set<uint32_t>::iterator > it3 = *it2;
-          m_piecesByRarity[it3.first + 1].insert (*(it3.second));
-          m_raritiesByPiece[*(it3.second)]++;
-          m_piecesByRarity[it3.first].erase (it3.second);
-        }
-      toMove[i].clear ();
-    }
-  delete[] toMove;
+  NS_LOG_LOGIC ("Peer " << peer->GetRemoteIp () << " announced " << PieceAvailability::Count (announced) << " pieces.");
 
-  // Step 3: Call the base class event handler (Note: This needs to be done at the end because it may cause a call to Schedule()!)
+  // Step 2: Call the base class event handler (Note: This needs to be done at the end because it may cause a call to Schedule()!)
   PartSelectionStrategyBase::ProcessBitfieldReceivedEvent (peer);
 }
 
@@ -127,56 +93,28 @@ void RarestFirstPartSelectionStrategy::ProcessPeerHaveEvent (Ptr<Peer> peer, uin
       return;
     }
 
-  // Step 1: Get the rarity of the newly-announced piece, return if an error (= already announced by each peer, e.g., double announce) occurred
-  uint16_t currentRarity = m_raritiesByPiece[pieceIndex];
-  if (currentRarity >= m_myClient->GetMaxPeers ())
+  // Step 1: Shift the availability of the respective piece, return if an error (e.g., double announce, invalid index) occurred
+  if (!m_availability.Add (m_announcedPieces[peer], pieceIndex))
     {
       return;
     }
-  // Step 1a: Else, shift the availability of the respective piece
-  else
-    {
-      m_piecesByRarity[currentRarity].erase (pieceIndex);
-      m_piecesByRarity[currentRarity + 1].insert (pieceIndex);
-      m_raritiesByPiece[pieceIndex] = currentRarity + 1;           // m_raritiesByPiece[pieceIndex] + 1;
-    }
 
-  // Step 3: Call the base class event handler, e.g., for invoking the scheduler
+  // Step 2: Call the base class event handler, e.g., for invoking the scheduler
   PartSelectionStrategyBase::ProcessPeerHaveEvent (peer, pieceIndex);
 }
 
 void RarestFirstPartSelectionStrategy::ProcessPeerConnectionCloseEvent (Ptr<Peer> peer)
 {
-  /*
-   * NOTE: This function is more or less the "inverse" to ProcessBitfieldReceivedEvent, so no further annotations here
-   */
-  std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > > *toMove = new std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >[m_myClient->GetMaxPeers ()];
-  for (uint16_t i = 1; i <= m_myClient->GetMaxPeers (); ++i)
+  // Step 1: Shift the availability of all pieces counted for the peer down by one
+  // (Note: The peer may already have cleared its bitfield, so we cannot rely on HasPiece () here)
+  std::map<Ptr<Peer>, PieceAvailability::Words>::iterator it = m_announcedPieces.find (peer);
+  if (it != m_announcedPieces.end ())
     {
-      std::set<uint32_t>::iterator it = m_piecesByRarity[i].begin ();
-      for (; it != m_piecesByRarity[i].end (); ++it)
-        {
-          if (peer->HasPiece (*it))
-            {
-              toMove[i - 1].push_back (std::pair<uint16_t, std::set<uint32_t>::iterator > (i, it));
-            }
-        }
+      m_availability.Update (it->second, PieceAvailability::Words ());
+      m_announcedPieces.erase (it);
     }
 
-  for (uint16_t i = 1; i <= m_myClient->GetMaxPeers (); ++i)
-    {
-      std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >::const_iterator it2 = toMove[i - 1].begin ();
-      for (; it2 != toMove[i - 1].end (); ++it2)
-        {
-          std::pair<uint16_t, std::set<uint32_t>::iterator > it3 = *it2;
-          m_piecesByRarity[it3.first - 1].insert (*(it3.second));
-          m_raritiesByPiece[*(it3.second)]--;
-          m_piecesByRarity[it3.first].erase (it3.second);
-        }
-      toMove[i - 1].clear ();
-    }
-  delete[] toMove;
-
+  // Step 2: Call the base class event handler
   PartSelectionStrategyBase::ProcessPeerConnectionCloseEvent (peer);
 }
 
@@ -185,67 +123,11 @@ void RarestFirstPartSelectionStrategy::ProcessStrategyOptionsChangedEvent ()
   // Step 1: We must react to a changed maximum number of peers so we can sort into our buckets correctly
   if (m_myClient->GetLastChangedStrategyOptionName () == "max_peers")
     {
-      // Step 1: We retrieve the old and new values of the maximum peers
+      // Step 1a: The availability counters stay valid, so we only have to re-sort the pieces into the new buckets
+      // (Note: If the surplus peers have not been de-registered yet, pieces announced by more peers than allowed
+      //        are kept in the highest bucket until their connections are closed)
       std::pair<std::string, std::string> maxPeers = m_myClient->GetStrategyOptionChangePair ("max_peers");
-      uint16_t oldMaxPeers = lexical_cast<uint16_t> (maxPeers.first);
-      uint16_t newMaxPeers = lexical_cast<uint16_t> (maxPeers.second);
-
-      // Step 2: Now, we create a new array, assign the values accordingly, delete the old array and set the pointer to the new array start
-      // Step 2a: The easy case: newMaxPeers >= oldMaxPeers: Just enlarge the array
-      if (newMaxPeers >= oldMaxPeers)
-        {
-          std::set<uint32_t>* newPiecesByRarity = new std::set<uint32_t>[newMaxPeers + 2];
-          for (uint32_t i = 0; i < oldMaxPeers; ++i)
-            {
-              newPiecesByRarity[i] = m_piecesByRarity[i];
-              m_piecesByRarity[i].clear ();
-            }
-          delete[] m_piecesByRarity;
-          m_piecesByRarity = newPiecesByRarity;
-        }
-      /*
-       * Step 2b: The not-so-easy case: newMaxPeers < oldMaxPeers: Resize the array and re-fill it
-       * NOTE: This implementation DEMANDS that the surplus peers have already been correctly de-registered from the client!
-       *       Otherwise, the strategy is unable to determine the number of correctly-registered clients.
-       *       Note that this is normally guaranteed if any strategy responsible for peer connections is the first strategy
-       *       informed about this event. The standard implementation of the ProtocolFactory guarantees this.
-       */
-      else
-        {
-          // Step 2b1: Delete the array of old sets and create a new one
-          for (uint32_t i = 0; i < oldMaxPeers; ++i)
-            {
-              m_piecesByRarity[i].clear ();
-            }
-          delete[] m_piecesByRarity;
-          m_piecesByRarity = new std::set<uint32_t>[newMaxPeers + 2];
-
-          // Step 2b2: Now, refill the buckets
-          for (uint32_t i = 0; i < m_myClient->GetTorrent ()->GetNumberOfPieces (); ++i)
-            {
-              // Step 2b2a: The easy subcase: The piece is available locally
-              if (m_neededPieces.find (i) == m_neededPieces.end ())
-                {
-                  m_piecesByRarity[newMaxPeers + 1].insert (i);
-                  m_raritiesByPiece[i] = newMaxPeers + 1;
-                }
-              // Step 2b2b: The not-so.easy subcase: The piece is NOT available locally, so we have to recount its rarity
-              else
-                {
-                  uint16_t rarity = 0;
-                  for (std::vector<Ptr<Peer> >::const_iterator it = m_myClient->GetPeerListIterator (); it != m_myClient->GetPeerListEnd (); ++it)
-                    {
-                      if ((*it)->HasPiece (i))
-                        {
-                          ++rarity;
-                        }
-                    }
-
-                  m_piecesByRarity[rarity].insert (i);
-                  m_raritiesByPiece[i] = rarity;
-                }
-            }
-        }
+      m_availability.SetMaxAvailability (lexical_cast<uint16_t> (maxPeers.second));
     }
 
   // Step 2: Call the base class event handler
@@ -254,26 +136,10 @@ void RarestFirstPartSelectionStrategy::ProcessStrategyOptionsChangedEvent ()
 
 void RarestFirstPartSelectionStrategy::ProcessCompletedPiece (uint32_t pieceIndex)
 {
-  // Step 1: Get the current rarity of the newly-completed piece
-  uint16_t currentRarity = m_raritiesByPiece[pieceIndex];
-
-  // Step 2: If the rarity was not the "maximum rarity" (i.e., it was missing), mark it as completed
-  if (currentRarity <= m_myClient->GetMaxPeers ())
-    {
-      m_piecesByRarity[currentRarity].erase (pieceIndex);
-      
-      // OLD
-      // m_piecesByRarity[m_myClient->GetMaxPeers () + 1].insert (pieceIndex);
-      
-      // MEMORY
-      uint32_t newRarity = m_myClient->GetMaxPeers () + 1;
-      m_piecesByRarity[newRarity].insert (pieceIndex);
-      // /MEMORY
-      
-      m_raritiesByPiece[pieceIndex] = m_myClient->GetMaxPeers () + 1;
-    }
+  // Step 1: Mark the newly-completed piece as completed, i.e., move it to the bucket of locally available pieces
+  m_availability.SetCompleted (pieceIndex);
 
-  // Step 3: Call the base class event handler
+  // Step 2: Call the base class event handler
   PartSelectionStrategyBase::ProcessCompletedPiece (pieceIndex);
 }
 
@@ -301,7 +167,7 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
         {
           if (RequestAllowedForBlock (peer, (*npmIt).second.m_pieceIndex, (*blockIt).first, (*blockIt).second - (*blockIt).first))
             {
-              NS_LOG_INFO ("Rarest First educated guess chose piece " << (*npmIt).second.m_pieceIndex << "@" << (*blockIt).first << "->" << (*blockIt).second - (*blockIt).first << " (rarity " <<  m_raritiesByPiece[(*npmIt).second.m_pieceIndex] << ").");
+              NS_LOG_INFO ("Rarest First educated guess chose piece " << (*npmIt).second.m_pieceIndex << "@" << (*blockIt).first << "->" << (*blockIt).second - (*blockIt).first << " (rarity " << m_availability.GetBucket ((*npmIt).second.m_pieceIndex) << ").");
 
               blockPtr.m_pieceIndex = (*npmIt).second.m_pieceIndex;
               blockPtr.m_blockOffset = (*blockIt).first;
@@ -325,20 +191,22 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
   // Step 3b: If the heuristic did not find a suitable block, apply a rarest-first scheme
   // Step 3b1: Iterate through the needed pieces in the order given by our rarity list
   uint16_t i = 1;
-  while (!blockFound && i <= m_myClient->GetMaxPeers ())
+  while (!blockFound && i <= m_availability.GetMaxAvailability ())
     {
       // Step 3b1a: Only if this bucket is nonempty, enter it
-      if (m_piecesByRarity[i].size () > 0)
+      uint32_t bucketSize = m_availability.GetBucketSize (i);
+      if (bucketSize > 0)
         {
           // Step 3b1a1: Now, prepare a data structure which contains all pieces of the current availability bucket AT THE GIVEN PEER
           std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t> > > possibleBlocks;
-          possibleBlocks.reserve (m_piecesByRarity[i].size ());
-          for (std::set<uint32_t>::const_iterator it = m_piecesByRarity[i].begin (); it != m_piecesByRarity[i].end (); ++it)
+          possibleBlocks.reserve (bucketSize);
+          for (uint32_t j = 0; j < bucketSize; ++j)
             {
               // Step 3b1a1b: Find the first fitting block for each piece
-              if (peer->HasPiece (*it))
+              uint32_t pieceIndex = m_availability.GetPiece (i, j);
+              if (peer->HasPiece (pieceIndex))
                 {
-                  NeededPiecesMap::iterator npmIt = m_neededPieces.find (*it);
+                  NeededPiecesMap::iterator npmIt = m_neededPieces.find (pieceIndex);
                   std::list<std::pair<uint32_t, uint32_t> >::iterator blockIt = (*npmIt).second.m_possibleBlocks.begin ();
                   while (blockIt != (*npmIt).second.m_possibleBlocks.end ())
                     {
@@ -366,7 +234,7 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
               blockFound = true;
               possibleBlocks.clear ();
 
-              NS_LOG_INFO ("Rarest First heuristic chose piece " << blockPtr.m_pieceIndex << "@" << blockPtr.m_blockOffset << "->" << blockPtr.m_blockOffset + blockPtr.m_blockLength << " (rarity " <<  m_raritiesByPiece[blockPtr.m_pieceIndex] << ").");
+              NS_LOG_INFO ("Rarest First heuristic chose piece " << blockPtr.m_pieceIndex << "@" << blockPtr.m_blockOffset << "->" << blockPtr.m_blockOffset + blockPtr.m_blockLength << " (rarity " << m_availability.GetBucket (blockPtr.m_pieceIndex) << ").");
 
               break;
             }
@@ -0,0 +1,451 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef BTUDPTRACKERPACKET_H_
+#define BTUDPTRACKERPACKET_H_
+
+#include "ns3/header.h"
+
+#include <cstring>
+
+namespace ns3 {
+namespace bittorrent {
+
+/*
+ * The messages of the UDP tracker protocol, see <a href="http://www.bittorrent.org/beps/bep_0015.html" target="_blank">BEP 15</a>.
+ *
+ * A request consists of a BitTorrentUdpTrackerRequestHeader, followed by a BitTorrentUdpTrackerAnnounceRequest
+ * (announce) or a list of 20-byte info hashes (scrape). A response consists of a BitTorrentUdpTrackerResponseHeader,
+ * followed by a BitTorrentUdpTrackerConnectResponse (connect), a BitTorrentUdpTrackerAnnounceResponse and a compact
+ * peer list of 6 bytes per peer (announce), 12 bytes of statistics per requested info hash (scrape) or an error message.
+ */
+
+/************************************************************************************************/
+/********************************* BitTorrentUdpTrackerRequestHeader ****************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief The header of a request to a UDP tracker.
+ */
+class BitTorrentUdpTrackerRequestHeader : public Header
+{
+// Types used
+public:
+  enum UdpTrackerAction
+  {
+    CONNECT = 0,
+    ANNOUNCE = 1,
+    SCRAPE = 2,
+    ERROR = 3
+  };
+
+// Fields
+private:
+  uint64_t m_connectionId;   // The id handed out by the tracker in a connect response; the protocol id for connect requests
+  uint32_t m_action;         // The UdpTrackerAction
+  uint32_t m_transactionId;  // Chosen by the client to match the response
+
+// Constructors etc.
+public:
+  BitTorrentUdpTrackerRequestHeader ();
+  BitTorrentUdpTrackerRequestHeader (uint64_t connectionId, uint32_t action, uint32_t transactionId);
+  ~BitTorrentUdpTrackerRequestHeader ();
+  static TypeId GetTypeId (void);
+
+// Getters, Setters
+  uint64_t GetConnectionId () const
+  {
+    return m_connectionId;
+  }
+
+  uint32_t GetAction () const
+  {
+    return m_action;
+  }
+
+  uint32_t GetTransactionId () const
+  {
+    return m_transactionId;
+  }
+
+// (De-)Serialization
+public:
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 16;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+private:
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
+/************************************************************************************************/
+/******************************** BitTorrentUdpTrackerAnnounceRequest ***************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief The body of an announce request to a UDP tracker.
+ */
+class BitTorrentUdpTrackerAnnounceRequest : public Header
+{
+// Types used
+public:
+  enum UdpTrackerEvent
+  {
+    NONE = 0,
+    COMPLETED = 1,
+    STARTED = 2,
+    STOPPED = 3
+  };
+
+// Fields
+private:
+  uint8_t m_infoHash[20];    // The info hash of the torrent
+  uint8_t m_peerId[20];      // The peer id of the client
+  uint64_t m_downloaded;
+  uint64_t m_left;
+  uint64_t m_uploaded;
+  uint32_t m_event;          // The UdpTrackerEvent
+  uint32_t m_ip;             // The IP address of the client; 0 to use the source address of the request
+  uint32_t m_key;
+  int32_t m_numWant;         // -1 for the tracker's default
+  uint16_t m_port;           // The port the client listens at for Peer Wire connections
+
+// Constructors etc.
+public:
+  BitTorrentUdpTrackerAnnounceRequest ();
+  ~BitTorrentUdpTrackerAnnounceRequest ();
+  static TypeId GetTypeId (void);
+
+// Getters, Setters
+  const uint8_t* GetInfoHash () const
+  {
+    return m_infoHash;
+  }
+
+  void SetInfoHash (const uint8_t *hash)
+  {
+    memcpy (m_infoHash, hash, 20);
+  }
+
+  const uint8_t* GetPeerId () const
+  {
+    return m_peerId;
+  }
+
+  void SetPeerId (const uint8_t *peerId)
+  {
+    memcpy (m_peerId, peerId, 20);
+  }
+
+  uint64_t GetDownloaded () const
+  {
+    return m_downloaded;
+  }
+
+  void SetDownloaded (uint64_t downloaded)
+  {
+    m_downloaded = downloaded;
+  }
+
+  uint64_t GetLeft () const
+  {
+    return m_left;
+  }
+
+  void SetLeft (uint64_t left)
+  {
+    m_left = left;
+  }
+
+  uint64_t GetUploaded () const
+  {
+    return m_uploaded;
+  }
+
+  void SetUploaded (uint64_t uploaded)
+  {
+    m_uploaded = uploaded;
+  }
+
+  uint32_t GetEvent () const
+  {
+    return m_event;
+  }
+
+  void SetEvent (uint32_t event)
+  {
+    m_event = event;
+  }
+
+  uint32_t GetIp () const
+  {
+    return m_ip;
+  }
+
+  void SetIp (uint32_t ip)
+  {
+    m_ip = ip;
+  }
+
+  uint32_t GetKey () const
+  {
+    return m_key;
+  }
+
+  void SetKey (uint32_t key)
+  {
+    m_key = key;
+  }
+
+  int32_t GetNumWant () const
+  {
+    return m_numWant;
+  }
+
+  void SetNumWant (int32_t numWant)
+  {
+    m_numWant = numWant;
+  }
+
+  uint16_t GetPort () const
+  {
+    return m_port;
+  }
+
+  void SetPort (uint16_t port)
+  {
+    m_port = port;
+  }
+
+// (De-)Serialization
+public:
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 82;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+private:
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
+/************************************************************************************************/
+/******************************** BitTorrentUdpTrackerResponseHeader ****************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief The header of a response of a UDP tracker.
+ */
+class BitTorrentUdpTrackerResponseHeader : public Header
+{
+// Fields
+private:
+  uint32_t m_action;         // The UdpTrackerAction of the request; ERROR, if it failed
+  uint32_t m_transactionId;  // The transaction id of the request
+
+// Constructors etc.
+public:
+  BitTorrentUdpTrackerResponseHeader ();
+  BitTorrentUdpTrackerResponseHeader (uint32_t action, uint32_t transactionId);
+  ~BitTorrentUdpTrackerResponseHeader ();
+  static TypeId GetTypeId (void);
+
+// Getters, Setters
+  uint32_t GetAction () const
+  {
+    return m_action;
+  }
+
+  uint32_t GetTransactionId () const
+  {
+    return m_transactionId;
+  }
+
+// (De-)Serialization
+public:
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 8;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+private:
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
+/************************************************************************************************/
+/******************************* BitTorrentUdpTrackerConnectResponse ****************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief The body of a connect response of a UDP tracker.
+ */
+class BitTorrentUdpTrackerConnectResponse : public Header
+{
+// Fields
+private:
+  uint64_t m_connectionId;   // The id to use in the following requests
+
+// Constructors etc.
+public:
+  BitTorrentUdpTrackerConnectResponse ();
+  BitTorrentUdpTrackerConnectResponse (uint64_t connectionId);
+  ~BitTorrentUdpTrackerConnectResponse ();
+  static TypeId GetTypeId (void);
+
+// Getters, Setters
+  uint64_t GetConnectionId () const
+  {
+    return m_connectionId;
+  }
+
+// (De-)Serialization
+public:
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 8;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+private:
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
+/************************************************************************************************/
+/******************************* BitTorrentUdpTrackerAnnounceResponse ***************************/
+/************************************************************************************************/
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief The body of an announce response of a UDP tracker, followed by the compact peer list.
+ */
+class BitTorrentUdpTrackerAnnounceResponse : public Header
+{
+// Fields
+private:
+  uint32_t m_interval;       // The reannouncement interval in seconds
+  uint32_t m_leechers;
+  uint32_t m_seeders;
+
+// Constructors etc.
+public:
+  BitTorrentUdpTrackerAnnounceResponse ();
+  BitTorrentUdpTrackerAnnounceResponse (uint32_t interval, uint32_t leechers, uint32_t seeders);
+  ~BitTorrentUdpTrackerAnnounceResponse ();
+  static TypeId GetTypeId (void);
+
+// Getters, Setters
+  uint32_t GetInterval () const
+  {
+    return m_interval;
+  }
+
+  uint32_t GetLeechers () const
+  {
+    return m_leechers;
+  }
+
+  uint32_t GetSeeders () const
+  {
+    return m_seeders;
+  }
+
+// (De-)Serialization
+public:
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 12;
+  }
+
+  virtual void Print (std::ostream &os) const
+  {
+    // Stub
+  }
+
+private:
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+};
+
+} // ns bittorrent
+} // ns ns3
+
+#endif /* BTUDPTRACKERPACKET_H_ */
@@ -24,6 +24,7 @@
 #include "BitTorrentHttpServer.h"
 
 #include "ns3/BitTorrentUtilities.h"
+#include "ns3/BitTorrentUdpTrackerPacket.h"
 #include "ns3/Torrent.h"
 
 #include "ns3/address.h"
@@ -31,11 +32,13 @@
 #include "ns3/callback.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/socket.h"
 
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace ns3 {
 namespace bittorrent {
@@ -54,6 +57,10 @@ typedef std::map<std::string, BTDict>           BTDoubleDict;
  * to communicate with both internal (i.e., ns-3 based) and external BitTorrent clients
  * using the standardized HTTP-based BitTorrent Tracker protocol.
  *
+ * Optionally, the tracker additionally serves announces and scrapes via the UDP tracker protocol
+ * (<a href="http://www.bittorrent.org/beps/bep_0015.html" target="_blank">BEP 15</a>), which replaces the TCP connection
+ * and the bencoded text of each announce by a connect exchange and a binary announce with a compact peer list, see SetUdpEnabled.
+ *
  * The tracker can handle multiple swarms (i.e., .torrent files) at the same time. Each torrent that
  * the tracker should accept must be previously registered using the AddTorrent member function. The
  * tracker returns a HTTP 404 (not found) error when a requested torrent swarm was not registered.
@@ -90,9 +97,21 @@ private:
   std::string                m_scrapePath;       // The scrape URL path that the tracker accepts
   std::string                m_updateInterval;   // Reannounce interval; a string since we only send it
 
+  // UDP tracker protocol
+  bool                       m_udpEnabled;       // Whether announces are also accepted via UDP and handed out as udp:// announce URLs
+  uint16_t                   m_udpPort;          // The port the UDP tracker listens at
+  Ptr<Socket>                m_udpSocket;        // The socket of the UDP tracker
+  uint64_t                   m_udpSecret;        // Randomizes the connection ids handed out by the UDP tracker
+  Ptr<UniformRandomVariable> m_udpSecretRandom;  // The stream the secret is drawn from when the UDP tracker is opened
+
+  // Processing cost, measured around the socket read handlers of the HTTP and the UDP tracker
+  uint64_t                   m_requestsHandled;  // Number of announce/scrape requests handled
+  int64_t                    m_processingCpuNs;  // Processor time of the simulation thread spent in the read handlers
+  int64_t                    m_processingWallNs; // Wall-clock time spent in the read handlers
+
 protected:
   /// @cond HIDDEN
-  std::map<std::string, BitTorrentTrackerCloudInfo> m_cloudInfo;     // The clouds that the tracker serves; info hash as index
+  std::map<std::string, BitTorrentTrackerCloudInfo> m_cloudInfo;     // The clouds that the tracker serves; binary (20-byte) info hash as index
   /// @endcond HIDDEN
 
 protected:
@@ -154,6 +173,7 @@ public:
   // Retrieves the full announce path, including IP address and port number
   /**
    * @returns the fully-qualified announce URL to use in a request to the tracker, including the tracker's IP and listening port.
+   * A udp:// URL, if the UDP tracker protocol is enabled.
    */
   std::string GetAnnounceURL () const;
 
@@ -179,6 +199,59 @@ public:
    */
   void SetUpdateInterval (Time updateInterval);
 
+  bool GetUdpEnabled () const;
+
+  /**
+   * \brief Enable the UDP tracker protocol (BEP 15).
+   *
+   * If enabled, the tracker listens for UDP tracker requests in addition to HTTP requests, and the announce URL of torrents
+   * added afterwards (see AddTorrent) is a udp:// URL, so the clients of these torrents use the UDP tracker protocol.
+   *
+   * The default is false. Must be set before the application is started.
+   *
+   * @param udpEnabled whether to enable the UDP tracker protocol.
+   */
+  void SetUdpEnabled (bool udpEnabled);
+
+  uint16_t GetUdpPort () const;
+
+  /**
+   * \brief Set the port the UDP tracker listens at. The default is 6969.
+   *
+   * @param udpPort the port to use. Must be set before the application is started.
+   */
+  void SetUdpPort (uint16_t udpPort);
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random variables used by the tracker.
+   *
+   * The tracker draws the secret of the UDP connection ids from this stream when it is started.
+   *
+   * @param stream first stream index to use.
+   * @returns the number of stream indices assigned by this tracker.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * @returns the number of announce and scrape requests the tracker has handled, via HTTP and UDP.
+   */
+  uint64_t GetRequestsHandled () const;
+
+  /**
+   * \brief Get the processor time the simulation spent handling tracker requests.
+   *
+   * The time is measured around the handlers of the tracker's sockets (reading, parsing and answering requests, including
+   * sending the answer down the stack), so HTTP and UDP trackers can be compared. Connection setup of HTTP is not included.
+   *
+   * @returns the accumulated processor time of the thread running the tracker.
+   */
+  Time GetProcessingCpuTime () const;
+
+  /**
+   * @returns the accumulated wall-clock time spent in the same handlers as GetProcessingCpuTime.
+   */
+  Time GetProcessingWallTime () const;
+
 // Main interaction methods
 public:
   /**
@@ -237,6 +310,12 @@ private:
   // The callback that is triggered when the server wants to answer; triggers the generation of an answer
   void DataCreater (std::string path, Ptr<Socket> socket, const Address& fromAddress);
 
+  // Handles incoming datagrams of the UDP tracker protocol
+  void HandleUdpRead (Ptr<Socket> socket);
+
+  // Adds the processor and wall-clock time since the given start times to the processing cost
+  void AccountProcessingTime (int64_t cpuStartNs, int64_t wallStartNs);
+
 // Overridable members for tracker-specific behavior
 public:
   /**
@@ -266,6 +345,21 @@ public:
 
 // Internal methods
 private:
+  // Applies the event of an announce (none, "started", "completed" or "stopped") to the cloud; false if the announce is invalid
+  bool ProcessAnnounce (BTDict& clientInfo);
+
+  // Selects up to numwant random members of a cloud
+  void SelectRandomClients (const BitTorrentTrackerCloudInfo& cloudInfo, uint32_t numwant, std::vector<const BTDict*>& result) const;
+
+  // Answer the requests of the UDP tracker protocol
+  void HandleUdpConnect (const BitTorrentUdpTrackerRequestHeader& request, const Address& fromAddress);
+  void HandleUdpAnnounce (const BitTorrentUdpTrackerRequestHeader& request, Ptr<Packet> packet, const Address& fromAddress);
+  void HandleUdpScrape (const BitTorrentUdpTrackerRequestHeader& request, Ptr<Packet> packet, const Address& fromAddress);
+  void SendUdpError (uint32_t transactionId, std::string message, const Address& fromAddress);
+
+  // The connection id of a client for a period of BT_TRACKER_UDP_CONNECTION_ID_LIFETIME seconds
+  uint64_t GetUdpConnectionId (const Address& fromAddress, uint64_t period) const;
+
   // Adds an info_hash to the trackers internal data structures so that announces for this torrent will be handled
   void AddInfoHash (std::string info_hash);
   // The inverse of AddInfoHash. A torrent without a registered info_hash will be ignored
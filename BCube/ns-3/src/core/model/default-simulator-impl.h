@@ -31,8 +31,25 @@
 
 #include <list>
 
+#ifdef NS3_EVENT_PROFILER
+#include <map>
+#include <vector>
+#include <ostream>
+#endif
+
 namespace ns3 {
 
+/**
+ * \ingroup core
+ *
+ * \brief The default, sequential simulator implementation
+ *
+ * When ns-3 is configured with --enable-event-profiler (NS3_EVENT_PROFILER),
+ * every event is timed with the wall clock and accounted under the function
+ * scheduled with MakeEvent (see EventImpl::GetProfileKey), and the depth of
+ * the event queue is sampled over simulated time. Both are printed as tables
+ * on Simulator::Destroy. Without that option, no profiling code is compiled.
+ */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
 public:
@@ -59,11 +76,16 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+#ifdef NS3_EVENT_PROFILER
+  void ProfileEvent (EventImpl *event);
+  void PrintProfile (std::ostream &os) const;
+#endif
  
   struct EventWithContext {
     uint32_t context;
@@ -84,11 +106,35 @@ private:
   uint32_t m_currentUid;
   uint64_t m_currentTs;
   uint32_t m_currentContext;
+  uint64_t m_eventCount;
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
 
   SystemThread::ThreadId m_main;
+
+#ifdef NS3_EVENT_PROFILER
+  struct ProfileEntry
+  {
+    ProfileEntry ();
+    uint64_t count;
+    uint64_t totalNs;       // wall clock time spent in the events
+    uint64_t maxNs;
+  };
+  typedef std::map<EventImpl::ProfileKey, ProfileEntry> Profile;
+  Profile m_profile;
+
+  struct DepthSample
+  {
+    DepthSample ();
+    uint64_t events;
+    uint64_t depthSum;      // sum over the events of the number of pending events
+    int maxDepth;
+  };
+  // samples of the event queue depth, one per m_depthSampleTs time steps of simulated time
+  std::vector<DepthSample> m_depthSamples;
+  uint64_t m_depthSampleTs;
+#endif
 };
 
 } // namespace ns3
@@ -21,7 +21,15 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "simple-ref-count.h"
+#include "ns3/core-config.h"
+
+#ifdef NS3_EVENT_PROFILER
+#include <string.h>
+#include <typeinfo>
+#include "type-traits.h"
+#endif
 
 namespace ns3 {
 
@@ -58,9 +66,53 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Events are allocated by EventPool
+   */
+  static void *operator new (size_t size);
+  /**
+   * \param size size of the dynamic type, EventImpl has a virtual destructor
+   */
+  static void operator delete (void *p, size_t size);
+
+#ifdef NS3_EVENT_PROFILER
+  /**
+   * \brief Identifies the code run by an event in the event profile of DefaultSimulatorImpl
+   */
+  struct ProfileKey
+  {
+    const std::type_info *type; //!< type of the scheduled function, or of the event itself
+    const void *function;       //!< first word of the scheduled (member) function pointer, 0 if unknown
+    bool member;                //!< whether function comes from a pointer to member function
+    bool operator < (const ProfileKey &other) const;
+  };
+  /**
+   * \returns the key under which this event is accounted by the event profiler
+   *
+   * The default is the dynamic type of the event. The events created by
+   * MakeEvent return the scheduled function instead, so that, e.g., two
+   * methods of one class with the same signature are told apart.
+   */
+  virtual ProfileKey GetProfileKey (void) const;
+#endif
+
 protected:
   virtual void Notify (void) = 0;
 
+#ifdef NS3_EVENT_PROFILER
+  template <typename F>
+  static ProfileKey MakeProfileKey (F function)
+  {
+    ProfileKey key;
+    key.type = &typeid (F);
+    key.function = 0;
+    key.member = TypeTraits<F>::IsPointerToMember;
+    // a member function pointer is (at least) a code address or a vtable offset, followed by a this adjustment
+    memcpy (&key.function, &function, sizeof (F) < sizeof (void *) ? sizeof (F) : sizeof (void *));
+    return key;
+  }
+#endif
+
 private:
   bool m_cancel;
 };
@@ -27,6 +27,8 @@
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
 #include "ns3/node.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 
 NS_LOG_COMPONENT_DEFINE ("TcpNewReno");
 
@@ -48,9 +50,20 @@ TcpNewReno::GetTypeId (void)
 		    BooleanValue (false),
 		    MakeBooleanAccessor (&TcpNewReno::m_limitedTx),
 		    MakeBooleanChecker ())
+    .AddAttribute ("Dctcp", "On ECN connections, reduce cwnd by alpha/2 (DCTCP) instead of by half",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpNewReno::m_dctcp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DctcpGain", "Weight of the fraction of marked bytes of the last window in DCTCP alpha",
+                   DoubleValue (1.0 / 16),
+                   MakeDoubleAccessor (&TcpNewReno::m_dctcpGain),
+                   MakeDoubleChecker<double> (0.0, 1.0))
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
                      MakeTraceSourceAccessor (&TcpNewReno::m_cWnd))
+    .AddTraceSource ("DctcpAlpha",
+                     "Estimated fraction of marked bytes (DCTCP alpha)",
+                     MakeTraceSourceAccessor (&TcpNewReno::m_dctcpAlpha))
   ;
   return tid;
 }
@@ -58,7 +71,14 @@ TcpNewReno::GetTypeId (void)
 TcpNewReno::TcpNewReno (void)
   : m_retxThresh (3), // mute valgrind, actual value set by the attribute system
     m_inFastRec (false),
-    m_limitedTx (false) // mute valgrind, actual value set by the attribute system
+    m_limitedTx (false), // mute valgrind, actual value set by the attribute system
+    m_dctcp (false),
+    m_dctcpGain (1.0 / 16),
+    m_dctcpAlpha (1.0), // RFC 8257 sec. 3.3
+    m_ecnBytesAcked (0),
+    m_ecnBytesMarked (0),
+    m_ecnWindowEnd (0),
+    m_ecnRecover (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -70,7 +90,14 @@ TcpNewReno::TcpNewReno (const TcpNewReno& sock)
     m_initialCWnd (sock.m_initialCWnd),
     m_retxThresh (sock.m_retxThresh),
     m_inFastRec (false),
-    m_limitedTx (sock.m_limitedTx)
+    m_limitedTx (sock.m_limitedTx),
+    m_dctcp (sock.m_dctcp),
+    m_dctcpGain (sock.m_dctcpGain),
+    m_dctcpAlpha (sock.m_dctcpAlpha),
+    m_ecnBytesAcked (0),
+    m_ecnBytesMarked (0),
+    m_ecnWindowEnd (sock.m_ecnWindowEnd),
+    m_ecnRecover (sock.m_ecnRecover)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -186,6 +213,42 @@ TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
     };
 }
 
+/** ACK of new data on ECN connection. Update DCTCP alpha at the end of each
+    observation window (about one RTT), and cut cwnd upon ECE at most once per
+    window of data (RFC 3168 sec. 6.1.2, RFC 8257 sec. 3.3) */
+void
+TcpNewReno::EcnEcho (SequenceNumber32 const& seq, bool ece)
+{
+  NS_LOG_FUNCTION (this << seq << ece);
+
+  uint32_t acked = static_cast<uint32_t> (seq - m_txBuffer.HeadSequence ());
+  m_ecnBytesAcked += acked;
+  if (ece)
+    {
+      m_ecnBytesMarked += acked;
+    }
+
+  if (m_dctcp && seq >= m_ecnWindowEnd)
+    {
+      double fraction = m_ecnBytesAcked > 0 ? static_cast<double> (m_ecnBytesMarked) / m_ecnBytesAcked : 0.0;
+      m_dctcpAlpha = (1 - m_dctcpGain) * m_dctcpAlpha + m_dctcpGain * fraction;
+      NS_LOG_INFO ("DCTCP window end: marked fraction " << fraction << ", alpha " << m_dctcpAlpha);
+      m_ecnBytesAcked = 0;
+      m_ecnBytesMarked = 0;
+      m_ecnWindowEnd = m_highTxMark;
+    }
+
+  if (ece && !m_inFastRec && seq > m_ecnRecover)
+    {
+      double reduction = m_dctcp ? m_dctcpAlpha.Get () / 2 : 0.5;
+      m_ssThresh = std::max (2 * m_segmentSize, static_cast<uint32_t> (m_cWnd * (1 - reduction)));
+      m_cWnd = m_ssThresh;
+      m_ecnRecover = m_highTxMark;
+      m_ecnSendCwr = true;
+      NS_LOG_INFO ("ECN echo. Reset cwnd to " << m_cWnd << ", ssthresh to " << m_ssThresh);
+    }
+}
+
 /** Retransmit timeout */
 void
 TcpNewReno::Retransmit (void)
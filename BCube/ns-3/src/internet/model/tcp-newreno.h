@@ -32,6 +32,12 @@ namespace ns3 {
  * \brief An implementation of a stream socket using TCP.
  *
  * This class contains the NewReno implementation of TCP, as of RFC2582.
+ *
+ * On connections that negotiated ECN (see TcpSocketBase::UseEcn), cwnd is
+ * reduced at most once per window of data on ACKs carrying ECE: by half
+ * (RFC 3168), or, if the Dctcp attribute is set, by alpha/2, where alpha
+ * is the moving average of the fraction of marked bytes per window
+ * (DCTCP, RFC 8257).
  */
 class TcpNewReno : public TcpSocketBase
 {
@@ -54,6 +60,7 @@ protected:
   virtual void NewAck (SequenceNumber32 const& seq); // Inc cwnd and call NewAck() of parent
   virtual void DupAck (const TcpHeader& t, uint32_t count);  // Halving cwnd and reset nextTxSequence
   virtual void Retransmit (void); // Exit fast recovery upon retransmit timeout
+  virtual void EcnEcho (SequenceNumber32 const& seq, bool ece); // Update DCTCP alpha and reduce cwnd upon ECE
 
   // Implementing ns3::TcpSocket -- Attribute get/set
   virtual void     SetSegSize (uint32_t size);
@@ -72,6 +79,15 @@ protected:
   uint32_t               m_retxThresh;   //< Fast Retransmit threshold
   bool                   m_inFastRec;    //< currently in fast recovery
   bool                   m_limitedTx;    //< perform limited transmit
+
+  // ECN and DCTCP
+  bool                   m_dctcp;          //< React to ECE in proportion to the fraction of marked bytes
+  double                 m_dctcpGain;      //< Weight of the new sample in alpha (g)
+  TracedValue<double>    m_dctcpAlpha;     //< Estimated fraction of marked bytes
+  uint32_t               m_ecnBytesAcked;  //< Bytes acknowledged in the current observation window
+  uint32_t               m_ecnBytesMarked; //< Bytes acknowledged with ECE in the current observation window
+  SequenceNumber32       m_ecnWindowEnd;   //< End of the current observation window
+  SequenceNumber32       m_ecnRecover;     //< No further cwnd reduction until this seqnum is acked
 };
 
 } // namespace ns3
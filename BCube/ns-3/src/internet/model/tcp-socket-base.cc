@@ -39,6 +39,7 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -83,6 +84,10 @@ TcpSocketBase::GetTypeId (void)
                    CallbackValue (),
                    MakeCallbackAccessor (&TcpSocketBase::m_icmpCallback6),
                    MakeCallbackChecker ())                   
+    .AddAttribute ("UseEcn", "Negotiate ECN (RFC 3168) on new connections and send data as ECN-capable",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_useEcn),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto))
@@ -127,7 +132,12 @@ TcpSocketBase::TcpSocketBase (void)
     m_connected (false),
     m_segmentSize (0),
     // For attribute initialization consistency (quiet valgrind)
-    m_rWnd (0)
+    m_rWnd (0),
+    m_useEcn (false),
+    m_ecnActive (false),
+    m_ecnCeState (false),
+    m_ecnEchoReceived (false),
+    m_ecnSendCwr (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -162,7 +172,12 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_msl (sock.m_msl),
     m_segmentSize (sock.m_segmentSize),
     m_maxWinSize (sock.m_maxWinSize),
-    m_rWnd (sock.m_rWnd)
+    m_rWnd (sock.m_rWnd),
+    m_useEcn (sock.m_useEcn),
+    m_ecnActive (sock.m_ecnActive),
+    m_ecnCeState (sock.m_ecnCeState),
+    m_ecnEchoReceived (false),
+    m_ecnSendCwr (sock.m_ecnSendCwr)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -766,6 +781,62 @@ TcpSocketBase::OutOfRange (SequenceNumber32 head, SequenceNumber32 tail) const
   return (tail < m_rxBuffer.NextRxSequence () || m_rxBuffer.MaxRxSequence () <= head);
 }
 
+/** Negotiate ECN on SYN and SYN+ACK (RFC 3168, Sec. 6.1.1), remember the CE
+    codepoint of received data segment and the ECE flag of received ACK, and
+    strip ECE and CWR flags from the header, so the state machine never sees them */
+void
+TcpSocketBase::ProcessEcn (TcpHeader& tcpHeader, bool ce, uint32_t dataSize)
+{
+  uint8_t ecnFlags = tcpHeader.GetFlags () & (TcpHeader::ECE | TcpHeader::CWR);
+  tcpHeader.SetFlags (tcpHeader.GetFlags () & ~(TcpHeader::ECE | TcpHeader::CWR));
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+
+  if (m_state == LISTEN && tcpflags == TcpHeader::SYN)
+    { // ECN-setup SYN, the value is inherited by the forked socket
+      m_ecnActive = m_useEcn && ecnFlags == (TcpHeader::ECE | TcpHeader::CWR);
+    }
+  else if (m_state == SYN_SENT && tcpflags == (TcpHeader::SYN | TcpHeader::ACK))
+    { // ECN-setup SYN+ACK
+      m_ecnActive = m_useEcn && ecnFlags == TcpHeader::ECE;
+    }
+  if (!m_ecnActive)
+    {
+      return;
+    }
+
+  m_ecnEchoReceived = ecnFlags & TcpHeader::ECE;
+  if (dataSize > 0 && ce != m_ecnCeState)
+    { // CE codepoint changed: ACK the data received so far with the old ECE state
+      // right away, so that the sender can count marked bytes exactly even
+      // with delayed ACKs (DCTCP receiver, RFC 8257, Sec. 3.2)
+      if (m_delAckCount > 0)
+        {
+          SendEmptyPacket (TcpHeader::ACK);
+        }
+      m_ecnCeState = ce;
+    }
+}
+
+/** ECE and CWR flags to be added to an outgoing empty segment */
+uint8_t
+TcpSocketBase::EcnFlags (uint8_t flags) const
+{
+  if (flags & TcpHeader::SYN)
+    {
+      if (flags & TcpHeader::ACK)
+        { // ECN-setup SYN+ACK
+          return m_ecnActive ? TcpHeader::ECE : 0;
+        }
+      // ECN-setup SYN
+      return m_useEcn ? (TcpHeader::ECE | TcpHeader::CWR) : 0;
+    }
+  if (m_ecnActive && (flags & TcpHeader::ACK) && m_ecnCeState)
+    {
+      return TcpHeader::ECE;
+    }
+  return 0;
+}
+
 /** Function called by the L3 protocol when it received a packet to pass on to
     the TCP. This function is registered as the "RxCallback" function in
     SetupCallback(), which invoked by Bind(), and CompleteFork() */
@@ -857,6 +928,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port
       return;
     }
 
+  ProcessEcn (tcpHeader, header.GetEcn () == Ipv4Header::CE, packet->GetSize ());
+
   // TCP state machine code in different process functions
   // C.f.: tcp_rcv_state_process() in tcp_input.c in Linux kernel
   switch (m_state)
@@ -952,6 +1025,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, Ipv6Header header, uint16_t port
       return;
     }
 
+  ProcessEcn (tcpHeader, (header.GetTrafficClass () & 0x3) == 0x3, packet->GetSize ());
+
   // TCP state machine code in different process functions
   // C.f.: tcp_rcv_state_process() in tcp_input.c in Linux kernel
   switch (m_state)
@@ -1075,6 +1150,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   else if (tcpHeader.GetAckNumber () > m_txBuffer.HeadSequence ())
     { // Case 3: New ACK, reset m_dupAckCount and update m_txBuffer
       NS_LOG_LOGIC ("New ack of " << tcpHeader.GetAckNumber ());
+      if (m_ecnActive)
+        {
+          EcnEcho (tcpHeader.GetAckNumber (), m_ecnEchoReceived);
+        }
       NewAck (tcpHeader.GetAckNumber ());
       m_dupAckCount = 0;
     }
@@ -1576,7 +1655,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       ++s;
     }
 
-  header.SetFlags (flags);
+  header.SetFlags (flags | EcnFlags (flags));
   header.SetSequenceNumber (s);
   header.SetAckNumber (m_rxBuffer.NextRxSequence ());
   if (m_endPoint != 0)
@@ -1804,18 +1883,23 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
    * Note that currently the socket adds both IPv4 tag and IPv6 tag
    * if both options are set. Once the packet got to layer three, only
    * the corresponding tags will be read.
+   * On ECN connections, new data segments are sent with ECT(0) codepoint and
+   * retransmitted ones as not ECN-capable (RFC 3168, Sec. 6.1.5).
    */
-  if (IsManualIpTos ())
+  uint8_t ecnCodepoint = seq < m_highTxMark ? Ipv4Header::NotECT : Ipv4Header::ECT0;
+  if (IsManualIpTos () || m_ecnActive)
     {
       SocketIpTosTag ipTosTag;
-      ipTosTag.SetTos (GetIpTos ());
+      uint8_t tos = IsManualIpTos () ? GetIpTos () : 0;
+      ipTosTag.SetTos (m_ecnActive ? (tos & 0xfc) | ecnCodepoint : tos);
       p->AddPacketTag (ipTosTag);
     }
 
-  if (IsManualIpv6Tclass ())
+  if (IsManualIpv6Tclass () || m_ecnActive)
     {
       SocketIpv6TclassTag ipTclassTag;
-      ipTclassTag.SetTclass (GetIpv6Tclass ());
+      uint8_t tclass = IsManualIpv6Tclass () ? GetIpv6Tclass () : 0;
+      ipTclassTag.SetTclass (m_ecnActive ? (tclass & 0xfc) | ecnCodepoint : tclass);
       p->AddPacketTag (ipTclassTag);
     }
 
@@ -1847,6 +1931,18 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
           m_state = LAST_ACK;
         }
     }
+  if (m_ecnActive)
+    {
+      if ((flags & TcpHeader::ACK) && m_ecnCeState)
+        {
+          flags |= TcpHeader::ECE;
+        }
+      if (m_ecnSendCwr && sz > 0)
+        { // Congestion window has been reduced in response to ECE
+          flags |= TcpHeader::CWR;
+          m_ecnSendCwr = false;
+        }
+    }
   TcpHeader header;
   header.SetFlags (flags);
   header.SetSequenceNumber (seq);
@@ -2044,6 +2140,15 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
 }
 
+/** Called on every new ACK of an ECN connection with the ECE flag of the
+    ACK, before NewAck. Congestion control reacts to ECE here; the default
+    implementation does nothing */
+void
+TcpSocketBase::EcnEcho (SequenceNumber32 const& seq, bool ece)
+{
+  NS_LOG_FUNCTION (this << seq << ece);
+}
+
 /** Called by ForwardUp() to estimate RTT */
 void
 TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
@@ -147,6 +147,10 @@ protected:
   void SendRST (void); // Send reset and tear down this socket
   bool OutOfRange (SequenceNumber32 head, SequenceNumber32 tail) const; // Check if a sequence number range is within the rx window
 
+  // Helper functions: ECN (RFC 3168) and DCTCP (RFC 8257)
+  void ProcessEcn (TcpHeader& tcpHeader, bool ce, uint32_t dataSize); // Negotiate ECN, track CE marks, strip ECE/CWR flags
+  uint8_t EcnFlags (uint8_t flags) const; // ECE/CWR flags to add to an outgoing empty segment
+
   // Helper functions: Connection close
   int DoClose (void); // Close a socket by sending RST, FIN, or FIN+ACK, depend on the current state
   void CloseAndNotify (void); // To CLOSED state, notify upper layer, and deallocate end point
@@ -180,6 +184,7 @@ protected:
   virtual void ReceivedData (Ptr<Packet>, const TcpHeader&); // Recv of a data, put into buffer, call L7 to get it if necessary
   virtual void EstimateRtt (const TcpHeader&); // RTT accounting
   virtual void NewAck (SequenceNumber32 const& seq); // Update buffers w.r.t. ACK
+  virtual void EcnEcho (SequenceNumber32 const& seq, bool ece); // New ACK with or without ECE on ECN connection, called before NewAck
   virtual void DupAck (const TcpHeader& t, uint32_t count) = 0; // Received dupack
   virtual void ReTxTimeout (void); // Call Retransmit() upon RTO event
   virtual void Retransmit (void); // Halving cwnd and call DoRetransmit()
@@ -240,6 +245,13 @@ protected:
   uint32_t              m_segmentSize; //< Segment size
   uint16_t              m_maxWinSize;  //< Maximum window size to advertise
   TracedValue<uint32_t> m_rWnd;        //< Flow control window at remote side
+
+  // ECN
+  bool                  m_useEcn;          //< Negotiate ECN on new connections
+  bool                  m_ecnActive;       //< ECN has been negotiated with the peer
+  bool                  m_ecnCeState;      //< CE codepoint of the last received data segment
+  bool                  m_ecnEchoReceived; //< ECE flag of the segment being processed
+  bool                  m_ecnSendCwr;      //< Set CWR on the next data segment
 };
 
 } // namespace ns3
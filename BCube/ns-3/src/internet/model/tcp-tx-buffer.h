@@ -77,7 +77,8 @@ public:
   uint32_t Available (void) const;
 
   /**
-   * Append a data packet to the end of the buffer
+   * Append a data packet to the end of the buffer. Packets tagged with a
+   * TcpVirtualPayloadTag are only accounted for by their size.
    *
    * \param p The packet to be appended to the Tx buffer
    * \return Boolean to indicate success
@@ -90,7 +91,9 @@ public:
   uint32_t SizeFromSequence (const SequenceNumber32& seq) const;
 
   /**
-   * Copy data of size numBytes into a packet, data from the range [seq, seq+numBytes)
+   * Copy data of size numBytes into a packet, data from the range [seq, seq+numBytes).
+   * If the range consists of virtual payload only, the returned packet has no
+   * payload data and is tagged with a TcpVirtualPayloadTag.
    */
   Ptr<Packet> CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq);
 
@@ -108,12 +111,24 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  /**
+   * \brief A part of the data in the buffer: a packet of the application or,
+   *        if the packet is null, m_size bytes of virtual payload (see TcpVirtualPayloadTag)
+   */
+  struct TxChunk
+  {
+    TxChunk (Ptr<Packet> packet, uint32_t size);
+
+    Ptr<Packet> m_packet;
+    uint32_t m_size;
+  };
+
+  typedef std::list<TxChunk>::iterator BufIterator;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //< Number of data bytes
   uint32_t m_maxBuffer;                         //< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //< Corresponding data (may be null)
+  std::list<TxChunk> m_data;                    //< Corresponding data (packets may be null)
 };
 
 } // namepsace ns3
@@ -46,8 +46,17 @@
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-virtual-payload-tag.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/error-model.h"
+#include "ns3/boolean.h"
+#include "../model/tcp-tx-buffer.h"
+#include "../model/tcp-rx-buffer.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("TcpTestSuite");
 
@@ -425,6 +434,318 @@ TcpTestCase::AddSimpleNetDevice6 (Ptr<Node> node, Ipv6Address ipaddr, Ipv6Prefix
   return dev;
 }
 
+// Sends a stream of real data interleaved with virtual payload from a
+// TcpTxBuffer to a TcpRxBuffer, with reordered and overlapping segments
+class TcpVirtualPayloadTestCase : public TestCase
+{
+public:
+  TcpVirtualPayloadTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpVirtualPayloadTestCase::TcpVirtualPayloadTestCase ()
+  : TestCase ("Sending virtual payload through the TCP buffers")
+{
+}
+
+void
+TcpVirtualPayloadTestCase::DoRun (void)
+{
+  TcpTxBuffer txBuffer (1);
+  TcpRxBuffer rxBuffer (1);
+  txBuffer.SetMaxBufferSize (65536);
+  rxBuffer.SetMaxBufferSize (65536);
+
+  // Messages of 13 bytes of real data, each followed by virtual payload
+  std::vector<int> expected; // The value of each byte, -1 for virtual payload
+  for (uint8_t i = 0; i < 5; ++i)
+    {
+      uint8_t header[13];
+      for (uint8_t j = 0; j < 13; ++j)
+        {
+          header[j] = i * 13 + j + 1;
+          expected.push_back (header[j]);
+        }
+      txBuffer.Add (Create<Packet> (header, 13));
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<Packet> p = Create<Packet> (500 + i * 777);
+          p->AddPacketTag (TcpVirtualPayloadTag ());
+          expected.insert (expected.end (), p->GetSize (), -1);
+          txBuffer.Add (p);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), expected.size (), "Wrong size of the Tx buffer");
+
+  std::vector<std::pair<SequenceNumber32, Ptr<Packet> > > segments;
+  for (SequenceNumber32 seq (1); seq < txBuffer.TailSequence (); seq += 536)
+    {
+      segments.push_back (std::make_pair (seq, txBuffer.CopyFromSequence (536, seq)));
+    }
+  std::swap (segments[2], segments[5]);
+  segments.push_back (segments[4]);
+  segments.push_back (std::make_pair (SequenceNumber32 (301), txBuffer.CopyFromSequence (1000, SequenceNumber32 (301))));
+
+  std::vector<int> received;
+  for (uint32_t i = 0; i < segments.size (); ++i)
+    {
+      TcpHeader header;
+      header.SetSequenceNumber (segments[i].first);
+      rxBuffer.Add (segments[i].second->Copy (), header);
+      Ptr<Packet> p;
+      while ((p = rxBuffer.Extract (i % 2 ? 700 : 65536)) != 0)
+        {
+          TcpVirtualPayloadTag tag;
+          if (p->PeekPacketTag (tag))
+            {
+              received.insert (received.end (), p->GetSize (), -1);
+              continue;
+            }
+          std::vector<uint8_t> data (p->GetSize ());
+          p->CopyData (&data[0], data.size ());
+          for (uint32_t j = 0; j < data.size (); ++j)
+            { // Virtual payload sharing a segment with real data is zero-filled
+              received.push_back (data[j] == 0 ? -1 : data[j]);
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (received.size (), expected.size (), "Wrong number of bytes received");
+  NS_TEST_ASSERT_MSG_EQ ((received == expected), true, "Received data differs from the sent data");
+  NS_TEST_ASSERT_MSG_EQ (rxBuffer.Size (), 0, "Data left in the Rx buffer");
+
+  txBuffer.DiscardUpTo (SequenceNumber32 (2001));
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), expected.size () - 2000, "Wrong size of the Tx buffer after discarding data");
+  txBuffer.DiscardUpTo (txBuffer.TailSequence ());
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), 0, "Data left in the Tx buffer");
+}
+
+// Records the TCP segments received by a device, marking CE on one data
+// segment and dropping another one the first time it is received
+class TcpEcnObserver : public ErrorModel
+{
+public:
+  struct Segment
+  {
+    SequenceNumber32 seq;
+    uint32_t dataSize;
+    uint8_t flags;
+    Ipv4Header::EcnType ecn;
+  };
+
+  TcpEcnObserver (uint32_t markSegment, uint32_t dropSegment);
+  std::vector<Segment> m_segments;
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  uint32_t m_markSegment;
+  uint32_t m_dropSegment;
+  uint32_t m_dataSegments;
+};
+
+TcpEcnObserver::TcpEcnObserver (uint32_t markSegment, uint32_t dropSegment)
+  : m_markSegment (markSegment),
+    m_dropSegment (dropSegment),
+    m_dataSegments (0)
+{
+}
+
+bool
+TcpEcnObserver::DoCorrupt (Ptr<Packet> p)
+{
+  Ipv4Header ipHeader;
+  TcpHeader tcpHeader;
+  p->RemoveHeader (ipHeader);
+  p->PeekHeader (tcpHeader);
+
+  Segment segment;
+  segment.seq = tcpHeader.GetSequenceNumber ();
+  segment.dataSize = p->GetSize () - tcpHeader.GetSerializedSize ();
+  segment.flags = tcpHeader.GetFlags ();
+  segment.ecn = ipHeader.GetEcn ();
+  m_segments.push_back (segment);
+
+  bool drop = false;
+  if (segment.dataSize > 0)
+    {
+      m_dataSegments++;
+      if (m_dataSegments == m_markSegment)
+        {
+          ipHeader.SetEcn (Ipv4Header::CE);
+        }
+      drop = m_dataSegments == m_dropSegment;
+    }
+  p->AddHeader (ipHeader);
+  return drop;
+}
+
+void
+TcpEcnObserver::DoReset (void)
+{
+}
+
+// Sends data over an ECN connection, marks one data segment with CE and
+// drops another one, and checks the ECN negotiation, the ECE echo from the
+// receiver, the CWR reply of the sender, and that only new data is ECT
+class TcpEcnTestCase : public TestCase
+{
+public:
+  TcpEcnTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  void ServerHandleRecv (Ptr<Socket> sock);
+  void SourceHandleSend (Ptr<Socket> sock, uint32_t available);
+
+  uint32_t m_totalBytes;
+  uint32_t m_currentSourceTxBytes;
+  uint32_t m_currentServerRxBytes;
+};
+
+TcpEcnTestCase::TcpEcnTestCase ()
+  : TestCase ("ECN negotiation and CE, ECE, CWR round trip"),
+    m_totalBytes (20000)
+{
+}
+
+void
+TcpEcnTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  s->SetRecvCallback (MakeCallback (&TcpEcnTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpEcnTestCase::ServerHandleRecv (Ptr<Socket> sock)
+{
+  Ptr<Packet> p;
+  while ((p = sock->Recv ()) != 0 && p->GetSize () > 0)
+    {
+      m_currentServerRxBytes += p->GetSize ();
+    }
+}
+
+void
+TcpEcnTestCase::SourceHandleSend (Ptr<Socket> sock, uint32_t available)
+{
+  while (sock->GetTxAvailable () > 0 && m_currentSourceTxBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (m_totalBytes - m_currentSourceTxBytes, sock->GetTxAvailable ());
+      int sent = sock->Send (Create<Packet> (toSend));
+      NS_TEST_EXPECT_MSG_EQ ((sent != -1), true, "Error during send ?");
+      m_currentSourceTxBytes += sent;
+    }
+}
+
+void
+TcpEcnTestCase::DoRun (void)
+{
+  m_currentSourceTxBytes = 0;
+  m_currentServerRxBytes = 0;
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", BooleanValue (true));
+
+  Ptr<Node> node0 = CreateObject<Node> ();
+  Ptr<Node> node1 = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  const char* ipaddr[] = { "192.168.1.1", "192.168.1.2" };
+  Ptr<Node> nodes[] = { node0, node1 };
+  Ptr<SimpleNetDevice> devs[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      nodes[i]->AggregateObject (CreateObject<ArpL3Protocol> ());
+      Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+      Ptr<Ipv4ListRouting> ipv4Routing = CreateObject<Ipv4ListRouting> ();
+      ipv4->SetRoutingProtocol (ipv4Routing);
+      ipv4Routing->AddRoutingProtocol (CreateObject<Ipv4StaticRouting> (), 0);
+      nodes[i]->AggregateObject (ipv4);
+      nodes[i]->AggregateObject (CreateObject<Icmpv4L4Protocol> ());
+      nodes[i]->AggregateObject (CreateObject<UdpL4Protocol> ());
+      nodes[i]->AggregateObject (CreateObject<TcpL4Protocol> ());
+
+      devs[i] = CreateObject<SimpleNetDevice> ();
+      devs[i]->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+      nodes[i]->AddDevice (devs[i]);
+      uint32_t ndid = ipv4->AddInterface (devs[i]);
+      ipv4->AddAddress (ndid, Ipv4InterfaceAddress (Ipv4Address (ipaddr[i]), Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (ndid);
+      devs[i]->SetChannel (channel);
+    }
+
+  // data segments arrive at node0, ACKs at node1
+  Ptr<TcpEcnObserver> dataObserver = CreateObject<TcpEcnObserver> (3, 10);
+  Ptr<TcpEcnObserver> ackObserver = CreateObject<TcpEcnObserver> (0, 0);
+  devs[0]->SetReceiveErrorModel (dataObserver);
+  devs[1]->SetReceiveErrorModel (ackObserver);
+
+  uint16_t port = 50000;
+  Ptr<Socket> server = node0->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  Ptr<Socket> source = node1->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                             MakeCallback (&TcpEcnTestCase::ServerHandleConnectionCreated, this));
+  source->SetSendCallback (MakeCallback (&TcpEcnTestCase::SourceHandleSend, this));
+  source->Connect (InetSocketAddress (Ipv4Address (ipaddr[0]), port));
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_currentServerRxBytes, m_totalBytes, "Server received all bytes");
+
+  const std::vector<TcpEcnObserver::Segment> &data = dataObserver->m_segments;
+  const std::vector<TcpEcnObserver::Segment> &acks = ackObserver->m_segments;
+  NS_TEST_ASSERT_MSG_EQ ((data[0].flags & ~TcpHeader::PSH), (TcpHeader::SYN | TcpHeader::ECE | TcpHeader::CWR),
+                         "SYN is not ECN-setup");
+  NS_TEST_ASSERT_MSG_EQ ((acks[0].flags & ~TcpHeader::PSH), (TcpHeader::SYN | TcpHeader::ACK | TcpHeader::ECE),
+                         "SYN+ACK is not ECN-setup");
+
+  SequenceNumber32 highSeq = data[0].seq;
+  uint32_t dataSegments = 0;
+  uint32_t retransmissions = 0;
+  bool cwrSent = false;
+  for (uint32_t i = 0; i < data.size (); ++i)
+    {
+      if (data[i].dataSize == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (data[i].ecn, Ipv4Header::NotECT, "Segment without data " << i << " is ECT");
+          continue;
+        }
+      dataSegments++;
+      if (data[i].seq < highSeq)
+        {
+          NS_TEST_ASSERT_MSG_EQ (data[i].ecn, Ipv4Header::NotECT, "Retransmitted segment " << i << " is ECT");
+          retransmissions++;
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (data[i].ecn, Ipv4Header::ECT0, "New data segment " << i << " is not ECT(0)");
+          highSeq = data[i].seq + SequenceNumber32 (data[i].dataSize);
+        }
+      if (data[i].flags & TcpHeader::CWR)
+        {
+          NS_TEST_ASSERT_MSG_GT (dataSegments, 3, "CWR set before the CE mark");
+          cwrSent = true;
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (retransmissions, 0, "Dropped segment was not retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (cwrSent, true, "Sender did not reply to ECE with CWR");
+
+  uint32_t echoes = 0;
+  for (uint32_t i = 1; i < acks.size (); ++i)
+    {
+      echoes += (acks[i].flags & TcpHeader::ECE) != 0;
+    }
+  NS_TEST_ASSERT_MSG_GT (echoes, 0, "Receiver did not echo CE with ECE");
+  NS_TEST_ASSERT_MSG_EQ ((acks.back ().flags & TcpHeader::ECE), 0, "Receiver echoes CE after unmarked data");
+}
+
+void
+TcpEcnTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+  Simulator::Destroy ();
+}
+
 static class TcpTestSuite : public TestSuite
 {
 public:
@@ -442,6 +763,9 @@ public:
     AddTestCase (new TcpTestCase (13, 200, 200, 200, 200, true));
     AddTestCase (new TcpTestCase (13, 1, 1, 1, 1, true));
     AddTestCase (new TcpTestCase (100000, 100, 50, 100, 20, true));
+
+    AddTestCase (new TcpVirtualPayloadTestCase ());
+    AddTestCase (new TcpEcnTestCase ());
   }
 
 } g_tcpTestSuite;
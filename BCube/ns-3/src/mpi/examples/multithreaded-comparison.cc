@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ *
+ *
+ * Runs the same scenario with DefaultSimulatorImpl and with
+ * MultithreadedSimulatorImpl and compares the packets received by every
+ * node.  The nodes form a ring, each node in its own partition:
+ *
+ *        2ms
+ *   n0 ------- n1
+ *    |          |
+ *    | 11ms     | 5ms
+ *    |          |
+ *   n3 ------- n2
+ *        8ms
+ *
+ * Every node sends packets to its neighbours.  A packet of size 100 + h is
+ * forwarded h more hops, each time as a new packet of one byte less, through
+ * the device selected by its size.  The program fails if any node received a
+ * different packet, or at a different time, under the two implementations.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedComparison");
+
+typedef std::vector<std::vector<std::string> > Trace;
+
+// Packets received by each node, written only by the partition of the node
+static Trace g_trace;
+
+static void
+Send (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x0800);
+}
+
+static void
+Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+         const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  Ptr<Node> node = device->GetNode ();
+  std::ostringstream line;
+  line << Simulator::Now ().GetTimeStep () << " dev " << device->GetIfIndex () << " size " << packet->GetSize ();
+  g_trace[node->GetId ()].push_back (line.str ());
+
+  if (packet->GetSize () > 100)
+    {
+      Send (node->GetDevice (packet->GetSize () % node->GetNDevices ()), packet->GetSize () - 1);
+    }
+}
+
+static Trace
+RunScenario (std::string simulatorImpl)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (simulatorImpl));
+
+  const uint32_t ringSize = 4;
+  const uint32_t delays[ringSize] = { 2, 5, 8, 11 };
+
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < ringSize; ++i)
+    {
+      nodes.Create (1, i);
+    }
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  for (uint32_t i = 0; i < ringSize; ++i)
+    {
+      p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (delays[i])));
+      p2p.Install (nodes.Get (i), nodes.Get ((i + 1) % ringSize));
+    }
+
+  g_trace.assign (ringSize, std::vector<std::string> ());
+  for (uint32_t i = 0; i < ringSize; ++i)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      node->RegisterProtocolHandler (MakeCallback (&Receive), 0x0800, 0);
+      for (uint32_t k = 0; k < 50; ++k)
+        {
+          Simulator::ScheduleWithContext (node->GetId (), MilliSeconds (100 + 10 * k) + MicroSeconds (137 * i),
+                                          &Send, node->GetDevice (k % 2), 100 + k % 7);
+        }
+    }
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // simultaneous receptions of a node may be ordered differently
+  for (Trace::iterator node = g_trace.begin (); node != g_trace.end (); node++)
+    {
+      std::sort (node->begin (), node->end ());
+    }
+  return g_trace;
+}
+
+int
+main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.Parse (argc, argv);
+
+  Trace expected = RunScenario ("ns3::DefaultSimulatorImpl");
+  Trace actual = RunScenario ("ns3::MultithreadedSimulatorImpl");
+
+  for (uint32_t node = 0; node < expected.size (); ++node)
+    {
+      if (expected[node] != actual[node])
+        {
+          NS_FATAL_ERROR ("Node " << node << " received " << actual[node].size () << " packets with MultithreadedSimulatorImpl, "
+                          << expected[node].size () << " with DefaultSimulatorImpl, or at different times");
+        }
+      NS_LOG_INFO ("Node " << node << " received " << expected[node].size () << " packets");
+    }
+  return 0;
+}
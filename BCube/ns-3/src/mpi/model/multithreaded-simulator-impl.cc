@@ -0,0 +1,742 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/make-event.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <sched.h>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+static const uint64_t NO_EVENTS = std::numeric_limits<uint64_t>::max ();
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+bool MultithreadedSimulatorImpl::m_isRunning = false;
+
+MultithreadedSimulatorImpl::Partition::Partition (MultithreadedSimulatorImpl *impl_, uint32_t id_)
+  : impl (impl_),
+    id (id_),
+    events (0),
+    // uids are allocated from 4.
+    // uid 0 is "invalid" events
+    // uid 1 is "now" events
+    // uid 2 is "destroy" events
+    uid (4),
+    currentTs (0),
+    // before ::Run is entered, the currentUid will be zero
+    currentUid (0),
+    currentContext (0xffffffff),
+    eventCount (0),
+    unscheduledEvents (0),
+    nextTs (NO_EVENTS),
+    thread (0)
+{
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<Object> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_global (new Partition (this, 0xffffffff)),
+    m_lookAhead (0),
+    m_windowEnd (0),
+    m_stop (false),
+    m_done (false),
+    m_running (false),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+#ifndef NS3_MULTITHREADED
+  NS_FATAL_ERROR ("Can't use multithreaded simulator without ./waf configure --enable-multithreaded-simulator");
+#endif
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+       partition != m_partitions.end ();
+       partition++)
+    {
+      while (!(*partition)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*partition)->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (std::vector< std::vector<Scheduler::Event> >::iterator outbox = (*partition)->outboxes.begin ();
+           outbox != (*partition)->outboxes.end ();
+           outbox++)
+        {
+          for (std::vector<Scheduler::Event>::iterator ev = outbox->begin (); ev != outbox->end (); ev++)
+            {
+              ev->impl->Unref ();
+            }
+        }
+      for (std::vector<Scheduler::Event>::iterator ev = (*partition)->globalOutbox.begin ();
+           ev != (*partition)->globalOutbox.end ();
+           ev++)
+        {
+          ev->impl->Unref ();
+        }
+      delete *partition;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  m_schedulerFactory = schedulerFactory;
+
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator partition = partitions.begin ();
+       partition != partitions.end ();
+       partition++)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*partition)->events != 0)
+        {
+          while (!(*partition)->events->IsEmpty ())
+            {
+              scheduler->Insert ((*partition)->events->RemoveNext ());
+            }
+        }
+      (*partition)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  uint32_t nPartitions = m_partitions.size ();
+  m_nodePartitions.clear ();
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      m_nodePartitions.push_back ((*node)->GetSystemId ());
+      nPartitions = std::max (nPartitions, (*node)->GetSystemId () + 1);
+    }
+  if (nPartitions == 0)
+    {
+      nPartitions = 1;
+    }
+
+  if (!m_partitions.empty () && nPartitions != m_partitions.size ())
+    {
+      NS_FATAL_ERROR ("Nodes of new partitions were created after the first Simulator::Run");
+    }
+
+  while (m_partitions.size () < nPartitions)
+    {
+      Partition *partition = new Partition (this, m_partitions.size ());
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      // events moved from the global list keep their uids
+      partition->uid = m_global->uid;
+      partition->currentTs = m_global->currentTs;
+      m_partitions.push_back (partition);
+    }
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+       partition != m_partitions.end ();
+       partition++)
+    {
+      (*partition)->outboxes.resize (nPartitions);
+    }
+
+  // distribute events with node contexts scheduled before the first Run
+  std::vector<Scheduler::Event> global;
+  while (!m_global->events->IsEmpty ())
+    {
+      Scheduler::Event ev = m_global->events->RemoveNext ();
+      Partition *partition = GetPartition (ev.key.m_context);
+      if (partition == m_global)
+        {
+          global.push_back (ev);
+        }
+      else
+        {
+          partition->events->Insert (ev);
+          partition->unscheduledEvents++;
+          m_global->unscheduledEvents--;
+        }
+    }
+  for (std::vector<Scheduler::Event>::iterator ev = global.begin (); ev != global.end (); ev++)
+    {
+      m_global->events->Insert (*ev);
+    }
+
+  CalculateLookAhead ();
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  m_lookAhead = NO_EVENTS;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = (*node)->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+              if (remoteNode->GetSystemId () == (*node)->GetSystemId ())
+                {
+                  continue;
+                }
+
+              // only works for p2p links currently
+              if (!localNetDevice->IsPointToPoint ())
+                {
+                  NS_FATAL_ERROR ("Nodes " << (*node)->GetId () << " and " << remoteNode->GetId ()
+                                  << " of different partitions are connected by a channel which is not point-to-point");
+                }
+
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              if (!delay.Get ().IsStrictlyPositive ())
+                {
+                  NS_FATAL_ERROR ("Channel between nodes " << (*node)->GetId () << " and " << remoteNode->GetId ()
+                                  << " of different partitions has zero delay");
+                }
+              m_lookAhead = std::min (m_lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+  NS_LOG_DEBUG (m_partitions.size () << " partitions, lookahead " << GetLookAhead ().GetSeconds () << "s");
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context == 0xffffffff || m_partitions.empty ())
+    {
+      return m_global;
+    }
+  if (context >= m_nodePartitions.size ())
+    {
+      NS_FATAL_ERROR ("Event context " << context << " is not a node created before Simulator::Run");
+    }
+  return m_partitions[m_nodePartitions[context]];
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition *partition, Scheduler::Event ev)
+{
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  partition->eventCount++;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Receive (Partition *partition)
+{
+  // in the order of source partitions, so that uids do not depend on thread scheduling
+  for (std::vector<Partition *>::iterator source = m_partitions.begin ();
+       source != m_partitions.end ();
+       source++)
+    {
+      std::vector<Scheduler::Event> &inbox = (*source)->outboxes[partition->id];
+      for (std::vector<Scheduler::Event>::iterator ev = inbox.begin (); ev != inbox.end (); ev++)
+        {
+          Insert (partition, *ev);
+        }
+      inbox.clear ();
+    }
+  partition->nextTs = partition->events->IsEmpty () ? NO_EVENTS : partition->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t generation = m_barrierGeneration;
+  if (__sync_add_and_fetch (&m_barrierCount, 1) == m_partitions.size ())
+    {
+      m_barrierCount = 0;
+      __sync_fetch_and_add (&m_barrierGeneration, 1);
+      return;
+    }
+
+  for (uint32_t spin = 0; generation == m_barrierGeneration; spin++)
+    {
+      if (spin > 1000)
+        {
+          sched_yield ();
+        }
+    }
+  __sync_synchronize ();
+}
+
+void
+MultithreadedSimulatorImpl::Coordinate (void)
+{
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+       partition != m_partitions.end ();
+       partition++)
+    {
+      for (std::vector<Scheduler::Event>::iterator ev = (*partition)->globalOutbox.begin ();
+           ev != (*partition)->globalOutbox.end ();
+           ev++)
+        {
+          Insert (m_global, *ev);
+        }
+      (*partition)->globalOutbox.clear ();
+    }
+
+  while (!m_stop)
+    {
+      uint64_t nextTs = NO_EVENTS;
+      for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+           partition != m_partitions.end ();
+           partition++)
+        {
+          nextTs = std::min (nextTs, (*partition)->nextTs);
+        }
+
+      uint64_t nextGlobalTs = m_global->events->IsEmpty () ? NO_EVENTS : m_global->events->PeekNext ().key.m_ts;
+      if (nextGlobalTs == NO_EVENTS && nextTs == NO_EVENTS)
+        {
+          break;
+        }
+
+      if (nextGlobalTs > nextTs)
+        {
+          m_windowEnd = m_lookAhead == NO_EVENTS ? NO_EVENTS : nextTs + m_lookAhead;
+          m_windowEnd = std::min (m_windowEnd, nextGlobalTs);
+          return;
+        }
+
+      // all partitions are paused at or before the global event
+      ProcessOneEvent (m_global);
+      for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+           partition != m_partitions.end ();
+           partition++)
+        {
+          (*partition)->nextTs = (*partition)->events->IsEmpty () ? NO_EVENTS : (*partition)->events->PeekNext ().key.m_ts;
+        }
+    }
+  m_done = true;
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *partition)
+{
+  while (true)
+    {
+      Receive (partition);
+      Barrier ();
+      if (partition->id == 0)
+        {
+          Coordinate ();
+        }
+      Barrier ();
+      if (m_done)
+        {
+          break;
+        }
+
+      m_current = partition;
+      while (!partition->events->IsEmpty () &&
+             partition->events->PeekNext ().key.m_ts < m_windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+      m_current = 0;
+      Barrier ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::PartitionMain (Partition *partition)
+{
+  partition->impl->RunPartition (partition);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_ASSERT_MSG (m_current == 0, "Simulator::Run is called from an event");
+  CreatePartitions ();
+
+  m_stop = false;
+  m_done = false;
+  m_running = true;
+  // set before the threads start and cleared after they are joined
+  m_isRunning = true;
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin () + 1;
+       partition != m_partitions.end ();
+       partition++)
+    {
+      (*partition)->thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::PartitionMain, *partition));
+      (*partition)->thread->Start ();
+    }
+  RunPartition (m_partitions[0]);
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin () + 1;
+       partition != m_partitions.end ();
+       partition++)
+    {
+      (*partition)->thread->Join ();
+      (*partition)->thread = 0;
+    }
+  m_isRunning = false;
+  m_running = false;
+
+  // the time seen outside of Run
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+       partition != m_partitions.end ();
+       partition++)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, (*partition)->currentTs);
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  for (std::vector<Partition *>::iterator partition = m_partitions.begin ();
+       partition != m_partitions.end () && !m_stop;
+       partition++)
+    {
+      NS_ASSERT ((*partition)->unscheduledEvents == 0);
+    }
+  NS_ASSERT (m_stop || m_global->unscheduledEvents == 0);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return m_current != 0 ? m_current->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_partitions.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return m_lookAhead == NO_EVENTS ? GetMaximumSimulationTime () : TimeStep (m_lookAhead);
+}
+
+bool
+MultithreadedSimulatorImpl::IsRunning (void)
+{
+  return m_isRunning;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator partition = m_partitions.begin ();
+       partition != m_partitions.end ();
+       partition++)
+    {
+      if (!(*partition)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events->IsEmpty ();
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  ScheduleWithContext (0xffffffff, time, MakeEvent (&Simulator::Stop));
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  Partition *partition = m_current != 0 ? m_current : m_global;
+  Time tAbsolute = time + TimeStep (partition->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = partition->currentContext;
+  Insert (partition, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, partition->uid - 1);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+
+  Partition *source = m_current != 0 ? m_current : m_global;
+  Partition *destination = GetPartition (context);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = source->currentTs + time.GetTimeStep ();
+  ev.key.m_context = context;
+  ev.key.m_uid = 0; // allocated by the destination
+
+  if (m_current == 0 || destination == m_current)
+    {
+      // partitions are paused or the event is local
+      Insert (destination, ev);
+    }
+  else if (destination == m_global)
+    {
+      // other partitions may already be past ev.key.m_ts, so an event for a time
+      // before the end of the window runs only when the window ends
+      if (ev.key.m_ts < m_windowEnd)
+        {
+          NS_LOG_LOGIC ("global event at " << ev.key.m_ts << " delayed to the end of the window at " << m_windowEnd);
+        }
+      m_current->globalOutbox.push_back (ev);
+    }
+  else
+    {
+      if (ev.key.m_ts < m_windowEnd)
+        {
+          NS_FATAL_ERROR ("Event for node " << context << " is scheduled by node " << m_current->currentContext
+                          << " of another partition " << time.GetSeconds () << "s ahead, less than the lookahead "
+                          << GetLookAhead ().GetSeconds () << "s");
+        }
+      m_current->outboxes[destination->id].push_back (ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (m_current == 0, "Destroy events can be scheduled only outside of Simulator::Run");
+  EventId id (Ptr<EventImpl> (event, false), m_global->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (m_current != 0 ? m_current->currentTs : m_global->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetPartition (id.GetContext ())->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (m_current == 0 || m_current == partition, "Event of another partition cannot be removed");
+
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *partition = GetPartition (ev.GetContext ());
+  if (ev.PeekEventImpl () == 0
+      || ev.GetTs () < partition->currentTs
+      || (ev.GetTs () == partition->currentTs
+          && ev.GetUid () <= partition->currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  // XXX: I am fairly certain other compilers use other non-standard
+  // post-fixes to indicate 64 bit constants.
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return m_current != 0 ? m_current->currentContext : m_global->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  // only exact between windows, when the worker threads are idle
+  uint64_t count = m_global->eventCount;
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); ++it)
+    {
+      count += (*it)->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
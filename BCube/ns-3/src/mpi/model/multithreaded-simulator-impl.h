@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/system-thread.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief conservative parallel simulator running partitions of nodes in threads of one process
+ *
+ * Nodes are partitioned by their system id (see Node::GetSystemId and
+ * NodeContainer::Create), as with DistributedSimulatorImpl, but all
+ * partitions run in the same process: partition 0 in the thread calling
+ * Simulator::Run, the others in their own threads.  Select it with
+ *
+ * \code
+ * GlobalValue::Bind ("SimulatorImplementationType",
+ *                    StringValue ("ns3::MultithreadedSimulatorImpl"));
+ * \endcode
+ *
+ * ns-3 must be configured with --enable-multithreaded-simulator, which makes
+ * reference counts atomic and per-packet allocation state thread-local.
+ *
+ * Each partition has its own event list.  Partitions run in windows of
+ * simulated time [t, t + lookahead), where t is the earliest pending event
+ * of all partitions and the lookahead is the minimum delay of point-to-point
+ * channels between partitions.  An event scheduled for a node of another
+ * partition is at least the lookahead away, so it is put into the
+ * single-producer/single-consumer inbox of the pair of partitions and moved
+ * into the event list of the receiver after the window.  Inboxes are
+ * written and read in different phases separated by barriers, so they need
+ * no locks.  PointToPointChannel hands the Ptr<Packet> to the other
+ * partition as a full copy (Packet::CreateFullCopy) instead of serializing it.
+ *
+ * Events without a node context (scheduled before Simulator::Run with
+ * Simulator::Schedule, e.g., Simulator::Stop (time), or with
+ * Simulator::ScheduleWithContext (0xffffffff, ...)) are global: they are
+ * executed in the main thread while all partitions are paused.  A window
+ * never extends past a pending global event, so global events scheduled
+ * before Simulator::Run, or by an event of a partition for a time at or
+ * after the end of the current window, are executed after all earlier
+ * events of all partitions.  A global event scheduled by an event of a
+ * partition for an earlier time (e.g., Simulator::Stop (time) with a time
+ * less than the lookahead) is executed when the current window ends, i.e.,
+ * after partitions may have executed events up to the window end, which
+ * are later than its own time.  Likewise, Simulator::Stop () takes effect
+ * at the end of the current window.
+ *
+ * Events of different partitions at the same time are not ordered, and
+ * events arriving from other partitions are inserted after the window, so
+ * among simultaneous events of a node they are ordered by source partition
+ * and send order.  The result is deterministic for a given partition map,
+ * i.e., it does not depend on the number of cores or on thread scheduling,
+ * and equals the result of DefaultSimulatorImpl unless a node has
+ * simultaneous events of which at least one came from another partition.
+ *
+ * During Simulator::Run, events must not touch nodes of other partitions,
+ * except through point-to-point channels and global events; loss models of
+ * channels between partitions, trace sinks and random variables shared by
+ * partitions, and packet metadata (Packet::EnablePrinting) are not
+ * thread-safe.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \returns number of partitions, known after the first Simulator::Run
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * \returns lookahead between partitions, known after the first Simulator::Run
+   */
+  Time GetLookAhead (void) const;
+
+  /**
+   * \returns true while Simulator::Run of a MultithreadedSimulatorImpl
+   *          executes partitions in their threads
+   *
+   * Lets models skip the work needed only to hand objects to another
+   * partition, e.g., PointToPointChannel copies packets only if it is true.
+   */
+  static bool IsRunning (void);
+
+private:
+  /**
+   * \brief Event list and clock of a partition, or of global events
+   */
+  struct Partition
+  {
+    Partition (MultithreadedSimulatorImpl *impl, uint32_t id);
+
+    MultithreadedSimulatorImpl *impl;
+    uint32_t id;
+    Ptr<Scheduler> events;
+    uint32_t uid;
+    uint64_t currentTs;
+    uint32_t currentUid;
+    uint32_t currentContext;
+    // number of events executed by this partition
+    uint64_t eventCount;
+    // number of events that have been inserted but not yet scheduled,
+    // not counting the "destroy" events; this is used for validation
+    int unscheduledEvents;
+    // events for other partitions (indexed by partition id) and global
+    // events, scheduled during the current window
+    std::vector< std::vector<Scheduler::Event> > outboxes;
+    std::vector<Scheduler::Event> globalOutbox;
+    // earliest pending event, computed between windows
+    uint64_t nextTs;
+    Ptr<SystemThread> thread;
+  };
+
+  virtual void DoDispose (void);
+
+  void CreatePartitions (void);
+  void CalculateLookAhead (void);
+  Partition *GetPartition (uint32_t context) const;
+
+  void Insert (Partition *partition, Scheduler::Event ev);
+  void ProcessOneEvent (Partition *partition);
+  void Receive (Partition *partition);
+  void RunPartition (Partition *partition);
+  void Coordinate (void);
+  void Barrier (void);
+
+  static void PartitionMain (Partition *partition);
+
+  typedef std::list<EventId> DestroyEvents;
+  DestroyEvents m_destroyEvents;
+
+  ObjectFactory m_schedulerFactory;
+  // global events, and all events before the first Simulator::Run
+  Partition *m_global;
+  std::vector<Partition *> m_partitions;
+  // node id -> partition
+  std::vector<uint32_t> m_nodePartitions;
+
+  uint64_t m_lookAhead;
+  uint64_t m_windowEnd;
+  volatile bool m_stop;
+  bool m_done;
+  bool m_running;
+
+  // barrier of all partitions, released when the generation changes
+  volatile uint32_t m_barrierCount;
+  volatile uint32_t m_barrierGeneration;
+
+  // partition run by the calling thread, 0 outside of the windows
+  static __thread Partition *m_current;
+
+  // whether Run of any instance is executing
+  static bool m_isRunning;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
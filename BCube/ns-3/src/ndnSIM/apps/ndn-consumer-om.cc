@@ -81,6 +81,21 @@ ConsumerOm::GetTypeId (void)
                    MakeDoubleAccessor (&ConsumerOm::m_beta),
                    MakeDoubleChecker<double> ())
 
+    .AddAttribute ("EcnFeedback", "Decrease Interest limit based on fraction of CE-marked Data (in addition to NACKs)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ConsumerOm::m_ecn),
+                   MakeBooleanChecker ())
+
+    .AddAttribute ("EcnGain", "Weight of the new sample when averaging fraction of CE-marked Data",
+                   StringValue ("0.0625"),
+                   MakeDoubleAccessor (&ConsumerOm::m_ecnGain),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+
+    .AddAttribute ("EcnInterval", "Interval at which fraction of CE-marked Data is estimated and Interest limit is decreased",
+                   StringValue ("10ms"),
+                   MakeTimeAccessor (&ConsumerOm::m_ecnInterval),
+                   MakeTimeChecker ())
+
     .AddAttribute ("MaxSeq",
                    "Maximum sequence number to request",
                    IntegerValue (std::numeric_limits<uint32_t>::max ()),
@@ -104,9 +119,16 @@ ConsumerOm::ConsumerOm ()
   , m_inited(false)
   , m_limitInterval (1.0)
   , m_firstTime (true)
+  , m_suspended (false)
   , m_data_count (0)
   , m_nack_count (0)
   , m_extra_nack_count (0)
+  , m_ecn (false)
+  , m_ecnGain (0.0625)
+  , m_ecnInterval (MilliSeconds (10))
+  , m_ecnFraction (0)
+  , m_ecnData (0)
+  , m_ecnMarked (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_seqMax = std::numeric_limits<uint32_t>::max ();
@@ -127,6 +149,9 @@ ConsumerOm::ScheduleNextPacket ()
   // double mean = 8.0 * m_payloadSize / m_desiredRate.GetBitRate ();
   // std::cout << "next: " << Simulator::Now().ToDouble(Time::S) + mean << "s\n";
 
+  if (m_suspended)
+    return;
+
   if (m_firstTime)
     {
       m_sendEvent = Simulator::Schedule (Seconds (0.0),
@@ -159,15 +184,22 @@ ConsumerOm::OnContentObject (const Ptr<const ContentObject> &contentObject,
   	
   Consumer::OnContentObject (contentObject, payload); // tracing inside
   //update interest limit
-  if(contentObject->GetCE()!=2)	//not a local cache hit
+  if(contentObject->GetCE()!=ContentObject::CE_LOCAL_HIT)	//not a local cache hit
   {
-  	m_limit = m_limit + m_alpha/m_limit;	//here we choose parameter such that the convergence time is similar to TCP
-  	m_alpha += 1/m_limit;
-  	if(m_alpha>m_alpha_max)
-  		m_alpha = m_alpha_max;
+  	bool marked = m_ecn && contentObject->GetCE()==ContentObject::CE_CONGESTION;
+  	if(!marked)	//marked Data does not increase the limit
+  	{
+  		m_limit = m_limit + m_alpha/m_limit;	//here we choose parameter such that the convergence time is similar to TCP
+  		m_alpha += 1/m_limit;
+  		if(m_alpha>m_alpha_max)
+  			m_alpha = m_alpha_max;
+  	}
   	m_data_count++;
+
+  	if(m_ecn)
+  		OnEcnFeedback (marked);
   }
-  else	//local hit, send next requests immediately
+  else if (!m_suspended)	//local hit, send next requests immediately
   {	
   	SendPacket();
   	//SendRandomPacket();
@@ -185,26 +217,7 @@ void
 ConsumerOm::OnExtraContentObject (const Ptr<const ContentObject> &contentObject,
                    				 Ptr<Packet> payload)
 {
-	//rule out nacks with different prefixes
-	std::list<std::string>::const_iterator rhs = contentObject->GetName().begin();
-	bool match = true;
-	for(std::list<std::string>::iterator it = m_interestName.begin();
-			it != m_interestName.end(); it++)
-	{
-		if(rhs==contentObject->GetName().end()
-		|| *it!=*rhs)
-		{
-			match = false;
-			break;
-		}
-		rhs++;
-	}
-	if(!match)
-	{
-		//NS_LOG_UNCOND("mismatch app="<<m_interestName<<" content="<<contentObject->GetName());
-		return;
-	}
-	
+	//only Data under our prefix is delivered here (see LocalAppRegistry)
 	//NS_LOG_UNCOND("OnExtraContentObject@"<<Names::FindName(m_node));
 	m_data_count++;
 }
@@ -214,24 +227,7 @@ void
 ConsumerOm::OnNack (const Ptr<const Interest> &interest, Ptr<Packet> packet)
 {
 	Consumer::OnNack (interest, packet);
-	//rule out nacks with different prefixes
-	std::list<std::string>::const_iterator rhs = interest->GetName().begin();
-	bool match = true;
-	for(std::list<std::string>::iterator it = m_interestName.begin();
-			it != m_interestName.end(); it++)
-	{
-		if(rhs==interest->GetName().end()
-		|| *it!=*rhs)
-		{
-			match = false;
-			break;
-		}
-		rhs++;
-	}
-	if(!match)
-	{
-		return;
-	}
+	//NACKs of other requesters are delivered here only for our prefix (see LocalAppRegistry)
 	
 	//update interest limit
 	if(interest->GetNack()==Interest::NACK_GIVEUP_PIT)	//NOT NACK_CONGESTION
@@ -265,6 +261,56 @@ ConsumerOm::OnNack (const Ptr<const Interest> &interest, Ptr<Packet> packet)
 	
 }
 
+void
+ConsumerOm::OnEcnFeedback (bool marked)
+{
+  m_ecnData ++;
+  if (marked)
+    m_ecnMarked ++;
+
+  Time now = Simulator::Now ();
+  if (now - m_ecnWindowStart < m_ecnInterval)
+    return;
+
+  double fraction = static_cast<double> (m_ecnMarked) / m_ecnData;
+  m_ecnFraction = (1 - m_ecnGain) * m_ecnFraction + m_ecnGain * fraction;
+
+  if (m_ecnMarked > 0)
+    {
+      m_limit = m_limit * (1 - m_ecnFraction / 2);
+      if (m_limit <= 0.1)		//we need to avoid non-sense interest limit
+        m_limit = 0.1;
+    }
+
+  NS_LOG_DEBUG ("ECN window: data=" << m_ecnData << " marked=" << m_ecnMarked
+                << " fraction=" << m_ecnFraction << " limit=" << m_limit);
+
+  m_ecnWindowStart = now;
+  m_ecnData = 0;
+  m_ecnMarked = 0;
+}
+
+void
+ConsumerOm::Suspend ()
+{
+  NS_LOG_FUNCTION (this);
+  m_suspended = true;
+  Simulator::Cancel (m_sendEvent);
+}
+
+void
+ConsumerOm::SaveState (std::ostream &os) const
+{
+  os << m_limit << " " << m_alpha << " " << m_inited << " " << m_ecnFraction;
+}
+
+void
+ConsumerOm::LoadState (std::istream &is)
+{
+  is >> m_limit >> m_alpha >> m_inited >> m_ecnFraction;
+  NS_LOG_DEBUG ("Warm start: limit=" << m_limit << " alpha=" << m_alpha << " ecnFraction=" << m_ecnFraction);
+}
+
 void
 ConsumerOm::ShowInterestLimit()
 {
@@ -310,13 +356,7 @@ ConsumerOm::SendRandomPacket()
   Ptr<Packet> packet = Create<Packet> ();
   packet->AddHeader (interestHeader);
 
-  /*m_seqTimeouts.insert (SeqTimeout (seq, Simulator::Now ()));
-  m_seqFullDelay.insert (SeqTimeout (seq, Simulator::Now ()));
-
-  m_seqLastDelay.erase (seq);
-  m_seqLastDelay.insert (SeqTimeout (seq, Simulator::Now ()));
-
-  m_seqRetxCounts[seq] ++;
+  /*m_seqWindow.Sent (seq, Simulator::Now ());
 
   m_transmittedInterests (&interestHeader, this, m_face);
 
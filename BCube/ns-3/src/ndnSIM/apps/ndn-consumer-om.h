@@ -23,6 +23,8 @@
 
 #include "ndn-consumer.h"
 #include "ns3/random-variable-stream.h"
+
+#include <iostream>
 namespace ns3 {
 namespace ndn {
 
@@ -60,6 +62,28 @@ public:
   virtual void
   OnExtraContentObject (const Ptr<const ContentObject> &contentObject,
                    Ptr<Packet> payload);          
+
+  /**
+   * @brief Stop sending Interests (including retransmissions), while still processing Data and NACKs
+   *
+   * Used to drain the network before taking a warm-start snapshot (see WarmStartHelper)
+   */
+  void
+  Suspend ();
+
+  /**
+   * @brief Write Interest limit control state (limit, positive feedback, ECN fraction) for a warm-start snapshot
+   */
+  void
+  SaveState (std::ostream &os) const;
+
+  /**
+   * @brief Restore Interest limit control state written by SaveState
+   *
+   * Parameters (InitLimit, DataFeedback, NackFeedback, ...) are not part of the state
+   */
+  void
+  LoadState (std::istream &is);
 protected:
   /**
    * \brief Constructs the Interest packet and sends it using a callback to the underlying NDN protocol
@@ -88,6 +112,13 @@ private:
    */
   void
   ShowInterestLimit();	
+
+  /**
+   * \brief Account received Data in ECN mode and, once per EcnInterval, decrease
+   * Interest limit proportionally to the smoothed fraction of marked Data (DCTCP-style)
+   */
+  void
+  OnEcnFeedback (bool marked);
   
 protected:
   double              m_limit;				//Interest limit (packet/s)
@@ -98,9 +129,18 @@ protected:
   bool								m_inited;
   double              m_limitInterval;
   bool                m_firstTime;
+  bool                m_suspended;    //no more Interests are sent (see Suspend)
   uint32_t						m_data_count;		//used for counting received data
   uint32_t						m_nack_count;
   uint32_t						m_extra_nack_count;
+
+  bool                m_ecn;          //react to CE-marked Data (see CeMarkingQueue)
+  double              m_ecnGain;      //weight of the new sample in the marked fraction average (g in DCTCP)
+  Time                m_ecnInterval;  //how often the marked fraction is estimated
+  double              m_ecnFraction;  //smoothed fraction of marked Data (alpha in DCTCP)
+  Time                m_ecnWindowStart;
+  uint32_t            m_ecnData;      //Data received in the current window
+  uint32_t            m_ecnMarked;    //CE-marked Data received in the current window
   
   TracedCallback<Ptr<Node> /* node */, uint32_t /* appID */,
                  Time /* time */, double /*m_limit*/> m_TraceLimit;
@@ -66,6 +66,19 @@ typedef std::map<Ptr<Node>, int32_t > TreeNode_t;	//node + metric (BCube source
 typedef TreeNode_t::iterator	TreeNodeIterator;
 typedef std::vector<std::pair<Ptr<Node>, Ptr<Node> > > TreeLink_t;
 typedef TreeLink_t::iterator TreeLinkIterator;
+typedef std::map<Ptr<Fib>, Fib::RouteList> RouteBatch_t;	//routes to be installed into each FIB
+typedef std::map<std::pair<Name, Ptr<Face> >, int32_t> RouteMetric_t;	//metrics of routes already in batch
+
+//Install all collected routes, one FIB at a time
+static void
+InstallRouteBatch (RouteBatch_t &batch)
+{
+	for(RouteBatch_t::iterator it = batch.begin(); it != batch.end(); it++)
+	{
+		it->first->AddBatch (it->second);
+	}
+	batch.clear();
+}
 
 void
 BCubeRoutingHelper::Install (Ptr<Node> node)
@@ -303,9 +316,9 @@ BCubeRoutingHelper::CalculateRoutes ()
 		                      Ptr<fib::Entry> entry = fib->Add (prefix, i->second.get<0> (), i->second.get<1> ());
 		                      entry->SetRealDelayToProducer (i->second.get<0> (), Seconds (i->second.get<2> ()));
 		
-		                      Ptr<Limits> faceLimits = i->second.get<0> ()->GetObject<Limits> ();
+		                      Limits *faceLimits = i->second.get<0> ()->GetLimits ();
 		
-		                      Ptr<Limits> fibLimits = entry->GetObject<Limits> ();
+		                      Limits *fibLimits = entry->GetLimits ();
 		                      if (fibLimits != 0)
 		                        {
 		                          // if it was created by the forwarding strategy via DidAddFibEntry event
@@ -353,6 +366,7 @@ BCubeRoutingHelper::CalculateBCubeRoutes(uint32_t m_n, uint32_t m_k)
   	NS_ASSERT(m_n>=1 && m_n<MAX_N);	
   	NS_ASSERT(m_k>=0 && m_k<MAX_K);
   	
+  RouteBatch_t batch;
 	for(NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); node++)
 	{
 		Ptr<GlobalRouter> source = (*node)->GetObject<GlobalRouter> ();
@@ -491,31 +505,21 @@ BCubeRoutingHelper::CalculateBCubeRoutes(uint32_t m_n, uint32_t m_k)
 					Ptr<Face> face = ndn->GetUploadFace ((digit-1)*2);
 					NS_ASSERT(face != 0);
 				
-					Ptr<fib::Entry> entry = fib->Add (prefix, face, metric);
-										
-		      entry->SetRealDelayToProducer (face, Seconds (0.001));	//1ms?
+					//delay of 1ms is also used for limits (if created by the forwarding strategy)
+					batch[fib].push_back (Fib::Route (prefix, face, metric, 0.001));
 		            
 		            /*NS_LOG_UNCOND("Node "<<B
 		            			<<" installs FIB "<<*prefix
 		            			<<" nexthop="<<A
 		            			<<" face="<<face->GetId()
 		            			<<" metric="<<metric);*/
-		
-		        	Ptr<Limits> faceLimits = face->GetObject<Limits> ();
-		
-		            Ptr<Limits> fibLimits = entry->GetObject<Limits> ();
-		            if (fibLimits != 0)
-		            {
-		                // if it was created by the forwarding strategy via DidAddFibEntry event
-		                fibLimits->SetLimits (faceLimits->GetMaxRate (), 2.0 * 0.001);
-		            }
-					
-					
 				}
 			}
 		}
 				
 	}
+	
+	InstallRouteBatch (batch);
 }
 
 void 
@@ -525,6 +529,8 @@ BCubeRoutingHelper::CalculateSharingRoutes(uint32_t m_n, uint32_t m_k)
   	NS_ASSERT(m_n>=1 && m_n<MAX_N);	
   	NS_ASSERT(m_k>=0 && m_k<MAX_K);
   	
+  	RouteBatch_t batch;
+  	RouteMetric_t metrics;
   	for(NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); node++)
   	{
   		/* Step 1: for each node, if it has local prefixes,
@@ -627,49 +633,39 @@ BCubeRoutingHelper::CalculateSharingRoutes(uint32_t m_n, uint32_t m_k)
 					NS_ASSERT(face != 0);
 					
 					//For BCube(8,3), we need at most (3+1)*2+1=9 digits, so int32_t is just enough 
-					//Ptr<fib::Entry> entry = fib->Add (prefix, face, metric); 
+					//Routes are collected and installed at the end, so previous metric of this face
+					//is taken from the batch (or from FIB, if the route was installed before)
+					RouteMetric_t::iterator previous = metrics.find (std::make_pair (*prefix, face));
+					int32_t cost = 10*metric+1;
+					if(previous != metrics.end())
+						cost = previous->second%10+1	//#faces
+				   	     +(previous->second - previous->second%10)*100	//previous routes (two-digit metric)	
+				   	     +metric*10;	//new metrics
+					else
+					{
 		        Ptr<fib::Entry> entry = fib->Find(*prefix);
-            if(entry==0)	//new entry
-            {
-            	 entry = fib->Add (prefix, face, 10*metric+1);
-            }
-		    		else
-		    		{
+		        if(entry!=0)
+		        {
 		    			//find the face
 		    			fib::FaceMetricContainer::type::index<fib::i_face>::type::iterator record
 	   					= entry->m_faces.get<fib::i_face> ().find (face);
 	   					
 	   					if(record!=entry->m_faces.get<fib::i_face> ().end())
-	   						entry = fib->Add (prefix, face, 
-	   										  record->GetRoutingCost ()%10+1	//#faces
+	   						cost = record->GetRoutingCost ()%10+1	//#faces
 				   						     +(record->GetRoutingCost () - record->GetRoutingCost ()%10)*100	//previous routes (two-digit metric)	
-				   						     +metric*10	//new metrics
-				   							 );
-	   					else	//entry for other faces
-	   						entry = fib->Add (prefix, face, 10*metric+1);
-		    		} 
-		    		entry->SetRealDelayToProducer (face, Seconds (0.001));	//1ms?   
-		
-		        	Ptr<Limits> faceLimits = face->GetObject<Limits> ();
-		
-		            Ptr<Limits> fibLimits = entry->GetObject<Limits> ();
-		            if (fibLimits != 0)
-		            {
-		                // if it was created by the forwarding strategy via DidAddFibEntry event
-		                fibLimits->SetLimits (faceLimits->GetMaxRate (), 2.0 * 0.001 /*exact RTT*/);
-		            }
-		            
-		            Ptr<fib::Entry> newentry = fib->Find(*prefix);
-		            fib::FaceMetricContainer::type::index<fib::i_face>::type::iterator record2
-	   				= entry->m_faces.get<fib::i_face> ().find (face);
+				   						     +metric*10;	//new metrics
+		    		}
+		    	}
+		    	metrics[std::make_pair (*prefix, face)] = cost;
+		    	
+		    	//delay of 1ms (exact RTT for limits is 2ms)
+		    	batch[fib].push_back (Fib::Route (prefix, face, cost, 0.001));
 		            
 		            /*NS_LOG_UNCOND("Node "<<B
 		            			<<" installs FIB "<<*prefix
 		            			<<" nexthop="<<A
 		            			<<" face="<<face->GetId()
-		            			<<" metric="<<record2->GetRoutingCost());*/
-					
-					
+		            			<<" metric="<<cost);*/
 				}
 			}
 			
@@ -679,6 +675,8 @@ BCubeRoutingHelper::CalculateSharingRoutes(uint32_t m_n, uint32_t m_k)
 		}
 		 
   	}
+  	
+  	InstallRouteBatch (batch);
 }
 
 } // namespace ndn
@@ -278,6 +278,7 @@ GlobalRoutingHelper::CalculateRoutes ()
 	      NS_ASSERT (fib != 0);
 	
 	      NS_LOG_DEBUG ("Reachability from Node: " << source->GetObject<Node> ()->GetId ());
+	      Fib::RouteList routes;
 	      for (DistancesMap::iterator i = distances.begin ();
 		   i != distances.end ();
 		   i++)
@@ -299,23 +300,13 @@ GlobalRoutingHelper::CalculateRoutes ()
 		                                    << " with distance " << i->second.get<1> ()
 		                                    << " with delay " << i->second.get<2> ());
 		
-		                      Ptr<fib::Entry> entry = fib->Add (prefix, i->second.get<0> (), i->second.get<1> ());
-		                      entry->SetRealDelayToProducer (i->second.get<0> (), Seconds (i->second.get<2> ()));
-		
-		                      Ptr<Limits> faceLimits = i->second.get<0> ()->GetObject<Limits> ();
-		
-		                      Ptr<Limits> fibLimits = entry->GetObject<Limits> ();
-		                      if (fibLimits != 0)
-		                        {
-		                          // if it was created by the forwarding strategy via DidAddFibEntry event
-		                          fibLimits->SetLimits (faceLimits->GetMaxRate (), 2 * i->second.get<2> () /*exact RTT*/);
-		                          NS_LOG_DEBUG ("Set limit for prefix " << *prefix << " " << faceLimits->GetMaxRate () << " / " <<
-		                                        2*i->second.get<2> () << "s (" << faceLimits->GetMaxRate () * 2 * i->second.get<2> () << ")");
-		                        }
+		                      // limits (if created by the forwarding strategy) are set from the delay, once per FIB entry
+		                      routes.push_back (Fib::Route (prefix, i->second.get<0> (), i->second.get<1> (), i->second.get<2> ()));
 		                    }
 				}
 			    }
 			}
+	      fib->AddBatch (routes);
     }
 }
 
@@ -354,6 +345,7 @@ GlobalRoutingHelper::CalculateAllPossibleRoutes ()
 
       Ptr<L3Protocol> l3 = source->GetObject<L3Protocol> ();
       NS_ASSERT (l3 != 0);
+      Fib::RouteList routes;
 
       // remember interface statuses
       std::vector<uint16_t> originalMetric (l3->GetNFaces ());
@@ -415,19 +407,8 @@ GlobalRoutingHelper::CalculateAllPossibleRoutes ()
                           if (i->second.get<0> ()->GetMetric () == std::numeric_limits<uint16_t>::max ()-1)
                             continue;
 
-                          Ptr<fib::Entry> entry = fib->Add (prefix, i->second.get<0> (), i->second.get<1> ());
-                          entry->SetRealDelayToProducer (i->second.get<0> (), Seconds (i->second.get<2> ()));
-
-                          Ptr<Limits> faceLimits = i->second.get<0> ()->GetObject<Limits> ();
-
-                          Ptr<Limits> fibLimits = entry->GetObject<Limits> ();
-                          if (fibLimits != 0)
-                            {
-                              // if it was created by the forwarding strategy via DidAddFibEntry event
-                              fibLimits->SetLimits (faceLimits->GetMaxRate (), 2 * i->second.get<2> () /*exact RTT*/);
-                              NS_LOG_DEBUG ("Set limit for prefix " << *prefix << " " << faceLimits->GetMaxRate () << " / " <<
-                                            2*i->second.get<2> () << "s (" << faceLimits->GetMaxRate () * 2 * i->second.get<2> () << ")");
-                            }
+                          // limits (if created by the forwarding strategy) are set from the delay, once per FIB entry
+                          routes.push_back (Fib::Route (prefix, i->second.get<0> (), i->second.get<1> (), i->second.get<2> ()));
                         }
                     }
                 }
@@ -442,6 +423,8 @@ GlobalRoutingHelper::CalculateAllPossibleRoutes ()
         {
           l3->GetFace (faceId)->SetMetric (originalMetric[faceId]);
         }
+
+      fib->AddBatch (routes);
     }
 }
 
@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-link-control-helper.h"
+#include "ndn-node-faces-helper.h"
+
+#include "ns3/ndn-face.h"
+#include "ns3/ndn-net-device-face.h"
+#include "ns3/ndn-pit-entry.h"
+#include "ns3/ndn-fib-entry.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/names.h"
+#include "ns3/channel.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.LinkControlHelper");
+
+namespace ns3 {
+namespace ndn {
+
+/// @cond include_hidden
+namespace linkcontrol {
+
+/**
+ * @brief Get faces of the node on links (channels) connecting it to the peer
+ */
+std::vector< Ptr<Face> >
+GetFacesTo (Ptr<Node> node, Ptr<Node> peer)
+{
+  std::vector< Ptr<Face> > faces = NodeFacesHelper::GetFaces (node);
+  std::vector< Ptr<Face> > result;
+  for (std::vector< Ptr<Face> >::iterator face = faces.begin (); face != faces.end (); face++)
+    {
+      Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (*face);
+      if (netDeviceFace == 0 || netDeviceFace->GetNetDevice ()->GetChannel () == 0)
+        continue;
+
+      Ptr<Channel> channel = netDeviceFace->GetNetDevice ()->GetChannel ();
+      for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+        {
+          if (channel->GetDevice (i)->GetNode () == peer)
+            {
+              result.push_back (*face);
+              break;
+            }
+        }
+    }
+  return result;
+}
+
+Ptr<Node>
+FindNode (const std::string &name, const std::string &file, uint32_t lineNo)
+{
+  Ptr<Node> node = Names::Find<Node> (name);
+  if (node != 0)
+    return node;
+
+  std::istringstream is (name);
+  uint32_t nodeId;
+  if (is >> nodeId && is.eof () && nodeId < NodeList::GetNNodes ())
+    return NodeList::GetNode (nodeId);
+
+  NS_FATAL_ERROR ("Unknown node " << name << " at " << file << ":" << lineNo);
+  return 0;
+}
+
+} // namespace linkcontrol
+/// @endcond
+
+void
+LinkControlHelper::SetFaceUp (Ptr<Face> face, bool up)
+{
+  face->SetUp (up);
+
+  if (!up)
+    {
+      std::vector< Ptr<pit::Entry> > pitEntries;
+      FaceReference<pit::Entry>::List &pitReferences = face->GetPitReferences ();
+      for (FaceReference<pit::Entry>::List::iterator reference = pitReferences.begin ();
+           reference != pitReferences.end ();
+           reference++)
+        {
+          pitEntries.push_back (reference->GetEntry ());
+        }
+      // removing incoming/outgoing records unlinks them from the face
+      for (std::vector< Ptr<pit::Entry> >::iterator entry = pitEntries.begin (); entry != pitEntries.end (); entry++)
+        {
+          (*entry)->RemoveAllReferencesToFace (face);
+        }
+    }
+
+  std::vector< Ptr<fib::Entry> > fibEntries;
+  FaceReference<fib::Entry>::List &fibReferences = face->GetFibReferences ();
+  for (FaceReference<fib::Entry>::List::iterator reference = fibReferences.begin ();
+       reference != fibReferences.end ();
+       reference++)
+    {
+      fibEntries.push_back (reference->GetEntry ());
+    }
+  for (std::vector< Ptr<fib::Entry> >::iterator entry = fibEntries.begin (); entry != fibEntries.end (); entry++)
+    {
+      (*entry)->UpdateStatus (face, up ? fib::FaceMetric::NDN_FIB_YELLOW : fib::FaceMetric::NDN_FIB_RED);
+    }
+}
+
+void
+LinkControlHelper::FailFace (Ptr<Face> face)
+{
+  NS_LOG_FUNCTION (boost::cref (*face));
+  SetFaceUp (face, false);
+}
+
+void
+LinkControlHelper::RecoverFace (Ptr<Face> face)
+{
+  NS_LOG_FUNCTION (boost::cref (*face));
+  SetFaceUp (face, true);
+}
+
+void
+LinkControlHelper::FailLink (Ptr<Node> node1, Ptr<Node> node2)
+{
+  NS_LOG_FUNCTION (node1->GetId () << node2->GetId ());
+
+  std::vector< Ptr<Face> > faces1 = linkcontrol::GetFacesTo (node1, node2);
+  std::vector< Ptr<Face> > faces2 = linkcontrol::GetFacesTo (node2, node1);
+  if (faces1.empty () || faces2.empty ())
+    {
+      NS_FATAL_ERROR ("No link between nodes " << node1->GetId () << " and " << node2->GetId ());
+    }
+
+  std::for_each (faces1.begin (), faces1.end (), &LinkControlHelper::FailFace);
+  std::for_each (faces2.begin (), faces2.end (), &LinkControlHelper::FailFace);
+}
+
+void
+LinkControlHelper::UpLink (Ptr<Node> node1, Ptr<Node> node2)
+{
+  NS_LOG_FUNCTION (node1->GetId () << node2->GetId ());
+
+  std::vector< Ptr<Face> > faces1 = linkcontrol::GetFacesTo (node1, node2);
+  std::vector< Ptr<Face> > faces2 = linkcontrol::GetFacesTo (node2, node1);
+  if (faces1.empty () || faces2.empty ())
+    {
+      NS_FATAL_ERROR ("No link between nodes " << node1->GetId () << " and " << node2->GetId ());
+    }
+
+  std::for_each (faces1.begin (), faces1.end (), &LinkControlHelper::RecoverFace);
+  std::for_each (faces2.begin (), faces2.end (), &LinkControlHelper::RecoverFace);
+}
+
+void
+LinkControlHelper::ScheduleFromFile (const std::string &file)
+{
+  NS_LOG_FUNCTION (file);
+
+  std::ifstream is (file.c_str ());
+  if (!is.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open failure trace " << file);
+    }
+
+  uint32_t lineNo = 0;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      lineNo ++;
+      line = line.substr (0, line.find ('#'));
+
+      std::istringstream event (line);
+      double time;
+      std::string action, name1, name2;
+      if (!(event >> time))
+        continue; // empty line or comment
+
+      event >> action >> name1 >> name2;
+      if (!event || time < 0)
+        {
+          NS_FATAL_ERROR ("Malformed failure event at " << file << ":" << lineNo);
+        }
+
+      Ptr<Node> node1 = linkcontrol::FindNode (name1, file, lineNo);
+      Ptr<Node> node2 = linkcontrol::FindNode (name2, file, lineNo);
+      if (action == "down")
+        Simulator::Schedule (Seconds (time) - Simulator::Now (), &LinkControlHelper::FailLink, node1, node2);
+      else if (action == "up")
+        Simulator::Schedule (Seconds (time) - Simulator::Now (), &LinkControlHelper::UpLink, node1, node2);
+      else
+        {
+          NS_FATAL_ERROR ("Unknown action " << action << " at " << file << ":" << lineNo << " (expected down or up)");
+        }
+    }
+}
+
+} // namespace ndn
+} // namespace ns3
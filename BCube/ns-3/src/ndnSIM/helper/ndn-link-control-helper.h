@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_LINK_CONTROL_HELPER_H
+#define NDN_LINK_CONTROL_HELPER_H
+
+#include "ns3/ptr.h"
+
+#include <string>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+class Face;
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to fail and recover faces and links during the simulation
+ *
+ * A failed face is put down, all PIT entries stop referring to it, and it is
+ * marked RED in all FIB entries, so forwarding strategies skip it while the
+ * routing metrics (e.g., BCube path labels) are preserved.  Only the entries
+ * referring to the face are touched (see Face::GetPitReferences and
+ * Face::GetFibReferences), so failures are cheap even with large tables.
+ *
+ * Failures can be scheduled from a trace file with one event per line:
+ *
+ * \code
+ * # <time, seconds> <down|up> <node> <node>
+ * 50.0  down  router  producer2
+ * 80.0  up    router  producer2
+ * \endcode
+ *
+ * Nodes are given by names (see Names::Add) or by node ids.
+ */
+class LinkControlHelper
+{
+public:
+  /**
+   * @brief Put the face down and remove it from PIT, mark it RED in FIB
+   */
+  static void
+  FailFace (Ptr<Face> face);
+
+  /**
+   * @brief Put the face up and mark it YELLOW in FIB
+   */
+  static void
+  RecoverFace (Ptr<Face> face);
+
+  /**
+   * @brief Fail faces of both nodes on links between them
+   */
+  static void
+  FailLink (Ptr<Node> node1, Ptr<Node> node2);
+
+  /**
+   * @brief Recover faces of both nodes on links between them
+   */
+  static void
+  UpLink (Ptr<Node> node1, Ptr<Node> node2);
+
+  /**
+   * @brief Schedule link failures and recoveries from the trace file
+   *
+   * Should be called after stacks are installed and before the simulation is run
+   */
+  static void
+  ScheduleFromFile (const std::string &file);
+
+private:
+  /**
+   * @brief Put the face up or down and update PIT and FIB entries referring to it
+   */
+  static void
+  SetFaceUp (Ptr<Face> face, bool up);
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_LINK_CONTROL_HELPER_H
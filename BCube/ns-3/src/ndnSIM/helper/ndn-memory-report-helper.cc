@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-memory-report-helper.h"
+#include "ndn-node-faces-helper.h"
+
+#include "ns3/ndn-face.h"
+#include "ns3/ndn-app-face.h"
+#include "ns3/ndn-net-device-face.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-content-object.h"
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-pit-entry.h"
+#include "ns3/ndn-fib.h"
+#include "ns3/ndn-content-store.h"
+#include "ns3/ndn-limits.h"
+#include "../model/fib/ndn-fib-impl.h"
+#include "../utils/ndn-limits-rate.h"
+#include "../utils/ndn-limits-window.h"
+#include "../utils/ndn-limits-delta-rate.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/names.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/event-impl.h"
+#include "ns3/log.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <fstream>
+#include <unistd.h>
+
+#include "../utils/mem-usage.h"
+
+NS_LOG_COMPONENT_DEFINE ("ndn.MemoryReportHelper");
+
+namespace ns3 {
+namespace ndn {
+
+/// @cond include_hidden
+namespace memory {
+
+// Typical overhead of the containers, in addition to sizeof () of stored values
+const size_t HEAP_BLOCK = 2 * sizeof (void*);      ///< malloc bookkeeping per allocation
+const size_t RB_TREE_NODE = 4 * sizeof (void*);    ///< std::set/std::map node (color, parent, left, right)
+const size_t LIST_NODE = 2 * sizeof (void*);       ///< std::list node (prev, next)
+const size_t MULTI_INDEX_NODE = 8 * sizeof (void*); ///< FaceMetricContainer: 2 ordered indexes + random access index
+const size_t TRIE_BUCKETS = 10 * sizeof (void*);   ///< initial bucket array of trie node children
+const size_t POLICY_HOOK = 2 * sizeof (void*);     ///< replacement policy hook (list or multiset)
+
+inline size_t
+NameBytes (const ndn::Name &name)
+{
+  size_t bytes = sizeof (ndn::Name) + HEAP_BLOCK;
+  for (ndn::Name::const_iterator component = name.begin (); component != name.end (); component++)
+    {
+      bytes += LIST_NODE + sizeof (std::string) + HEAP_BLOCK;
+      if (component->capacity () > 15) // longer strings do not fit into the string object
+        bytes += component->capacity () + 1 + HEAP_BLOCK;
+    }
+  return bytes;
+}
+
+inline size_t
+TrieNodeBytes ()
+{
+  // all tries (PIT, FIB, CS) use the same node layout, only the payload pointer type differs
+  return sizeof (fib::FibImpl::super::parent_trie) + HEAP_BLOCK + TRIE_BUCKETS + HEAP_BLOCK + POLICY_HOOK;
+}
+
+inline size_t
+EventBytes ()
+{
+  // event object (bound member function and arguments) + scheduler record
+  return sizeof (EventImpl) + 4 * sizeof (void*) + HEAP_BLOCK + RB_TREE_NODE + 3 * sizeof (uint64_t);
+}
+
+inline size_t
+LimitsBytes (Ptr<ndn::Limits> limits)
+{
+  if (limits == 0)
+    return 0;
+
+  if (DynamicCast<LimitsDeltaRate> (limits) != 0)
+    return sizeof (LimitsDeltaRate) + HEAP_BLOCK;
+  else if (DynamicCast<LimitsRate> (limits) != 0)
+    return sizeof (LimitsRate) + HEAP_BLOCK;
+  else if (DynamicCast<LimitsWindow> (limits) != 0)
+    return sizeof (LimitsWindow) + HEAP_BLOCK;
+  else
+    return sizeof (ndn::Limits) + HEAP_BLOCK;
+}
+
+} // namespace memory
+/// @endcond
+
+MemoryReportHelper::MemoryReportHelper (const std::string &file)
+{
+  boost::shared_ptr<std::ofstream> os (new std::ofstream ());
+  os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+  if (!os->is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open " << file << " for memory report");
+    }
+  m_os = os;
+
+  PrintHeader ();
+}
+
+MemoryReportHelper::MemoryReportHelper (boost::shared_ptr<std::ostream> os)
+  : m_os (os)
+{
+  PrintHeader ();
+}
+
+void
+MemoryReportHelper::PrintHeader ()
+{
+  *m_os << "Time" << "\t"
+        << "Node" << "\t"
+        << "Table" << "\t"
+        << "Entries" << "\t"
+        << "Bytes" << "\n";
+}
+
+void
+MemoryReportHelper::Add (Ptr<Node> node)
+{
+  m_nodes.Add (node);
+}
+
+void
+MemoryReportHelper::Add (const NodeContainer &nodes)
+{
+  m_nodes.Add (nodes);
+}
+
+void
+MemoryReportHelper::AddAll ()
+{
+  m_nodes = NodeContainer::GetGlobal ();
+}
+
+void
+MemoryReportHelper::ReportAt (Time time)
+{
+  Simulator::Schedule (time - Simulator::Now (), &MemoryReportHelper::Report, Ptr<MemoryReportHelper> (this));
+}
+
+void
+MemoryReportHelper::ReportPeriodically (Time period)
+{
+  NS_ASSERT_MSG (period.IsStrictlyPositive (), "Period of memory reports should be positive");
+  Simulator::ScheduleNow (&MemoryReportHelper::PeriodicReport, Ptr<MemoryReportHelper> (this), period);
+}
+
+void
+MemoryReportHelper::PeriodicReport (Time period)
+{
+  Report ();
+  Simulator::Schedule (period, &MemoryReportHelper::PeriodicReport, Ptr<MemoryReportHelper> (this), period);
+}
+
+void
+MemoryReportHelper::Report ()
+{
+  NS_LOG_FUNCTION (this << m_nodes.GetN ());
+
+  for (NodeContainer::Iterator node = m_nodes.Begin (); node != m_nodes.End (); node++)
+    {
+      ReportNode (*node);
+    }
+
+  int64_t rss = MemUsage::Get ();
+  PrintRow ("*", "ProcessRss", 0, rss > 0 ? static_cast<uint64_t> (rss) : 0);
+  m_os->flush ();
+}
+
+void
+MemoryReportHelper::PrintRow (const std::string &node, const std::string &table, uint64_t entries, uint64_t bytes)
+{
+  *m_os << Simulator::Now ().ToDouble (Time::S) << "\t"
+        << node << "\t"
+        << table << "\t"
+        << entries << "\t"
+        << bytes << "\n";
+}
+
+void
+MemoryReportHelper::ReportNode (Ptr<Node> node)
+{
+  using namespace memory;
+
+  std::string name = Names::FindName (node);
+  if (name.empty ())
+    name = boost::lexical_cast<std::string> (node->GetId ());
+
+  uint64_t limitsCount = 0;
+  uint64_t limitsBytes = 0;
+
+  Ptr<Pit> pit = node->GetObject<Pit> ();
+  if (pit != 0)
+    {
+      uint64_t bytes = 0;
+      for (Ptr<pit::Entry> entry = pit->Begin (); entry != pit->End (); entry = pit->Next (entry))
+        {
+          bytes += sizeof (pit::Entry) + HEAP_BLOCK + TrieNodeBytes ();
+          bytes += entry->GetIncoming ().size () * (RB_TREE_NODE + sizeof (pit::IncomingFace) + HEAP_BLOCK);
+          bytes += entry->GetOutgoing ().size () * (RB_TREE_NODE + sizeof (pit::OutgoingFace) + HEAP_BLOCK);
+          bytes += entry->GetSeenNonces ().size () * (RB_TREE_NODE + sizeof (uint32_t) + HEAP_BLOCK);
+          bytes += entry->GetIncomingIndex ().size () * (RB_TREE_NODE + sizeof (uint32_t) + HEAP_BLOCK);
+          // list node with shared_ptr, shared_ptr control block and the tag itself
+          bytes += entry->GetFwTagCount () * (LIST_NODE + 2 * sizeof (void*) + HEAP_BLOCK + 4 * sizeof (void*) + 2 * HEAP_BLOCK);
+
+          Ptr<const Interest> interest = entry->GetInterest ();
+          if (interest != 0)
+            bytes += sizeof (Interest) + HEAP_BLOCK + NameBytes (interest->GetName ());
+        }
+      PrintRow (name, "Pit", pit->GetSize (), bytes);
+    }
+
+  Ptr<Fib> fib = node->GetObject<Fib> ();
+  uint64_t events = 0;
+  if (fib != 0)
+    {
+      uint64_t bytes = 0;
+      for (Ptr<fib::Entry> entry = fib->Begin (); entry != fib->End (); entry = fib->Next (entry))
+        {
+          bytes += sizeof (fib::EntryImpl) + HEAP_BLOCK + TrieNodeBytes ();
+          bytes += NameBytes (entry->GetPrefix ());
+          bytes += entry->m_faces.size () * (sizeof (fib::FaceMetric) + MULTI_INDEX_NODE + HEAP_BLOCK);
+          // random access index keeps an array of pointers
+          bytes += entry->m_faces.size () * sizeof (void*);
+          // FaceCounters: 7 arrays of doubles, one of uint32_t and one of face pointers
+          bytes += entry->m_counters.GetSize () * (7 * sizeof (double) + sizeof (uint32_t) + sizeof (void*)) + 9 * HEAP_BLOCK;
+
+          Ptr<Limits> limits = entry->GetObject<Limits> ();
+          if (limits != 0)
+            {
+              limitsCount ++;
+              limitsBytes += LimitsBytes (limits);
+            }
+
+          // each FIB entry keeps ShowRate and ResetCount events scheduled
+          events += 2;
+        }
+      PrintRow (name, "Fib", fib->GetSize (), bytes);
+    }
+
+  Ptr<ContentStore> cs = node->GetObject<ContentStore> ();
+  if (cs != 0)
+    {
+      uint64_t bytes = 0;
+      for (Ptr<cs::Entry> entry = cs->Begin (); entry != cs->End (); entry = cs->Next (entry))
+        {
+          bytes += sizeof (cs::Entry) + HEAP_BLOCK + TrieNodeBytes ();
+          bytes += sizeof (ContentObject) + HEAP_BLOCK + NameBytes (entry->GetName ());
+
+          // only encoded packet is stored (payload is a fragment created on demand)
+          bytes += sizeof (Packet) + HEAP_BLOCK + entry->GetEncodedPacket ()->GetSize () + HEAP_BLOCK;
+        }
+      PrintRow (name, "ContentStore", cs->GetSize (), bytes);
+    }
+
+  std::vector< Ptr<Face> > faces = NodeFacesHelper::GetFaces (node);
+  if (!faces.empty ())
+    {
+      uint64_t count = 0;
+      uint64_t bytes = 0;
+      for (std::vector< Ptr<Face> >::iterator face = faces.begin (); face != faces.end (); face++)
+        {
+          if (*face == 0)
+            continue;
+
+          count ++;
+          if (DynamicCast<NetDeviceFace> (*face) != 0)
+            bytes += sizeof (NetDeviceFace) + HEAP_BLOCK;
+          else if (DynamicCast<AppFace> (*face) != 0)
+            bytes += sizeof (AppFace) + HEAP_BLOCK;
+          else
+            bytes += sizeof (Face) + HEAP_BLOCK;
+
+          Ptr<Limits> limits = (*face)->GetObject<Limits> ();
+          if (limits != 0)
+            {
+              limitsCount ++;
+              limitsBytes += LimitsBytes (limits);
+            }
+        }
+      PrintRow (name, "Faces", count, bytes);
+    }
+
+  PrintRow (name, "Limits", limitsCount, limitsBytes);
+  PrintRow (name, "Events", events, events * EventBytes ());
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_MEMORY_REPORT_HELPER_H
+#define NDN_MEMORY_REPORT_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <ostream>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to report estimated memory footprint of NDN tables on each node
+ *
+ * On every report, the helper walks Pit, Fib, ContentStore and faces of the
+ * nodes and writes one row per (node, table) into the trace file:
+ *
+ * \code
+ * Time	Node	Table	Entries	Bytes
+ * \endcode
+ *
+ * Tables are:
+ * - Pit: PIT entries, their trie nodes, names, incoming/outgoing/nonce sets and forwarding tags
+ * - Fib: FIB entries, their trie nodes, names, multi-index face records and congestion counters
+ * - ContentStore: CS entries, their trie nodes, names, headers and payloads
+ * - Faces: face objects
+ * - Limits: Limits objects aggregated to faces and FIB entries
+ * - Events: periodic events kept by FIB entries
+ *
+ * Sizes are estimates: they are calculated from sizeof () of the objects and
+ * typical per-node overhead of the containers (trie nodes with bucket arrays,
+ * red-black tree nodes of std::set and ordered multi-index indexes, list nodes),
+ * not measured from the allocator.  They are meant to compare runs and find the
+ * tables that grow, not to match RSS exactly.  For reference, an extra row with
+ * Node "*" and Table "ProcessRss" reports the resident set size of the process
+ * (see MemUsage).
+ *
+ * Example:
+ *
+ * \code
+ * Ptr<ndn::MemoryReportHelper> memory = Create<ndn::MemoryReportHelper> ("memory-report.txt");
+ * memory->AddAll ();
+ * memory->ReportPeriodically (Seconds (10.0));
+ * Simulator::Run ();
+ * \endcode
+ */
+class MemoryReportHelper : public SimpleRefCount<MemoryReportHelper>
+{
+public:
+  /**
+   * @brief Create helper writing report into the file
+   * @param file Name of the output file
+   */
+  MemoryReportHelper (const std::string &file);
+
+  /**
+   * @brief Create helper writing report into the stream
+   */
+  MemoryReportHelper (boost::shared_ptr<std::ostream> os);
+
+  /**
+   * @brief Add node to the report
+   */
+  void
+  Add (Ptr<Node> node);
+
+  /**
+   * @brief Add nodes to the report
+   */
+  void
+  Add (const NodeContainer &nodes);
+
+  /**
+   * @brief Add all nodes in the simulation (NodeList) to the report
+   */
+  void
+  AddAll ();
+
+  /**
+   * @brief Schedule one report at the specified simulation time
+   */
+  void
+  ReportAt (Time time);
+
+  /**
+   * @brief Schedule reports with the specified period, starting from now
+   */
+  void
+  ReportPeriodically (Time period);
+
+  /**
+   * @brief Write report now
+   */
+  void
+  Report ();
+
+private:
+  void
+  PrintHeader ();
+
+  void
+  PeriodicReport (Time period);
+
+  void
+  ReportNode (Ptr<Node> node);
+
+  void
+  PrintRow (const std::string &node, const std::string &table, uint64_t entries, uint64_t bytes);
+
+private:
+  boost::shared_ptr<std::ostream> m_os;
+  NodeContainer m_nodes;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_MEMORY_REPORT_HELPER_H
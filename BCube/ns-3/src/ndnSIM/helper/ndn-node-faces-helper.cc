@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-node-faces-helper.h"
+
+#include "ns3/ndn-l3-protocol.h"
+#include "ns3/ndn-bcube-l3-protocol.h"
+#include "ns3/ndn-l2-protocol.h"
+#include "ns3/ndn-face.h"
+
+#include "ns3/node.h"
+
+namespace ns3 {
+namespace ndn {
+
+std::vector< Ptr<Face> >
+NodeFacesHelper::GetFaces (Ptr<Node> node)
+{
+  std::vector< Ptr<Face> > faces;
+  Ptr<L3Protocol> l3 = node->GetObject<L3Protocol> ();
+  Ptr<BCubeL3Protocol> bcubeL3 = node->GetObject<BCubeL3Protocol> ();
+  Ptr<L2Protocol> l2 = node->GetObject<L2Protocol> ();
+  if (l3 != 0)
+    {
+      for (uint32_t i = 0; i < l3->GetNFaces (); i++)
+        faces.push_back (l3->GetFace (i));
+    }
+  if (bcubeL3 != 0)
+    {
+      // face ids are dense (upload and download faces), an app face takes only upload id
+      for (uint32_t i = 0; i < bcubeL3->GetNFaces (); i++)
+        faces.push_back (bcubeL3->GetFaceById (i));
+    }
+  if (l2 != 0)
+    {
+      for (uint32_t i = 0; i < l2->GetNFaces (); i++)
+        faces.push_back (l2->GetFaceById (i));
+    }
+  return faces;
+}
+
+Ptr<Face>
+NodeFacesHelper::GetFaceById (Ptr<Node> node, uint32_t id)
+{
+  Ptr<L3Protocol> l3 = node->GetObject<L3Protocol> ();
+  Ptr<BCubeL3Protocol> bcubeL3 = node->GetObject<BCubeL3Protocol> ();
+  Ptr<L2Protocol> l2 = node->GetObject<L2Protocol> ();
+  if (l3 != 0)
+    return l3->GetFaceById (id);
+  if (bcubeL3 != 0)
+    return bcubeL3->GetFaceById (id);
+  if (l2 != 0)
+    return l2->GetFaceById (id);
+  return 0;
+}
+
+} // namespace ndn
+} // namespace ns3
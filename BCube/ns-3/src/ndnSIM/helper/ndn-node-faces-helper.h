@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_NODE_FACES_HELPER_H
+#define NDN_NODE_FACES_HELPER_H
+
+#include "ns3/ptr.h"
+
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+class Face;
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to enumerate faces of a node, whatever NDN stack is installed on it
+ *
+ * Faces are kept by L3Protocol (StackHelper), BCubeL3Protocol (BCubeStackHelper)
+ * or L2Protocol (SwitchStackHelper), which do not share an interface.
+ */
+class NodeFacesHelper
+{
+public:
+  /**
+   * @brief Get all faces of the node
+   *
+   * Faces of BCubeL3Protocol and L2Protocol are listed by id.  An application face of
+   * BCubeL3Protocol takes only an upload id, so the list may have null entries
+   */
+  static std::vector< Ptr<Face> >
+  GetFaces (Ptr<Node> node);
+
+  /**
+   * @brief Get face of the node by its id
+   * @returns 0 if there is no such face
+   */
+  static Ptr<Face>
+  GetFaceById (Ptr<Node> node, uint32_t id);
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_NODE_FACES_HELPER_H
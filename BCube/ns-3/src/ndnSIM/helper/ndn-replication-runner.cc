@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-replication-runner.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/rng-seed-manager.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.ReplicationRunner");
+
+namespace ns3 {
+namespace ndn {
+
+bool     ReplicationRunner::s_isReplication = false;
+uint32_t ReplicationRunner::s_currentRun = 0;
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1)
+  , m_firstRun (1)
+  , m_maxParallel (0)
+{
+}
+
+void
+ReplicationRunner::SetReplications (uint32_t replications)
+{
+  m_replications = replications;
+}
+
+void
+ReplicationRunner::SetFirstRun (uint32_t firstRun)
+{
+  m_firstRun = firstRun;
+}
+
+void
+ReplicationRunner::SetMaxParallel (uint32_t maxParallel)
+{
+  m_maxParallel = maxParallel;
+}
+
+void
+ReplicationRunner::AddTraceFile (const std::string &file)
+{
+  m_traceFiles.push_back (file);
+}
+
+bool
+ReplicationRunner::IsReplication ()
+{
+  return s_isReplication;
+}
+
+std::string
+ReplicationRunner::GetTraceFileName (const std::string &file)
+{
+  if (!s_isReplication)
+    return file;
+
+  return GetTraceFileName (file, s_currentRun);
+}
+
+std::string
+ReplicationRunner::GetTraceFileName (const std::string &file, uint32_t run)
+{
+  std::string suffix = ".run" + boost::lexical_cast<std::string> (run);
+
+  // keep extension, so "rate-trace.txt" becomes "rate-trace.run5.txt"
+  std::string::size_type dot = file.rfind ('.');
+  std::string::size_type slash = file.rfind ('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return file + suffix;
+
+  return file.substr (0, dot) + suffix + file.substr (dot);
+}
+
+uint32_t
+ReplicationRunner::Run (ScenarioCallback scenario)
+{
+  NS_ASSERT_MSG (!s_isReplication, "ReplicationRunner::Run cannot be called from inside a replication");
+
+  uint32_t maxParallel = m_maxParallel;
+  if (maxParallel == 0)
+    {
+      long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+      maxParallel = cpus > 0 ? static_cast<uint32_t> (cpus) : 1;
+    }
+
+  NS_LOG_INFO ("Running " << m_replications << " replications, up to " << maxParallel << " in parallel");
+
+  std::map<pid_t, uint32_t> running;
+  std::list<uint32_t> succeeded;
+  uint32_t failed = 0;
+  uint32_t next = 0;
+
+  while (next < m_replications || !running.empty ())
+    {
+      while (next < m_replications && running.size () < maxParallel)
+        {
+          uint32_t run = m_firstRun + next;
+          next ++;
+
+          // do not let children inherit (and print again) buffered output of the parent
+          std::cout.flush ();
+          std::cerr.flush ();
+          fflush (0);
+
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Cannot fork process for replication with run " << run);
+            }
+          else if (pid == 0)
+            {
+              s_isReplication = true;
+              s_currentRun = run;
+              RngSeedManager::SetRun (run);
+
+              scenario (run);
+
+              std::cout.flush ();
+              std::cerr.flush ();
+              fflush (0);
+              _exit (0);
+            }
+
+          NS_LOG_DEBUG ("Started replication with run " << run << " (pid " << pid << ")");
+          running[pid] = run;
+        }
+
+      int status = 0;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("waitpid failed while waiting for replications");
+        }
+
+      std::map<pid_t, uint32_t>::iterator process = running.find (pid);
+      if (process == running.end ())
+        continue; // not one of ours
+
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+        {
+          NS_LOG_DEBUG ("Replication with run " << process->second << " finished");
+          succeeded.push_back (process->second);
+        }
+      else
+        {
+          NS_LOG_ERROR ("Replication with run " << process->second << " failed");
+          failed ++;
+        }
+      running.erase (process);
+    }
+
+  succeeded.sort ();
+  for (std::list<std::string>::const_iterator file = m_traceFiles.begin ();
+       file != m_traceFiles.end ();
+       file ++)
+    {
+      MergeTraceFile (*file, succeeded);
+    }
+
+  return failed;
+}
+
+void
+ReplicationRunner::MergeTraceFile (const std::string &file, const std::list<uint32_t> &runs) const
+{
+  std::ofstream os (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+  if (!os.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open " << file << " to merge replication traces");
+      return;
+    }
+
+  bool headerWritten = false;
+  for (std::list<uint32_t>::const_iterator run = runs.begin ();
+       run != runs.end ();
+       run ++)
+    {
+      std::string runFile = GetTraceFileName (file, *run);
+      std::ifstream is (runFile.c_str ());
+      if (!is.is_open ())
+        {
+          NS_LOG_WARN ("Trace file " << runFile << " does not exist");
+          continue;
+        }
+
+      std::string line;
+      // all tracers write a single header line, copy it only once
+      if (std::getline (is, line) && !headerWritten)
+        {
+          os << "Run" << "\t" << line << "\n";
+          headerWritten = true;
+        }
+
+      while (std::getline (is, line))
+        {
+          if (line.empty ())
+            continue;
+          os << *run << "\t" << line << "\n";
+        }
+
+      is.close ();
+      std::remove (runFile.c_str ());
+    }
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-warm-start-helper.h"
+#include "ndn-node-faces-helper.h"
+
+#include "ns3/ndn-face.h"
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-fib.h"
+#include "ns3/ndn-fib-entry.h"
+#include "../apps/ndn-consumer-om.h"
+#include "../utils/ndn-limits-delta-rate.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.WarmStartHelper");
+
+namespace ns3 {
+namespace ndn {
+
+/// @cond include_hidden
+namespace warmstart {
+
+uint32_t
+GetPitSize ()
+{
+  uint32_t size = 0;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      Ptr<Pit> pit = (*node)->GetObject<Pit> ();
+      if (pit != 0)
+        size += pit->GetSize ();
+    }
+  return size;
+}
+
+} // namespace warmstart
+/// @endcond
+
+void
+WarmStartHelper::SaveAt (Time time, const std::string &file, Time maxDrain)
+{
+  Simulator::Schedule (time - Simulator::Now (), &WarmStartHelper::Suspend, file, time + maxDrain);
+}
+
+void
+WarmStartHelper::Suspend (const std::string &file, Time deadline)
+{
+  NS_LOG_FUNCTION (file);
+
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNApplications (); i++)
+        {
+          Ptr<ConsumerOm> consumer = DynamicCast<ConsumerOm> ((*node)->GetApplication (i));
+          if (consumer != 0)
+            consumer->Suspend ();
+        }
+    }
+
+  WaitForEmptyPits (file, deadline);
+}
+
+void
+WarmStartHelper::WaitForEmptyPits (const std::string &file, Time deadline)
+{
+  uint32_t pitSize = warmstart::GetPitSize ();
+  if (pitSize > 0 && Simulator::Now () < deadline)
+    {
+      // PIT entries are removed at least when they expire, so the wait is bounded by the Interest lifetime
+      Simulator::Schedule (MilliSeconds (10), &WarmStartHelper::WaitForEmptyPits, file, deadline);
+      return;
+    }
+
+  if (pitSize > 0)
+    NS_LOG_WARN ("PITs still have " << pitSize << " entries, the snapshot is not quiescent");
+
+  Save (file);
+  Simulator::Stop ();
+}
+
+void
+WarmStartHelper::Save (const std::string &file)
+{
+  NS_LOG_FUNCTION (file);
+
+  std::ofstream os (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+  if (!os.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open " << file << " for warm-start snapshot");
+    }
+  os.precision (std::numeric_limits<double>::digits10 + 2); // restore doubles exactly
+
+  os << "# ndnSIM warm-start snapshot at " << Simulator::Now ().ToDouble (Time::S) << "s\n";
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      uint32_t nodeId = (*node)->GetId ();
+
+      for (uint32_t i = 0; i < (*node)->GetNApplications (); i++)
+        {
+          Ptr<ConsumerOm> consumer = DynamicCast<ConsumerOm> ((*node)->GetApplication (i));
+          if (consumer == 0)
+            continue;
+
+          os << "consumer " << nodeId << " " << i << " ";
+          consumer->SaveState (os);
+          os << "\n";
+        }
+
+      std::vector< Ptr<Face> > faces = NodeFacesHelper::GetFaces (*node);
+      for (std::vector< Ptr<Face> >::iterator face = faces.begin (); face != faces.end (); face++)
+        {
+          if (*face == 0 || (*face)->GetDeltaRateLimits () == 0)
+            continue;
+
+          os << "face-limits " << nodeId << " " << (*face)->GetId () << " ";
+          (*face)->GetDeltaRateLimits ()->SaveState (os);
+          os << "\n";
+        }
+
+      Ptr<Fib> fib = (*node)->GetObject<Fib> ();
+      if (fib == 0)
+        continue;
+
+      for (Ptr<fib::Entry> entry = fib->Begin (); entry != fib->End (); entry = fib->Next (entry))
+        {
+          os << "fib " << nodeId << " " << entry->GetPrefix () << " ";
+          entry->SaveState (os);
+          os << "\n";
+
+          if (entry->GetDeltaRateLimits () != 0)
+            {
+              os << "fib-limits " << nodeId << " " << entry->GetPrefix () << " ";
+              entry->GetDeltaRateLimits ()->SaveState (os);
+              os << "\n";
+            }
+        }
+    }
+
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Failed to write warm-start snapshot " << file);
+    }
+}
+
+void
+WarmStartHelper::Load (const std::string &file)
+{
+  NS_LOG_FUNCTION (file);
+
+  std::ifstream is (file.c_str ());
+  if (!is.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open warm-start snapshot " << file);
+    }
+
+  uint32_t lineNo = 0;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      lineNo ++;
+      if (line.empty () || line[0] == '#')
+        continue;
+
+      std::istringstream record (line);
+      std::string type;
+      uint32_t nodeId;
+      record >> type >> nodeId;
+      if (!record || nodeId >= NodeList::GetNNodes ())
+        {
+          NS_FATAL_ERROR ("Invalid record at " << file << ":" << lineNo << ", snapshot does not match the topology");
+        }
+      Ptr<Node> node = NodeList::GetNode (nodeId);
+
+      if (type == "consumer")
+        {
+          uint32_t appIndex;
+          record >> appIndex;
+          Ptr<ConsumerOm> consumer = appIndex < node->GetNApplications () ?
+            DynamicCast<ConsumerOm> (node->GetApplication (appIndex)) : 0;
+          if (consumer == 0)
+            {
+              NS_FATAL_ERROR ("No ConsumerOm " << appIndex << " on node " << nodeId << " (" << file << ":" << lineNo << ")");
+            }
+          consumer->LoadState (record);
+        }
+      else if (type == "face-limits")
+        {
+          uint32_t faceId;
+          record >> faceId;
+          Ptr<Face> face = NodeFacesHelper::GetFaceById (node, faceId);
+          if (face == 0 || face->GetDeltaRateLimits () == 0)
+            {
+              NS_FATAL_ERROR ("No face " << faceId << " with LimitsDeltaRate on node " << nodeId << " (" << file << ":" << lineNo << ")");
+            }
+          face->GetDeltaRateLimits ()->LoadState (record);
+        }
+      else if (type == "fib" || type == "fib-limits")
+        {
+          std::string prefix;
+          record >> prefix;
+          Ptr<Fib> fib = node->GetObject<Fib> ();
+          Ptr<fib::Entry> entry = fib != 0 ? fib->Find (Name (prefix)) : 0;
+          if (entry == 0)
+            {
+              NS_FATAL_ERROR ("No FIB entry " << prefix << " on node " << nodeId << " (" << file << ":" << lineNo << ")");
+            }
+
+          if (type == "fib")
+            entry->LoadState (record);
+          else if (entry->GetDeltaRateLimits () != 0)
+            entry->GetDeltaRateLimits ()->LoadState (record);
+        }
+      else
+        {
+          NS_FATAL_ERROR ("Unknown record type " << type << " at " << file << ":" << lineNo);
+        }
+
+      if (record.fail ())
+        {
+          NS_FATAL_ERROR ("Malformed record at " << file << ":" << lineNo);
+        }
+    }
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_WARM_START_HELPER_H
+#define NDN_WARM_START_HELPER_H
+
+#include "ns3/nstime.h"
+
+#include <string>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to save congestion control state at a quiescent point and to start other runs from it
+ *
+ * ConsumerOm starts from InitLimit and needs tens to hundreds of simulated seconds
+ * to converge.  In parameter sweeps, one run can take a snapshot of the converged
+ * state, and all other runs can start from it:
+ *
+ * \code
+ * // warm-up run
+ * ndn::WarmStartHelper::SaveAt (Seconds (200.0), "warm.snapshot");
+ * Simulator::Run ();   // stops after the snapshot is written
+ *
+ * // sweep runs (the same topology, apps and routes)
+ * ndn::WarmStartHelper::Load ("warm.snapshot");
+ * Simulator::Run ();
+ * \endcode
+ *
+ * The snapshot contains:
+ * - Interest limit, positive feedback and ECN fraction of every ConsumerOm
+ * - tokens, Interest counter of the last interval and NACK counter of LimitsDeltaRate of faces and FIB entries
+ * - NACK/Data counters, their EWMA and traffic fractions of next hops of FIB entries
+ *
+ * PIT, content store and packets in flight are not saved.  To make the snapshot
+ * consistent without them, SaveAt suspends all ConsumerOm applications and waits
+ * until PITs of all nodes are empty before taking the snapshot.
+ *
+ * Objects are identified by node id, application index, face id and FIB prefix.
+ * The run loading the snapshot must create them in the same order, i.e., use the
+ * same topology, applications and routing; parameters of the objects (e.g., limits
+ * of the faces) may differ.  Sequence numbers of consumers are not saved, so
+ * consumers start from the first Data packet with the converged Interest limits.
+ */
+class WarmStartHelper
+{
+public:
+  /**
+   * @brief Schedule snapshot of all nodes and stop the simulation after it is written
+   * @param time     when consumers are suspended
+   * @param file     name of the snapshot file
+   * @param maxDrain maximum time to wait for PITs to become empty (the snapshot is taken anyway)
+   */
+  static void
+  SaveAt (Time time, const std::string &file, Time maxDrain = Seconds (10.0));
+
+  /**
+   * @brief Write snapshot of all nodes now, without draining the network
+   */
+  static void
+  Save (const std::string &file);
+
+  /**
+   * @brief Restore state of all nodes from the snapshot
+   *
+   * Should be called after applications, stacks and routes are installed
+   */
+  static void
+  Load (const std::string &file);
+
+private:
+  static void
+  Suspend (const std::string &file, Time deadline);
+
+  static void
+  WaitForEmptyPits (const std::string &file, Time deadline);
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_WARM_START_HELPER_H
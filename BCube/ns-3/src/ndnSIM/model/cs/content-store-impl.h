@@ -44,8 +44,8 @@ public:
   typedef Entry base_type;
 
 public:
-  EntryImpl (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> packet)
-    : Entry (cs, header, packet)
+  EntryImpl (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet)
+    : Entry (cs, header, payload, packet)
     , item_ (0)
   {
   }
@@ -90,7 +90,7 @@ public:
   Lookup (Ptr<const Interest> interest);
 
   virtual inline bool
-  Add (Ptr<const ContentObject> header, Ptr<const Packet> packet);
+  Add (Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet = 0);
 
   // virtual bool
   // Remove (Ptr<Interest> header);
@@ -183,11 +183,11 @@ ContentStoreImpl<Policy>::Lookup (Ptr<const Interest> interest)
 
 template<class Policy>
 bool
-ContentStoreImpl<Policy>::Add (Ptr<const ContentObject> header, Ptr<const Packet> packet)
+ContentStoreImpl<Policy>::Add (Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet/* = 0*/)
 {
   NS_LOG_FUNCTION (this << header->GetName ());
 
-  Ptr< entry > newEntry = Create< entry > (this, header, packet);
+  Ptr< entry > newEntry = Create< entry > (this, header, payload, packet);
   std::pair< typename super::iterator, bool > result = super::insert (header->GetName (), newEntry);
 
   if (result.first != super::end ())
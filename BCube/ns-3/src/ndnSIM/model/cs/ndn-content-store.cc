@@ -60,24 +60,43 @@ namespace cs {
 
 //////////////////////////////////////////////////////////////////////
 
-Entry::Entry (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> packet)
+Entry::Entry (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet/* = 0*/)
   : m_cs (cs)
   , m_header (header)
-  , m_packet (packet->Copy ())
+  , m_encodedPacket (packet)
+  , m_payloadOffset (header->GetSerializedSize ())
+  , m_payloadSize (payload->GetSize ())
 {
+  if (m_encodedPacket == 0)
+    {
+      static ContentObjectTail tail; ///< \internal for optimization purposes
+
+      Ptr<Packet> encoded = payload->Copy ();
+      encoded->AddHeader (*m_header);
+      encoded->AddTrailer (tail);
+      m_encodedPacket = encoded;
+    }
+
+  NS_ASSERT_MSG (m_payloadOffset + m_payloadSize <= m_encodedPacket->GetSize (),
+                 "Encoded packet does not match ContentObject header and payload");
 }
 
 Ptr<Packet>
 Entry::GetFullyFormedNdnPacket () const
 {
-  static ContentObjectTail tail; ///< \internal for optimization purposes
-
-  Ptr<Packet> packet = m_packet->Copy ();
-  packet->AddHeader (*m_header);
-  packet->AddTrailer (tail);
+  // buffer is shared copy-on-write, only the packet object is created
+  Ptr<Packet> packet = m_encodedPacket->Copy ();
+  // tags (e.g., hop count) belong to the packet that was cached, not to the cache hit
+  packet->RemoveAllPacketTags ();
   return packet;
 }
 
+Ptr<const Packet>
+Entry::GetEncodedPacket () const
+{
+  return m_encodedPacket;
+}
+
 const Name&
 Entry::GetName () const
 {
@@ -93,7 +112,9 @@ Entry::GetHeader () const
 Ptr<const Packet>
 Entry::GetPacket () const
 {
-  return m_packet;
+  Ptr<Packet> payload = m_encodedPacket->CreateFragment (m_payloadOffset, m_payloadSize);
+  payload->RemoveAllPacketTags ();
+  return payload;
 }
 
 Ptr<ContentStore>
@@ -65,12 +65,15 @@ public:
    * \brief Construct content store entry
    *
    * \param header Parsed ContentObject header
-   * \param packet Original Ndn packet
+   * \param payload Payload of the ContentObject
+   * \param packet Fully encoded Ndn packet (ContentObject header, payload and trailer).
+   *               If 0, the packet is encoded once, here
    *
-   * The constructor will make a copy of the supplied packet and calls
-   * RemoveHeader and RemoveTail on the copy.
+   * The packet is not copied: the entry keeps a reference to the supplied (immutable)
+   * encoded packet, which is shared copy-on-write with all cache hits.  Payload is not
+   * stored separately, only its position inside the encoded packet
    */
-  Entry (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> packet);
+  Entry (Ptr<ContentStore> cs, Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet = 0);
 
   /**
    * \brief Get prefix of the stored entry
@@ -88,18 +91,24 @@ public:
 
   /**
    * \brief Get content of the stored entry
-   * \returns content of the stored entry
+   * \returns content of the stored entry (fragment of the encoded packet, sharing its buffer)
    */
   Ptr<const Packet>
   GetPacket () const;
 
   /**
-   * \brief Convenience method to create a fully formed Ndn packet from stored header and content
-   * \returns A read-write copy of the packet with ContentObject and ContentObjectTail
+   * \brief Get fully formed Ndn packet (ContentObject, content and ContentObjectTail)
+   * \returns A read-write (copy-on-write) copy of the stored encoded packet, without packet tags
    */
   Ptr<Packet>
   GetFullyFormedNdnPacket () const;
 
+  /**
+   * \brief Get stored (immutable) encoded Ndn packet
+   */
+  Ptr<const Packet>
+  GetEncodedPacket () const;
+
   /**
    * @brief Get pointer to access store, to which this entry is added
    */
@@ -109,7 +118,9 @@ public:
 private:
   Ptr<ContentStore> m_cs; ///< \brief content store to which entry is added
   Ptr<const ContentObject> m_header; ///< \brief non-modifiable ContentObject
-  Ptr<Packet> m_packet; ///< \brief non-modifiable content of the ContentObject packet
+  Ptr<const Packet> m_encodedPacket; ///< \brief non-modifiable fully encoded Ndn packet, shared by all cache hits
+  uint32_t m_payloadOffset; ///< \brief offset of the content in m_encodedPacket (size of ContentObject header)
+  uint32_t m_payloadSize;   ///< \brief size of the content
 };
 
 } // namespace cs
@@ -154,12 +165,13 @@ public:
    * \brief Add a new content to the content store.
    *
    * \param header Fully parsed ContentObject
-   * \param packet Fully formed Ndn packet to add to content store
-   * (will be copied and stripped down of headers)
+   * \param payload Payload of the ContentObject (will not be copied)
+   * \param packet Fully encoded Ndn packet, as received from the face (will not be copied).
+   *               If 0, the packet will be encoded from header and payload
    * @returns true if an existing entry was updated, false otherwise
    */
   virtual bool
-  Add (Ptr<const ContentObject> header, Ptr<const Packet> packet) = 0;
+  Add (Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet = 0) = 0;
 
   // /*
   //  * \brief Add a new content to the content store.
@@ -26,6 +26,7 @@
 #include "ns3/names.h"
 
 #include "ns3/node.h"
+#include "ns3/ndn-limits-delta-rate.h"
 
 #include <cmath>
 
@@ -58,6 +59,58 @@ struct FaceMetricByFace
 };
 
 
+uint32_t
+FaceCounters::Add (Ptr<Face> face)
+{
+  m_nack.push_back (0);
+  m_data_in.push_back (0);
+  m_data_ce.push_back (0);
+  m_nack_old.push_back (0);
+  m_data_in_old.push_back (0);
+  m_data_ce_old.push_back (0);
+  m_fraction.push_back (1); //initially arbitrary large number. Will be updated later
+  m_interest_count.push_back (0);
+  m_face.push_back (face);
+
+  return m_face.size () - 1;
+}
+
+Ptr<Face>
+FaceCounters::Remove (uint32_t slot)
+{
+  NS_ASSERT (slot < m_face.size ());
+
+  uint32_t last = m_face.size () - 1;
+  Ptr<Face> moved = 0;
+  if (slot != last)
+    {
+      m_nack[slot] = m_nack[last];
+      m_data_in[slot] = m_data_in[last];
+      m_data_ce[slot] = m_data_ce[last];
+      m_nack_old[slot] = m_nack_old[last];
+      m_data_in_old[slot] = m_data_in_old[last];
+      m_data_ce_old[slot] = m_data_ce_old[last];
+      m_fraction[slot] = m_fraction[last];
+      m_interest_count[slot] = m_interest_count[last];
+      m_face[slot] = m_face[last];
+      moved = m_face[slot];
+    }
+
+  m_nack.pop_back ();
+  m_data_in.pop_back ();
+  m_data_ce.pop_back ();
+  m_nack_old.pop_back ();
+  m_data_in_old.pop_back ();
+  m_data_ce_old.pop_back ();
+  m_fraction.pop_back ();
+  m_interest_count.pop_back ();
+  m_face.pop_back ();
+
+  return moved;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void
 FaceMetric::UpdateRtt (const Time &rttSample)
 {
@@ -90,9 +143,7 @@ Entry::UpdateFaceRtt (Ptr<Face> face, const Time &sample)
 
   m_faces.modify (record,
                   ll::bind (&FaceMetric::UpdateRtt, ll::_1, sample));
-
-  // reordering random access index same way as by metric index
-  m_faces.get<i_nth> ().rearrange (m_faces.get<i_metric> ().begin ());
+  // RTT is not a part of the metric index, no need to reorder the random access index
 }
 
 void
@@ -116,7 +167,7 @@ Entry::UpdateStatus (Ptr<Face> face, FaceMetric::Status status)
  * 	We have to encode this way, because one face may be used for multiple one-way routing
  */
 void
-Entry::AddOrUpdateRoutingMetric (Ptr<Face> face, int32_t metric)
+Entry::UpdateRoutingMetric (Ptr<Face> face, int32_t metric)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT_MSG (face != NULL, "Trying to Add or Update NULL face");
@@ -124,7 +175,8 @@ Entry::AddOrUpdateRoutingMetric (Ptr<Face> face, int32_t metric)
   FaceMetricByFace::type::iterator record = m_faces.get<i_face> ().find (face);
   if (record == m_faces.get<i_face> ().end ())
     {
-      m_faces.insert (FaceMetric (face, metric));	//first metric
+      m_faces.insert (FaceMetric (face, metric, m_counters, m_counters.Add (face))).first	//first metric
+        ->Link (face->GetFibReferences (), this);
     }
   else
   {
@@ -144,11 +196,51 @@ Entry::AddOrUpdateRoutingMetric (Ptr<Face> face, int32_t metric)
 	m_faces.modify (record,
                         ll::bind (&FaceMetric::SetStatus, ll::_1, FaceMetric::NDN_FIB_YELLOW));
   }
+}
 
+void
+Entry::ReorderFaces ()
+{
   // reordering random access index same way as by metric index
   m_faces.get<i_nth> ().rearrange (m_faces.get<i_metric> ().begin ());
 }
 
+void
+Entry::AddOrUpdateRoutingMetric (Ptr<Face> face, int32_t metric)
+{
+  UpdateRoutingMetric (face, metric);
+  ReorderFaces ();
+}
+
+void
+Entry::RemoveFace (const Ptr<Face> &face)
+{
+  FaceMetricByFace::type::iterator record = m_faces.get<i_face> ().find (face);
+  if (record == m_faces.get<i_face> ().end ())
+    return;
+
+  uint32_t slot = record->GetSlot ();
+  m_faces.erase (record);
+
+  Ptr<Face> moved = m_counters.Remove (slot);
+  if (moved != 0)
+    {
+      FaceMetricByFace::type::iterator movedRecord = m_faces.get<i_face> ().find (moved);
+      NS_ASSERT (movedRecord != m_faces.get<i_face> ().end ());
+      movedRecord->SetSlot (slot);
+    }
+}
+
+void
+Entry::SetLimits (Ptr<Limits> limits)
+{
+  NS_ASSERT_MSG (m_limits == 0, "Limits are already set on the FIB entry");
+
+  AggregateObject (limits);
+  m_limits = PeekPointer (limits);
+  m_deltaRateLimits = PeekPointer (DynamicCast<LimitsDeltaRate> (limits));
+}
+
 int32_t
 Entry::GetRoutingMetric(Ptr<Face> face)
 {
@@ -189,6 +281,57 @@ Entry::Invalidate ()
     }
 }
 
+void
+Entry::SaveState (std::ostream &os) const
+{
+  os << m_inited << " " << m_faces.size ();
+  for (FaceMetricContainer::type::const_iterator metric = m_faces.begin ();
+       metric != m_faces.end ();
+       metric++)
+    {
+      uint32_t slot = metric->GetSlot ();
+      os << " " << metric->GetFace ()->GetId ()
+         << " " << m_counters.m_nack[slot]
+         << " " << m_counters.m_data_in[slot]
+         << " " << m_counters.m_data_ce[slot]
+         << " " << m_counters.m_nack_old[slot]
+         << " " << m_counters.m_data_in_old[slot]
+         << " " << m_counters.m_data_ce_old[slot]
+         << " " << m_counters.m_fraction[slot];
+    }
+}
+
+void
+Entry::LoadState (std::istream &is)
+{
+  uint32_t count = 0;
+  is >> m_inited >> count;
+  for (uint32_t i = 0; i < count && is; i++)
+    {
+      uint32_t faceId;
+      double nack, data_in, data_ce, nack_old, data_in_old, data_ce_old, fraction;
+      is >> faceId >> nack >> data_in >> data_ce >> nack_old >> data_in_old >> data_ce_old >> fraction;
+
+      FaceMetricContainer::type::iterator metric = m_faces.begin ();
+      while (metric != m_faces.end () && metric->GetFace ()->GetId () != faceId)
+        metric++;
+      if (metric == m_faces.end ())
+        {
+          NS_LOG_WARN ("Face " << faceId << " is not a next hop of " << *m_prefix << ", skipping its state");
+          continue;
+        }
+
+      uint32_t slot = metric->GetSlot ();
+      m_counters.m_nack[slot] = nack;
+      m_counters.m_data_in[slot] = data_in;
+      m_counters.m_data_ce[slot] = data_ce;
+      m_counters.m_nack_old[slot] = nack_old;
+      m_counters.m_data_in_old[slot] = data_in_old;
+      m_counters.m_data_ce_old[slot] = data_ce_old;
+      m_counters.m_fraction[slot] = fraction;
+    }
+}
+
 void
 Entry::ShowRate()
 {
@@ -206,27 +349,35 @@ Entry::ShowRate()
 void
 Entry::ResetCount()
 {
-	//reset overall data rate
-	
-	//reset each face's count
-	for (FaceMetricByFace::type::iterator face = m_faces.begin ();
-       face != m_faces.end ();
-       face++)
+  const uint32_t facecount = m_counters.GetSize ();
+  if (facecount == 0)
     {
-    	
-    		/*if(face->GetFace()->GetNode()->GetId()==1)
-	    	NS_LOG_UNCOND(Names::FindName(face->GetFace()->GetNode())
-	    				<<" prefix="<<*m_prefix
-	    				<<" faceID="<<face->GetFace()->GetId()
-	    				<<" fraction="<<face->GetFraction()
-	    				<<" interest="<<face->GetInterest()
-	    				<<" NACK="<<face->GetNack()
-	    				<<" Data_in="<<face->GetDataIn()
-	    				<<std::endl
-	    				);*/
-	    								
-      m_faces.modify (face,
-                      ll::bind (&FaceMetric::ResetCounter, ll::_1));
+      Simulator::Schedule(Seconds(UPDATE_INTERVAL), &Entry::ResetCount, this);
+      return;
+    }
+
+  // counters are stored as struct-of-arrays (FaceCounters), so all loops below
+  // are simple loops over arrays that the compiler can vectorize
+  double *nack = &m_counters.m_nack[0];
+  double *data_in = &m_counters.m_data_in[0];
+  double *data_ce = &m_counters.m_data_ce[0];
+  double *nack_old = &m_counters.m_nack_old[0];
+  double *data_in_old = &m_counters.m_data_in_old[0];
+  double *data_ce_old = &m_counters.m_data_ce_old[0];
+  double *fraction = &m_counters.m_fraction[0];
+  uint32_t *interest_count = &m_counters.m_interest_count[0];
+
+	//reset each face's count (smoothed with EWMA)
+  for (uint32_t i = 0; i < facecount; i++)
+    {
+      data_in_old[i] = ALPHA*data_in[i]+(1-ALPHA)*data_in_old[i];
+      data_ce_old[i] = ALPHA*data_ce[i]+(1-ALPHA)*data_ce_old[i];
+      nack_old[i] = ALPHA*nack[i]+(1-ALPHA)*nack_old[i];
+
+      data_in[i] = 0;
+      data_ce[i] = 0;
+      nack[i] = 0;
+      interest_count[i] = 0;
     }
     
   double K_bound = MAX_BOUND;
@@ -235,31 +386,25 @@ Entry::ResetCount()
   double K = 0;
   double q_var = 0;
   double q_mean = 0;
-  uint32_t facecount = 0;
   
-  for (FaceMetricByFace::type::iterator face = m_faces.begin ();
-       face != m_faces.end ();
-       face++)
+  for (uint32_t i = 0; i < facecount; i++)
     {  
-    	q_mean += face->GetNackOld(); 
-	    facecount ++;   								
+    	q_mean += nack_old[i]; 
     }
-  for (FaceMetricByFace::type::iterator face = m_faces.begin ();
-       face != m_faces.end ();
-       face++)
+  for (uint32_t i = 0; i < facecount; i++)
     {  
-    		double tmp = face->GetFraction()*q_mean/100.0-face->GetNackOld();
+    		double tmp = fraction[i]*q_mean/100.0-nack_old[i];
     		q_var += tmp*tmp;
     		if(tmp>0)
     		{
-    			double tmp2 = (w_upper_bound-face->GetFraction())/tmp;
+    			double tmp2 = (w_upper_bound-fraction[i])/tmp;
     			if(K_bound>tmp2)
     				K_bound = tmp2;
     				
     		}
     		else if(tmp<0)
     		{
-    			double tmp2 = (w_lower_bound-face->GetFraction())/tmp;
+    			double tmp2 = (w_lower_bound-fraction[i])/tmp;
     			if(K_bound>tmp2)
     				K_bound = tmp2;
     				
@@ -270,32 +415,16 @@ Entry::ResetCount()
   K = K_bound*tanh(q_var/(1+q_mean)/2);  
   //K = K_bound*tanh(q_var/(1+q_mean)); 
   
-  for (FaceMetricByFace::type::iterator face = m_faces.begin ();
-       face != m_faces.end ();
-       face++)
+  for (uint32_t i = 0; i < facecount; i++)
     { 
-    	
 	      /*if(m_inited)
-	      {
-		      double fraction = face->GetFraction()
-		      								+ K * (face->GetFraction()*q_mean/100.0-face->GetNackOld());
-		      m_faces.modify (face,
-		                      ll::bind (&FaceMetric::SetFraction, ll::_1,fraction));
-		    }
+		      fraction[i] = fraction[i] + K * (fraction[i]*q_mean/100.0-nack_old[i]);
 		    else
-		    {
-	    		m_faces.modify (face,
-	                      ll::bind (&FaceMetric::SetFraction, ll::_1,100.0/facecount));
-		    }*/
-		    
-		    m_faces.modify (face,
-	                      ll::bind (&FaceMetric::SetFraction, ll::_1,100.0/facecount));
+	    		fraction[i] = 100.0/facecount;*/
 		    
-    									
+		    fraction[i] = 100.0/facecount;
     }  
   m_inited = true; 
-  
-    
  
   Simulator::Schedule(Seconds(UPDATE_INTERVAL), &Entry::ResetCount, this);
 }
@@ -39,6 +39,8 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
+#include <vector>
+
 //parameters for weight update
 #define UPDATE_INTERVAL 1
 #define SHOW_RATE_INTERVAL 1
@@ -52,11 +54,68 @@ typedef Name NameComponents;
 
 namespace fib {
 
+class Entry;
+
+/**
+ * \ingroup ndn
+ * \brief Congestion counters of all next hops of a FIB entry, stored as parallel arrays
+ *
+ * The counters change on every Interest, Data and NACK, but are not part of any
+ * FaceMetricContainer key.  Keeping them out of the container avoids
+ * m_faces.modify () (and re-checking of the ordered indexes) on each update, and
+ * lets Entry::ResetCount process all next hops with plain loops over the arrays.
+ *
+ * Slots are kept dense: removing a slot moves the last one into its place.
+ */
+class FaceCounters
+{
+public:
+  /**
+   * @brief Allocate slot for a new next hop
+   * @returns index of the slot
+   */
+  uint32_t
+  Add (Ptr<Face> face);
+
+  /**
+   * @brief Release the slot, moving the last slot into its place
+   * @returns face that owned the moved slot (0 if no slot was moved)
+   */
+  Ptr<Face>
+  Remove (uint32_t slot);
+
+  /**
+   * @brief Number of allocated slots
+   */
+  uint32_t
+  GetSize () const { return m_face.size (); }
+
+public:
+  std::vector<double> m_nack;        ///< \brief nack counter
+  std::vector<double> m_data_in;     ///< \brief incoming data counter
+  std::vector<double> m_data_ce;     ///< \brief incoming marked data counter
+  //the following variables are used for storing counters last round
+  std::vector<double> m_nack_old;
+  std::vector<double> m_data_in_old;
+  std::vector<double> m_data_ce_old;
+  std::vector<double> m_fraction;    ///< \brief fraction of traffic this face can forward(%)
+  std::vector<uint32_t> m_interest_count; ///< \brief used for debug
+
+private:
+  std::vector< Ptr<Face> > m_face;   ///< \brief owner of each slot
+};
+
 /**
  * \ingroup ndn
  * \brief Structure holding various parameters associated with a (FibEntry, Face) tuple
+ *
+ * Congestion counters are stored in FaceCounters of the FIB entry, FaceMetric only
+ * refers to its slot.  Counter accessors are const, as counters can be updated
+ * through the const references returned by FaceMetricContainer without m_faces.modify ()
+ *
+ * FaceMetric is linked into the list of FIB references of its face (Face::GetFibReferences)
  */
-class FaceMetric
+class FaceMetric : public FaceReference<Entry>
 {
 public:
   /**
@@ -71,23 +130,19 @@ public:
    *
    * \param face Face for which metric
    * \param cost Initial value for routing cost
+   * \param counters Counter arrays of the FIB entry
+   * \param slot Slot allocated for the face in counters
    */
-  FaceMetric (Ptr<Face> face, int32_t cost)
+  FaceMetric (Ptr<Face> face, int32_t cost, FaceCounters &counters, uint32_t slot)
     : m_face (face)
     , m_status (NDN_FIB_YELLOW)
     , m_routingCost (cost)
     , m_sRtt   (Seconds (0))
     , m_rttVar (Seconds (0))
     , m_realDelay (Seconds (0))
-    , m_nack (0)	
-    , m_data_in (0) 
-    , m_data_ce (0) 
-    , m_nack_old (0)
-    , m_data_in_old (0)
-    , m_data_ce_old (0)   
-    , m_fraction (1) //initially arbitrary large number. Will be updated later
+    , m_counters (&counters)
+    , m_slot (slot)
     , m_sharing_metric (1)
-    , m_interest_count (0)
   { }
  
   /**
@@ -179,120 +234,112 @@ public:
   }
   
   void
-  IncreaseNack()
+  IncreaseNack() const
   {
-
-  	m_nack++;
+  	m_counters->m_nack[m_slot]++;
   }
   
   void
-  SetNack(double rhs)
+  SetNack(double rhs) const
   {
-  	m_nack = rhs;
+  	m_counters->m_nack[m_slot] = rhs;
   }
   
   double
   GetNack() const
   {
   	//return m_nack_old+1;
-  	return m_nack+1;
+  	return m_counters->m_nack[m_slot]+1;
   }
   
   double
   GetNackOld() const
   {
-  	return m_nack_old;
+  	return m_counters->m_nack_old[m_slot];
   }
   
   void
-  IncreaseDataIn()
+  IncreaseDataIn() const
   {
-  	m_data_in++;
+  	m_counters->m_data_in[m_slot]++;
   }
   
   void
-  SetDataIn(double rhs)
+  SetDataIn(double rhs) const
   {
-  	m_data_in = rhs;
+  	m_counters->m_data_in[m_slot] = rhs;
   }
   
   double
   GetDataIn() const
   {
-  	return m_data_in_old+1;
+  	return m_counters->m_data_in_old[m_slot]+1;
   }
   
   void
-  IncreaseDataCE()
+  IncreaseDataCE() const
   {
-  	m_data_ce++;
+  	m_counters->m_data_ce[m_slot]++;
   }
   
   void
-  SetDataCE(double rhs)
+  SetDataCE(double rhs) const
   {
-  	m_data_ce = rhs;
+  	m_counters->m_data_ce[m_slot] = rhs;
   }
   
   double
   GetDataCE() const
   {
-  	return m_data_ce_old+1;
+  	return m_counters->m_data_ce_old[m_slot]+1;
   }
   
   double
   GetFraction() const
   {
-  	return m_fraction;
+  	return m_counters->m_fraction[m_slot];
   }
   
   void
-  SetFraction(double rhs) //if 50%, rhs=50
+  SetFraction(double rhs) const //if 50%, rhs=50
  	{
- 		m_fraction = rhs;
+ 		m_counters->m_fraction[m_slot] = rhs;
  	}
   
   double
   GetSharingMetric() const
   {
-  	
-  	
   	return m_sharing_metric;
   }
   
   void
-  IncreaseInterest()
+  IncreaseInterest() const
   {
-  	m_interest_count++;
+  	m_counters->m_interest_count[m_slot]++;
   }
   
   uint32_t 
   GetInterest() const
   {
-  	return m_interest_count;
+  	return m_counters->m_interest_count[m_slot];
   }
- 
-  
-  void 
-  ResetCounter ()
+
+  /**
+   * @brief Get slot of the face in FaceCounters of the FIB entry
+   */
+  uint32_t
+  GetSlot () const
   {
-  	m_data_in_old = ALPHA*m_data_in+(1-ALPHA)*m_data_in_old;
-  	m_data_ce_old = ALPHA*m_data_ce+(1-ALPHA)*m_data_ce_old;
-  	m_nack_old = ALPHA*m_nack+(1-ALPHA)*m_nack_old;
-  	
-  	
-  
-  	//m_sharing_metric = (m_data_in_old+1)*(m_data_in_old+1)/(double)((m_data_ce_old+1)*(m_nack_old+1)); 
-  	//m_sharing_metric = (m_data_in_old+1)/(double)(m_nack_old+1);  
-  	//m_sharing_metric = (double)(m_nack_old)*100.0/m_sharing_metric; 
-  	
-  	
-  	m_data_in = 0;
-  	m_data_ce = 0;
-  	m_nack = 0;
-  	
-  	m_interest_count = 0;
-  	
+    return m_slot;
+  }
+
+  /**
+   * @brief Update slot after FaceCounters moved it (slot is not a part of any index)
+   */
+  void
+  SetSlot (uint32_t slot) const
+  {
+    m_slot = slot;
   }
 
 private:
@@ -313,18 +360,10 @@ private:
 
   Time m_realDelay;    ///< \brief real propagation delay to the producer, calculated based on NS-3 p2p link delays
 
-	double m_nack;		 ///< \brief nack counter
-	double m_data_in;  ///< \brief incoming data counter
-	double m_data_ce;  ///< \brief incoming marked data counter
-	//the following variables are used for storing counters last round
-	double m_nack_old;
-	double m_data_in_old;
-	double m_data_ce_old;
+  FaceCounters *m_counters; ///< \brief congestion counters of the FIB entry
+  mutable uint32_t m_slot;  ///< \brief slot of this face in m_counters
 
-  double m_fraction;				///< fraction of traffic this face can forward(%)
 	double m_sharing_metric;	///< used for calculating m_fraction
-	
-	uint32_t m_interest_count;			///< used for debug
 };
 
 /// @cond include_hidden
@@ -397,6 +436,8 @@ public:
   , m_needsProbing (false)
   , m_inited (false)
   , m_data (0)
+  , m_limits (0)
+  , m_deltaRateLimits (0)
   {
   	Simulator::Schedule (Seconds (0.001), &Entry::ShowRate, this);
   	Simulator::Schedule (Seconds (0.001), &Entry::ResetCount, this);
@@ -415,6 +456,18 @@ public:
    * Initial status of the next hop is set to YELLOW
    */
   void AddOrUpdateRoutingMetric (Ptr<Face> face, int32_t metric);
+
+  /**
+   * \brief Add or update routing metric of FIB next hop without reordering faces
+   *
+   * Used for bulk updates (Fib::AddBatch).  ReorderFaces must be called after the last update
+   */
+  void UpdateRoutingMetric (Ptr<Face> face, int32_t metric);
+
+  /**
+   * \brief Reorder random access index of faces the same way as by metric index
+   */
+  void ReorderFaces ();
   
   int32_t
   GetRoutingMetric(Ptr<Face> face);
@@ -433,6 +486,23 @@ public:
   void
   Invalidate ();
 
+  /**
+   * @brief Write congestion state of the next hops (NACK/Data counters, their EWMA and
+   * traffic fractions) for a warm-start snapshot
+   *
+   * Next hops are identified by face ids
+   */
+  void
+  SaveState (std::ostream &os) const;
+
+  /**
+   * @brief Restore congestion state written by SaveState
+   *
+   * Counters of faces that are not next hops of this entry are skipped
+   */
+  void
+  LoadState (std::istream &is);
+
   /**
    * @brief Update RTT averages for the face
    */
@@ -457,10 +527,7 @@ public:
    * @brief Remove record associated with `face`
    */
   void
-  RemoveFace (const Ptr<Face> &face)
-  {
-    m_faces.erase (face);
-  }
+  RemoveFace (const Ptr<Face> &face);
   
   void
   IncreaseData ()
@@ -473,6 +540,32 @@ public:
   {
   	return m_data;
   }
+
+  /**
+   * @brief Aggregate limits to the FIB entry and remember typed pointer to them
+   *
+   * Should be used instead of AggregateObject (see Face::SetLimits)
+   */
+  void
+  SetLimits (Ptr<Limits> limits);
+
+  /**
+   * @brief Get limits of the FIB entry (0 if per-FIB limits are not enabled)
+   */
+  Limits *
+  GetLimits () const
+  {
+    return m_limits;
+  }
+
+  /**
+   * @brief Get limits of the FIB entry if they are LimitsDeltaRate (0 otherwise)
+   */
+  LimitsDeltaRate *
+  GetDeltaRateLimits () const
+  {
+    return m_deltaRateLimits;
+  }
 	
 private:
   friend std::ostream& operator<< (std::ostream& os, const Entry &entry);
@@ -483,11 +576,16 @@ private:
 public:
   Ptr<const Name> m_prefix; ///< \brief Prefix of the FIB entry
   FaceMetricContainer::type m_faces; ///< \brief Indexed list of faces
+  FaceCounters m_counters;           ///< \brief Congestion counters of faces in m_faces
 
   bool m_needsProbing;      ///< \brief flag indicating that probing should be performed
 	bool m_inited;					///< whether it is initialized
 	
 	uint32_t m_data;				///< brief used for measuring real throughput
+
+private:
+  Limits *m_limits;                   ///< \brief limits aggregated to the entry (owned by the aggregate)
+  LimitsDeltaRate *m_deltaRateLimits; ///< \brief the same limits, if they are LimitsDeltaRate
 };
 
 std::ostream& operator<< (std::ostream& os, const Entry &entry);
@@ -23,6 +23,7 @@
 #include "ns3/ndn-face.h"
 #include "ns3/ndn-interest.h"
 #include "ns3/ndn-forwarding-strategy.h"
+#include "ns3/ndn-limits.h"
 
 #include "ns3/node.h"
 #include "ns3/assert.h"
@@ -34,6 +35,8 @@
 #include <boost/lambda/bind.hpp>
 namespace ll = boost::lambda;
 
+#include <algorithm>
+
 NS_LOG_COMPONENT_DEFINE ("ndn.fib.FibImpl");
 
 namespace ns3 {
@@ -42,6 +45,17 @@ namespace fib {
 
 NS_OBJECT_ENSURE_REGISTERED (FibImpl);
 
+/// @cond include_hidden
+struct RouteByPrefix
+{
+  bool
+  operator() (const Fib::Route &a, const Fib::Route &b) const
+  {
+    return *a.m_prefix < *b.m_prefix;
+  }
+};
+/// @endcond
+
 TypeId 
 FibImpl::GetTypeId (void)
 {
@@ -133,6 +147,76 @@ FibImpl::Add (const Ptr<const Name> &prefix, Ptr<Face> face, int32_t metric)
     return 0;
 }
 
+void
+FibImpl::AddBatch (RouteList &routes)
+{
+  NS_LOG_FUNCTION (this->GetObject<Node> ()->GetId () << routes.size ());
+
+  if (routes.empty ())
+    return;
+
+  std::stable_sort (routes.begin (), routes.end (), RouteByPrefix ());
+
+  Ptr<ForwardingStrategy> forwardingStrategy = this->GetObject<ForwardingStrategy> ();
+  NS_ASSERT (forwardingStrategy != 0);
+
+  RouteList::const_iterator group = routes.begin ();
+  while (group != routes.end ())
+    {
+      RouteList::const_iterator groupEnd = group;
+      while (groupEnd != routes.end () && *groupEnd->m_prefix == *group->m_prefix)
+        groupEnd++;
+
+      // will add entry if doesn't exists, or just return an iterator to the existing entry
+      std::pair< super::iterator, bool > result = super::insert (*group->m_prefix, 0);
+      if (result.first == super::end ())
+        {
+          group = groupEnd;
+          continue;
+        }
+
+      if (result.second)
+        {
+          Ptr<EntryImpl> newEntry = Create<EntryImpl> (group->m_prefix);
+          newEntry->SetTrie (result.first);
+          result.first->set_payload (newEntry);
+        }
+
+      Ptr<EntryImpl> entry = result.first->payload ();
+      RouteList::const_iterator lastWithDelay = groupEnd;
+      for (RouteList::const_iterator route = group; route != groupEnd; route++)
+        {
+          entry->UpdateRoutingMetric (route->m_face, route->m_metric);
+          if (route->m_delay >= 0)
+            {
+              entry->SetRealDelayToProducer (route->m_face, Seconds (route->m_delay));
+              lastWithDelay = route;
+            }
+        }
+      super::modify (result.first,
+                     ll::bind (&Entry::ReorderFaces, ll::_1));
+
+      if (result.second)
+        {
+          // notify forwarding strategy about new FIB entry (once, with all faces already in place)
+          forwardingStrategy->DidAddFibEntry (entry);
+        }
+
+      Limits *fibLimits = entry->GetLimits ();
+      if (fibLimits != 0 && lastWithDelay != groupEnd)
+        {
+          // if it was created by the forwarding strategy via DidAddFibEntry event
+          Limits *faceLimits = lastWithDelay->m_face->GetLimits ();
+          if (faceLimits != 0)
+            {
+              fibLimits->SetLimits (faceLimits->GetMaxRate (), 2 * lastWithDelay->m_delay /*exact RTT*/);
+            }
+        }
+
+      group = groupEnd;
+    }
+}
+
 void
 FibImpl::Remove (const Ptr<const Name> &prefix)
 {
@@ -197,24 +281,20 @@ FibImpl::RemoveFromAll (Ptr<Face> face)
 {
   NS_LOG_FUNCTION (this);
 
-  std::for_each (super::parent_trie::recursive_iterator (super::getTrie ()),
-                 super::parent_trie::recursive_iterator (0), 
-                 ll::bind (&FibImpl::RemoveFace,
-                           this, ll::_1, face));
-
-  super::parent_trie::recursive_iterator trieNode (super::getTrie ());
-  super::parent_trie::recursive_iterator end (0);
-  for (; trieNode != end; trieNode++)
+  // only entries having the face as a next hop are visited (see Face::GetFibReferences)
+  FaceReference<Entry>::List &references = face->GetFibReferences ();
+  while (!references.empty ())
     {
-      if (trieNode->payload () == 0) continue;
-      
-      if (trieNode->payload ()->m_faces.size () == 0)
+      Ptr<EntryImpl> entry = static_cast<EntryImpl*> (references.front ().GetEntry ());
+      RemoveFace (*entry->to_iterator (), face); // unlinks the reference
+
+      if (entry->m_faces.size () == 0)
         {
           // notify forwarding strategy about soon be removed FIB entry
           NS_ASSERT (this->GetObject<ForwardingStrategy> () != 0);
-          this->GetObject<ForwardingStrategy> ()->WillRemoveFibEntry (trieNode->payload ());
-          
-          trieNode = super::parent_trie::recursive_iterator (trieNode->erase ());
+          this->GetObject<ForwardingStrategy> ()->WillRemoveFibEntry (entry);
+
+          super::erase (entry->to_iterator ());
         }
     }
 }
@@ -97,6 +97,9 @@ public:
   virtual Ptr<Entry>
   Add (const Ptr<const Name> &prefix, Ptr<Face> face, int32_t metric);
 
+  virtual void
+  AddBatch (RouteList &routes);
+
   virtual void
   Remove (const Ptr<const Name> &prefix);
 
@@ -26,6 +26,8 @@
 
 #include "ns3/ndn-fib-entry.h"
 
+#include <vector>
+
 namespace ns3 {
 namespace ndn {
 
@@ -39,6 +41,35 @@ typedef Interest InterestHeader;
 class Fib : public Object
 {
 public:
+  /**
+   * @brief Route to be installed with AddBatch
+   */
+  struct Route
+  {
+    /**
+     * @param prefix Prefix
+     * @param face   Forwarding face
+     * @param metric Routing metric
+     * @param delay  Real propagation delay to the producer in seconds (negative if unknown)
+     */
+    Route (const Ptr<const Name> &prefix, Ptr<Face> face, int32_t metric, double delay = -1.0)
+      : m_prefix (prefix)
+      , m_face (face)
+      , m_metric (metric)
+      , m_delay (delay)
+    { }
+
+    Ptr<const Name> m_prefix; ///< @brief Prefix
+    Ptr<Face> m_face;         ///< @brief Forwarding face
+    int32_t m_metric;         ///< @brief Routing metric
+    double m_delay;           ///< @brief Real propagation delay to the producer (seconds)
+  };
+
+  /**
+   * @brief List of routes for AddBatch
+   */
+  typedef std::vector<Route> RouteList;
+
   /**
    * \brief Interface ID
    *
@@ -103,6 +134,23 @@ public:
   virtual Ptr<fib::Entry>
   Add (const Ptr<const Name> &prefix, Ptr<Face> face, int32_t metric) = 0;
 
+  /**
+   * \brief Add or update a number of FIB entries at once
+   *
+   * Routes are grouped by prefix (the list is sorted in place, preserving the order
+   * of routes for the same prefix).  For each prefix, the trie is walked once and
+   * faces of the entry are reordered once after all its routes are applied.
+   * Routes for the same prefix and face are applied in order, so the last one wins,
+   * the same as with a sequence of Add calls.
+   *
+   * If the forwarding strategy created per-entry limits (via DidAddFibEntry), they are set
+   * once per entry, using max rate of the face and delay of the last route with known delay
+   *
+   * @param routes List of routes
+   */
+  virtual void
+  AddBatch (RouteList &routes) = 0;
+
   /**
    * @brief Remove FIB entry
    *
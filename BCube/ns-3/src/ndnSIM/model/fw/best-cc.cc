@@ -32,8 +32,6 @@
 #include "ns3/names.h"
 
 #include <vector>
-#include <cstdlib>
-#include <ctime>
 #include <boost/foreach.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lambda/bind.hpp>
@@ -69,7 +67,6 @@ BestCC::GetTypeId (void)
 
 BestCC::BestCC ()
 {
-	srand(time(0));
 }
 
 //Static Forwarding
@@ -107,7 +104,7 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
 		  	
 		  if(totalweight<1)totalweight = 1;
 		  	
-		  double target = rand()%(int)totalweight;
+		  double target = m_rand->GetInteger (0, (uint32_t)totalweight - 1);
 		  double coin = 0;	
 		  //Step2: choose ONE face based on our congestion control strategy
 		  std::vector< Ptr<Face> > vecFaces;
@@ -141,14 +138,12 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
   	    if (record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ())
         {
       		
-        	pitEntry->GetFibEntry ()->m_faces.modify (record,
-                      ll::bind (&fib::FaceMetric::IncreaseNack, ll::_1));
+        	record->IncreaseNack ();
         }
 	  	return false;
 	  }	
 	  
-	  Ptr<Limits> faceLimits = optimalFace->GetObject<Limits> ();
-	  faceLimits->BorrowLimit ();
+	  optimalFace->GetDeltaRateLimits ()->BorrowDeltaLimit ();
 	  TrySendOutInterest (inFace, optimalFace, header, origPacket, pitEntry);
 	  propagatedCount++;
 	  //////////////////////////////////////////
@@ -157,8 +152,7 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
   	  if (record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ())
       {
       		
-        	pitEntry->GetFibEntry ()->m_faces.modify (record,
-                      ll::bind (&fib::FaceMetric::IncreaseInterest, ll::_1));
+        	record->IncreaseInterest ();
       }  
     //////////////////////////////////////////
   
@@ -290,14 +284,12 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
   	    if (record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ())
         {
       		
-        	pitEntry->GetFibEntry ()->m_faces.modify (record,
-                      ll::bind (&fib::FaceMetric::IncreaseNack, ll::_1));
+        	record->IncreaseNack ();
         }
 	  	return false;
 	  }	
 	  
-	  Ptr<Limits> faceLimits = optimalFace->GetObject<Limits> ();
-	  faceLimits->BorrowLimit ();
+	  optimalFace->GetDeltaRateLimits ()->BorrowDeltaLimit ();
 	  TrySendOutInterest (inFace, optimalFace, header, origPacket, pitEntry);
 	  propagatedCount++;
 	  //////////////////////////////////////////
@@ -306,8 +298,7 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
   	  if (record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ())
       {
       		
-        	pitEntry->GetFibEntry ()->m_faces.modify (record,
-                      ll::bind (&fib::FaceMetric::IncreaseInterest, ll::_1));
+        	record->IncreaseInterest ();
       }  
     //////////////////////////////////////////
   
@@ -323,7 +314,7 @@ BestCC::OnNack (Ptr<Face> inFace,
                Ptr<const Packet> origPacket)
 {
   super::OnNack (inFace, header, origPacket);
-  Ptr<LimitsDeltaRate> faceLimits = inFace->GetObject<LimitsDeltaRate> ();
+  LimitsDeltaRate *faceLimits = inFace->GetDeltaRateLimits ();
   if(faceLimits)
   	faceLimits->IncreaseNack ();
 }*/
@@ -377,7 +368,7 @@ BestCC::OnNack (Ptr<Face> inFace,
       DidExhaustForwardingOptions (inFace, nonNackHeader, nonNackInterest, pitEntry);
     }
       
-  Ptr<LimitsDeltaRate> faceLimits = inFace->GetObject<LimitsDeltaRate> ();
+  LimitsDeltaRate *faceLimits = inFace->GetDeltaRateLimits ();
   if(faceLimits)
   	faceLimits->IncreaseNack ();
   
@@ -389,8 +380,7 @@ BestCC::OnNack (Ptr<Face> inFace,
   	  if (record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ())
       {
       		
-        	pitEntry->GetFibEntry ()->m_faces.modify (record,
-                      ll::bind (&fib::FaceMetric::IncreaseNack, ll::_1));
+        	record->IncreaseNack ();
           //NS_LOG_UNCOND("OnNack node="<<inFace->GetNode()->GetId()<<" fraction="<<record->GetFraction());             	      
       }
       
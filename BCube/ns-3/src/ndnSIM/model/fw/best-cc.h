@@ -118,7 +118,7 @@ public:
   {
     ObjectFactory factory ("ns3::ndn::Limits::LimitsDeltaRate");
     Ptr<Limits> limits = factory.Create<Limits> ();
-    face->AggregateObject (limits);
+    face->SetLimits (limits);
 
     super::AddFace (face);
   }
@@ -170,8 +170,9 @@ PerOutFaceDeltaLimits::CanSendOutInterest (Ptr<Face> inFace,
 {
   NS_LOG_FUNCTION (this << pitEntry->GetPrefix ());
   
-  Ptr<Limits> faceLimits = outFace->GetObject<Limits> ();
-  if (faceLimits->IsBelowLimit ())
+  // BestCC always installs LimitsDeltaRate on faces (see AddFace)
+  LimitsDeltaRate *faceLimits = outFace->GetDeltaRateLimits ();
+  if (faceLimits->IsBelowDeltaLimit ())
     {
       //if (super::CanSendOutInterest (inFace, outFace, header, origPacket, pitEntry))
         {
@@ -194,8 +195,7 @@ PerOutFaceDeltaLimits::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntr
        face != pitEntry->GetOutgoing ().end ();
        face ++)
     {
-      Ptr<Limits> faceLimits = face->m_face->GetObject<Limits> ();
-      faceLimits->ReturnLimit ();
+      face->m_face->GetLimits ()->ReturnLimit ();
     }
 
   super::WillEraseTimedOutPendingInterest (pitEntry);
@@ -211,8 +211,7 @@ PerOutFaceDeltaLimits::WillSatisfyPendingInterest (Ptr<Face> inFace,
        face != pitEntry->GetOutgoing ().end ();
        face ++)
     {
-      Ptr<Limits> faceLimits = face->m_face->GetObject<Limits> ();
-      faceLimits->ReturnLimit ();
+      face->m_face->GetLimits ()->ReturnLimit ();
     }
   
   super::WillSatisfyPendingInterest (inFace, pitEntry);
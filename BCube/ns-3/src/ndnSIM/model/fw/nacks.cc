@@ -31,6 +31,7 @@
 #include "ns3/ndn-bcube-tag.h"
 #include "ns3/ndn-app-face.h"
 #include "ns3/ndn-app.h"
+#include "ns3/ndn-local-app-registry.h"
 
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
@@ -189,13 +190,13 @@ Nacks::DidExhaustForwardingOptions (Ptr<Face> inFace,
 	      target->AddHeader(*NewHeader);	
 	        
 	      BCubeTag tag;
-		  target->RemovePacketTag(tag);
+		  target->PeekPacketTag(tag);
 		  /* To simplify implementation, we make the following assumption:
 	 	   * For each switch, it has no more than 10 ports (e.g. BCube[8,3] can already support 4096 switches)
 	 	   * So RoutingCost = prevhop*10 + nexthop;
 	       */
 		  tag.SetNextHop(incoming.m_localport);
-		  target->AddPacketTag(tag);
+		  target->ReplacePacketTag(tag);
           //incoming.m_face->Send (packet->Copy ());	//by Felix: NACK is multicasted!!!
           
 		  /*NS_LOG_UNCOND(Names::FindName(inFace->GetNode())
@@ -206,14 +207,15 @@ Nacks::DidExhaustForwardingOptions (Ptr<Face> inFace,
           m_outNacks (nackHeader, incoming.m_face);
         }
         
-      //copy NACK to all applications of this node
+      //copy NACK to local applications requesting the same prefix
       Ptr<Node> node = inFace->GetNode();
       NS_ASSERT(node!=0);
-      for(uint32_t k=0; k!=node->GetNApplications(); k++)
+      if(m_localApps!=0)
       {
-      	Ptr<App> app = DynamicCast<App>(node->GetApplication(k));
-      	if(app!=0)
-      	{
+      const LocalAppRegistry::AppList &apps = m_localApps->Lookup (pitEntry->GetFibEntry (), nackHeader->GetName ());
+      for(uint32_t i = 0; i < apps.size(); i++)
+      {
+      	Ptr<App> app = apps[i];
       		bool ignore = false;
       		//If you already decrease the rate, don't decrease again
       		BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
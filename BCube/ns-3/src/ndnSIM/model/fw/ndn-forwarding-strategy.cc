@@ -31,6 +31,7 @@
 #include "ns3/ndn-face.h"
 #include "ns3/ndn-app-face.h"
 #include "ns3/ndn-app.h"
+#include "ns3/ndn-local-app-registry.h"
 #include "ns3/ndn-bcube-tag.h"
 #include "ns3/names.h"
 
@@ -58,6 +59,26 @@ NS_OBJECT_ENSURE_REGISTERED (ForwardingStrategy);
 
 NS_LOG_COMPONENT_DEFINE (ForwardingStrategy::GetLogName ().c_str ());
 
+/**
+ * @brief Add Data to the content store
+ *
+ * Congestion mark (see CeMarkingQueue) describes the path the Data has taken, so cache hits
+ * should not carry it.  Only marked Data is re-encoded, everything else is stored as is
+ */
+static bool
+AddToContentStore (Ptr<ContentStore> contentStore,
+                   Ptr<const ContentObject> header,
+                   Ptr<const Packet> payload,
+                   Ptr<const Packet> origPacket)
+{
+  if (header->GetCE () != ContentObject::CE_CONGESTION)
+    return contentStore->Add (header, payload, origPacket);
+
+  Ptr<ContentObject> unmarked = Create<ContentObject> (*header);
+  unmarked->SetCE (ContentObject::CE_NONE);
+  return contentStore->Add (unmarked, payload);
+}
+
 std::string
 ForwardingStrategy::GetLogName ()
 {
@@ -99,8 +120,8 @@ TypeId ForwardingStrategy::GetTypeId (void)
 }
 
 ForwardingStrategy::ForwardingStrategy ()
+  : m_rand (CreateObject<UniformRandomVariable> ())
 {
-	srand(time(0));
 }
 
 ForwardingStrategy::~ForwardingStrategy ()
@@ -122,6 +143,10 @@ ForwardingStrategy::NotifyNewAggregate ()
     {
       m_contentStore = GetObject<ContentStore> ();
     }
+  if (m_localApps == 0)
+    {
+      m_localApps = GetObject<LocalAppRegistry> ();
+    }
 
   Object::NotifyNewAggregate ();
 }
@@ -132,6 +157,7 @@ ForwardingStrategy::DoDispose ()
   m_pit = 0;
   m_contentStore = 0;
   m_fib = 0;
+  m_localApps = 0;
 
   Object::DoDispose ();
 }
@@ -242,11 +268,9 @@ ForwardingStrategy::OnData (Ptr<Face> inFace,
 
       if (m_cacheUnsolicitedData)
         {
-      
-          Ptr<Packet> payloadCopy = payload->Copy ();
-
           // Optimistically add or update entry in the content store
-          cached = m_contentStore->Add (header, payloadCopy);
+          // (already encoded packet is stored as is, without a copy)
+          cached = AddToContentStore (m_contentStore, header, payload, origPacket);
         }
       else
         {
@@ -287,11 +311,9 @@ ForwardingStrategy::OnData (Ptr<Face> inFace,
      	
      	if(update)
      	{
-     		fibEntry->m_faces.modify (record,
-                    ll::bind (&fib::FaceMetric::IncreaseDataIn, ll::_1));
+     		record->IncreaseDataIn ();
 	      if(header->GetCE()==1)
-	      	fibEntry->m_faces.modify (record,
-	                      ll::bind (&fib::FaceMetric::IncreaseDataCE, ll::_1));
+	      	record->IncreaseDataCE ();
      	}
    		
      	
@@ -300,20 +322,10 @@ ForwardingStrategy::OnData (Ptr<Face> inFace,
     	/////////////////////////////////////////////////////
       bool cached = false;
 
-      FwHopCountTag hopCountTag;
-      if (payload->PeekPacketTag (hopCountTag))
-        {
-          Ptr<Packet> payloadCopy = payload->Copy ();
-          payloadCopy->RemovePacketTag (hopCountTag);
-
-          // Add or update entry in the content store
-          cached = m_contentStore->Add (header, payloadCopy);
-        }
-      else
-        {
-          // Add or update entry in the content store
-          cached = m_contentStore->Add (header, payload); // no need for extra copy
-        }
+      // Add or update entry in the content store
+      // (already encoded packet is stored as is, without a copy; packet tags,
+      // such as FwHopCountTag, are stripped from cache hits by the content store)
+      cached = AddToContentStore (m_contentStore, header, payload, origPacket);
 
       DidReceiveSolicitedData (inFace, header, payload, origPacket, cached);
     }
@@ -469,11 +481,11 @@ ForwardingStrategy::SatisfyPendingInterest (Ptr<Face> inFace,
     	target->RemoveHeader(*NewHeader);   	
     	
     	BCubeTag tag;
-    	target->RemovePacketTag(tag);
+    	target->PeekPacketTag(tag);
     	tag.SetNextHop(incoming.m_localport);
     	/*NS_LOG_UNCOND("SatisfyPendingInterest@"<<Names::FindName(inFace->GetNode())
     				<<": m_localport="<<incoming.m_localport);*/
-    	target->AddPacketTag(tag);	
+    	target->ReplacePacketTag(tag);	//updated in place, unless shared with origPacket
     	target->AddHeader(*NewHeader);	
     	
     	////////////////////////////////////////////////////////////////////
@@ -503,15 +515,13 @@ ForwardingStrategy::SatisfyPendingInterest (Ptr<Face> inFace,
   	}
   }  
   //if(inFace!=0)
-  if(extra_content)
+  //copy only to applications requesting the same prefix
+  if(extra_content && m_localApps!=0)
   {
-  	//Ptr<Node> node = inFace->GetNode();
-  	NS_ASSERT(node!=0);
-  	for(uint32_t k=0; k!=node->GetNApplications(); k++)
+  	const LocalAppRegistry::AppList &apps = m_localApps->Lookup (pitEntry->GetFibEntry (), header->GetName ());
+  	for(uint32_t i = 0; i < apps.size(); i++)
   	{
-      	Ptr<App> app = DynamicCast<App>(node->GetApplication(k));
-      	if(app!=0)
-      	{
+      	Ptr<App> app = apps[i];
       		/*//If it is already forwarded to app, don't do it again
       		bool ignore = false;
       		BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
@@ -528,7 +538,6 @@ ForwardingStrategy::SatisfyPendingInterest (Ptr<Face> inFace,
 	      		app->OnExtraContentObject(header, payload->Copy());
 	      	}*/
 	      	app->OnExtraContentObject(header, payload->Copy());
-      	}      	
     }
   }
   
@@ -714,7 +723,7 @@ ForwardingStrategy::TrySendOutInterest (Ptr<Face> inFace,
 	NS_ASSERT(record != pitEntry->GetFibEntry ()->m_faces.get<fib::i_face> ().end ());
 		
 	BCubeTag tag;
-	if(packetToSend->RemovePacketTag(tag))	//there exists a tag: update m_cur
+	if(packetToSend->PeekPacketTag(tag))	//there exists a tag: update m_cur
 	{
 		tag.SetPrevHop(tag.GetNextHop());
 		uint32_t npaths = record->GetRoutingCost()%10;	//the same face may be used by multiple paths
@@ -738,7 +747,7 @@ ForwardingStrategy::TrySendOutInterest (Ptr<Face> inFace,
 		//tag.SetForwardingTag(record->GetRoutingCost());
 		tag.SetPrevHop(tag.GetNextHop());
 		uint32_t npaths = record->GetRoutingCost()%10;	//the same face may be used by multiple paths
-		uint32_t choice = rand()%npaths;	//make a random choice
+		uint32_t choice = m_rand->GetInteger (0, npaths - 1);	//make a random choice
 		uint32_t label = record->GetRoutingCost()/10;
 		label /= pow(100,choice);
 		label = label %100;
@@ -754,7 +763,7 @@ ForwardingStrategy::TrySendOutInterest (Ptr<Face> inFace,
 	
 	tag.SetPrevHop(node_name[outFace->GetId()/2+1]-'0');
 	
-	packetToSend->AddPacketTag(tag);	
+	packetToSend->ReplacePacketTag(tag);	
   bool successSend = outFace->Send (packetToSend);
   if (!successSend)
     {
@@ -814,7 +823,10 @@ ForwardingStrategy::DidAddFibEntry (Ptr<fib::Entry> fibEntry)
 void
 ForwardingStrategy::WillRemoveFibEntry (Ptr<fib::Entry> fibEntry)
 {
-  // do nothing here
+  if (m_localApps != 0)
+    {
+      m_localApps->Forget (fibEntry);
+    }
 }
 
 
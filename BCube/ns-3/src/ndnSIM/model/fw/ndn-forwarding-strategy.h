@@ -25,6 +25,7 @@
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 namespace ndn {
@@ -43,6 +44,7 @@ class FibFaceMetric;
 class Fib;
 namespace fib { class Entry; }
 class ContentStore;
+class LocalAppRegistry;
 
 /**
  * \ingroup ndn
@@ -476,10 +478,13 @@ protected:
   Ptr<Pit> m_pit; ///< \brief Reference to PIT to which this forwarding strategy is associated
   Ptr<Fib> m_fib; ///< \brief FIB
   Ptr<ContentStore> m_contentStore; ///< \brief Content store (for caching purposes only)
+  Ptr<LocalAppRegistry> m_localApps; ///< \brief Registry of local applications (aggregated when the first one registers)
 
   bool m_cacheUnsolicitedData;
   bool m_detectRetransmissions;
 
+  Ptr<UniformRandomVariable> m_rand; ///< \brief Per-node random stream (seeded from the global seed and run number)
+
   TracedCallback<Ptr<const Interest>,
                  Ptr<const Face> > m_outInterests; ///< @brief Transmitted interests trace
 
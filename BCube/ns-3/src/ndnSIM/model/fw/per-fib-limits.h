@@ -74,7 +74,7 @@ public:
   {
     super::AddFace (face);
 
-    if (face->GetObject<Limits> () == 0)
+    if (face->GetLimits () == 0)
       {
         NS_FATAL_ERROR ("At least per-face limits should be enabled");
         exit (1);
@@ -86,10 +86,10 @@ public:
   DidAddFibEntry (Ptr<fib::Entry> fibEntry)
   {
     ObjectFactory factory;
-    factory.SetTypeId (fibEntry->m_faces.begin ()->GetFace ()->GetObject<Limits> ()->GetInstanceTypeId ());
+    factory.SetTypeId (fibEntry->m_faces.begin ()->GetFace ()->GetLimits ()->GetInstanceTypeId ());
 
     Ptr<Limits> limits = factory.template Create<Limits> ();
-    fibEntry->AggregateObject (limits);
+    fibEntry->SetLimits (limits);
 
     super::DidAddFibEntry (fibEntry);
   }
@@ -147,7 +147,7 @@ PerFibLimits<Parent>::CanSendOutInterest (Ptr<Face> inFace,
 {
   NS_LOG_FUNCTION (this << pitEntry->GetPrefix ());
 
-  Ptr<Limits> fibLimits = pitEntry->GetFibEntry ()->template GetObject<Limits> ();
+  Limits *fibLimits = pitEntry->GetFibEntry ()->GetLimits ();
   // no checks for the limit here. the check should be somewhere elese
 
   if (fibLimits->IsBelowLimit ())
@@ -168,7 +168,7 @@ PerFibLimits<Parent>::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry
 {
   NS_LOG_FUNCTION (this << pitEntry->GetPrefix ());
 
-  Ptr<Limits> fibLimits = pitEntry->GetFibEntry ()->template GetObject<Limits> ();
+  Limits *fibLimits = pitEntry->GetFibEntry ()->GetLimits ();
   fibLimits->ReturnLimit ();
 
   super::WillEraseTimedOutPendingInterest (pitEntry);
@@ -182,7 +182,7 @@ PerFibLimits<Parent>::WillSatisfyPendingInterest (Ptr<Face> inFace,
 {
   NS_LOG_FUNCTION (this << pitEntry->GetPrefix ());
 
-  Ptr<Limits> fibLimits = pitEntry->GetFibEntry ()->template GetObject<Limits> ();
+  Limits *fibLimits = pitEntry->GetFibEntry ()->GetLimits ();
   fibLimits->ReturnLimit ();
 
   super::WillSatisfyPendingInterest (inFace, pitEntry);
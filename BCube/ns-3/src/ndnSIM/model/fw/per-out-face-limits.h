@@ -77,7 +77,7 @@ public:
   {
     ObjectFactory factory (m_limitType);
     Ptr<Limits> limits = factory.template Create<Limits> ();
-    face->AggregateObject (limits);
+    face->SetLimits (limits);
 
     super::AddFace (face);
   }
@@ -140,7 +140,7 @@ PerOutFaceLimits<Parent>::CanSendOutInterest (Ptr<Face> inFace,
 {
   NS_LOG_FUNCTION (this << pitEntry->GetPrefix ());
   
-  Ptr<Limits> faceLimits = outFace->template GetObject<Limits> ();
+  Limits *faceLimits = outFace->GetLimits ();
   if (faceLimits->IsBelowLimit ())
     {
       if (super::CanSendOutInterest (inFace, outFace, header, origPacket, pitEntry))
@@ -163,8 +163,7 @@ PerOutFaceLimits<Parent>::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitE
        face != pitEntry->GetOutgoing ().end ();
        face ++)
     {
-      Ptr<Limits> faceLimits = face->m_face->GetObject<Limits> ();
-      faceLimits->ReturnLimit ();
+      face->m_face->GetLimits ()->ReturnLimit ();
     }
 
   super::WillEraseTimedOutPendingInterest (pitEntry);
@@ -182,8 +181,7 @@ PerOutFaceLimits<Parent>::WillSatisfyPendingInterest (Ptr<Face> inFace,
        face != pitEntry->GetOutgoing ().end ();
        face ++)
     {
-      Ptr<Limits> faceLimits = face->m_face->GetObject<Limits> ();
-      faceLimits->ReturnLimit ();
+      face->m_face->GetLimits ()->ReturnLimit ();
     }
   
   super::WillSatisfyPendingInterest (inFace, pitEntry);
@@ -43,7 +43,6 @@
 #include "ndn-net-device-face.h"
 
 #include <boost/foreach.hpp>
-#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("ndn.BCubeL3Protocol");
 
@@ -51,6 +50,7 @@ namespace ns3 {
 namespace ndn {
 
 const uint16_t BCubeL3Protocol::ETHERNET_FRAME_TYPE = 0x7777;
+const uint32_t BCubeL3Protocol::NO_PORT;
 
 uint64_t BCubeL3Protocol::s_interestCounter = 0;
 uint64_t BCubeL3Protocol::s_dataCounter = 0;
@@ -146,6 +146,7 @@ BCubeL3Protocol::DoDispose (void)
     }
   m_uploadfaces.clear ();
   m_downloadfaces.clear ();
+  m_portByIfIndex.clear ();
   m_node = 0;
 
   // Force delete on objects
@@ -154,13 +155,30 @@ BCubeL3Protocol::DoDispose (void)
   Object::DoDispose ();
 }
 
+void
+BCubeL3Protocol::AddPortByNetDevice (const Ptr<Face> &face, uint32_t port)
+{
+  Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (face);
+  if (netDeviceFace == 0 || netDeviceFace->GetNetDevice () == 0)
+    return;
+
+  uint32_t ifIndex = netDeviceFace->GetNetDevice ()->GetIfIndex ();
+  if (ifIndex >= m_portByIfIndex.size ())
+    m_portByIfIndex.resize (ifIndex + 1, NO_PORT);
+  m_portByIfIndex[ifIndex] = port;
+}
+
 uint32_t
 BCubeL3Protocol::AddFace (const Ptr<Face> &uploadface, const Ptr<Face> &downloadface)
 {
 	NS_ASSERT(m_faceCounter%2==0);
+	uint32_t port = m_uploadfaces.size ();
+	AddPortByNetDevice (uploadface, port);
 	
 	//Add upload face
   uploadface->SetId (m_faceCounter); // sets a unique ID of the face. This ID serves only informational purposes
+  uploadface->SetDirection (Face::DIRECTION_UPLOAD);
+  uploadface->SetPortIndex (port);
 
   // ask face to register in lower-layer stack
   uploadface->RegisterProtocolHandler (MakeCallback (&BCubeL3Protocol::Receive, this));
@@ -172,6 +190,8 @@ BCubeL3Protocol::AddFace (const Ptr<Face> &uploadface, const Ptr<Face> &download
   
   //Add download face
   downloadface->SetId (m_faceCounter); // sets a unique ID of the face. This ID serves only informational purposes
+  downloadface->SetDirection (Face::DIRECTION_DOWNLOAD);
+  downloadface->SetPortIndex (port);
 
   // ask face to register in lower-layer stack
   downloadface->RegisterProtocolHandler (MakeCallback (&BCubeL3Protocol::Receive, this));
@@ -191,6 +211,8 @@ BCubeL3Protocol::AddAppFace (const Ptr<Face> &face)
 	//To be consistent with AddFace(), AppFace would "consume" ids, 
 	//and the real id is the even number (same as upload face)
 	face->SetId (m_faceCounter);
+	face->SetDirection (Face::DIRECTION_BOTH);
+	face->SetPortIndex (m_uploadfaces.size ());
 	
 	face->RegisterProtocolHandler (MakeCallback (&BCubeL3Protocol::Receive, this));
 	
@@ -212,10 +234,13 @@ BCubeL3Protocol::RemoveFace (Ptr<Face> face)
   Ptr<Pit> pit = GetObject<Pit> ();
 
   // just to be on a safe side. Do the process in two steps
+  // Only PIT entries referring to the face are visited (see Face::GetPitReferences)
   std::list< Ptr<pit::Entry> > entriesToRemoves;
-  for (Ptr<pit::Entry> pitEntry = pit->Begin (); pitEntry != 0; pitEntry = pit->Next (pitEntry))
+  FaceReference<pit::Entry>::List &references = face->GetPitReferences ();
+  while (!references.empty ())
     {
-      pitEntry->RemoveAllReferencesToFace (face);
+      Ptr<pit::Entry> pitEntry = references.front ().GetEntry ();
+      pitEntry->RemoveAllReferencesToFace (face); // unlinks all references of the entry to the face
 
       // If this face is the only for the associated FIB entry, then FIB entry will be removed soon.
       // Thus, we have to remove the whole PIT entry
@@ -230,13 +255,12 @@ BCubeL3Protocol::RemoveFace (Ptr<Face> face)
       pit->MarkErased (removedEntry);
     }
 
-  FaceList::iterator face_it = find (m_uploadfaces.begin(), m_uploadfaces.end(), face);
-  if(face_it != m_uploadfaces.end())
-  	m_uploadfaces.erase (face_it);
-  	
-  face_it = find (m_downloadfaces.begin(), m_downloadfaces.end(), face);
-  if (face_it != m_downloadfaces.end ())
-  	m_downloadfaces.erase (face_it);
+  // keep the slot, so ports (and face ids) of the other faces do not change
+  uint32_t port = face->GetPortIndex ();
+  if (port < m_uploadfaces.size () && m_uploadfaces[port] == face)
+  	m_uploadfaces[port] = 0;
+  if (port < m_downloadfaces.size () && m_downloadfaces[port] == face)
+  	m_downloadfaces[port] = 0;
   
 
   GetObject<Fib> ()->RemoveFromAll (face);
@@ -247,9 +271,10 @@ Ptr<Face>
 BCubeL3Protocol::GetUploadFace (uint32_t index) const
 {
   NS_ASSERT (0 <= index && index < 2*m_uploadfaces.size () && index%2==0);
-  if(DynamicCast<NetDeviceFace>(m_uploadfaces[index/2])!=0)
-  	return m_uploadfaces[index/2];
-  else	//app-face
+  const Ptr<Face> &face = m_uploadfaces[index/2];
+  if (face != 0 && !face->IsDownload ())
+  	return face;
+  else	//app-face (works in both directions) or removed face
   	return 0;
 }
 
@@ -263,45 +288,42 @@ BCubeL3Protocol::GetDownloadFace (uint32_t index) const
 Ptr<Face>
 BCubeL3Protocol::GetFaceById (uint32_t index) const
 {
-  BOOST_FOREACH (const Ptr<Face> &face, m_uploadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      if (face->GetId () == index)
-        return face;
-    }
-  BOOST_FOREACH (const Ptr<Face> &face, m_downloadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      if (face->GetId () == index)
-        return face;
-    }
+  // upload faces have even ids, download faces have odd ids, both are stored at port index/2
+  const FaceList &faces = (index%2 == 0) ? m_uploadfaces : m_downloadfaces;
+  uint32_t port = index/2;
+  if (port < faces.size () && faces[port] != 0 && faces[port]->GetId () == index)
+    return faces[port];
   return 0;
 }
 
+uint32_t
+BCubeL3Protocol::GetPortByNetDevice (Ptr<NetDevice> netDevice) const
+{
+  if (netDevice == 0 || netDevice->GetNode () != m_node)
+    return NO_PORT;
+
+  uint32_t ifIndex = netDevice->GetIfIndex ();
+  if (ifIndex >= m_portByIfIndex.size ())
+    return NO_PORT;
+  return m_portByIfIndex[ifIndex];
+}
+
 Ptr<Face>
 BCubeL3Protocol::GetUploadFaceByNetDevice (Ptr<NetDevice> netDevice) const
 {
-  BOOST_FOREACH (const Ptr<Face> &face, m_uploadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (face);
-      if (netDeviceFace == 0) continue;
-
-      if (netDeviceFace->GetNetDevice () == netDevice)
-        return face;
-    }  
-  return 0;
+  uint32_t port = GetPortByNetDevice (netDevice);
+  if (port == NO_PORT)
+    return 0;
+  return m_uploadfaces[port];
 }
 
 Ptr<Face>
 BCubeL3Protocol::GetDownloadFaceByNetDevice (Ptr<NetDevice> netDevice) const
 {  
-  BOOST_FOREACH (const Ptr<Face> &face, m_downloadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (face);
-      if (netDeviceFace == 0) continue;
-
-      if (netDeviceFace->GetNetDevice () == netDevice)
-        return face;
-    }
-  return 0;
+  uint32_t port = GetPortByNetDevice (netDevice);
+  if (port == NO_PORT)
+    return 0;
+  return m_downloadfaces[port];
 }
 
 uint32_t
@@ -340,7 +362,7 @@ BCubeL3Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
 						if(header->GetNack()==Interest::NORMAL_INTEREST)
 						{
 							//servers receive interest from download link
-							if(std::find(m_downloadfaces.begin(), m_downloadfaces.end(), face) != m_downloadfaces.end())
+							if(face->IsDownload ())
 							{
 								//NS_LOG_UNCOND("BCubeL3Protocol: "<<Names::FindName(m_node)<<" receives interest from face="<<face->GetId());
 								m_forwardingStrategy->OnInterest (face, header, p/*original packet*/);
@@ -351,7 +373,7 @@ BCubeL3Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
 						}
 						else
 						//servers receive nack from upload link
-							if(std::find(m_uploadfaces.begin(), m_uploadfaces.end(), face) != m_uploadfaces.end())
+							if(face->IsUpload ())
 							{
 								//NS_LOG_UNCOND("BCubeL3Protocol: "<<Names::FindName(m_node)<<" receives data from face="<<face->GetId());
 								m_forwardingStrategy->OnInterest (face, header, p/*original packet*/);
@@ -377,7 +399,7 @@ BCubeL3Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
             packet->RemoveTrailer (contentObjectTrailer);
             
             //servers receive Data from upload link
-						if(std::find(m_uploadfaces.begin(), m_uploadfaces.end(), face) != m_uploadfaces.end())
+						if(face->IsUpload ())
 						{
 							//NS_LOG_UNCOND("BCubeL3Protocol: Receive data from face="<<face->GetId()<<" node="<<m_node->GetId());
 							m_forwardingStrategy->OnData (face, header, packet/*payload*/, p/*original packet*/);
@@ -156,6 +156,18 @@ private:
   void
   Receive (const Ptr<Face> &face, const Ptr<const Packet> &p);
 
+  /**
+   * \brief Remember port of the face, so it can be found by NetDevice in O(1)
+   */
+  void
+  AddPortByNetDevice (const Ptr<Face> &face, uint32_t port);
+
+  /**
+   * \brief Get port of the NetDevice (NO_PORT if NetDevice does not belong to the stack)
+   */
+  uint32_t
+  GetPortByNetDevice (Ptr<NetDevice> netDevice) const;
+
 protected:
   virtual void DoDispose (void); ///< @brief Do cleanup
 
@@ -171,8 +183,11 @@ private:
   
 private:
   uint32_t m_faceCounter; ///< \brief counter of faces. Increased every time a new face is added to the stack
-  FaceList m_uploadfaces; ///< \brief list of faces that belongs to ndn stack on this node
-  FaceList m_downloadfaces;
+  FaceList m_uploadfaces; ///< \brief list of faces that belongs to ndn stack on this node, indexed by port (face id / 2)
+  FaceList m_downloadfaces; ///< \brief list of download faces, indexed by port (face id / 2)
+  std::vector<uint32_t> m_portByIfIndex; ///< \brief port of each NetDevice, indexed by NetDevice::GetIfIndex ()
+
+  static const uint32_t NO_PORT = static_cast<uint32_t> (-1);
 
   static uint64_t s_interestCounter;
   static uint64_t s_dataCounter;
@@ -154,6 +154,16 @@ public:
   uint32_t
   GetSignature () const;
   
+  /**
+   * @brief Values of the CE byte
+   */
+  enum CEValue
+    {
+      CE_NONE = 0,        ///< @brief no mark
+      CE_CONGESTION = 1,  ///< @brief congestion experienced (set by queues, see CeMarkingQueue)
+      CE_LOCAL_HIT = 2    ///< @brief data is satisfied from the local content store
+    };
+
   void
   SetCE (uint8_t CE);
   
@@ -0,0 +1,98 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_FACE_REFERENCE_H
+#define NDN_FACE_REFERENCE_H
+
+#include <boost/intrusive/list.hpp>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-face
+ * @brief Hook of a table record referring to a face (PIT incoming/outgoing face, FIB next hop)
+ *
+ * Records are linked into per-face lists (see Face::GetPitReferences and
+ * Face::GetFibReferences), so that all table entries referring to a face can be
+ * found without walking the whole table.  The hook unlinks itself when the record
+ * is destroyed, i.e., erased from its container in any way.  Copies of a record
+ * are not linked.
+ *
+ * @tparam E type of the table entry owning the record
+ */
+template<class E>
+class FaceReference : public boost::intrusive::list_base_hook< boost::intrusive::link_mode<boost::intrusive::auto_unlink> >
+{
+public:
+  typedef boost::intrusive::list_base_hook< boost::intrusive::link_mode<boost::intrusive::auto_unlink> > hook;
+  typedef boost::intrusive::list< FaceReference<E>, boost::intrusive::constant_time_size<false> > List;
+
+  FaceReference ()
+    : m_entry (0)
+  {
+  }
+
+  FaceReference (const FaceReference &)
+    : hook ()
+    , m_entry (0)
+  {
+  }
+
+  FaceReference &
+  operator = (const FaceReference &)
+  {
+    // keep own linkage
+    return *this;
+  }
+
+  /**
+   * @brief Link record (stored in a container of the entry) into the list of the face
+   *
+   * Records are const in the containers, but the hook is not a part of any key
+   */
+  void
+  Link (List &list, E *entry) const
+  {
+    FaceReference &self = const_cast<FaceReference&> (*this);
+    if (self.is_linked ())
+      return;
+
+    self.m_entry = entry;
+    list.push_back (self);
+  }
+
+  /**
+   * @brief Get entry owning the record
+   */
+  E *
+  GetEntry () const
+  {
+    return m_entry;
+  }
+
+private:
+  E *m_entry;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_FACE_REFERENCE_H
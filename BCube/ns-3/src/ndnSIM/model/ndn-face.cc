@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 #include "ns3/random-variable.h"
 #include "ns3/pointer.h"
+#include "ns3/ndn-limits-delta-rate.h"
 
 #include "ns3/ndnSIM/utils/ndn-fw-hop-count-tag.h"
 
@@ -76,6 +77,10 @@ Face::Face (Ptr<Node> node)
   , m_ifup (false)
   , m_id ((uint32_t)-1)
   , m_metric (0)
+  , m_direction (DIRECTION_BOTH)
+  , m_portIndex ((uint32_t)-1)
+  , m_limits (0)
+  , m_deltaRateLimits (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -102,6 +107,16 @@ Face::GetNode () const
   return m_node;
 }
 
+void
+Face::SetLimits (Ptr<Limits> limits)
+{
+  NS_ASSERT_MSG (m_limits == 0, "Limits are already set on the face");
+
+  AggregateObject (limits);
+  m_limits = PeekPointer (limits);
+  m_deltaRateLimits = PeekPointer (DynamicCast<LimitsDeltaRate> (limits));
+}
+
 void
 Face::RegisterProtocolHandler (ProtocolHandler handler)
 {
@@ -123,11 +138,11 @@ Face::Send (Ptr<Packet> packet)
     }
 
   FwHopCountTag hopCount;
-  bool tagExists = packet->RemovePacketTag (hopCount);
+  bool tagExists = packet->PeekPacketTag (hopCount);
   if (tagExists)
     {
       hopCount.Increment ();
-      packet->AddPacketTag (hopCount);
+      packet->ReplacePacketTag (hopCount);
     }
 
   bool ok = SendImpl (packet);
@@ -30,6 +30,7 @@
 #include "ns3/type-id.h"
 #include "ns3/traced-callback.h"
 #include "ns3/ndn-limits.h"
+#include "ns3/ndn-face-reference.h"
 
 namespace ns3 {
 
@@ -38,6 +39,11 @@ class Node;
 
 namespace ndn {
 
+class LimitsDeltaRate;
+
+namespace pit { class Entry; }
+namespace fib { class Entry; }
+
 /**
  * \ingroup ndn
  * \defgroup ndn-face Faces
@@ -169,6 +175,95 @@ public:
   inline uint32_t
   GetId () const;
 
+  /**
+   * \brief Direction of the face on a shared NetDevice
+   *
+   * In BCube, two faces are created for every NetDevice: upload (server to switch)
+   * and download (switch to server).  Application faces and all faces outside
+   * BCube stacks work in both directions.
+   */
+  enum Direction
+    {
+      DIRECTION_UPLOAD   = 1,
+      DIRECTION_DOWNLOAD = 2,
+      DIRECTION_BOTH     = DIRECTION_UPLOAD | DIRECTION_DOWNLOAD
+    };
+
+  /**
+   * \brief Set direction of the face (set once by the stack when face is added)
+   */
+  inline void
+  SetDirection (Direction direction);
+
+  /**
+   * \brief Get direction of the face
+   */
+  inline Direction
+  GetDirection () const;
+
+  /**
+   * \brief Check whether face accepts packets in upload direction
+   */
+  inline bool
+  IsUpload () const;
+
+  /**
+   * \brief Check whether face accepts packets in download direction
+   */
+  inline bool
+  IsDownload () const;
+
+  /**
+   * \brief Set index of the port (NetDevice) this face is attached to
+   *
+   * Upload and download faces of the same NetDevice share the port index
+   */
+  inline void
+  SetPortIndex (uint32_t portIndex);
+
+  /**
+   * \brief Get index of the port (NetDevice) this face is attached to
+   */
+  inline uint32_t
+  GetPortIndex () const;
+
+  /**
+   * \brief Aggregate limits to the face and remember typed pointer to them
+   *
+   * Forwarding strategies should use this method instead of AggregateObject, so that
+   * per-packet admission checks can use GetLimits instead of GetObject<Limits>
+   */
+  void
+  SetLimits (Ptr<Limits> limits);
+
+  /**
+   * \brief Get limits of the face (0 if limits are not enabled)
+   */
+  inline Limits *
+  GetLimits () const;
+
+  /**
+   * \brief Get limits of the face if they are LimitsDeltaRate (0 otherwise)
+   */
+  inline LimitsDeltaRate *
+  GetDeltaRateLimits () const;
+
+  /**
+   * \brief Get list of PIT records (incoming and outgoing faces) referring to this face
+   *
+   * Records are linked by pit::Entry and unlink themselves when erased
+   */
+  inline FaceReference<pit::Entry>::List &
+  GetPitReferences ();
+
+  /**
+   * \brief Get list of FIB next hops referring to this face
+   *
+   * Records are linked by fib::Entry and unlink themselves when erased
+   */
+  inline FaceReference<fib::Entry>::List &
+  GetFibReferences ();
+
   /**
    * \brief Compare two faces. Only two faces on the same node could be compared.
    *
@@ -214,6 +309,12 @@ private:
   bool m_ifup; ///< \brief flag indicating that the interface is UP 
   uint32_t m_id; ///< \brief id of the interface in NDN stack (per-node uniqueness)
   uint32_t m_metric; ///< \brief metric of the face
+  Direction m_direction; ///< \brief direction of the face on the shared NetDevice
+  uint32_t m_portIndex; ///< \brief index of the port in the stack (BCube stacks only)
+  Limits *m_limits; ///< \brief limits aggregated to the face (owned by the aggregate)
+  LimitsDeltaRate *m_deltaRateLimits; ///< \brief the same limits, if they are LimitsDeltaRate
+  FaceReference<pit::Entry>::List m_pitReferences; ///< \brief PIT records referring to the face
+  FaceReference<fib::Entry>::List m_fibReferences; ///< \brief FIB next hops referring to the face
 
   TracedCallback<Ptr<const Packet> > m_txTrace;
   TracedCallback<Ptr<const Packet> > m_rxTrace;
@@ -240,6 +341,66 @@ Face::GetId () const
   return m_id;
 }
 
+void
+Face::SetDirection (Direction direction)
+{
+  m_direction = direction;
+}
+
+Face::Direction
+Face::GetDirection () const
+{
+  return m_direction;
+}
+
+bool
+Face::IsUpload () const
+{
+  return (m_direction & DIRECTION_UPLOAD) != 0;
+}
+
+bool
+Face::IsDownload () const
+{
+  return (m_direction & DIRECTION_DOWNLOAD) != 0;
+}
+
+void
+Face::SetPortIndex (uint32_t portIndex)
+{
+  m_portIndex = portIndex;
+}
+
+uint32_t
+Face::GetPortIndex () const
+{
+  return m_portIndex;
+}
+
+Limits *
+Face::GetLimits () const
+{
+  return m_limits;
+}
+
+LimitsDeltaRate *
+Face::GetDeltaRateLimits () const
+{
+  return m_deltaRateLimits;
+}
+
+FaceReference<pit::Entry>::List &
+Face::GetPitReferences ()
+{
+  return m_pitReferences;
+}
+
+FaceReference<fib::Entry>::List &
+Face::GetFibReferences ()
+{
+  return m_fibReferences;
+}
+
 inline bool
 Face::operator!= (const Face &face) const
 {
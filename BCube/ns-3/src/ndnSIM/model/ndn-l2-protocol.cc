@@ -55,6 +55,7 @@ namespace ns3 {
 namespace ndn {
 
 const uint16_t L2Protocol::ETHERNET_FRAME_TYPE = 0x7777;
+const uint32_t L2Protocol::NO_PORT;
 
 NS_OBJECT_ENSURE_REGISTERED (L2Protocol);
 
@@ -113,6 +114,7 @@ L2Protocol::DoDispose (void)
     }
   m_uploadfaces.clear ();
   m_downloadfaces.clear ();
+  m_portByIfIndex.clear ();
   m_node = 0;
 
   Object::DoDispose ();
@@ -122,8 +124,21 @@ uint32_t
 L2Protocol::AddFace (const Ptr<Face> &upload_face, const Ptr<Face> &download_face)
 {
 	NS_ASSERT(upload_face != 0 && download_face !=0 && upload_face != download_face);
+	uint32_t port = m_uploadfaces.size ();
+
+	Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (upload_face);
+	if (netDeviceFace != 0 && netDeviceFace->GetNetDevice () != 0)
+	{
+		uint32_t ifIndex = netDeviceFace->GetNetDevice ()->GetIfIndex ();
+		if (ifIndex >= m_portByIfIndex.size ())
+			m_portByIfIndex.resize (ifIndex + 1, NO_PORT);
+		m_portByIfIndex[ifIndex] = port;
+	}
+
   //upload_face and download_face share the same ID, but they can be got via different functions
   upload_face->SetId (m_faceCounter); // sets a unique ID of the face. This ID serves only informational purposes
+  upload_face->SetDirection (Face::DIRECTION_UPLOAD);
+  upload_face->SetPortIndex (port);
   // ask face to register in lower-layer stack
   // L2Protocol would only receive packets from upload_face (server->switch)
   // For download_face, no need for Receive callback
@@ -133,6 +148,8 @@ L2Protocol::AddFace (const Ptr<Face> &upload_face, const Ptr<Face> &download_fac
   
   //Add download face
   download_face->SetId (m_faceCounter); // sets a unique ID of the face. This ID serves only informational purposes
+  download_face->SetDirection (Face::DIRECTION_DOWNLOAD);
+  download_face->SetPortIndex (port);
 	download_face->RegisterProtocolHandler (MakeCallback (&L2Protocol::Receive, this));
 	m_downloadfaces.push_back (download_face);
 	m_faceCounter++;
@@ -146,53 +163,38 @@ L2Protocol::AddFace (const Ptr<Face> &upload_face, const Ptr<Face> &download_fac
 Ptr<Face>
 L2Protocol::GetUploadFace (uint32_t index) const
 {
-  NS_ASSERT (0 <= index && index < m_uploadfaces.size () && index%2==0);
+  NS_ASSERT (0 <= index && index/2 < m_uploadfaces.size () && index%2==0);
   return m_uploadfaces[index/2];
 }
 
 Ptr<Face>
 L2Protocol::GetDownloadFace (uint32_t index) const
 {
-  NS_ASSERT (0 <= index && index < m_downloadfaces.size () && index%2==1);
+  NS_ASSERT (0 <= index && index/2 < m_downloadfaces.size () && index%2==1);
   return m_downloadfaces[index/2];
 }
 
 Ptr<Face>
 L2Protocol::GetFaceById (uint32_t index) const
 {
-  BOOST_FOREACH (const Ptr<Face> &face, m_uploadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      if (face->GetId () == index)
-        return face;
-    }
- BOOST_FOREACH (const Ptr<Face> &face, m_downloadfaces) // this function is not supposed to be called often, so linear search is fine
-  {
-    if (face->GetId () == index)
-      return face;
-  }
+  // upload faces have even ids, download faces have odd ids, both are stored at port index/2
+  const FaceList &faces = (index%2 == 0) ? m_uploadfaces : m_downloadfaces;
+  uint32_t port = index/2;
+  if (port < faces.size () && faces[port]->GetId () == index)
+    return faces[port];
   return 0;
 }
 
 Ptr<Face>
 L2Protocol::GetFaceByNetDevice (Ptr<NetDevice> netDevice) const
 {
-  BOOST_FOREACH (const Ptr<Face> &face, m_uploadfaces) // this function is not supposed to be called often, so linear search is fine
-    {
-      Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (face);
-      if (netDeviceFace == 0) continue;
+  if (netDevice == 0 || netDevice->GetNode () != m_node)
+    return 0;
 
-      if (netDeviceFace->GetNetDevice () == netDevice)
-        return face;
-    }
- BOOST_FOREACH (const Ptr<Face> &face, m_downloadfaces) // this function is not supposed to be called often, so linear search is fine
-  {
-    Ptr<NetDeviceFace> netDeviceFace = DynamicCast<NetDeviceFace> (face);
-    if (netDeviceFace == 0) continue;
-
-    if (netDeviceFace->GetNetDevice () == netDevice)
-      return face;
-  }
-  return 0;
+  uint32_t ifIndex = netDevice->GetIfIndex ();
+  if (ifIndex >= m_portByIfIndex.size () || m_portByIfIndex[ifIndex] == NO_PORT)
+    return 0;
+  return m_uploadfaces[m_portByIfIndex[ifIndex]];
 }
 
 uint32_t
@@ -233,7 +235,7 @@ L2Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
         //Switch should receive Interest from uploadlink
         if(header->GetNack()==Interest::NORMAL_INTEREST)
         {
-        	if(std::find(m_uploadfaces.begin(), m_uploadfaces.end(), face) == m_uploadfaces.end())
+        	if(!face->IsUpload ())
         		return;
         	//tag identifies the next hop!
         	
@@ -253,7 +255,7 @@ L2Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
         //Switch should receive NACK from downloadlink
         else
         {
-        	if(std::find(m_downloadfaces.begin(), m_downloadfaces.end(), face) != m_downloadfaces.end())
+        	if(face->IsDownload ())
         		return;
         	//tag identifies the next hop!
         	/*NS_LOG_UNCOND("L2Protocol: "<<Names::FindName(m_node)
@@ -273,7 +275,7 @@ L2Protocol::Receive (const Ptr<Face> &face, const Ptr<const Packet> &p)
     case HeaderHelper::CONTENT_OBJECT_NDNSIM:
       {
       	//Switch should receive Data from downloadlink, and forwarded to uploadlink
-      	if(std::find(m_downloadfaces.begin(), m_downloadfaces.end(), face) != m_downloadfaces.end())
+      	if(face->IsDownload ())
       		return;
       		
       	/*NS_LOG_UNCOND("L2Protocol: "<<Names::FindName(m_node)
@@ -146,6 +146,9 @@ private:
   uint32_t m_faceCounter; ///< \brief counter of faces. Increased every time a new face is added to the stack
   FaceList m_uploadfaces; ///< \brief list of upload faces that belongs to switch
 	FaceList m_downloadfaces; ///< \brief list of download faces that belongs to switch 
+  std::vector<uint32_t> m_portByIfIndex; ///< \brief port of each NetDevice, indexed by NetDevice::GetIfIndex ()
+
+  static const uint32_t NO_PORT = static_cast<uint32_t> (-1);
   
   // These objects are aggregated, but for optimization, get them here
   Ptr<Node> m_node; ///< \brief node on which ndn stack is installed
@@ -177,10 +177,13 @@ L3Protocol::RemoveFace (Ptr<Face> face)
   Ptr<Pit> pit = GetObject<Pit> ();
 
   // just to be on a safe side. Do the process in two steps
+  // Only PIT entries referring to the face are visited (see Face::GetPitReferences)
   std::list< Ptr<pit::Entry> > entriesToRemoves;
-  for (Ptr<pit::Entry> pitEntry = pit->Begin (); pitEntry != 0; pitEntry = pit->Next (pitEntry))
+  FaceReference<pit::Entry>::List &references = face->GetPitReferences ();
+  while (!references.empty ())
     {
-      pitEntry->RemoveAllReferencesToFace (face);
+      Ptr<pit::Entry> pitEntry = references.front ().GetEntry ();
+      pitEntry->RemoveAllReferencesToFace (face); // unlinks all references of the entry to the face
 
       // If this face is the only for the associated FIB entry, then FIB entry will be removed soon.
       // Thus, we have to remove the whole PIT entry
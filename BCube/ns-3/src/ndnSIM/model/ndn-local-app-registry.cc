@@ -0,0 +1,160 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-local-app-registry.h"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+
+#include "ns3/ndn-app.h"
+#include "ns3/ndn-fib-entry.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.LocalAppRegistry");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED (LocalAppRegistry);
+
+TypeId
+LocalAppRegistry::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::LocalAppRegistry")
+    .SetGroupName ("Ndn")
+    .SetParent<Object> ()
+    .AddConstructor<LocalAppRegistry> ()
+    ;
+  return tid;
+}
+
+LocalAppRegistry::LocalAppRegistry ()
+{
+}
+
+Ptr<LocalAppRegistry>
+LocalAppRegistry::GetOrCreate (Ptr<Node> node)
+{
+  Ptr<LocalAppRegistry> registry = node->GetObject<LocalAppRegistry> ();
+  if (registry == 0)
+    {
+      registry = CreateObject<LocalAppRegistry> ();
+      node->AggregateObject (registry);
+    }
+  return registry;
+}
+
+uint32_t
+LocalAppRegistry::Register (const Name &prefix, Ptr<App> app)
+{
+  std::map<Name, uint32_t>::iterator id = m_prefixIds.find (prefix);
+  if (id == m_prefixIds.end ())
+    {
+      id = m_prefixIds.insert (std::make_pair (prefix, static_cast<uint32_t> (m_prefixes.size ()))).first;
+      m_prefixes.push_back (prefix);
+      m_apps.push_back (AppList ());
+    }
+  NS_LOG_DEBUG ("Register app " << app->GetId () << " for " << prefix << " (prefix id " << id->second << ")");
+
+  m_apps[id->second].push_back (app);
+  m_resolved.clear ();
+  return id->second;
+}
+
+void
+LocalAppRegistry::Unregister (Ptr<App> app)
+{
+  for (std::vector<AppList>::iterator apps = m_apps.begin (); apps != m_apps.end (); apps++)
+    {
+      apps->erase (std::remove (apps->begin (), apps->end (), app), apps->end ());
+    }
+  m_resolved.clear ();
+}
+
+bool
+LocalAppRegistry::IsPrefixOf (const Name &prefix, const Name &name)
+{
+  return prefix.size () <= name.size () &&
+    std::equal (prefix.begin (), prefix.end (), name.begin ());
+}
+
+const LocalAppRegistry::Resolution &
+LocalAppRegistry::Resolve (const fib::Entry *fibEntry)
+{
+  std::map<const fib::Entry *, Resolution>::iterator resolved = m_resolved.find (fibEntry);
+  if (resolved != m_resolved.end ())
+    return resolved->second;
+
+  // without FIB entry, resolve for the root prefix: every registered prefix is then checked against the name
+  static const Name root;
+  const Name &fibPrefix = fibEntry != 0 ? fibEntry->GetPrefix () : root;
+
+  Resolution &resolution = m_resolved[fibEntry];
+  for (uint32_t id = 0; id < m_prefixes.size (); id++)
+    {
+      if (m_apps[id].empty ())
+        continue;
+
+      if (IsPrefixOf (m_prefixes[id], fibPrefix))
+        resolution.apps.insert (resolution.apps.end (), m_apps[id].begin (), m_apps[id].end ());
+      else if (IsPrefixOf (fibPrefix, m_prefixes[id]))
+        resolution.partialIds.push_back (id);
+      // otherwise, no name under the FIB prefix can match
+    }
+  return resolution;
+}
+
+const LocalAppRegistry::AppList &
+LocalAppRegistry::Lookup (Ptr<const fib::Entry> fibEntry, const Name &name)
+{
+  const Resolution &resolution = Resolve (PeekPointer (fibEntry));
+  if (resolution.partialIds.empty ())
+    return resolution.apps;
+
+  m_matched.assign (resolution.apps.begin (), resolution.apps.end ());
+  for (std::vector<uint32_t>::const_iterator id = resolution.partialIds.begin ();
+       id != resolution.partialIds.end ();
+       id++)
+    {
+      if (IsPrefixOf (m_prefixes[*id], name))
+        m_matched.insert (m_matched.end (), m_apps[*id].begin (), m_apps[*id].end ());
+    }
+  return m_matched;
+}
+
+void
+LocalAppRegistry::Forget (Ptr<const fib::Entry> fibEntry)
+{
+  m_resolved.erase (PeekPointer (fibEntry));
+}
+
+void
+LocalAppRegistry::DoDispose ()
+{
+  m_resolved.clear ();
+  m_matched.clear ();
+  m_apps.clear ();
+
+  Object::DoDispose ();
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_LOCAL_APP_REGISTRY_H
+#define NDN_LOCAL_APP_REGISTRY_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/ndn-name.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+class App;
+
+namespace fib {
+class Entry;
+}
+
+/**
+ * @ingroup ndn
+ * @brief Per-node registry of local applications interested in NACKs and Data for their prefixes
+ *
+ * Forwarding strategies copy NACKs and Data passing through the node to
+ * local consumers (intra-sharing feedback).  Instead of offering every packet
+ * to every application of the node, consumers register their Interest prefix
+ * here.  Each distinct prefix is interned to a numeric id, and for every FIB
+ * entry the registry resolves (once, then caches) the list of applications
+ * whose prefix covers all names under the FIB prefix.  The cache is keyed by
+ * the FIB entry itself, so a lookup per packet compares only pointers, never
+ * names.  Cached resolutions are dropped on (un)registration and when the
+ * forwarding strategy is told that the FIB entry is removed (see Forget).
+ *
+ * Applications with prefixes longer than the FIB prefix (i.e., covering only
+ * part of the names under it) are checked against the packet name on each
+ * lookup; in the usual setup, where consumers use the routed prefix, there are
+ * none.
+ *
+ * The registry is aggregated to the node on the first registration.
+ */
+class LocalAppRegistry : public Object
+{
+public:
+  typedef std::vector< Ptr<App> > AppList;
+
+  static TypeId
+  GetTypeId ();
+
+  /**
+   * @brief Default constructor
+   */
+  LocalAppRegistry ();
+
+  /**
+   * @brief Get registry of the node, aggregating a new one if necessary
+   */
+  static Ptr<LocalAppRegistry>
+  GetOrCreate (Ptr<Node> node);
+
+  /**
+   * @brief Register application interested in NACKs and Data for names under the prefix
+   * @returns interned id of the prefix
+   */
+  uint32_t
+  Register (const Name &prefix, Ptr<App> app);
+
+  /**
+   * @brief Remove all registrations of the application
+   */
+  void
+  Unregister (Ptr<App> app);
+
+  /**
+   * @brief Get applications interested in the name
+   * @param fibEntry FIB entry, whose prefix is a prefix of the name (may be 0)
+   * @param name     name of the NACK or Data
+   *
+   * The returned list is valid until the next (un)registration, FIB entry
+   * removal or lookup that involves prefixes longer than the FIB prefix, so
+   * the caller should iterate it by index
+   */
+  const AppList &
+  Lookup (Ptr<const fib::Entry> fibEntry, const Name &name);
+
+  /**
+   * @brief Drop the resolution cached for the FIB entry, which is about to be removed
+   */
+  void
+  Forget (Ptr<const fib::Entry> fibEntry);
+
+protected:
+  // from Object
+  virtual void
+  DoDispose ();
+
+private:
+  /**
+   * @brief Applications matched for one FIB entry
+   */
+  struct Resolution
+  {
+    AppList apps;                      ///< @brief applications interested in all names under the FIB prefix
+    std::vector<uint32_t> partialIds;  ///< @brief prefixes interested only in some of the names under the FIB prefix
+  };
+
+  const Resolution &
+  Resolve (const fib::Entry *fibEntry);
+
+  static bool
+  IsPrefixOf (const Name &prefix, const Name &name);
+
+private:
+  std::map<Name, uint32_t> m_prefixIds;  ///< @brief interned prefixes
+  std::vector<Name> m_prefixes;          ///< @brief prefixes by id
+  std::vector<AppList> m_apps;           ///< @brief registered applications by prefix id
+
+  std::map<const fib::Entry *, Resolution> m_resolved; ///< @brief cache of resolutions by FIB entry (0 for no entry)
+  AppList m_matched;                     ///< @brief applications matched by the last lookup with partial prefixes
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_LOCAL_APP_REGISTRY_H
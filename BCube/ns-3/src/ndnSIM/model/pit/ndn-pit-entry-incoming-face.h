@@ -30,11 +30,13 @@ namespace ns3 {
 namespace ndn {
 namespace pit {
 
+class Entry;
+
 /**
  * \ingroup ndn
  * \brief PIT state component for each incoming interest (not including duplicates)
  */
-struct IncomingFace
+struct IncomingFace : public FaceReference<Entry>
 {
   Ptr< Face > m_face; ///< \brief face of the incoming Interest
   Time m_arrivalTime;   ///< \brief arrival time of the incoming Interest
@@ -30,11 +30,13 @@ namespace ns3 {
 namespace ndn {
 namespace pit {
 
+class Entry;
+
 /**
  * \ingroup ndn
  * \brief PIT state component for each outgoing interest
  */
-struct OutgoingFace
+struct OutgoingFace : public FaceReference<Entry>
 {
   Ptr<Face> m_face;     ///< \brief face of the outgoing Interest
   Time m_sendTime;          ///< \brief time when the first outgoing interest is sent (for RTT measurements)
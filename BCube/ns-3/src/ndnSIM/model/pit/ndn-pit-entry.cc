@@ -115,6 +115,7 @@ Entry::AddIncoming (Ptr<Face> face)
     m_incoming.insert (IncomingFace (face));
 
   // NS_ASSERT_MSG (ret.second, "Something is wrong");
+  ret.first->Link (face->GetPitReferences (), this);
 
   return ret.first;
 }
@@ -126,6 +127,7 @@ Entry::AddIncoming (Ptr<Face> face, uint32_t localport)
   m_incoming.insert (IncomingFace (face, localport));
 
   // NS_ASSERT_MSG (ret.second, "Something is wrong");
+  ret.first->Link (face->GetPitReferences (), this);
 
   return ret.first;
 }
@@ -154,6 +156,8 @@ Entry::AddOutgoing (Ptr<Face> face)
       // m_outgoing.modify (ret.first,
       //                    ll::bind (&OutgoingFace::UpdateOnRetransmit, ll::_1));
     }
+  else
+    ret.first->Link (face->GetPitReferences (), this);
 
   return ret.first;
 }
@@ -259,6 +263,24 @@ Entry::GetOutgoing () const
   return m_outgoing;
 }
 
+const Entry::nonce_container &
+Entry::GetSeenNonces () const
+{
+  return m_seenNonces;
+}
+
+const Entry::in_index &
+Entry::GetIncomingIndex () const
+{
+  return m_incoming_index;
+}
+
+uint32_t
+Entry::GetFwTagCount () const
+{
+  return m_fwTags.size ();
+}
+
 uint32_t
 Entry::GetOutgoingCount () const
 {
@@ -278,6 +278,24 @@ public:
   uint32_t
   GetOutgoingCount () const;
 
+  /**
+   * @brief Get associated set (const reference) of seen nonces
+   */
+  const nonce_container &
+  GetSeenNonces () const;
+
+  /**
+   * @brief Get associated set (const reference) of local port indexes of incoming faces
+   */
+  const in_index &
+  GetIncomingIndex () const;
+
+  /**
+   * @brief Get number of forwarding strategy tags
+   */
+  uint32_t
+  GetFwTagCount () const;
+
   /**
    * @brief Add new forwarding strategy tag
    */
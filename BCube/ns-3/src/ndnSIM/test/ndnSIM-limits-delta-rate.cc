@@ -0,0 +1,96 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndnSIM-limits-delta-rate.h"
+
+#include "ns3/core-module.h"
+
+namespace ns3
+{
+
+void
+LimitsDeltaRateTest::Borrow (uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_limits->IsBelowDeltaLimit (), true, "token should be available at " << Simulator::Now ());
+      m_limits->BorrowDeltaLimit ();
+    }
+}
+
+void
+LimitsDeltaRateTest::Check (bool belowLimit, double tokens, double increment)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_limits->IsBelowDeltaLimit (), belowLimit, "wrong limit state at " << Simulator::Now ());
+  // GetCurrentCounter is the number of tokens missing in the bucket
+  NS_TEST_ASSERT_MSG_EQ_TOL (5.0 - m_limits->GetCurrentCounter (), tokens, 0.001, "wrong number of tokens at " << Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_limits->GetAvailableInterestIncrement (), increment, 0.001,
+                             "wrong available increment at " << Simulator::Now ());
+}
+
+void
+LimitsDeltaRateTest::CheckState (std::string state)
+{
+  std::ostringstream os;
+  m_limits->SaveState (os);
+  NS_TEST_ASSERT_MSG_EQ (os.str (), state, "wrong state of the limits at " << Simulator::Now ());
+}
+
+void
+LimitsDeltaRateTest::DoRun ()
+{
+  ObjectFactory factory ("ns3::ndn::Limits::LimitsDeltaRate");
+  factory.Set ("TokenBucket", BooleanValue (true));
+  factory.Set ("BurstDepth", DoubleValue (5.0));
+  factory.Set ("UpdateInterval", StringValue ("1.0"));
+  m_limits = factory.Create<ndn::LimitsDeltaRate> ();
+  m_limits->SetLimits (100.0, 0.0); // 100 Interests per second and per interval
+
+  // starts with the full bucket, which limits the initial burst
+  Check (true, 5.0, 100.0);
+  Borrow (5);
+  Check (false, 0.0, 95.0);
+
+  // refills at the limit rate: 2.5 tokens after 25 ms
+  Simulator::Schedule (MilliSeconds (25), &LimitsDeltaRateTest::Check, this, true, 2.5, 95.0);
+  Simulator::Schedule (MilliSeconds (25), &LimitsDeltaRateTest::Borrow, this, 2);
+  Simulator::Schedule (MilliSeconds (25), &LimitsDeltaRateTest::Check, this, false, 0.5, 93.0);
+
+  // capped at BurstDepth after a long idle period
+  Simulator::Schedule (MilliSeconds (900), &LimitsDeltaRateTest::Check, this, true, 5.0, 93.0);
+
+  // the remaining allowance is per interval, as in interval mode
+  Simulator::Schedule (MilliSeconds (1000), &LimitsDeltaRateTest::Check, this, true, 5.0, 100.0);
+  Simulator::Schedule (MilliSeconds (1500), &LimitsDeltaRateTest::Borrow, this, 3);
+  Simulator::Schedule (MilliSeconds (1500), &LimitsDeltaRateTest::Check, this, true, 2.0, 97.0);
+
+  // a lower limit slows down the refill, tokens earned before keep the old rate
+  Simulator::Schedule (MilliSeconds (1510), &ndn::LimitsDeltaRate::UpdateCurrentLimit, m_limits, 50.0);
+  Simulator::Schedule (MilliSeconds (1530), &LimitsDeltaRateTest::Check, this, true, 4.0, 47.0);
+
+  // Interests of the last interval are kept for a warm-start snapshot
+  Simulator::Schedule (MilliSeconds (2500), &LimitsDeltaRateTest::CheckState, this, std::string ("5 3 0"));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_limits = 0;
+}
+
+}
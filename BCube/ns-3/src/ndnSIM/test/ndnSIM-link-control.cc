@@ -0,0 +1,100 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndnSIM-link-control.h"
+#include "ns3/core-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include "ns3/ndn-link-control-helper.h"
+#include "ns3/ndn-node-faces-helper.h"
+#include "ns3/ndn-fib-entry.h"
+
+namespace ns3
+{
+
+void
+LinkControlTest::Check (Ptr<Node> node, bool up, bool pending)
+{
+  Ptr<ndn::Face> face;
+  std::vector< Ptr<ndn::Face> > faces = ndn::NodeFacesHelper::GetFaces (node);
+  for (std::vector< Ptr<ndn::Face> >::iterator i = faces.begin (); i != faces.end (); i++)
+    {
+      if (DynamicCast<ndn::NetDeviceFace> (*i) != 0)
+        face = *i;
+    }
+  NS_TEST_ASSERT_MSG_NE (face, 0, "node should have a face on the link");
+  NS_TEST_ASSERT_MSG_EQ (face->IsUp (), up, "wrong state of the face at " << Simulator::Now ());
+
+  Ptr<ndn::fib::Entry> fibEntry = node->GetObject<ndn::Fib> ()->Find (ndn::Name ("/prefix"));
+  NS_TEST_ASSERT_MSG_NE (fibEntry, 0, "route should not be removed");
+  ndn::fib::FaceMetricContainer::type::index<ndn::fib::i_face>::type::iterator record =
+    fibEntry->m_faces.get<ndn::fib::i_face> ().find (face);
+  NS_TEST_ASSERT_MSG_EQ ((record != fibEntry->m_faces.get<ndn::fib::i_face> ().end ()), true,
+                         "face should stay in the FIB entry");
+  if (!up)
+    NS_TEST_ASSERT_MSG_EQ (record->GetStatus (), ndn::fib::FaceMetric::NDN_FIB_RED,
+                           "failed face should be RED at " << Simulator::Now ());
+  else
+    NS_TEST_ASSERT_MSG_NE (record->GetStatus (), ndn::fib::FaceMetric::NDN_FIB_RED,
+                           "recovered face should not be RED at " << Simulator::Now ());
+
+  NS_TEST_ASSERT_MSG_EQ ((!face->GetPitReferences ().empty ()), pending,
+                         "wrong PIT references of the face at " << Simulator::Now ());
+}
+
+void
+LinkControlTest::DoRun ()
+{
+  Ptr<Node> consumer = CreateObject<Node> ();
+  Ptr<Node> router = CreateObject<Node> ();
+  PointToPointHelper p2p;
+  p2p.Install (consumer, router);
+
+  ndn::StackHelper ndn;
+  ndn.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
+  ndn.Install (consumer);
+  ndn.Install (router);
+
+  ndn::StackHelper::AddRoute (consumer, "/prefix", 0, 0);
+
+  // nobody answers, so the Interests stay in the PIT with the link face as outgoing
+  ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+  consumerHelper.SetPrefix ("/prefix");
+  consumerHelper.SetAttribute ("Frequency", StringValue ("10"));
+  consumerHelper.Install (consumer);
+
+  Simulator::Schedule (Seconds (1.5), &LinkControlTest::Check, this, consumer, true, true);
+
+  Simulator::Schedule (Seconds (2.0), &ndn::LinkControlHelper::FailLink, consumer, router);
+  Simulator::Schedule (Seconds (2.0), &LinkControlTest::Check, this, consumer, false, false);
+  // new Interests are not forwarded to the failed face
+  Simulator::Schedule (Seconds (2.5), &LinkControlTest::Check, this, consumer, false, false);
+
+  Simulator::Schedule (Seconds (3.0), &ndn::LinkControlHelper::UpLink, consumer, router);
+  Simulator::Schedule (Seconds (3.0), &LinkControlTest::Check, this, consumer, true, false);
+  Simulator::Schedule (Seconds (3.5), &LinkControlTest::Check, this, consumer, true, true);
+
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+}
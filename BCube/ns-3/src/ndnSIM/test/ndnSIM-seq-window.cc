@@ -0,0 +1,116 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndnSIM-seq-window.h"
+
+#include "ns3/ndnSIM/utils/ndn-seq-window.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+
+void
+SeqWindowTest::CheckWraparound ()
+{
+  ndn::SeqWindow window (4, 64);
+
+  // sequence numbers crossing 2^32 are consecutive, not 2^32 apart
+  const uint32_t start = 0xFFFFFFF0;
+  for (uint32_t i = 0; i < 32; i++)
+    window.Sent (start + i, MilliSeconds (i));
+
+  NS_TEST_ASSERT_MSG_EQ (window.GetSize (), 32, "all sequence numbers should be tracked");
+  NS_TEST_ASSERT_MSG_EQ (window.GetBase (), start, "base should be the first sequence number");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), 32, "span should not include the whole 32-bit space");
+  NS_TEST_ASSERT_MSG_NE (window.Find (0), 0, "sequence number after wraparound should be tracked");
+  NS_TEST_ASSERT_MSG_EQ (window.Find (0)->firstSent, MilliSeconds (16), "wrong entry after wraparound");
+
+  // a sequence number before the base, across the wraparound
+  window.Erase (start);
+  window.Erase (start + 1);
+  NS_TEST_ASSERT_MSG_EQ (window.GetBase (), start + 2, "base should follow the lowest tracked sequence number");
+  window.Sent (start, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (window.GetBase (), start, "base should move back");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), 32, "span should not include the whole 32-bit space");
+  NS_TEST_ASSERT_MSG_EQ (window.Find (start + 1), 0, "erased sequence number should not be tracked");
+
+  // timeouts expire in the order of transmission
+  uint32_t seq = 0;
+  NS_TEST_ASSERT_MSG_EQ (window.PopExpired (MilliSeconds (2), seq), true, "timeout should expire");
+  NS_TEST_ASSERT_MSG_EQ (seq, start + 2, "wrong expired sequence number");
+
+  for (uint32_t i = 0; i < 32; i++)
+    window.Erase (start + i);
+  NS_TEST_ASSERT_MSG_EQ (window.GetSize (), 0, "window should be empty");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), 0, "span of empty window should be empty");
+}
+
+void
+SeqWindowTest::CheckPinnedBase ()
+{
+  const uint32_t maxSpan = 256;
+  ndn::SeqWindow window (4, maxSpan);
+
+  // the Interest for sequence number 5 is never answered, all other ones are answered in order
+  for (uint32_t seq = 5; seq < 5 + 10 * maxSpan; seq++)
+    {
+      window.Sent (seq, MilliSeconds (seq));
+      if (seq != 5)
+        window.Erase (seq);
+      NS_TEST_ASSERT_MSG_LT (window.GetSpan (), maxSpan + 1, "span should be bounded");
+    }
+  NS_TEST_ASSERT_MSG_EQ (window.Find (5), 0, "pinned sequence number should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSize (), 0, "only the pinned sequence number was outstanding");
+
+  uint32_t seq = 0;
+  NS_TEST_ASSERT_MSG_EQ (window.PopExpired (MilliSeconds (100000), seq), false,
+                         "timeout of an evicted sequence number should not expire");
+
+  // outstanding sequence numbers at both ends: the ones farthest from the new one are evicted
+  window.Sent (1000, Seconds (100));
+  window.Sent (1000 + maxSpan - 1, Seconds (101));
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), maxSpan, "span should fill the window");
+  window.Sent (1000 + maxSpan, Seconds (102));
+  NS_TEST_ASSERT_MSG_EQ (window.Find (1000), 0, "lowest sequence number should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (window.GetBase (), 1000 + maxSpan - 1, "base should skip untracked slots");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSize (), 2, "wrong number of tracked sequence numbers");
+
+  window.Sent (1000, Seconds (103));
+  NS_TEST_ASSERT_MSG_EQ (window.Find (1000 + maxSpan), 0, "highest sequence number should be evicted");
+  NS_TEST_ASSERT_MSG_NE (window.Find (1000 + maxSpan - 1), 0, "sequence number within the span should be kept");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), maxSpan, "wrong span after moving base back");
+
+  // a jump by more than the maximum span forgets everything
+  window.Sent (1000 + 100 * maxSpan, Seconds (104));
+  NS_TEST_ASSERT_MSG_EQ (window.GetSize (), 1, "only the new sequence number should be tracked");
+  NS_TEST_ASSERT_MSG_EQ (window.GetSpan (), 1, "wrong span after the jump");
+
+  NS_TEST_ASSERT_MSG_EQ (window.PopExpired (Seconds (200), seq), true, "timeout should expire");
+  NS_TEST_ASSERT_MSG_EQ (seq, 1000 + 100 * maxSpan, "only the tracked sequence number should expire");
+}
+
+void
+SeqWindowTest::DoRun ()
+{
+  CheckWraparound ();
+  CheckPinnedBase ();
+}
+
+}
@@ -0,0 +1,48 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDNSIM_TEST_SEQ_WINDOW_H
+#define NDNSIM_TEST_SEQ_WINDOW_H
+
+#include "ns3/test.h"
+
+namespace ns3 {
+
+class SeqWindowTest : public TestCase
+{
+public:
+  SeqWindowTest ()
+    : TestCase ("Sequence number window test")
+  {
+  }
+
+private:
+  virtual void DoRun ();
+
+  void
+  CheckWraparound ();
+
+  void
+  CheckPinnedBase ();
+};
+
+}
+
+#endif // NDNSIM_TEST_SEQ_WINDOW_H
@@ -24,6 +24,9 @@
 #include "ndnSIM-serialization.h"
 #include "ndnSIM-pit.h"
 #include "ndnSIM-fib-entry.h"
+#include "ndnSIM-seq-window.h"
+#include "ndnSIM-limits-delta-rate.h"
+#include "ndnSIM-link-control.h"
 
 namespace ns3
 {
@@ -39,6 +42,9 @@ public:
     AddTestCase (new InterestSerializationTest ());
     AddTestCase (new ContentObjectSerializationTest ());
     AddTestCase (new FibEntryTest ());
+    AddTestCase (new SeqWindowTest ());
+    AddTestCase (new LimitsDeltaRateTest ());
+    AddTestCase (new LinkControlTest ());
     // AddTestCase (new PitTest ());
   }
 };
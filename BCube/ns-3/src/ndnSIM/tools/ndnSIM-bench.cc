@@ -0,0 +1,388 @@
+/* -*- Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include "ns3/BitTorrentTracker.h"
+#include "ns3/BitTorrentClient.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/*
+ * Standard benchmark of the simulator on the data center scenarios of this tree.
+ *
+ * Runs a fixed matrix of scenarios
+ *
+ *   {bcube-4-1, bcube-4-2, bcube-4-3, bcube-8-3, fattree-12} x {sharing, no sharing} x {ndn, bittorrent}
+ *
+ * each with the same seed and a short simulation time, and writes one JSON record per scenario with the wall clock
+ * time of the setup phase (topology, stacks, routing, applications) and of Simulator::Run, the number of executed
+ * events, the event rate, the peak resident set size and the number of packets forwarded by the point-to-point links.
+ *
+ * Traffic matrix: the servers (nodes whose name starts with "S") are taken in topology order; a quarter of them
+ * request data. Without sharing, the k-th consumer (counted from the end) fetches its own content from the k-th
+ * server; with sharing, all consumers fetch the same content from the first server.
+ *
+ * Every scenario runs in its own process (see ndn::ReplicationRunner), so that the peak RSS of one scenario does not
+ * include the memory of the previous ones and a crashing scenario is reported as failed instead of aborting the suite.
+ *
+ * Example:
+ *
+ *   ./waf --run "ndnSIM-bench --output=bench.json"
+ *   ./waf --run "ndnSIM-bench --filter=bcube-4 --time=5"
+ */
+
+NS_LOG_COMPONENT_DEFINE ("ndn.Bench");
+
+struct BenchScenario
+{
+  std::string topology;  // name of the topology (see GetTopologyFile)
+  bool sharing;
+  bool bittorrent;
+
+  std::string
+  GetName () const
+  {
+    return topology + (sharing ? "-sharing" : "-nosharing") + (bittorrent ? "-bittorrent" : "-ndn");
+  }
+};
+
+static std::vector<BenchScenario> g_scenarios;
+
+static double g_simulationTime = 2.0;
+static uint32_t g_consumerPackets = 10000;
+static std::string g_topologyDir = "src/ndnSIM/examples/topologies/";
+static std::string g_torrentFolder = "input/bittorrent/torrent-data";
+static std::string g_torrentFile = "input/bittorrent/torrent-data/10MB-full.dat.torrent";
+
+static const std::string g_recordFile = "ndnSIM-bench.record";
+
+static uint64_t g_packetsForwarded = 0;
+static uint64_t g_packetsDropped = 0;
+
+static void
+EnqueuePacket (Ptr<const Packet> packet)
+{
+  g_packetsForwarded ++;
+}
+
+static void
+DropPacket (Ptr<const Packet> packet)
+{
+  g_packetsDropped ++;
+}
+
+/**
+ * The topology files are named differently in the trees (e.g., bcube-8-3.txt or bcube-8-3), so look for the file
+ * with the .txt extension first and without extension otherwise
+ */
+static std::string
+GetTopologyFile (const std::string &topology)
+{
+  std::string file = g_topologyDir + topology + ".txt";
+  if (std::ifstream (file.c_str ()).good ())
+    {
+      return file;
+    }
+
+  return g_topologyDir + topology;
+}
+
+static std::vector< Ptr<Node> >
+GetServers ()
+{
+  std::vector< Ptr<Node> > servers;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      std::string name = Names::FindName (*node);
+      if (!name.empty () && name[0] == 'S')
+        {
+          servers.push_back (*node);
+        }
+    }
+  return servers;
+}
+
+static void
+InstallNdn (const BenchScenario &scenario, const std::vector< Ptr<Node> > &servers, uint32_t flows)
+{
+  Config::SetDefault ("ns3::ndn::fw::Nacks::EnableNACKs", BooleanValue (true));
+  Config::SetDefault ("ns3::ndn::Limits::LimitsDeltaRate::UpdateInterval", StringValue ("1.0"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::DataFeedback", StringValue ("1000"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::NackFeedback", StringValue ("1.5"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::LimitInterval", StringValue ("1.0"));
+  Config::SetDefault ("ns3::ndn::ConsumerOm::InitLimit", StringValue ("10.0"));
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.SetForwardingStrategy ("ns3::ndn::fw::BestCC::PerOutFaceDeltaLimits");
+  ndnHelper.EnableLimits (true, Seconds (0.2), 40, 1100);
+  ndnHelper.InstallAll ();
+
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll ();
+
+  for (uint32_t k = 0; k < flows; k++)
+    {
+      std::string prefix = scenario.sharing ? "/prefix" : "/flow" + boost::lexical_cast<std::string> (k);
+
+      if (!scenario.sharing || k == 0)
+        {
+          ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+          producerHelper.SetPrefix (prefix);
+          producerHelper.SetAttribute ("PayloadSize", StringValue ("1024"));
+          producerHelper.Install (servers[k]);
+          ndnGlobalRoutingHelper.AddOrigins (prefix, servers[k]);
+        }
+
+      ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerOm");
+      consumerHelper.SetPrefix (prefix);
+      consumerHelper.SetAttribute ("MaxSeq", IntegerValue (g_consumerPackets));
+      ApplicationContainer consumers = consumerHelper.Install (servers[servers.size () - 1 - k]);
+      consumers.Start (Seconds (0));
+      consumers.Stop (Seconds (g_simulationTime));
+    }
+
+  ndnGlobalRoutingHelper.CalculateAllPossibleRoutes ();
+}
+
+static void
+InstallBitTorrent (const BenchScenario &scenario, AnnotatedTopologyReader &topologyReader,
+                   const std::vector< Ptr<Node> > &servers, uint32_t flows)
+{
+  InternetStackHelper internet;
+  internet.InstallAll ();
+  topologyReader.AssignIpv4Addresses ("10.1.1.0");
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // with sharing, all consumers join one swarm; without, every flow is a swarm of its own (one seed, one leecher)
+  Ptr<bittorrent::Torrent> sharedTorrent;
+  for (uint32_t k = 0; k < flows; k++)
+    {
+      if (!scenario.sharing || k == 0)
+        {
+          Ptr<bittorrent::BitTorrentTracker> tracker = Create<bittorrent::BitTorrentTracker> ();
+          servers[k]->AddApplication (tracker);
+          sharedTorrent = tracker->AddTorrent (g_torrentFolder, g_torrentFile);
+
+          Ptr<bittorrent::BitTorrentClient> seed = Create<bittorrent::BitTorrentClient> ();
+          seed->SetTorrent (sharedTorrent);
+          seed->SetInitialBitfield ("full");
+          servers[k]->AddApplication (seed);
+        }
+
+      Ptr<bittorrent::BitTorrentClient> leecher = Create<bittorrent::BitTorrentClient> ();
+      leecher->SetTorrent (sharedTorrent);
+      leecher->SetStopTime (Seconds (g_simulationTime));
+      servers[servers.size () - 1 - k]->AddApplication (leecher);
+    }
+}
+
+/**
+ * Runs one scenario of the matrix; executed in a forked process.  The resulting record is written to
+ * ndn::ReplicationRunner::GetTraceFileName (g_recordFile), where the parent picks it up.
+ */
+static void
+RunScenario (uint32_t index, uint32_t run)
+{
+  const BenchScenario &scenario = g_scenarios[index];
+
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("50"));
+
+  SystemWallClockMs setupClock;
+  setupClock.Start ();
+
+  AnnotatedTopologyReader topologyReader ("", 25);
+  topologyReader.SetFileName (GetTopologyFile (scenario.topology));
+  NodeContainer nodes = topologyReader.Read ();
+
+  std::vector< Ptr<Node> > servers = GetServers ();
+  uint32_t flows = servers.size () / 4;
+  NS_ABORT_MSG_IF (flows == 0, "Topology " << scenario.topology << " has less than 4 servers");
+
+  if (scenario.bittorrent)
+    {
+      InstallBitTorrent (scenario, topologyReader, servers, flows);
+    }
+  else
+    {
+      InstallNdn (scenario, servers, flows);
+    }
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Enqueue",
+                                 MakeCallback (&EnqueuePacket));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/TxQueue/Drop",
+                                 MakeCallback (&DropPacket));
+
+  Simulator::Stop (Seconds (g_simulationTime));
+  int64_t setupMs = setupClock.End ();
+
+  SystemWallClockMs runClock;
+  runClock.Start ();
+  Simulator::Run ();
+  int64_t runMs = runClock.End ();
+
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  std::ofstream os (ndn::ReplicationRunner::GetTraceFileName (g_recordFile).c_str ());
+  os << "\"status\": \"ok\""
+     << ", \"nodes\": " << nodes.GetN ()
+     << ", \"flows\": " << flows
+     << ", \"setup_time_ms\": " << setupMs
+     << ", \"run_time_ms\": " << runMs
+     << ", \"wall_time_ms\": " << setupMs + runMs
+     << ", \"events\": " << events
+     << ", \"events_per_sec\": " << (runMs > 0 ? static_cast<uint64_t> (events * 1000.0 / runMs) : 0)
+     << ", \"peak_rss_kb\": " << usage.ru_maxrss // kilobytes on Linux
+     << ", \"packets_forwarded\": " << g_packetsForwarded
+     << ", \"packets_dropped\": " << g_packetsDropped;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string output = "";
+  std::string filter = "";
+  uint32_t seed = 1;
+  bool runNdn = true;
+  bool runBitTorrent = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("time", "Simulated time of every scenario (in seconds)", g_simulationTime);
+  cmd.AddValue ("packets", "Maximum number of packets requested by every NDN consumer", g_consumerPackets);
+  cmd.AddValue ("seed", "Seed of the random number generator, the same for all scenarios", seed);
+  cmd.AddValue ("filter", "Run only the scenarios whose name contains this string", filter);
+  cmd.AddValue ("ndn", "Run the NDN scenarios", runNdn);
+  cmd.AddValue ("bittorrent", "Run the BitTorrent scenarios", runBitTorrent);
+  cmd.AddValue ("topologies", "Directory of the topology files", g_topologyDir);
+  cmd.AddValue ("folder", "Folder of the data shared in the BitTorrent scenarios", g_torrentFolder);
+  cmd.AddValue ("torrent", "The .torrent file of the data shared in the BitTorrent scenarios", g_torrentFile);
+  cmd.AddValue ("output", "File to write the JSON results to (standard output if empty)", output);
+  cmd.Parse (argc, argv);
+
+  RngSeedManager::SetSeed (seed);
+
+  const char *topologies[] = { "bcube-4-1", "bcube-4-2", "bcube-4-3", "bcube-8-3", "fattree-12" };
+  for (uint32_t t = 0; t < sizeof (topologies) / sizeof (topologies[0]); t++)
+    {
+      for (int bittorrent = 0; bittorrent <= 1; bittorrent++)
+        {
+          for (int sharing = 1; sharing >= 0; sharing--)
+            {
+              BenchScenario scenario;
+              scenario.topology = topologies[t];
+              scenario.sharing = sharing;
+              scenario.bittorrent = bittorrent;
+
+              if ((scenario.bittorrent ? runBitTorrent : runNdn) &&
+                  scenario.GetName ().find (filter) != std::string::npos)
+                {
+                  g_scenarios.push_back (scenario);
+                }
+            }
+        }
+    }
+
+  bool haveTorrent = std::ifstream (g_torrentFile.c_str ()).good ();
+
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"simulation_time_s\": " << g_simulationTime << ",\n"
+       << "  \"seed\": " << seed << ",\n"
+       << "  \"scenarios\": [";
+
+  for (uint32_t i = 0; i < g_scenarios.size (); i++)
+    {
+      const BenchScenario &scenario = g_scenarios[i];
+      std::string name = scenario.GetName ();
+
+      json << (i == 0 ? "\n" : ",\n")
+           << "    { \"name\": \"" << name << "\""
+           << ", \"topology\": \"" << scenario.topology << "\""
+           << ", \"sharing\": " << (scenario.sharing ? "true" : "false")
+           << ", \"stack\": \"" << (scenario.bittorrent ? "bittorrent" : "ndn") << "\", ";
+
+      if (scenario.bittorrent && !haveTorrent)
+        {
+          NS_LOG_UNCOND (name << ": skipped, torrent " << g_torrentFile << " not found");
+          json << "\"status\": \"skipped\" }";
+          continue;
+        }
+
+      NS_LOG_UNCOND (name << ": running");
+
+      std::string record = ndn::ReplicationRunner::GetTraceFileName (g_recordFile, 1);
+      std::remove (record.c_str ());
+
+      ndn::ReplicationRunner runner;
+      runner.SetFirstRun (1);
+      runner.SetReplications (1);
+      runner.SetMaxParallel (1);
+      uint32_t failed = runner.Run (MakeBoundCallback (&RunScenario, i));
+
+      std::ifstream is (record.c_str ());
+      std::string fields;
+      std::getline (is, fields);
+      is.close ();
+      std::remove (record.c_str ());
+
+      if (failed > 0 || fields.empty ())
+        {
+          NS_LOG_UNCOND (name << ": failed");
+          json << "\"status\": \"failed\" }";
+        }
+      else
+        {
+          json << fields << " }";
+        }
+    }
+
+  json << "\n  ]\n}\n";
+
+  if (output.empty ())
+    {
+      std::cout << json.str ();
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      os << json.str ();
+    }
+
+  return 0;
+}
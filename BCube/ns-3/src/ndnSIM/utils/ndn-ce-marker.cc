@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ns3/ce-marking-queue.h"
+#include "ns3/log.h"
+
+#include "ns3/ndn-content-object.h"
+#include "ns3/ndn-header-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("ndn.CeMarker");
+
+namespace ns3 {
+namespace ndn {
+
+/// @brief PPP protocol number of NDN frames (see PointToPointNetDevice::EtherToPpp)
+static const uint16_t PPP_NDN_PROTOCOL = 0x0077;
+
+/**
+ * @brief Set CE byte of the Data packet queued in CeMarkingQueue
+ *
+ * Interests are not touched, and Data that already carries a non-zero CE value is left as is.
+ */
+static bool
+MarkData (Ptr<Packet> p)
+{
+  try
+    {
+      if (HeaderHelper::GetNdnHeaderType (p) != HeaderHelper::CONTENT_OBJECT_NDNSIM)
+        {
+          return false;
+        }
+
+      ContentObject header;
+      p->RemoveHeader (header);
+      bool marked = header.GetCE () == ContentObject::CE_NONE;
+      if (marked)
+        {
+          header.SetCE (ContentObject::CE_CONGESTION);
+        }
+      p->AddHeader (header);
+      return marked;
+    }
+  catch (UnknownHeaderException)
+    {
+      NS_LOG_DEBUG ("Unknown NDN header, the packet is not marked");
+      return false;
+    }
+}
+
+static class CeMarkerRegistration
+{
+public:
+  CeMarkerRegistration ()
+  {
+    CeMarkingQueue::SetMarker (PPP_NDN_PROTOCOL, MakeCallback (&MarkData));
+  }
+} g_ceMarkerRegistration;
+
+} // namespace ndn
+} // namespace ns3
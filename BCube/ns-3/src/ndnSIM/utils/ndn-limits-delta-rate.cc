@@ -24,6 +24,7 @@
 #include "ns3/random-variable.h"
 #include "ns3/double.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/ndn-face.h"
 #include "ns3/node.h"
 
@@ -46,21 +47,51 @@ LimitsDeltaRate::GetTypeId ()
                    StringValue ("1.0"),
                    MakeDoubleAccessor (&LimitsDeltaRate::m_resetInterval),
                    MakeDoubleChecker<double> ())
-    
+
+    .AddAttribute ("TokenBucket", "Refill tokens continuously instead of resetting the Interest counter every UpdateInterval",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LimitsDeltaRate::m_tokenBucket),
+                   MakeBooleanChecker ())
+
+    .AddAttribute ("BurstDepth", "Maximum number of tokens (Interests sent back-to-back) in token bucket mode",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&LimitsDeltaRate::m_burstDepth),
+                   MakeDoubleChecker<double> (1.0))
 
     ;
   return tid;
 }
 
 LimitsDeltaRate::LimitsDeltaRate()
-	: m_bucketMax (1)
+	: m_enabled (false)
+  , m_tokenBucket (false)
+  , m_burstDepth (10.0)
+  , m_tokens (0)
+  , m_bucketMax (1)
   , m_bucket (0)
   , m_bucketOld (0)
   , m_resetInterval (1.0)
   , m_nack (0)
   //, m_oldnack (0)
 { 
-	Simulator::Schedule (Seconds (m_resetInterval), &LimitsDeltaRate::UpdateBucket, this);	
+}
+
+void
+LimitsDeltaRate::NotifyConstructionCompleted ()
+{
+  super::NotifyConstructionCompleted ();
+
+  if (m_tokenBucket)
+    {
+      // start with the full bucket, tokens are calculated on demand
+      m_tokens = m_burstDepth;
+      m_lastRefill = Simulator::Now ();
+      m_intervalStart = Simulator::Now ();
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (m_resetInterval), &LimitsDeltaRate::UpdateBucket, this);
+    }
 }
 	
 
@@ -73,7 +104,11 @@ LimitsDeltaRate::NotifyNewAggregate ()
 void
 LimitsDeltaRate::SetLimits (double rate, double delay)
 {
+  if (m_tokenBucket)
+    RefillTokens (); // tokens accumulated so far are refilled at the old rate
+
   super::SetLimits (rate, delay);
+  m_enabled = IsEnabled ();
 
   // maximum allowed burst
   m_bucketMax = GetMaxRate () * m_resetInterval;	//scale the interest limit based on the reset interval
@@ -86,24 +121,10 @@ LimitsDeltaRate::UpdateCurrentLimit (double limit)
 {
   NS_ASSERT_MSG (limit >= 0.0, "Limit should be greater or equal to zero");
 
-  m_bucketMax  = limit * m_resetInterval; //scale the interest limit based on the reset interval
-}
-
-bool
-LimitsDeltaRate::IsBelowLimit ()
-{
-  if (!IsEnabled ()) return true;
-
-  return (m_bucketMax - m_bucket >= 1.0);
-}
+  if (m_tokenBucket)
+    RefillTokens (); // tokens accumulated so far are refilled at the old rate
 
-void
-LimitsDeltaRate::BorrowLimit ()
-{
-  if (!IsEnabled ()) return;
-
-  NS_ASSERT_MSG (m_bucketMax - m_bucket >= 1.0, "Should not be possible, unless we IsBelowLimit was not checked correctly");
-  m_bucket += 1;
+  m_bucketMax  = limit * m_resetInterval; //scale the interest limit based on the reset interval
 }
 
 void
@@ -115,13 +136,45 @@ LimitsDeltaRate::ReturnLimit ()
 double 
 LimitsDeltaRate::GetAvailableInterestIncrement () const
 {
-	double Delta = m_bucketMax - m_bucket; 
+	double bucket = m_bucket;
+	if (m_tokenBucket)
+	  {
+	    double bucketOld;
+	    GetIntervalCounters (bucket, bucketOld);
+	  }
+
+	double Delta = m_bucketMax - bucket; 
 	Delta = Delta > 0 ? Delta : 0; 
 	return Delta;	
 	//return Delta/(m_nack+1);	
 	//return 1/(m_nack+1);	//only care about whether remote links are congested as long as local links allow forwarding
 }
 
+void
+LimitsDeltaRate::SaveState (std::ostream &os) const
+{
+  double bucket = m_bucket;
+  double bucketOld = m_bucketOld;
+  if (m_tokenBucket)
+    GetIntervalCounters (bucket, bucketOld);
+
+  os << (m_tokenBucket ? GetTokens () : 0.0) << " " << bucketOld << " " << m_nack;
+}
+
+void
+LimitsDeltaRate::LoadState (std::istream &is)
+{
+  double tokens = 0;
+  is >> tokens >> m_bucketOld >> m_nack;
+  if (m_tokenBucket)
+    {
+      m_tokens = std::min (m_burstDepth, tokens);
+      m_lastRefill = Simulator::Now ();
+      m_bucket = 0;
+      m_intervalStart = Simulator::Now ();
+    }
+}
+
 void
 LimitsDeltaRate::UpdateBucket ()
 {
@@ -23,6 +23,12 @@
 
 #include "ndn-limits.h"
 #include <ns3/nstime.h>
+#include <ns3/assert.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 
 namespace ns3 {
 namespace ndn {
@@ -30,6 +36,18 @@ namespace ndn {
 /**
  * \ingroup ndn
  * \brief Structure to manage limits for outstanding interests
+ *
+ * Two modes are supported:
+ * - interval mode (default): the Interest counter is reset every UpdateInterval, and up to
+ *   rate*UpdateInterval Interests are allowed anywhere within the interval
+ * - token bucket mode (TokenBucket=true): tokens are refilled continuously at the current rate,
+ *   up to BurstDepth tokens.  The amount of tokens is calculated lazily from Simulator::Now ()
+ *   on every check, so no periodic event is scheduled
+ *
+ * In both modes, the Interests sent in the current UpdateInterval are counted, so that
+ * GetAvailableInterestIncrement (the remaining allowance of the interval, used by BestCC to
+ * compare faces) has the same meaning.  In token bucket mode, the interval is advanced lazily
+ * when the counter is accessed.
  */
 class LimitsDeltaRate :
     public Limits
@@ -65,6 +83,9 @@ public:
     return GetMaxRate ();
   }
   
+  /**
+   * @brief Get number of Interests that can still be sent in the current interval (in both modes)
+   */
   virtual
   double GetAvailableInterestIncrement () const;
 
@@ -72,13 +93,33 @@ public:
    * @brief Check if Interest limit is reached (token bucket is not empty)
    */
   virtual bool
-  IsBelowLimit ();
+  IsBelowLimit ()
+  {
+    return IsBelowDeltaLimit ();
+  }
 
   /**
    * @brief Get token from the bucket
    */
   virtual void
-  BorrowLimit ();
+  BorrowLimit ()
+  {
+    BorrowDeltaLimit ();
+  }
+
+  /**
+   * @brief Non-virtual (inlined) version of IsBelowLimit
+   *
+   * Should be used on the per-packet path through Face::GetDeltaRateLimits
+   */
+  inline bool
+  IsBelowDeltaLimit ();
+
+  /**
+   * @brief Non-virtual (inlined) version of BorrowLimit
+   */
+  inline void
+  BorrowDeltaLimit ();
 
   /**
    * @brief Does nothing (token bucket leakage is time-dependent only)
@@ -104,9 +145,16 @@ public:
     return m_bucketMax;
   }
   
+  /**
+   * @brief Get number of Interests sent in the current interval (interval mode)
+   * or number of tokens missing in the bucket (token bucket mode)
+   */
   virtual double
   GetCurrentCounter () const
   {
+    if (m_tokenBucket)
+      return m_burstDepth - GetTokens ();
+
   	return m_bucket;
   }
   
@@ -122,12 +170,66 @@ public:
   	m_nack++;
   }
 
+  /**
+   * @brief Write state of the limits (tokens, Interest counter of the last interval, NACK counter)
+   * for a warm-start snapshot
+   *
+   * The maximum rate is a parameter (see SetLimits) and is not part of the state
+   */
+  void
+  SaveState (std::ostream &os) const;
+
+  /**
+   * @brief Restore state written by SaveState
+   *
+   * Interest counter of the current interval is not restored: intervals restart with the simulation
+   */
+  void
+  LoadState (std::istream &is);
+
 protected:
   // from Node
   void
   NotifyNewAggregate ();
 
+  // from ObjectBase
+  virtual void
+  NotifyConstructionCompleted ();
+
 private:
+  /**
+   * @brief Rate at which tokens are refilled in token bucket mode (packet/s)
+   */
+  inline double
+  GetRefillRate () const;
+
+  /**
+   * @brief Get number of tokens available now in token bucket mode (without updating the state)
+   */
+  inline double
+  GetTokens () const;
+
+  /**
+   * @brief Bring number of tokens up to date in token bucket mode
+   */
+  inline void
+  RefillTokens ();
+
+  /**
+   * @brief Get Interest counters of the current and the last interval in token bucket mode
+   * (without updating the state)
+   */
+  inline void
+  GetIntervalCounters (double &bucket, double &bucketOld) const;
+
+  /**
+   * @brief Start a new interval of the Interest counter if the current one is over (token bucket mode)
+   *
+   * Equivalent of UpdateBucket, without a scheduled event
+   */
+  inline void
+  RollInterval ();
+
   
   /**
    * @brief Reset Interest counter, and update positive Interest arrival rate variation
@@ -137,6 +239,12 @@ private:
   
 private:
   bool m_isLeakScheduled;
+  bool m_enabled;       ///< \brief cached value of IsEnabled (), updated in SetLimits
+  bool m_tokenBucket;   ///< \brief continuously refilled token bucket instead of periodic reset
+  double m_burstDepth;  ///< \brief maximum number of tokens in token bucket mode (packets)
+  double m_tokens;      ///< \brief number of tokens at m_lastRefill (token bucket mode)
+  Time m_lastRefill;    ///< \brief time when m_tokens was last updated (token bucket mode)
+  Time m_intervalStart; ///< \brief start of the current interval of m_bucket (token bucket mode)
 
   double m_bucketMax;   ///< \brief Maximum Interest allowance for this face (packet/s)
   double m_bucket;			///< \brief Interest packet counter. will be reset every m_resetInterval. Equivalent to actual Interest arrival rate
@@ -147,6 +255,89 @@ private:
   
 };
 
+double
+LimitsDeltaRate::GetRefillRate () const
+{
+  return m_bucketMax / m_resetInterval;
+}
+
+double
+LimitsDeltaRate::GetTokens () const
+{
+  double elapsed = (Simulator::Now () - m_lastRefill).ToDouble (Time::S);
+  return std::min (m_burstDepth, m_tokens + GetRefillRate () * elapsed);
+}
+
+void
+LimitsDeltaRate::RefillTokens ()
+{
+  Time now = Simulator::Now ();
+  if (now == m_lastRefill)
+    return;
+
+  m_tokens = GetTokens ();
+  m_lastRefill = now;
+}
+
+void
+LimitsDeltaRate::GetIntervalCounters (double &bucket, double &bucketOld) const
+{
+  bucket = m_bucket;
+  bucketOld = m_bucketOld;
+
+  double elapsed = (Simulator::Now () - m_intervalStart).ToDouble (Time::S);
+  if (elapsed < m_resetInterval)
+    return;
+
+  // nothing was sent in the intervals skipped while idle
+  bucketOld = elapsed < 2 * m_resetInterval ? m_bucket : 0;
+  bucket = 0;
+}
+
+void
+LimitsDeltaRate::RollInterval ()
+{
+  double elapsed = (Simulator::Now () - m_intervalStart).ToDouble (Time::S);
+  if (elapsed < m_resetInterval)
+    return;
+
+  GetIntervalCounters (m_bucket, m_bucketOld);
+  m_intervalStart += Seconds (std::floor (elapsed / m_resetInterval) * m_resetInterval);
+}
+
+bool
+LimitsDeltaRate::IsBelowDeltaLimit ()
+{
+  if (!m_enabled) return true;
+
+  if (m_tokenBucket)
+    {
+      RefillTokens ();
+      return m_tokens >= 1.0;
+    }
+
+  return (m_bucketMax - m_bucket >= 1.0);
+}
+
+void
+LimitsDeltaRate::BorrowDeltaLimit ()
+{
+  if (!m_enabled) return;
+
+  if (m_tokenBucket)
+    {
+      RefillTokens ();
+      NS_ASSERT_MSG (m_tokens >= 1.0, "Should not be possible, unless we IsBelowLimit was not checked correctly");
+      m_tokens -= 1;
+
+      RollInterval ();
+      m_bucket += 1;
+      return;
+    }
+
+  NS_ASSERT_MSG (m_bucketMax - m_bucket >= 1.0, "Should not be possible, unless we IsBelowLimit was not checked correctly");
+  m_bucket += 1;
+}
 
 } // namespace ndn
 } // namespace ns3
@@ -0,0 +1,192 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-seq-window.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.SeqWindow");
+
+namespace ns3 {
+namespace ndn {
+
+static uint32_t
+RoundUpToPowerOfTwo (uint32_t value)
+{
+  uint32_t power = 1;
+  while (power < value)
+    power <<= 1;
+  return power;
+}
+
+SeqWindow::SeqWindow (uint32_t initialCapacity, uint32_t maxSpan)
+  : m_slots (RoundUpToPowerOfTwo (std::min (initialCapacity, maxSpan)))
+  , m_head (0)
+  , m_base (0)
+  , m_span (0)
+  , m_count (0)
+  , m_maxSpan (RoundUpToPowerOfTwo (maxSpan))
+  , m_timeouts (RoundUpToPowerOfTwo (initialCapacity))
+  , m_timeoutsHead (0)
+  , m_timeoutsSize (0)
+{
+}
+
+SeqWindow::Entry &
+SeqWindow::MakeSlot (uint32_t seq)
+{
+  if (m_span == 0)
+    {
+      m_base = seq;
+      m_span = 1;
+      return Slot (0);
+    }
+
+  // distances modulo 2^32: a sequence number up to 2^31 behind the base is before it
+  if (static_cast<int32_t> (seq - m_base) < 0)
+    { // move base back, new slots are in front of the current ones
+      uint32_t shift = m_base - seq;
+      // the span would not fit, forget the highest sequence numbers
+      if (shift >= m_maxSpan)
+        EvictBack (0);
+      else if (m_span + shift > m_maxSpan)
+        EvictBack (m_maxSpan - shift);
+
+      if (m_span == 0)
+        return MakeSlot (seq);
+
+      if (m_span + shift > m_slots.size ())
+        GrowSlots (m_span + shift);
+
+      m_head = (m_head - shift) & (m_slots.size () - 1);
+      m_base = seq;
+      m_span += shift;
+      for (uint32_t offset = 1; offset < shift; offset ++)
+        Slot (offset).used = false;
+      return Slot (0);
+    }
+
+  uint32_t offset = seq - m_base;
+  if (offset >= m_maxSpan)
+    { // the span would not fit, forget the lowest sequence numbers
+      EvictFront (seq - (m_maxSpan - 1));
+      if (m_span == 0)
+        return MakeSlot (seq);
+      offset = seq - m_base;
+    }
+
+  if (offset >= m_span)
+    { // move end of the span forward
+      if (offset + 1 > m_slots.size ())
+        GrowSlots (offset + 1);
+
+      for (uint32_t i = m_span; i < offset; i ++)
+        Slot (i).used = false;
+      m_span = offset + 1;
+    }
+  return Slot (offset);
+}
+
+void
+SeqWindow::EvictFront (uint32_t base)
+{
+  while (m_span > 0 && (static_cast<int32_t> (base - m_base) > 0 || !Slot (0).used))
+    {
+      Entry &entry = Slot (0);
+      if (entry.used)
+        {
+          NS_LOG_DEBUG ("Evicting " << m_base << " from the window");
+          entry.used = false;
+          entry.timerArmed = false;
+          m_count --;
+        }
+      m_head = (m_head + 1) & (m_slots.size () - 1);
+      m_base ++;
+      m_span --;
+    }
+}
+
+void
+SeqWindow::EvictBack (uint32_t span)
+{
+  while (m_span > span || (m_span > 0 && !Slot (m_span - 1).used))
+    {
+      Entry &entry = Slot (m_span - 1);
+      if (entry.used)
+        {
+          NS_LOG_DEBUG ("Evicting " << (m_base + m_span - 1) << " from the window");
+          entry.used = false;
+          entry.timerArmed = false;
+          m_count --;
+        }
+      m_span --;
+    }
+}
+
+void
+SeqWindow::GrowSlots (uint32_t span)
+{
+  uint32_t capacity = RoundUpToPowerOfTwo (std::max<uint32_t> (span, std::min<uint32_t> (2 * m_slots.size (), m_maxSpan)));
+  NS_LOG_DEBUG ("Growing window from " << m_slots.size () << " to " << capacity << " slots");
+
+  std::vector<Entry> slots (capacity);
+  for (uint32_t offset = 0; offset < m_span; offset ++)
+    slots[offset] = Slot (offset);
+
+  m_slots.swap (slots);
+  m_head = 0;
+}
+
+void
+SeqWindow::CompactTimeouts ()
+{
+  // an old timeout that never expires (e.g., timeouts are not checked) keeps invalidated
+  // timeouts behind it in the queue, so they have to be removed from the middle too
+  uint32_t mask = m_timeouts.size () - 1;
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < m_timeoutsSize; i ++)
+    {
+      const Timeout &timeout = m_timeouts[(m_timeoutsHead + i) & mask];
+      if (!IsStale (timeout))
+        {
+          m_timeouts[(m_timeoutsHead + size) & mask] = timeout;
+          size ++;
+        }
+    }
+  m_timeoutsSize = size;
+
+  if (m_timeoutsSize <= m_timeouts.size () / 2)
+    return;
+
+  uint32_t capacity = 2 * m_timeouts.size ();
+  NS_LOG_DEBUG ("Growing timeout queue from " << m_timeouts.size () << " to " << capacity << " entries");
+
+  std::vector<Timeout> timeouts (capacity);
+  for (uint32_t i = 0; i < m_timeoutsSize; i ++)
+    timeouts[i] = m_timeouts[(m_timeoutsHead + i) & mask];
+
+  m_timeouts.swap (timeouts);
+  m_timeoutsHead = 0;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,329 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_SEQ_WINDOW_H
+#define NDN_SEQ_WINDOW_H
+
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn
+ * @brief Per-sequence-number bookkeeping of a consumer: send times, retransmission counts and pending timeouts
+ *
+ * Entries live in a ring buffer indexed by (seq - base), where base is the
+ * lowest sequence number still tracked.  The ring spans from the lowest to the
+ * highest tracked sequence number and doubles its capacity when the span
+ * does not fit.  Once the capacity has reached the span of the consumer's
+ * window, Interests and Data are processed without any memory allocation.
+ *
+ * The span is bounded by maxSpan.  A sequence number that does not fit is
+ * tracked by evicting the entries farthest from it (e.g., an old unanswered
+ * Interest pinning the base); evicted sequence numbers are forgotten, as if
+ * erased.  Sequence numbers are compared modulo 2^32, so the window keeps
+ * working when they wrap around.
+ *
+ * Retransmission timeouts are kept in a FIFO queue (also a ring buffer) in
+ * the order of transmission.  Since simulation time never goes back, the queue
+ * is sorted by send time and the expired timeouts are always at its head.
+ * Timeouts invalidated by Data, NACK or retransmission of the sequence number
+ * are not searched for; they are dropped when they reach the head of the queue.
+ */
+class SeqWindow
+{
+public:
+  /**
+   * @brief Bookkeeping of one sequence number
+   */
+  struct Entry
+  {
+    Time firstSent;     ///< @brief time when the first Interest was sent
+    Time lastSent;      ///< @brief time when the last Interest was sent
+    uint32_t retxCount; ///< @brief number of sent Interests
+    bool timerArmed;    ///< @brief retransmission timeout is pending
+    bool used;          ///< @brief sequence number is tracked
+  };
+
+  /**
+   * @brief Create window with the specified initial capacity and maximum span (both rounded up to a power of two)
+   */
+  SeqWindow (uint32_t initialCapacity = 64, uint32_t maxSpan = 65536);
+
+  /**
+   * @brief Find entry of the sequence number
+   * @returns 0 if the sequence number is not tracked
+   */
+  inline const Entry *
+  Find (uint32_t seq) const;
+
+  /**
+   * @brief Record that Interest for the sequence number has been sent at the time
+   *
+   * On the first Interest, sets firstSent.  On every Interest, sets lastSent,
+   * increments retxCount and (re)arms the retransmission timeout.
+   */
+  inline const Entry &
+  Sent (uint32_t seq, const Time &now);
+
+  /**
+   * @brief Cancel retransmission timeout of the sequence number, keeping its entry
+   */
+  inline void
+  DisarmTimer (uint32_t seq);
+
+  /**
+   * @brief Stop tracking the sequence number
+   */
+  inline void
+  Erase (uint32_t seq);
+
+  /**
+   * @brief Get the sequence number with the oldest timeout, if it expired
+   *
+   * The timeout is expired if the Interest was sent not later than deadline.
+   * The timeout is disarmed before the call returns.
+   *
+   * @param deadline latest send time of an expired Interest
+   * @param seq [out] sequence number of the expired Interest
+   * @returns false if there are no more expired timeouts
+   */
+  inline bool
+  PopExpired (const Time &deadline, uint32_t &seq);
+
+  /**
+   * @brief Get lowest tracked sequence number (meaningless if nothing is tracked)
+   */
+  uint32_t
+  GetBase () const
+  {
+    return m_base;
+  }
+
+  /**
+   * @brief Get number of slots from the lowest to the highest tracked sequence number
+   */
+  uint32_t
+  GetSpan () const
+  {
+    return m_span;
+  }
+
+  /**
+   * @brief Get number of tracked sequence numbers
+   */
+  uint32_t
+  GetSize () const
+  {
+    return m_count;
+  }
+
+private:
+  struct Timeout
+  {
+    Time time;
+    uint32_t seq;
+  };
+
+  inline Entry &
+  Slot (uint32_t offset)
+  {
+    return m_slots[(m_head + offset) & (m_slots.size () - 1)];
+  }
+
+  inline Entry *
+  FindSlot (uint32_t seq);
+
+  /**
+   * @brief Check whether the timeout has been invalidated by Data, NACK or retransmission
+   */
+  inline bool
+  IsStale (const Timeout &timeout);
+
+  /**
+   * @brief Drop invalidated timeouts from the head of the queue
+   */
+  inline void
+  TrimTimeouts ();
+
+  /**
+   * @brief Make slots for the sequence number, moving base or end of the span as necessary
+   */
+  Entry &
+  MakeSlot (uint32_t seq);
+
+  /**
+   * @brief Stop tracking the sequence numbers before base
+   *
+   * Also skips the untracked slots at the new base.
+   */
+  void
+  EvictFront (uint32_t base);
+
+  /**
+   * @brief Stop tracking the highest sequence numbers, so that at most span slots remain
+   */
+  void
+  EvictBack (uint32_t span);
+
+  /**
+   * @brief Reallocate ring of slots with at least the specified capacity
+   */
+  void
+  GrowSlots (uint32_t span);
+
+  /**
+   * @brief Make room in the full queue of timeouts
+   *
+   * Drops all invalidated timeouts, not only those at the head, and grows
+   * the queue only if it would remain more than half full
+   */
+  void
+  CompactTimeouts ();
+
+private:
+  std::vector<Entry> m_slots; ///< @brief ring of entries, size is a power of two
+  uint32_t m_head;            ///< @brief index of the slot of m_base
+  uint32_t m_base;            ///< @brief lowest tracked sequence number
+  uint32_t m_span;            ///< @brief number of slots from m_base to the highest tracked sequence number
+  uint32_t m_count;           ///< @brief number of tracked sequence numbers
+  uint32_t m_maxSpan;         ///< @brief maximum span, a power of two
+
+  std::vector<Timeout> m_timeouts; ///< @brief ring of timeouts in the order of send time, size is a power of two
+  uint32_t m_timeoutsHead;
+  uint32_t m_timeoutsSize;
+};
+
+SeqWindow::Entry *
+SeqWindow::FindSlot (uint32_t seq)
+{
+  uint32_t offset = seq - m_base;
+  if (offset >= m_span)
+    return 0;
+
+  Entry &entry = Slot (offset);
+  return entry.used ? &entry : 0;
+}
+
+const SeqWindow::Entry *
+SeqWindow::Find (uint32_t seq) const
+{
+  return const_cast<SeqWindow*> (this)->FindSlot (seq);
+}
+
+const SeqWindow::Entry &
+SeqWindow::Sent (uint32_t seq, const Time &now)
+{
+  Entry *entry = FindSlot (seq);
+  if (entry == 0)
+    {
+      entry = &MakeSlot (seq);
+      entry->firstSent = now;
+      entry->retxCount = 0;
+      entry->used = true;
+      m_count ++;
+    }
+  entry->lastSent = now;
+  entry->retxCount ++;
+  entry->timerArmed = true;
+
+  if (m_timeoutsSize == m_timeouts.size ())
+    CompactTimeouts ();
+  Timeout &timeout = m_timeouts[(m_timeoutsHead + m_timeoutsSize) & (m_timeouts.size () - 1)];
+  timeout.time = now;
+  timeout.seq = seq;
+  m_timeoutsSize ++;
+
+  return *entry;
+}
+
+bool
+SeqWindow::IsStale (const Timeout &timeout)
+{
+  Entry *entry = FindSlot (timeout.seq);
+  return entry == 0 || !entry->timerArmed || entry->lastSent != timeout.time;
+}
+
+void
+SeqWindow::TrimTimeouts ()
+{
+  while (m_timeoutsSize > 0 && IsStale (m_timeouts[m_timeoutsHead]))
+    {
+      m_timeoutsHead = (m_timeoutsHead + 1) & (m_timeouts.size () - 1);
+      m_timeoutsSize --;
+    }
+}
+
+void
+SeqWindow::DisarmTimer (uint32_t seq)
+{
+  Entry *entry = FindSlot (seq);
+  if (entry != 0)
+    {
+      entry->timerArmed = false;
+      TrimTimeouts ();
+    }
+}
+
+void
+SeqWindow::Erase (uint32_t seq)
+{
+  Entry *entry = FindSlot (seq);
+  if (entry == 0)
+    return;
+
+  entry->used = false;
+  entry->timerArmed = false;
+  m_count --;
+
+  // shrink the span from both sides, so that base follows the lowest outstanding sequence number
+  while (m_span > 0 && !Slot (0).used)
+    {
+      m_head = (m_head + 1) & (m_slots.size () - 1);
+      m_base ++;
+      m_span --;
+    }
+  while (m_span > 0 && !Slot (m_span - 1).used)
+    m_span --;
+
+  // with in-order Data, this keeps the queue about as long as the window, even if timeouts are not checked
+  TrimTimeouts ();
+}
+
+bool
+SeqWindow::PopExpired (const Time &deadline, uint32_t &seq)
+{
+  TrimTimeouts ();
+  if (m_timeoutsSize == 0 || m_timeouts[m_timeoutsHead].time > deadline)
+    return false; // all later timeouts are even later
+
+  seq = m_timeouts[m_timeoutsHead].seq;
+  FindSlot (seq)->timerArmed = false;
+  TrimTimeouts ();
+  return true;
+}
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_SEQ_WINDOW_H
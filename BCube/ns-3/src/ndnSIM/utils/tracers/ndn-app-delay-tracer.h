@@ -29,6 +29,8 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/shared_ptr.hpp>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -39,9 +41,76 @@ namespace ndn {
 
 class App;
 
+namespace app_delay {
+
+/**
+ * @brief Streaming quantile sketch of delays (log-linear histogram, in the spirit of HDR histogram)
+ *
+ * Delays (in nanoseconds) below 128 are counted exactly, larger ones in buckets 1/64 of the power of two they fall
+ * into. Any quantile is therefore reported within 1/128 of its exact value, whatever the range of the delays, and
+ * the memory is bounded by the largest delay (about 2000 counters for delays of seconds).
+ */
+class DelaySketch
+{
+public:
+  DelaySketch ();
+
+  void
+  Add (const Time &delay);
+
+  void
+  Reset ();
+
+  uint64_t
+  GetCount () const;
+
+  Time
+  GetMean () const;
+
+  Time
+  GetMax () const;
+
+  /**
+   * @brief Get the delay below which the fraction q (0..1) of the delays lies
+   */
+  Time
+  GetQuantile (double q) const;
+
+private:
+  static uint32_t
+  GetBucket (uint64_t value);
+
+  static uint64_t
+  GetBucketValue (uint32_t bucket);
+
+private:
+  std::vector<uint32_t> m_buckets;
+  uint64_t m_count;
+  uint64_t m_sum;
+  uint64_t m_min;
+  uint64_t m_max;
+};
+
+struct Stats
+{
+  inline void Reset ()
+  {
+    m_lastDelay.Reset ();
+    m_fullDelay.Reset ();
+  }
+  DelaySketch m_lastDelay;
+  DelaySketch m_fullDelay;
+};
+
+}
+
 /**
  * @ingroup ndn
- * @brief  network-layer tracer for aggregate packet counts
+ * @brief Application-level tracer for Interest-Data delays
+ *
+ * By default, the tracer writes one row per received Data. With a non-zero averaging period, it instead keeps a
+ * quantile sketch of the delays per application and writes, every period, the number of received Data and the
+ * mean, 50th, 90th, 99th, 99.9th percentile and maximum delay of each application.
  */
 class AppDelayTracer : public SimpleRefCount<AppDelayTracer>
 {
@@ -50,14 +119,15 @@ public:
    * @brief Helper method to install tracers on all simulation nodes
    *
    * @param file File to which traces will be written
-   * @param averagingPeriod How often data will be written into the trace file (default, every half second)
+   * @param averagingPeriod How often delay quantiles will be written into the trace file (default, zero, writes one
+   *                        row per received Data instead)
    *
    * @returns a tuple of reference to output stream and list of tracers. !!! Attention !!! This tuple needs to be preserved
    *          for the lifetime of simulation, otherwise SEGFAULTs are inevitable
    * 
    */
   static boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<AppDelayTracer> > >
-  InstallAll (const std::string &file);
+  InstallAll (const std::string &file, Time averagingPeriod = Seconds (0));
 
   /**
    * @brief Trace constructor that attaches to all applications on the node using node's pointer
@@ -85,11 +155,33 @@ public:
    */
   void
   PrintHeader (std::ostream &os) const;
-  
+
+  /**
+   * @brief Print delay quantiles of the current averaging period
+   *
+   * @param os reference to output stream
+   */
+  void
+  Print (std::ostream &os) const;
+
+  /**
+   * @brief Aggregate delays over the period instead of writing one row per received Data
+   *
+   * Has to be called before the output header is printed. A zero period switches back to per-packet rows.
+   */
+  void
+  SetAveragingPeriod (const Time &period);
+
 private:
   void
   Connect ();
 
+  void
+  Reset ();
+
+  void
+  PeriodicPrinter ();
+
   void 
   LastRetransmittedInterestDataDelay (Ptr<App> app, uint32_t seqno, Time delay, int32_t hopCount);
   
@@ -101,6 +193,10 @@ private:
   Ptr<Node> m_nodePtr;
 
   boost::shared_ptr<std::ostream> m_os;
+
+  Time m_period;
+  EventId m_printEvent;
+  std::map<uint32_t, app_delay::Stats> m_stats; // by app id
 };
 
 } // namespace ndn
@@ -0,0 +1,165 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_FLOW_MONITOR_H
+#define NDN_FLOW_MONITOR_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/histogram.h"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace ns3 {
+
+class Node;
+class Packet;
+class NodeContainer;
+
+namespace ndn {
+
+class App;
+class Face;
+class Interest;
+class ContentObject;
+
+/**
+ * @ingroup ndn
+ * @brief Flow-level statistics of NDN consumers, modelled on ns3::FlowMonitor
+ *
+ * Every consumer application (ndn::Consumer and its subclasses) is a flow of its prefix. For every flow, the monitor
+ * records the time of the first Interest, of the first Data and, for flows bounded by the MaxSeq attribute, of the
+ * completion (Data for all MaxSeq sequence numbers received), the number of Interests, Data and NACKs, the received
+ * payload bytes and the distribution of the delay between the first Interest for a sequence number and its Data.
+ *
+ * All statistics are kept in memory, in histograms with at most MaxBins bins each (larger values are counted in the
+ * last bin), and written as one XML file: one \<Flow\> element per consumer, followed by one \<Prefix\> element per
+ * prefix with the histograms of the flow completion times and of the goodputs of its flows.
+ *
+ * Example:
+ *
+ * \code
+ * ndn::FlowMonitor::InstallAll ("flows.xml"); // written on Simulator::Destroy
+ * Simulator::Run ();
+ * Simulator::Destroy ();
+ * \endcode
+ */
+class FlowMonitor : public Object
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  FlowMonitor ();
+
+  /**
+   * @brief Install the monitor on all consumer applications of all nodes and write the statistics to the file on
+   *        Simulator::Destroy
+   *
+   * Applications have to be installed before calling this method.
+   *
+   * @returns the monitor, e.g., to serialize intermediate statistics (not necessary to keep it otherwise)
+   */
+  static Ptr<FlowMonitor>
+  InstallAll (const std::string &file);
+
+  /**
+   * @brief Start monitoring all consumer applications of the nodes
+   */
+  void
+  Install (const NodeContainer &nodes);
+
+  /**
+   * @brief Start monitoring all consumer applications of the node
+   */
+  void
+  Install (Ptr<Node> node);
+
+  /**
+   * @brief Start monitoring the application, if it is a consumer
+   * @returns true, if the application is monitored
+   */
+  bool
+  Install (Ptr<App> app);
+
+  void
+  SerializeToXmlStream (std::ostream &os, int indent) const;
+
+  void
+  SerializeToXmlFile (const std::string &fileName) const;
+
+private:
+  struct FlowStats
+  {
+    FlowStats (double delayBinWidth);
+
+    std::string node;
+    uint32_t appId;
+    std::string prefix;
+    uint32_t maxSeq;            // std::numeric_limits<uint32_t>::max () for unbounded flows
+
+    Time timeFirstInterest;
+    Time timeFirstData;
+    Time timeLastData;
+    Time timeCompleted;
+    bool started;
+    bool completed;
+
+    uint32_t interests;         // transmitted Interests, including retransmissions
+    uint32_t data;              // received Data for own requests (one per sequence number)
+    uint32_t nacks;             // NACKs for own Interests
+    uint64_t rxBytes;           // payload of data
+    uint32_t lastPayloadSize;   // payload of the Data being received
+
+    Histogram delayHistogram;   // delay between first Interest and Data (seconds)
+  };
+
+  void
+  AddValue (Histogram &histogram, double value) const;
+
+  void
+  TransmittedInterest (uint32_t flow, Ptr<const Interest> interest, Ptr<App> app, Ptr<Face> face);
+
+  void
+  ReceivedContentObject (uint32_t flow, Ptr<const ContentObject> contentObject, Ptr<const Packet> payload,
+                         Ptr<App> app, Ptr<Face> face);
+
+  void
+  ReceivedNack (uint32_t flow, Ptr<const Interest> interest, Ptr<App> app, Ptr<Face> face);
+
+  void
+  FirstInterestDataDelay (uint32_t flow, Ptr<App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount);
+
+private:
+  std::vector<FlowStats> m_flowStats;
+
+  double m_delayBinWidth;
+  double m_fctBinWidth;
+  double m_goodputBinWidth;
+  uint32_t m_maxBins;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_FLOW_MONITOR_H
@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/core-config.h"
 
 #define noBUFFER_FREE_LIST 1
 
@@ -611,7 +612,11 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
+#ifdef NS3_MULTITHREADED
+  static __thread uint32_t g_recommendedStart;
+#else
   static uint32_t g_recommendedStart;
+#endif
 
   /* offset to the start of the virtual zero area from the start 
    * of m_data->m_data
@@ -129,6 +129,61 @@ PacketTagList::Remove (Tag &tag)
   return true;
 }
 
+bool
+PacketTagList::Replace (Tag const&tag)
+{
+  NS_LOG_FUNCTION (this << &tag);
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_ASSERT (tag.GetSerializedSize () <= PACKET_TAG_MAX_SIZE);
+  /**
+   * A TagData is private to this list only if it and all the TagData
+   * before it have a count of 1: a shared TagData is also reached
+   * through the lists sharing it.
+   */
+  bool shared = false;
+  struct TagData *target = m_next;
+  for (; target != 0; target = target->next)
+    {
+      shared = shared || target->count > 1;
+      if (target->tid == tid)
+        {
+          break;
+        }
+    }
+  if (target == 0)
+    {
+      Add (tag);
+      return false;
+    }
+  if (shared)
+    {
+      // copy-on-write: copy the TagData up to the target, share the rest
+      struct TagData *start = 0;
+      struct TagData **prevNext = &start;
+      struct TagData *copy = 0;
+      for (struct TagData *cur = m_next; cur != target->next; cur = cur->next)
+        {
+          copy = AllocData ();
+          copy->tid = cur->tid;
+          copy->count = 1;
+          copy->next = 0;
+          std::memcpy (copy->data, cur->data, PACKET_TAG_MAX_SIZE);
+          *prevNext = copy;
+          prevNext = &copy->next;
+        }
+      copy->next = target->next;
+      if (copy->next != 0)
+        {
+          copy->next->count++;
+        }
+      RemoveAll ();
+      m_next = start;
+      target = copy;
+    }
+  tag.Serialize (TagBuffer (target->data, target->data+tag.GetSerializedSize ()));
+  return true;
+}
+
 void 
 PacketTagList::Add (const Tag &tag) const
 {
@@ -173,5 +228,24 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+PacketTagList
+PacketTagList::CreateFullCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  struct TagData **last = &copy.m_next;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *data = AllocData ();
+      data->tid = cur->tid;
+      data->count = 1;
+      data->next = 0;
+      std::memcpy (data->data, cur->data, PACKET_TAG_MAX_SIZE);
+      *last = data;
+      last = &data->next;
+    }
+  return copy;
+}
+
 } // namespace ns3
 
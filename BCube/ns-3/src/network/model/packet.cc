@@ -28,7 +28,11 @@ NS_LOG_COMPONENT_DEFINE ("Packet");
 
 namespace ns3 {
 
+#ifdef NS3_MULTITHREADED
+__thread uint32_t Packet::m_globalUid = 0;
+#else
 uint32_t Packet::m_globalUid = 0;
+#endif
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -137,6 +141,19 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::CreateFullCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p = Copy ();
+  p->m_buffer = m_buffer.CreateFullCopy ();
+  p->m_packetTagList = m_packetTagList.CreateFullCopy ();
+
+  p->m_byteTagList = ByteTagList ();
+  p->m_byteTagList.Add (m_byteTagList); // copies tag data
+  return p;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -884,6 +901,13 @@ Packet::PeekPacketTag (Tag &tag) const
   bool found = m_packetTagList.Peek (tag);
   return found;
 }
+bool 
+Packet::ReplacePacketTag (const Tag &tag)
+{
+  NS_LOG_FUNCTION (this << &tag);
+  bool found = m_packetTagList.Replace (tag);
+  return found;
+}
 void 
 Packet::RemoveAllPacketTags (void)
 {
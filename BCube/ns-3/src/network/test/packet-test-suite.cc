@@ -79,6 +79,37 @@ public:
     : ATestTagBase () {}
 };
 
+class AValueTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void) {
+    static TypeId tid = TypeId ("anon::AValueTag")
+      .SetParent<Tag> ()
+      .AddConstructor<AValueTag> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 1;
+  }
+  virtual void Serialize (TagBuffer buf) const {
+    buf.WriteU8 (m_value);
+  }
+  virtual void Deserialize (TagBuffer buf) {
+    m_value = buf.ReadU8 ();
+  }
+  virtual void Print (std::ostream &os) const {
+    os << (uint32_t)m_value;
+  }
+  AValueTag (uint8_t value = 0)
+    : m_value (value) {}
+  uint8_t m_value;
+};
+
 class ATestHeaderBase : public Header
 {
 public:
@@ -420,6 +451,31 @@ PacketTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (b), false, "trivial");
   }
 
+  {
+    // replace a packet tag in place and in a list shared with a copy
+    Packet p;
+    p.AddPacketTag (ATestTag<10> ());
+    NS_TEST_EXPECT_MSG_EQ (p.ReplacePacketTag (AValueTag (1)), false, "tag is added");
+    p.AddPacketTag (ATestTag<11> ());
+    AValueTag v;
+    NS_TEST_EXPECT_MSG_EQ (p.ReplacePacketTag (AValueTag (2)), true, "tag is replaced");
+    p.PeekPacketTag (v);
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)v.m_value, 2, "in place");
+    Packet copy = p;
+    NS_TEST_EXPECT_MSG_EQ (copy.ReplacePacketTag (AValueTag (3)), true, "tag is replaced");
+    copy.PeekPacketTag (v);
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)v.m_value, 3, "copy-on-write");
+    p.PeekPacketTag (v);
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)v.m_value, 2, "original is not modified");
+    ATestTag<10> a;
+    NS_TEST_EXPECT_MSG_EQ (copy.PeekPacketTag (a), true, "tags after the replaced one are kept");
+    NS_TEST_EXPECT_MSG_EQ (copy.RemovePacketTag (a), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (a), true, "shared tags are not modified");
+    p.ReplacePacketTag (AValueTag (4));
+    copy.PeekPacketTag (v);
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)v.m_value, 3, "copy is not modified");
+  }
+
   {
     // bug 572
     Ptr<Packet> tmp = Create<Packet> (1000);
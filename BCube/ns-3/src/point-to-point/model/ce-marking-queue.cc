@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ce-marking-queue.h"
+#include "ppp-header.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+NS_LOG_COMPONENT_DEFINE ("CeMarkingQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CeMarkingQueue);
+
+TypeId
+CeMarkingQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CeMarkingQueue")
+    .SetParent<DropTailQueue> ()
+    .AddConstructor<CeMarkingQueue> ()
+
+    .AddAttribute ("MarkingThreshold",
+                   "Queue occupancy (packets or bytes, according to Mode) at which packets are marked",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&CeMarkingQueue::m_markingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+
+    .AddTraceSource ("Mark", "Packet has been marked with Congestion Experienced",
+                     MakeTraceSourceAccessor (&CeMarkingQueue::m_markTrace))
+    ;
+  return tid;
+}
+
+CeMarkingQueue::CeMarkingQueue ()
+  : m_markingThreshold (20)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CeMarkingQueue::~CeMarkingQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::map<uint16_t, CeMarkingQueue::Marker> &
+CeMarkingQueue::GetMarkers (void)
+{
+  // markers are registered during static initialization of other modules
+  static std::map<uint16_t, Marker> markers;
+  return markers;
+}
+
+void
+CeMarkingQueue::SetMarker (uint16_t protocol, Marker marker)
+{
+  GetMarkers ()[protocol] = marker;
+}
+
+bool
+CeMarkingQueue::IsAboveThreshold (void)
+{
+  if (GetMode () == QUEUE_MODE_BYTES)
+    {
+      return GetNBytes () >= m_markingThreshold;
+    }
+  return GetNPackets () >= m_markingThreshold;
+}
+
+bool
+CeMarkingQueue::DoEnqueue (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (IsAboveThreshold () && Mark (p))
+    {
+      m_markTrace (p);
+    }
+
+  return DropTailQueue::DoEnqueue (p);
+}
+
+bool
+CeMarkingQueue::Mark (Ptr<Packet> p)
+{
+  PppHeader ppp;
+  p->PeekHeader (ppp);
+  std::map<uint16_t, Marker>::const_iterator marker = GetMarkers ().find (ppp.GetProtocol ());
+  if (marker == GetMarkers ().end ())
+    {
+      return false;
+    }
+
+  p->RemoveHeader (ppp);
+  bool marked = marker->second (p);
+  p->AddHeader (ppp);
+  return marked;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef CE_MARKING_QUEUE_H
+#define CE_MARKING_QUEUE_H
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/traced-callback.h"
+#include "ns3/callback.h"
+
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ *
+ * \brief DropTail queue that marks packets with Congestion Experienced when queue occupancy crosses a threshold
+ *
+ * The queue is meant to be installed on PointToPointNetDevices.  Similar to DCTCP
+ * switches, marking is based on the instantaneous occupancy: if there are at least
+ * MarkingThreshold packets (or bytes, depending on the Mode attribute of DropTailQueue)
+ * already in the queue, the enqueued frame is passed without its PPP header to the
+ * marker registered for its PPP protocol number.  Frames of other protocols are only
+ * subject to the tail drop.
+ *
+ * The queue does not know the network layer headers, the markers are registered by
+ * their users: ndnSIM sets CE byte of Data packets (PPP protocol 0x0077) when it is
+ * loaded, a TCP scenario registers the marker of ECN-capable IPv4 packets (PPP
+ * protocol 0x0021) itself, see scratch/tcp-incast-bcube-4-1.cc.  So a link shared
+ * by TCP and NDN traffic can mark both.
+ *
+ * Example:
+ *
+ * \code
+ * Config::SetDefault ("ns3::CeMarkingQueue::MarkingThreshold", UintegerValue (20));
+ * PointToPointHelper p2p;
+ * p2p.SetQueue ("ns3::CeMarkingQueue");
+ * \endcode
+ */
+class CeMarkingQueue : public DropTailQueue
+{
+public:
+  /**
+   * \brief Sets the congestion mark of a network layer packet, returns true if the packet was marked
+   *
+   * The marker must not change the size of the packet, so that byte accounting of the queue
+   * stays correct.
+   */
+  typedef Callback<bool, Ptr<Packet> > Marker;
+
+  static TypeId GetTypeId (void);
+
+  CeMarkingQueue ();
+  virtual ~CeMarkingQueue ();
+
+  /**
+   * \brief Register the marker of packets carried in PPP frames with the given protocol number
+   */
+  static void SetMarker (uint16_t protocol, Marker marker);
+
+protected:
+  // from DropTailQueue
+  virtual bool DoEnqueue (Ptr<Packet> p);
+
+private:
+  // Check whether occupancy of the queue is above the marking threshold
+  bool IsAboveThreshold (void);
+
+  // Pass the packet carried by the PPP frame to the marker of its protocol, returns true if the packet was marked
+  bool Mark (Ptr<Packet> p);
+
+  static std::map<uint16_t, Marker> &GetMarkers (void);
+
+private:
+  uint32_t m_markingThreshold;
+
+  TracedCallback<Ptr<const Packet> > m_markTrace;
+};
+
+} // namespace ns3
+
+#endif /* CE_MARKING_QUEUE_H */
@@ -22,8 +22,14 @@
 #include "ns3/point-to-point-loss-model.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/core-config.h"
+
+#ifdef NS3_MULTITHREADED
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointChannel");
 
@@ -123,7 +129,17 @@ PointToPointChannel::TransmitStart (
   //   }
   // continue normal operations
   
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  Ptr<Node> dstNode = m_link[wire].m_dst->GetNode ();
+#ifdef NS3_MULTITHREADED
+  if (MultithreadedSimulatorImpl::IsRunning () &&
+      dstNode->GetSystemId () != src->GetNode ()->GetSystemId ())
+    {
+      // the receiving partition runs in another thread, which must not
+      // share datasets of the packet with this one
+      p = p->CreateFullCopy ();
+    }
+#endif
+  Simulator::ScheduleWithContext (dstNode->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
 
@@ -41,7 +41,6 @@ main (int argc, char *argv[])
 {
 	int simulation_time = 400;
 	//int no_flow = 2;	//number of DATA flows, at most 8 (we have 16 servers)
-	srand(time(0));
   // setting default parameters for PointToPoint links and channels
   Config::SetDefault ("ns3::ndn::fw::Nacks::EnableNACKs", BooleanValue (true));
   Config::SetDefault ("ns3::ndn::Limits::LimitsDeltaRate::UpdateInterval", StringValue ("1.0")); 
@@ -95,12 +94,13 @@ main (int argc, char *argv[])
   /*ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerOm");
   ApplicationContainer consumers;
   std::set<int> setExclude;
+  Ptr<UniformRandomVariable> server_rand = CreateObject<UniformRandomVariable> ();
   for(int k=0;k!=no_flow;k++)
   {
   	int v1, v2;
   	while(true)
   	{
-  		v1 = rand()%16;
+  		v1 = server_rand->GetInteger (0, 15);
   		if(setExclude.find(v1)==setExclude.end())
   		{
   			setExclude.insert(v1);
@@ -109,7 +109,7 @@ main (int argc, char *argv[])
   	}
   	while(true)
   	{
-  		v2 = rand()%16;
+  		v2 = server_rand->GetInteger (0, 15);
   		if( v2!=v1 && setExclude.find(v2)==setExclude.end())
   		{
   			setExclude.insert(v2);
@@ -127,6 +127,7 @@ Story::Story ()
   m_otherNodeCount = 0;
   m_loggingToFile = false;
   m_checkData = false;
+  m_virtualPayload = false;
 }
 
 Story::~Story ()
@@ -153,6 +154,11 @@ bool Story::GetCheckData () const
   return m_checkData;
 }
 
+bool Story::GetVirtualPayload () const
+{
+  return m_virtualPayload;
+}
+
 uint32_t Story::GetBTNodeCount () const
 {
   return m_btNodeCount;
@@ -1523,6 +1529,7 @@ void Story::ReadAndScheduleStory (std::string filePath, uint32_t simulationDurat
                           btclient->SetStartTime (Seconds (simulationDuration));                             // So the applications don't start when not ordered to
                           btclient->SetStopTime (Seconds (simulationDuration - 1));
                           btclient->SetCheckDownloadedData (m_checkData);
+                          btclient->SetVirtualPayload (m_virtualPayload);
 
 #ifdef NS3_MPI
                           if (PeekPointer (*it)->GetSystemId () == MpiInterface::GetSystemId ())
@@ -1799,6 +1806,7 @@ void Story::ReadAndScheduleStory (std::string filePath, uint32_t simulationDurat
                       btclient->SetStartTime (Seconds (simulationDuration - 1)); // So the applications don't start when not ordered to
                       btclient->SetStopTime (Seconds (simulationDuration));
                       btclient->SetCheckDownloadedData (m_checkData);
+                      btclient->SetVirtualPayload (m_virtualPayload);
 
 #ifdef NS3_MPI
                       if (PeekPointer (*it)->GetSystemId () == MpiInterface::GetSystemId ())
@@ -2132,6 +2140,25 @@ void Story::ReadAndScheduleStory (std::string filePath, uint32_t simulationDurat
                       NS_ABORT_MSG ("[line " << currentLine << "] Error: Don't know whether to check downloaded Data or not.");
                     }
                 }
+              else if (buffer == "virtualpayload")
+                {
+                  lineBuffer >> buffer;
+
+                  if (buffer == "1")
+                    {
+                      m_virtualPayload = true;
+                      std::cout << "		Clients will send the data of PIECE messages as virtual TCP payload."<< std::endl;
+                    }
+                  else if (buffer == "0")
+                    {
+                      m_virtualPayload = false;
+                      std::cout << "		Clients will send the data of PIECE messages as real TCP payload."<< std::endl;
+                    }
+                  else
+                    {
+                      NS_ABORT_MSG ("[line " << currentLine << "] Error: Don't know whether to send virtual payload or not.");
+                    }
+                }
               else
                 {
                   NS_ABORT_MSG ("[line " << currentLine << "] Error: Don't know what to set for the simulation.");
@@ -102,6 +102,7 @@ private:
   bool                       m_loggingToFile;              // Whether to direct logging output to a file or the screen
   bool                       m_useFakeData;                // Whether to use fake data or not
   bool                       m_checkData;                  // Whether to check the data upon reception
+  bool                       m_virtualPayload;             // Whether to send the data of PIECE messages as virtual TCP payload
   uint32_t                   m_btNodeCount;                // The number of nodes hosting BitTorrentClients
   uint32_t                   m_otherNodeCount;             // The number of other nodes in the simulation
   std::string                m_torrentFolder;              // The folder in which the torrent data resides
@@ -251,6 +252,12 @@ public:
    */
   bool GetCheckData () const;
 
+  /**
+   * @returns true, if the BitTorrentClient class shall be configured to send the data of PIECE messages as virtual TCP payload.
+   * Received data is not checked for checksum errors then.
+   */
+  bool GetVirtualPayload () const;
+
   /**
    * @returns the number of nodes containing instances of the BitTorrentClient class.
    */
@@ -130,6 +130,7 @@ private:
   // Time                                 m_postPieceTimeoutPatience;   // A currently unused attribute for a work-in-progress heuristic in the base part selection strategy
 
   bool                                 m_checkDownloadedData;        // Whether to perform SHA-1 checks on downloaded pieces
+  bool                                 m_virtualPayload;             // Whether to send the data of PIECE messages as virtual TCP payload
 
   // Internal derived variables (stored for faster access to them)
   uint32_t                             m_piecesCompleted;            // Number of pieces downloaded so far
@@ -647,6 +648,29 @@ public:
    */
   void SetCheckDownloadedData (bool checkDownloadedData);
 
+  /**
+   * @returns true, if the data of PIECE messages is sent as virtual payload.
+   */
+  bool GetVirtualPayload () const
+  {
+    return m_virtualPayload;
+  }
+
+  /**
+   * \brief Control whether the data of PIECE messages is sent as virtual payload.
+   *
+   * If set, the blocks sent by the client are handed to TCP as byte counts (see TcpVirtualPayloadTag) instead of copies of the
+   * shared data. TCP then neither copies nor fragments nor re-assembles the payload data of these segments, which results in a
+   * considerable simulation speedup for large swarms. The Peer Wire messages themselves, including the header of each PIECE
+   * message, are still sent as real data, so the message framing is exact.
+   *
+   * Since the content of virtual payload is not transmitted, received blocks consisting (partly) of virtual payload are not checked,
+   * regardless of SetCheckDownloadedData. Receiving virtual payload does not need any configuration.
+   *
+   * @param virtualPayload whether to send the data of PIECE messages as virtual payload
+   */
+  void SetVirtualPayload (bool virtualPayload);
+
   // Internal derived variables
 
   /**
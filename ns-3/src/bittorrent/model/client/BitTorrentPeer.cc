@@ -29,7 +29,9 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
+#include "ns3/simulator.h"
 #include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-virtual-payload-tag.h"
 #include "ns3/uinteger.h"
 
 #include <cstring> // for memcpy
@@ -42,6 +44,42 @@ namespace bittorrent {
 NS_LOG_COMPONENT_DEFINE ("bittorrent::Peer");
 NS_OBJECT_ENSURE_REGISTERED (Peer);
 
+namespace {
+
+void
+WriteU32 (uint8_t *buffer, uint32_t value)
+{
+  buffer[0] = (value >> 24) & 0xff;
+  buffer[1] = (value >> 16) & 0xff;
+  buffer[2] = (value >> 8) & 0xff;
+  buffer[3] = value & 0xff;
+}
+
+/*
+ * Create a Peer Wire message without payload from its bytes, i.e., a packet with a single buffer, instead of
+ * adding the message, type and length headers to an empty packet one by one. The bytes are the same.
+ */
+Ptr<Packet>
+CreateMessage (BitTorrentTypeHeader::BitTorrentMessageType type, uint32_t fields = 0, uint32_t field0 = 0, uint32_t field1 = 0, uint32_t field2 = 0)
+{
+  NS_ASSERT (fields <= 3);
+
+  uint8_t buffer[BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + BT_PROTOCOL_MESSAGES_REQUEST_LENGTH];
+  uint32_t values[3] = { field0, field1, field2 };
+  uint32_t length = 1 + 4 * fields;
+
+  WriteU32 (buffer, length);
+  buffer[BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH] = static_cast<uint8_t> (type);
+  for (uint32_t i = 0; i < fields; ++i)
+    {
+      WriteU32 (buffer + BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + 1 + 4 * i, values[i]);
+    }
+
+  return Create<Packet> (buffer, BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + length);
+}
+
+} // namespace
+
 Peer::Peer (Ptr<BitTorrentClient> myClient)
 {
   // Main attributes
@@ -59,11 +97,7 @@ Peer::Peer (Ptr<BitTorrentClient> myClient)
     {
       bitfieldSize++;
     }
-  m_bitfield.resize (bitfieldSize);
-  for (uint8_t i = 0; i < bitfieldSize; ++i)
-    {
-      m_bitfield[i] = 0;
-    }
+  m_bitfield.assign (bitfieldSize, 0);
 
   m_pieceCorruptionMap = new uint8_t [m_myClient->GetTorrent ()->GetNumberOfPieces ()];
   for (uint32_t i = 0; i < m_myClient->GetTorrent ()->GetNumberOfPieces (); i++)
@@ -74,8 +108,7 @@ Peer::Peer (Ptr<BitTorrentClient> myClient)
 
   // Packet reception members and corresponding state machine attributes
   m_packetBuffer = Create<Packet> ();
-  m_lengthHeader.SetPacketLength (BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH);
-  m_lengthHeaderRemoved = false;
+  m_packetBufferVirtual = 0;
   m_blockBuffer = 0;
   m_blockBufferSize = 0;
 
@@ -170,12 +203,8 @@ void Peer::ServeNewPeer (Ptr<Socket> socket, Ipv4Address address, uint16_t port)
 
   // <-- Step 3: Since the other client is already initialized (remote establishment of connection), we await the BitTorrent handshake packet and prepare to send ours
 
-  // Step 4: Add the announcement message to the send queue
-  m_sendQueue.push_back (announcementPacket);
-  m_sendQueuePieceMessageIndicators.push_back (false);
-
-  // Step 5: Send out the announcement by processing the send queue
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  // Step 4: Add the announcement message to the send queue, it is sent out by processing the send queue
+  EnqueueMessage (announcementPacket, false);
 }
 
 void Peer::CloseConnection (bool silent)
@@ -217,33 +246,13 @@ void Peer::RequestPiece (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t blo
       return;
     }
 
-  // Step 1: Create a packet
-  Ptr<Packet> packet = Create<Packet> ();
-
-  // Step 2: Create a BitTorrentLengthHeader so we can read out the length of the message properly again at the remote Peer
-  BitTorrentLengthHeader lenHead;
-  lenHead.SetPacketLength (BT_PROTOCOL_MESSAGES_REQUEST_LENGTH);
-
-  // Step 3: Create a BitTorrentTypeHeader so we can read out the type of the message properly again at the remote Peer
-  BitTorrentTypeHeader typeHead;
-  typeHead.SetMessageType (BitTorrentTypeHeader::REQUEST);
-
-  // Step 4: Create the message specific to this call (in this case, a REQUEST message)
-  BitTorrentRequestMessage reqMsg (pieceIndex,blockOffSet,blockLength);
+  // Step 1: Create the message (in this case, a REQUEST message), consisting of the length, the type and the message specific to this call
+  Ptr<Packet> packet = CreateMessage (BitTorrentTypeHeader::REQUEST, 3, pieceIndex, blockOffSet, blockLength);
 
-  // Step 5: Combine the headers from steps 2..4 by adding them to the created packet
-  packet->AddHeader (reqMsg);
-  packet->AddHeader (typeHead);
-  packet->AddHeader (lenHead);
-
-  // Step 6: Enqueue the packet
-  // Step 6a: Insert it into the send queue
-  m_sendQueue.push_back (packet);
-  // Step 6b: Indicate that this message is NOT a PIECE message (which is handled differently)
-  m_sendQueuePieceMessageIndicators.push_back (false);
+  NS_LOG_INFO ("Peer: Sending out request to " << GetRemoteIp () << "; for " << pieceIndex << "@" << blockOffSet << "->" << blockOffSet + blockLength << ".");
 
-  // Step 7: Send out messages in the send queue
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  // Step 2: Enqueue the packet; it is sent out together with the other messages of this event
+  EnqueueMessage (packet, false);
 }
 
 void Peer::CancelRequest (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t blockLength)
@@ -253,45 +262,10 @@ void Peer::CancelRequest (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t bl
       return;
     }
 
-  Ptr<Packet> packet = Create<Packet> ();
-
-  BitTorrentLengthHeader lenHead;
-  lenHead.SetPacketLength (BT_PROTOCOL_MESSAGES_CANCEL_LENGTH);
-  BitTorrentTypeHeader typeHead;
-  typeHead.SetMessageType (BitTorrentTypeHeader::CANCEL);
-  BitTorrentCancelMessage canMsg (pieceIndex, blockOffSet, blockLength);
-
-  packet->AddHeader (canMsg);
-  packet->AddHeader (typeHead);
-  packet->AddHeader (lenHead);
+  Ptr<Packet> packet = CreateMessage (BitTorrentTypeHeader::CANCEL, 3, pieceIndex, blockOffSet, blockLength);
 
   // Prioritized sending
-  if (m_blockSendingActive)      // Insert the cancel request right at the beginning but after the currently sending block
-    {
-      std::list<Ptr<Packet> >::iterator sendQueueIt = m_sendQueue.begin ();
-      std::list<bool>::iterator sendQueuePieceMessageIndicatorsIt = m_sendQueuePieceMessageIndicators.begin ();
-
-      ++sendQueueIt;
-      ++sendQueuePieceMessageIndicatorsIt;
-
-      if (sendQueueIt == m_sendQueue.end ())
-        {
-          m_sendQueue.push_back (packet);
-          m_sendQueuePieceMessageIndicators.push_back (false);
-        }
-      else
-        {
-          m_sendQueue.insert (sendQueueIt, packet);
-          m_sendQueuePieceMessageIndicators.insert (sendQueuePieceMessageIndicatorsIt, false);
-        }
-    }
-  else
-    {
-      m_sendQueue.push_front (packet);
-      m_sendQueuePieceMessageIndicators.push_front (false);
-    }
-
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, true);
 }
 
 void Peer::SendBitfield ()
@@ -314,10 +288,7 @@ void Peer::SendBitfield ()
   packet->AddHeader (typeHead);
   packet->AddHeader (lenHead);
 
-  m_sendQueue.push_back (packet);
-  m_sendQueuePieceMessageIndicators.push_back (false);
-
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, false);
 }
 
 void Peer::SendHaveMessage (uint32_t pieceIndex)
@@ -327,45 +298,10 @@ void Peer::SendHaveMessage (uint32_t pieceIndex)
       return;
     }
 
-  Ptr<Packet> packet = Create<Packet> ();
-
-  BitTorrentLengthHeader lenHead;
-  BitTorrentTypeHeader typeHead;
-  BitTorrentHaveMessage haveMsg (pieceIndex);
-  lenHead.SetPacketLength (BT_PROTOCOL_MESSAGES_HAVE_LENGTH);
-  typeHead.SetMessageType (BitTorrentTypeHeader::HAVE);
-
-  packet->AddHeader (haveMsg);
-  packet->AddHeader (typeHead);
-  packet->AddHeader (lenHead);
+  Ptr<Packet> packet = CreateMessage (BitTorrentTypeHeader::HAVE, 1, pieceIndex);
 
   // Prioritized sending
-  if (m_blockSendingActive)      // Insert the have message right at the beginning but after the currently sending block
-    {
-      std::list<Ptr<Packet> >::iterator sendQueueIt = m_sendQueue.begin ();
-      std::list<bool>::iterator sendQueuePieceMessageIndicatorsIt = m_sendQueuePieceMessageIndicators.begin ();
-
-      ++sendQueueIt;
-      ++sendQueuePieceMessageIndicatorsIt;
-
-      if (sendQueueIt == m_sendQueue.end ())
-        {
-          m_sendQueue.push_back (packet);
-          m_sendQueuePieceMessageIndicators.push_back (false);
-        }
-      else
-        {
-          m_sendQueue.insert (sendQueueIt, packet);
-          m_sendQueuePieceMessageIndicators.insert (sendQueuePieceMessageIndicatorsIt, false);
-        }
-    }
-  else
-    {
-      m_sendQueue.push_front (packet);
-      m_sendQueuePieceMessageIndicators.push_front (false);
-    }
-
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, true);
 }
 
 void Peer::SetAmChoking (bool amChoking)
@@ -384,14 +320,11 @@ void Peer::SendBlock (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t blockL
   reqInfo.blockOffSet = blockOffSet;
   reqInfo.blockLength = std::min (m_myClient->GetTorrent ()->GetPieceLength () - blockOffSet, blockLength);
 
-  Ptr<Packet> dummyPacket = Create<Packet> ();
-
-  m_sendQueue.push_back (dummyPacket);
-  m_sendQueuePieceMessageIndicators.push_back (true);
+  m_sendQueue.push_back (SendQueueItem (0, true));
   m_requestQueue.push_back (reqInfo);
 
-  // Blocks (PIECE messages) are handled separately by HandleSend, just call it
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  // Blocks (PIECE messages) are handled separately by HandleSend, just schedule it
+  ScheduleSend ();
 }
 
 void Peer::SendExtendedMessage (uint8_t messageId, const std::string& message)
@@ -413,10 +346,7 @@ void Peer::SendExtendedMessage (uint8_t messageId, const std::string& message)
   packet->AddHeader (typeHead);
   packet->AddHeader (lenHead);
 
-  m_sendQueue.push_back (packet);
-  m_sendQueuePieceMessageIndicators.push_back (false);
-
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, false);
 }
 
 Ipv4Address Peer::GetRemoteIp () const
@@ -509,27 +439,9 @@ void Peer::NotifyPeerOfChokeChange ()
       return;
     }
 
-  Ptr<Packet> packet = Create<Packet> ();
-
-  BitTorrentLengthHeader lenHead;
-  lenHead.SetPacketLength (BT_PROTOCOL_MESSAGES_CHOKE_LENGTH);
-  BitTorrentTypeHeader typeHead;
-  if (m_amChoking)
-    {
-      typeHead.SetMessageType (BitTorrentTypeHeader::CHOKE);
-    }
-  else
-    {
-      typeHead.SetMessageType (BitTorrentTypeHeader::UNCHOKE);
-    }
-
-  packet->AddHeader (typeHead);
-  packet->AddHeader (lenHead);
-
-  m_sendQueue.push_back (packet);
-  m_sendQueuePieceMessageIndicators.push_back (false);
+  Ptr<Packet> packet = CreateMessage (m_amChoking ? BitTorrentTypeHeader::CHOKE : BitTorrentTypeHeader::UNCHOKE);
 
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, false);
 }
 
 void Peer::NotifyPeerOfInterestedChange ()
@@ -539,41 +451,19 @@ void Peer::NotifyPeerOfInterestedChange ()
       return;
     }
 
-  Ptr<Packet> packet = Create<Packet> ();
-
-  BitTorrentLengthHeader lenHead;
-  lenHead.SetPacketLength (BT_PROTOCOL_MESSAGES_INTERESTED_LENGTH);
-  BitTorrentTypeHeader typeHead;
-  if (m_amInterested)
-    {
-      typeHead.SetMessageType (BitTorrentTypeHeader::INTERESTED);
-    }
-  else
-    {
-      typeHead.SetMessageType (BitTorrentTypeHeader::NOT_INTERESTED);
-    }
-
-  packet->AddHeader (typeHead);
-  packet->AddHeader (lenHead);
-
-  m_sendQueue.push_back (packet);
-  m_sendQueuePieceMessageIndicators.push_back (false);
+  Ptr<Packet> packet = CreateMessage (m_amInterested ? BitTorrentTypeHeader::INTERESTED : BitTorrentTypeHeader::NOT_INTERESTED);
 
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (packet, false);
 }
 
-void Peer::HandleCancel (Ptr<Packet> packet)
+void Peer::HandleCancel (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t blockLength)
 {
-  BitTorrentCancelMessage cancelMsg;
-  packet->RemoveHeader (cancelMsg);
-
   RequestInformation reqInfo;
-  reqInfo.pieceIndex = cancelMsg.GetPieceIndex ();
-  reqInfo.blockOffSet = cancelMsg.GetBlockOffset ();
-  reqInfo.blockLength = cancelMsg.GetBlockLength ();
+  reqInfo.pieceIndex = pieceIndex;
+  reqInfo.blockOffSet = blockOffSet;
+  reqInfo.blockLength = blockLength;
 
-  std::list<bool>::iterator it = m_sendQueuePieceMessageIndicators.begin ();
-  std::list<Ptr<Packet> >::iterator it2 = m_sendQueue.begin ();
+  std::deque<SendQueueItem>::iterator it = m_sendQueue.begin ();
   std::list<RequestInformation>::iterator it3 = m_requestQueue.begin ();
 
   bool requestFound = false;
@@ -584,9 +474,9 @@ void Peer::HandleCancel (Ptr<Packet> packet)
       return;
     }
 
-  while (!requestFound && it != m_sendQueuePieceMessageIndicators.end () && it3 != m_requestQueue.end ())
+  while (!requestFound && it != m_sendQueue.end () && it3 != m_requestQueue.end ())
     {
-      if (*it)          // If we have found a scheduled PIECE message
+      if ((*it).isPiece)          // If we have found a scheduled PIECE message
         {
           if ((*it3) == reqInfo)              // If the information on that PIECE message matches CANCEL message...
             {
@@ -601,21 +491,19 @@ void Peer::HandleCancel (Ptr<Packet> packet)
 
       NS_ASSERT (!requestFound);
 
-      ++it;           // Next packet type indicator
-      ++it2;           // Next packet
+      ++it;           // Next packet
     }
 
   if (requestFound)
     {
-      m_sendQueuePieceMessageIndicators.erase (it);
-      m_sendQueue.erase (it2);
+      m_sendQueue.erase (it);
       m_requestQueue.erase (it3);
 
       m_myClient->PeerCancelEvent (this, reqInfo.pieceIndex, reqInfo.blockOffSet, reqInfo.blockLength);
     }
   else
     {
-      NS_LOG_INFO ("Peer: Received CANCEL for non-existing prior REQUEST: " << cancelMsg.GetPieceIndex () << "@" << cancelMsg.GetBlockOffset () << "->" << cancelMsg.GetBlockOffset () + cancelMsg.GetBlockLength () << ".");
+      NS_LOG_INFO ("Peer: Received CANCEL for non-existing prior REQUEST: " << pieceIndex << "@" << blockOffSet << "->" << blockOffSet + blockLength << ".");
     }
 }
 
@@ -636,15 +524,18 @@ bool Peer::HandlePiece (Ptr<Packet> packet, uint32_t packetLength)
       m_blockBufferSize = blockLength;
     }
 
+  // Virtual payload (see BitTorrentClient::SetVirtualPayload) follows the real data of the block, if any; it has no content to copy
   uint32_t dataToRead = std::min (packet->GetSize (),blockLength);
-  m_totalBytesDownloaded += dataToRead;
+  uint32_t virtualDataToRead = std::min (m_packetBufferVirtual, blockLength - dataToRead);
+  m_totalBytesDownloaded += dataToRead + virtualDataToRead;
 
   packet->CopyData (m_blockBuffer, dataToRead);
   packet->RemoveAtStart (dataToRead);
+  m_packetBufferVirtual -= virtualDataToRead;
 
-  if (blockLength - dataToRead == 0)
+  if (blockLength - dataToRead - virtualDataToRead == 0)
     {
-      if (m_myClient->GetCheckDownloadedData ())
+      if (m_myClient->GetCheckDownloadedData () && virtualDataToRead == 0)
         {
           if (std::memcmp (
                 m_blockBuffer,
@@ -679,7 +570,57 @@ void Peer::HandleRead (Ptr<Socket> socket)
   uint32_t available = socket->GetRxAvailable ();
   while (available > 0)
     {
-      m_packetBuffer->AddAtEnd (socket->Recv ());
+      Ptr<Packet> packet = socket->Recv ();
+      TcpVirtualPayloadTag virtualTag;
+      if (packet->PeekPacketTag (virtualTag))
+        {
+          // Virtual payload is only counted, it is consumed by HandlePiece as part of the current PIECE message
+          m_packetBufferVirtual += packet->GetSize ();
+        }
+      else
+        {
+          if (m_packetBufferVirtual > 0)
+            {
+              // Step 1: Handle all messages received so far, i.e., the current PIECE message may only be missing its last bytes now
+              ProcessPacketBuffer ();
+              if (!(m_connectionState == CONN_STATE_CONNECTED || m_connectionState == CONN_STATE_AWAIT_HANDSHAKE))
+                {
+                  return;
+                }
+
+              /*
+               * Step 2: TCP delivers virtual payload sharing a segment with real data zero-filled, so the beginning of this packet
+               * may still belong to the block: count it as virtual payload as well and handle the then complete PIECE message
+               */
+              BitTorrentMessageParser parser;
+              m_packetBuffer->PeekHeader (parser);
+              if (m_packetBufferVirtual > 0 && parser.GetMessages ().empty () && parser.HasNextMessage () &&
+                  parser.GetNextMessage ().m_type == BitTorrentTypeHeader::PIECE)
+                {
+                  uint32_t blockDataMissing = BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + parser.GetNextMessage ().m_length - m_packetBuffer->GetSize () - m_packetBufferVirtual;
+                  uint32_t blockData = std::min (blockDataMissing, packet->GetSize ());
+                  packet->RemoveAtStart (blockData);
+                  m_packetBufferVirtual += blockData;
+                  if (blockData == blockDataMissing)
+                    {
+                      ProcessPacketBuffer ();
+                      if (!(m_connectionState == CONN_STATE_CONNECTED || m_connectionState == CONN_STATE_AWAIT_HANDSHAKE))
+                        {
+                          return;
+                        }
+                    }
+                }
+
+              // Step 3: The remote peer sent virtual payload for something else than PIECE data; keep the framing exact nevertheless
+              if (m_packetBufferVirtual > 0 && packet->GetSize () > 0)
+                {
+                  NS_LOG_INFO ("Peer: Received real data from " << GetRemoteIp () << " while " << m_packetBufferVirtual << " bytes of virtual payload are pending.");
+                  m_packetBuffer->AddAtEnd (Create<Packet> (m_packetBufferVirtual));
+                  m_packetBufferVirtual = 0;
+                }
+            }
+          m_packetBuffer->AddAtEnd (packet);
+        }
 
       uint64_t currentSecond = static_cast<uint64_t> (Simulator::Now ().GetSeconds ());
       uint64_t currentSecondModulo = currentSecond % BT_PEER_DOWNLOADUPLOADRATE_ROLLING_AVERAGE_SECONDS;
@@ -696,178 +637,233 @@ void Peer::HandleRead (Ptr<Socket> socket)
       available = socket->GetRxAvailable ();
     }
 
-  while (m_packetBuffer->GetSize () >= m_lengthHeader.GetPacketLength ())
+  ProcessPacketBuffer ();
+}
+
+void Peer::ProcessPacketBuffer ()
+{
+  if (m_connectionState == CONN_STATE_AWAIT_HANDSHAKE)
     {
-      if (m_connectionState == CONN_STATE_AWAIT_HANDSHAKE)
+      /*
+       * RENE: Add way to Get protocol length from the packet first
+       * down here -------------------+ (Just as with BitTorrentLengthHeader, but 1 byte instead of 4)
+       *                              |
+       *                              v
+       */
+      if (m_packetBuffer->GetSize () >= BT_PROTOCOL_MESSAGES_HANDSHAKE_LENGTH_MIN + BT_PROTOCOL_MESSAGES_HANDSHAKE_PROTOCOL_STRING_LENGTH)
         {
-          /*
-           * RENE: Add way to Get protocol length from the packet first
-           * down here -------------------+ (Just as with BitTorrentLengthHeader, but 1 byte instead of 4)
-           *                              |
-           *                              v
-           */
-          if (m_packetBuffer->GetSize () >= BT_PROTOCOL_MESSAGES_HANDSHAKE_LENGTH_MIN + BT_PROTOCOL_MESSAGES_HANDSHAKE_PROTOCOL_STRING_LENGTH)
-            {
-              BitTorrentHandshakeMessage handshake;
-              m_packetBuffer->RemoveHeader (handshake);
+          BitTorrentHandshakeMessage handshake;
+          m_packetBuffer->RemoveHeader (handshake);
 
-              // Store data from packet
-              m_remotePeerId.append (reinterpret_cast<const char*> (handshake.GetPeerId ()),BT_PROTOCOL_MESSAGES_HANDSHAKE_PEERID_LENGTH_MAX);
+          // Store data from packet
+          m_remotePeerId.append (reinterpret_cast<const char*> (handshake.GetPeerId ()),BT_PROTOCOL_MESSAGES_HANDSHAKE_PEERID_LENGTH_MAX);
 
-              m_connectionEstablishmentTime = Simulator::Now ();
-              m_connectionState = CONN_STATE_CONNECTED;
+          m_connectionEstablishmentTime = Simulator::Now ();
+          m_connectionState = CONN_STATE_CONNECTED;
+        }
+      else
+        {
+          return;                   // We still wait for the completion of the handshake message
+        }
+    }
 
-              m_lengthHeader.SetPacketLength (BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH);
-            }
-          else
-            {
-              break;                   // We still wait for the completion of the handshake message
-            }
+  while (m_connectionState == CONN_STATE_CONNECTED)
+    {
+      // Step 1: Parse all complete messages without payload at the beginning of the buffer in place
+      BitTorrentMessageParser parser;
+      m_packetBuffer->PeekHeader (parser);
+
+      // Step 2: Handle them in order and remove them from the buffer at once
+      const std::vector<BitTorrentMessageParser::Message> &messages = parser.GetMessages ();
+      uint32_t consumed = 0;
+      for (std::vector<BitTorrentMessageParser::Message>::const_iterator it = messages.begin ();
+           it != messages.end () && m_connectionState == CONN_STATE_CONNECTED; ++it)
+        {
+          HandleMessage (*it);
+          consumed += BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + (*it).m_length;
         }
-      else if (m_connectionState == CONN_STATE_CONNECTED)
+      m_packetBuffer->RemoveAtStart (consumed);
+
+      // Step 3: Handle the following message with payload (BITFIELD, PIECE, EXTENDED), once it is complete (including virtual payload)
+      if (m_connectionState != CONN_STATE_CONNECTED || !parser.HasNextMessage ())
         {
-          if (!m_lengthHeaderRemoved)              // We have not yet inspected the beginning of the next message
-            {
-              NS_ASSERT (m_packetBuffer->GetSize () >= m_lengthHeader.GetPacketLength ());
+          break;
+        }
+      if (!parser.IsNextMessageComplete ()
+          && (parser.GetNextMessage ().m_type != BitTorrentTypeHeader::PIECE
+              || m_packetBuffer->GetSize () + m_packetBufferVirtual < BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + parser.GetNextMessage ().m_length))
+        {
+          break;
+        }
+      HandlePayloadMessage (parser.GetNextMessage ());
+    }
+}
 
-              m_packetBuffer->RemoveHeader (m_lengthHeader);
+void Peer::HandleMessage (const BitTorrentMessageParser::Message &message)
+{
+  switch (message.m_type)
+    {
+    case BitTorrentTypeHeader::KEEP_ALIVE:
+      {
+        break;
+      }
+    case BitTorrentTypeHeader::CHOKE:
+      {
+        if (!m_peerChoking)
+          {
+            m_peerChoking = true;
+
+            uint64_t currentSecond = static_cast<uint64_t> (Simulator::Now ().GetSeconds ());
+            uint64_t currentSecondModulo = currentSecond % BT_PEER_DOWNLOADUPLOADRATE_ROLLING_AVERAGE_SECONDS;
+            if (m_downloadHistoryReSetTime[currentSecondModulo] != currentSecond)
+              {
+                m_downloadHistoryReSetTime[currentSecondModulo] = currentSecond;
+                m_downloadHistory[currentSecondModulo] = 0;
+              }
+
+            m_myClient->PeerChokeChangingEvent (this);
+          }
+        break;
+      }
+    case BitTorrentTypeHeader::UNCHOKE:
+      {
+        if (m_peerChoking)
+          {
+            m_peerChoking = false;
+            m_myClient->PeerChokeChangingEvent (this);
+          }
+        break;
+      }
+    case BitTorrentTypeHeader::INTERESTED:
+      {
+        if (!m_peerInterested)
+          {
+            m_peerInterested = true;
+            m_myClient->PeerInterestedChangingEvent (this);
+          }
+        break;
+      }
+    case BitTorrentTypeHeader::NOT_INTERESTED:
+      {
+        if (m_peerInterested)
+          {
+            m_peerInterested = false;
+            m_myClient->PeerInterestedChangingEvent (this);
+          }
+        break;
+      }
+    case BitTorrentTypeHeader::HAVE:
+      {
+        uint32_t pieceIndex = message.m_fields[0];
+        if (pieceIndex >= m_myClient->GetTorrent ()->GetNumberOfPieces ())
+          {
+            NS_LOG_INFO ("Peer: Received a HAVE message for invalid piece " << pieceIndex << " from " << GetRemoteIp () << ".");
+            break;
+          }
+
+        m_bitfield[pieceIndex / 8] |= (1 << (7 - pieceIndex % 8));
+
+        m_myClient->PeerHaveEvent (this, pieceIndex);
+        break;
+      }
+    case BitTorrentTypeHeader::REQUEST:
+      {
+        m_myClient->PeerRequestEvent (this, message.m_fields[0], message.m_fields[1], message.m_fields[2]);
+        break;
+      }
+    case BitTorrentTypeHeader::CANCEL:
+      {
+        HandleCancel (message.m_fields[0], message.m_fields[1], message.m_fields[2]);
+        break;
+      }
+    case BitTorrentTypeHeader::PORT:
+      {
+        m_myClient->PeerPortMessageEvent (this, message.m_fields[0]);
+        break;
+      }
+    default:
+      {
+        break;
+      }
+    }
+}
 
-              if (m_lengthHeader.GetPacketLength () == 0)                 // We received a keep-alive message
-                {
-                  m_lengthHeader.SetPacketLength (BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH);                      // So we will end up in this same else if(!m_lengthHeaderRemoved) section again
-                }
-              else
-                {
-                  // If we receive messages > BT_PROTOCOL_MESSAGES_LENGTHHEADER_THRESHOLD_PIECE_OR_EXTENSIONPROTOCOL_MESSAGE bytes, we assume they are piece messages and start estimating the upload bandwidth of the peer
-                  // Note: Since we do this all the time, it does not matter that a bitfield message might be sent; the time is just replaced
-                  m_lengthHeaderRemoved = true;
-                }
-            }
-          else
-            {
-              NS_ASSERT (m_packetBuffer->GetSize () >= m_lengthHeader.GetPacketLength ());
+void Peer::HandlePayloadMessage (const BitTorrentMessageParser::Message &message)
+{
+  // The parser has only peeked at the length and type headers, remove them now
+  m_packetBuffer->RemoveAtStart (BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH + 1);
 
-              m_packetBuffer->RemoveHeader (m_typeHeader);
+  switch (message.m_type)
+    {
+    case BitTorrentTypeHeader::BITFIELD:
+      {
+        if (message.m_length - 1 != m_myClient->GetTorrent ()->GetBitfieldSize ())
+          {
+            NS_LOG_INFO ("Peer: Received a bitfield of wrong length from " << GetRemoteIp () << ".");
+            m_packetBuffer->RemoveAtStart (message.m_length - 1);
+            break;
+          }
+
+        BitTorrentBitfieldMessage bitfieldMsg (message.m_length - 1);
+        m_packetBuffer->RemoveHeader (bitfieldMsg);
+        bitfieldMsg.CopyBitFieldTo (&m_bitfield);
+
+        m_myClient->PeerBitfieldReceivedEvent (this);
+        break;
+      }
+    case BitTorrentTypeHeader::PIECE:
+      {
+        HandlePiece (m_packetBuffer, message.m_length);
+        break;
+      }
+    case BitTorrentTypeHeader::EXTENDED:
+      {
+        BitTorrentExtensionMessage extMsg (message.m_length - 1);
+        m_packetBuffer->RemoveHeader (extMsg);
+
+        m_myClient->PeerExtensionMessageEvent (this, extMsg.GetMessageId (), extMsg.GetContent ());
+        break;
+      }
+    default:
+      {
+        m_packetBuffer->RemoveAtStart (message.m_length - 1);
+        break;
+      }
+    }
+}
 
-              switch (m_typeHeader.GetMessageType ())
-                {
-                case BitTorrentTypeHeader::CHOKE:
-                  {
-                    if (!m_peerChoking)
-                      {
-                        m_peerChoking = true;
-
-                        uint64_t currentSecond = static_cast<uint64_t> (Simulator::Now ().GetSeconds ());
-                        uint64_t currentSecondModulo = currentSecond % BT_PEER_DOWNLOADUPLOADRATE_ROLLING_AVERAGE_SECONDS;
-                        if (m_downloadHistoryReSetTime[currentSecondModulo] != currentSecond)
-                          {
-                            m_downloadHistoryReSetTime[currentSecondModulo] = currentSecond;
-                            m_downloadHistory[currentSecondModulo] = 0;
-                          }
-
-                        m_myClient->PeerChokeChangingEvent (this);
-                      }
-                    break;
-                  }
-                case BitTorrentTypeHeader::UNCHOKE:
-                  {
-                    if (m_peerChoking)
-                      {
-                        m_peerChoking = false;
-                        m_myClient->PeerChokeChangingEvent (this);
-                      }
-                    break;
-                  }
-                case BitTorrentTypeHeader::INTERESTED:
-                  {
-                    if (!m_peerInterested)
-                      {
-                        m_peerInterested = true;
-                        m_myClient->PeerInterestedChangingEvent (this);
-                      }
-                    break;
-                  }
-                case BitTorrentTypeHeader::NOT_INTERESTED:
-                  {
-                    if (m_peerInterested)
-                      {
-                        m_peerInterested = false;
-                        m_myClient->PeerInterestedChangingEvent (this);
-                      }
-                    break;
-                  }
-                case BitTorrentTypeHeader::HAVE:
-                  {
-                    BitTorrentHaveMessage haveMsg;
-                    m_packetBuffer->RemoveHeader (haveMsg);
-
-                    uint32_t pieceIndex = haveMsg.GetPieceIndex ();
-
-                    m_bitfield[pieceIndex / 8] |= (1 << (7 - pieceIndex % 8));
-
-                    m_myClient->PeerHaveEvent (this, pieceIndex);
-                    break;
-                  }
-                case BitTorrentTypeHeader::BITFIELD:
-                  {
-                    BitTorrentBitfieldMessage bitfieldMsg (m_lengthHeader.GetPacketLength () - 1);
-                    m_packetBuffer->RemoveHeader (bitfieldMsg);
-                    if (m_lengthHeader.GetPacketLength () - 1 != m_myClient->GetTorrent ()->GetBitfieldSize ())
-                      {
-                        NS_LOG_INFO ("Peer: Received a bitfield of wrong length from " << GetRemoteIp () << ".");
-                        return;
-                      }
-
-                    bitfieldMsg.CopyBitFieldTo (&m_bitfield);
-
-                    m_myClient->PeerBitfieldReceivedEvent (this);
-                    break;
-                  }
-                case BitTorrentTypeHeader::REQUEST:
-                  {
-                    BitTorrentRequestMessage reqMsg;
-                    m_packetBuffer->RemoveHeader (reqMsg);
-
-                    m_myClient->PeerRequestEvent (this, reqMsg.GetPieceIndex (), reqMsg.GetBlockOffset (), reqMsg.GetBlockLength ());
-                    break;
-                  }
-                case BitTorrentTypeHeader::PIECE:
-                  {
-                    HandlePiece (m_packetBuffer, m_lengthHeader.GetPacketLength ());
-                    break;
-                  }
-                case BitTorrentTypeHeader::CANCEL:
-                  {
-                    HandleCancel (m_packetBuffer);
-                    break;
-                  }
-                case BitTorrentTypeHeader::PORT:
-                  {
-                    BitTorrentPortMessage portMsg;
-                    m_packetBuffer->RemoveHeader (portMsg);
-
-                    m_myClient->PeerPortMessageEvent (this, portMsg.GetListenPort ());
-                    break;
-                  }
-                case BitTorrentTypeHeader::EXTENDED:
-                  {
-                    BitTorrentExtensionMessage extMsg (m_lengthHeader.GetPacketLength () - 1);
-                    m_packetBuffer->RemoveHeader (extMsg);
-
-                    m_myClient->PeerExtensionMessageEvent (this, extMsg.GetMessageId (), extMsg.GetContent ());
-                    break;
-                  }
-                default:
-                  {
-                    m_packetBuffer->RemoveAtStart (m_lengthHeader.GetPacketLength ());
-                    break;
-                  }
-                }                 // end of switch(m_typeHeader.GetMessageType())
-
-              m_lengthHeaderRemoved = false;                   // So we end up in the other branch of the if statement again
-              m_lengthHeader.SetPacketLength (BT_PROTOCOL_MESSAGES_LENGTHHEADER_LENGTH);                   // So we will stay in / enter this while loop if we have enough bytes in the buffer left
-            }
-        }
+void Peer::EnqueueMessage (Ptr<Packet> message, bool prioritized)
+{
+  if (!prioritized)
+    {
+      m_sendQueue.push_back (SendQueueItem (message, false));
+    }
+  else if (m_blockSendingActive)      // Insert the message right at the beginning but after the currently sending block
+    {
+      m_sendQueue.insert (m_sendQueue.begin () + 1, SendQueueItem (message, false));
+    }
+  else
+    {
+      m_sendQueue.push_front (SendQueueItem (message, false));
+    }
+
+  ScheduleSend ();
+}
+
+void Peer::ScheduleSend ()
+{
+  // Messages queued in the meantime (e.g., by handling the other messages of a received segment) are sent out together
+  if (!m_sendEvent.IsRunning ())
+    {
+      m_sendEvent = Simulator::ScheduleNow (&Peer::SendQueuedMessages, this);
+    }
+}
+
+void Peer::SendQueuedMessages ()
+{
+  if (m_peerSocket != 0)
+    {
+      HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
     }
 }
 
@@ -899,8 +895,17 @@ void Peer::HandleSend (Ptr<Socket> socket, uint32_t bytesFree)
           // Step 1: Calculate the actual amount of bytes that we still have to send
           uint32_t bytesToSend = std::min (m_peerSocket->GetTxAvailable (), m_blockSendDataLeft);
 
-          // Step 2: Create a packet of the appropriate size containing the real data we have to send
-          Ptr<Packet> nextPart = Create<Packet> (m_blockSendPtr, bytesToSend);
+          // Step 2: Create a packet of the appropriate size containing the real data we have to send, or only its size for virtual payload
+          Ptr<Packet> nextPart;
+          if (m_myClient->GetVirtualPayload ())
+            {
+              nextPart = Create<Packet> (bytesToSend);
+              nextPart->AddPacketTag (TcpVirtualPayloadTag ());
+            }
+          else
+            {
+              nextPart = Create<Packet> (m_blockSendPtr, bytesToSend);
+            }
 
           // Step 3: Correct the data pointers so we read the correct data in a (possible) next iteration
           m_blockSendPtr += bytesToSend;
@@ -923,7 +928,6 @@ void Peer::HandleSend (Ptr<Socket> socket, uint32_t bytesFree)
 
               m_myClient->PeerBlockUploadCompleteEvent (this, m_requestQueue.front ().pieceIndex,m_requestQueue.front ().blockOffSet,  m_requestQueue.front ().blockLength);
 
-              m_sendQueuePieceMessageIndicators.pop_front ();
               m_sendQueue.pop_front ();
               m_requestQueue.pop_front ();
             }
@@ -932,7 +936,7 @@ void Peer::HandleSend (Ptr<Socket> socket, uint32_t bytesFree)
         }
       else
         {
-          if (m_sendQueuePieceMessageIndicators.front ())
+          if (m_sendQueue.front ().isPiece)
             {
               NS_ASSERT (!m_requestQueue.empty ());
 
@@ -977,37 +981,31 @@ void Peer::HandleSend (Ptr<Socket> socket, uint32_t bytesFree)
             }
           else
             {
-              if (m_peerSocket->GetTxAvailable () >= m_sendQueue.front ()->GetSize ())
+              uint32_t txAvailable = m_peerSocket->GetTxAvailable ();
+              if (txAvailable >= m_sendQueue.front ().packet->GetSize ())
                 {
-                  // Step 1: Generate the packet to send
-                  Ptr<Packet> packet = m_sendQueue.front ();
-                  BitTorrentLengthHeader head;
-
-                  packet->RemoveHeader (head);
-                  BitTorrentTypeHeader typeHeader;
-                  packet->PeekHeader (typeHeader);
-                  packet->AddHeader (head);
-
-                  // Step 2: Send out the packet
-                  m_peerSocket->Send (packet);
-                  // m_lastTimePacketSent = Simulator::Now();
+                  // Step 1: Take the first packet from the internal queue
+                  Ptr<Packet> packet = m_sendQueue.front ().packet;
+                  m_sendQueue.pop_front ();
 
-                  if (typeHeader.GetMessageType () == BitTorrentTypeHeader::REQUEST)
+                  /*
+                   * Step 2: Coalesce the following non-PIECE messages that still fit into the tx buffer, so a burst of
+                   * small messages (e.g., HAVE messages after completing a piece) results in a single write to the socket
+                   */
+                  if (!m_sendQueue.empty () && !m_sendQueue.front ().isPiece &&
+                      packet->GetSize () + m_sendQueue.front ().packet->GetSize () <= txAvailable)
                     {
-                      packet->RemoveHeader (head);
-                      packet->RemoveHeader (typeHeader);
-                      BitTorrentRequestMessage reqMsg;
-                      packet->RemoveHeader (reqMsg);
-                      packet->AddHeader (reqMsg);
-                      packet->AddHeader (typeHeader);
-                      packet->AddHeader (head);
-
-                      NS_LOG_INFO ("Peer: Sending out request to " << GetRemoteIp () << "; for " << reqMsg.GetPieceIndex () << "@" << reqMsg.GetBlockOffset () << "->" << reqMsg.GetBlockOffset () + reqMsg.GetBlockLength () << ".");
+                      while (!m_sendQueue.empty () && !m_sendQueue.front ().isPiece &&
+                             packet->GetSize () + m_sendQueue.front ().packet->GetSize () <= txAvailable)
+                        {
+                          packet->AddAtEnd (m_sendQueue.front ().packet);
+                          m_sendQueue.pop_front ();
+                        }
                     }
 
-                  // Step 3: Remove the packet data from the internal queue
-                  m_sendQueue.pop_front ();
-                  m_sendQueuePieceMessageIndicators.pop_front ();
+                  // Step 3: Send out the packet
+                  m_peerSocket->Send (packet);
+                  // m_lastTimePacketSent = Simulator::Now();
 
                   // Step 4: Start another iteration so further packets can be sent out directly
                   nextIteration = true;
@@ -1058,10 +1056,7 @@ void Peer::HandleConnected (Ptr<Socket> socket)
   Ptr<Packet> announcementPacket = Create<Packet> ();
   announcementPacket->AddHeader (handshake);
 
-  m_sendQueue.push_back (announcementPacket);
-  m_sendQueuePieceMessageIndicators.push_back (false);
-
-  HandleSend (m_peerSocket, m_peerSocket->GetTxAvailable ());
+  EnqueueMessage (announcementPacket, false);
 }
 
 void Peer::HandleConnectionFail (Ptr<Socket> socket)
@@ -1134,8 +1129,9 @@ void Peer::PseudoDeInitializeMe ()
   m_bitfield.clear ();
 
   m_packetBuffer->RemoveAtStart (0xFFFFFFFF);
+  m_packetBufferVirtual = 0;
 
-  m_sendQueuePieceMessageIndicators.clear ();
+  m_sendEvent.Cancel ();
   m_sendQueue.clear ();
   m_requestQueue.clear ();
   delete[] m_blockBuffer;
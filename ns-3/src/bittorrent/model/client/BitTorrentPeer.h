@@ -25,10 +25,13 @@
 
 #include "BitTorrentPacket.h"
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 #include "ns3/socket.h"
 
+#include <deque>
 #include <list>
 #include <stdexcept>
 #include <vector>
@@ -91,6 +94,19 @@ private:
     }
   };
 
+  // An entry of the send queue
+  struct SendQueueItem
+  {
+    Ptr<Packet> packet;      // The message; empty for PIECE messages, which are created when they are sent
+    bool isPiece;            // Whether the message is a PIECE message (which is handled differently)
+
+    SendQueueItem (Ptr<Packet> packet, bool isPiece)
+      : packet (packet),
+        isPiece (isPiece)
+    {
+    }
+  };
+
 // Fields
 private:
   // Main attributes
@@ -114,11 +130,9 @@ private:
   uint8_t*                        m_pieceCorruptionMap;    // An array indicating which of the received pieces were corrupted
 
 
-  // Packet reception members and corresponding state machine attributes
+  // Packet reception members
   Ptr<Packet>                     m_packetBuffer;          // All incoming data is collected in a buffer represented by a Packet instance
-  BitTorrentLengthHeader          m_lengthHeader;          // Stores the announced size of the next BitTorrent PeerWire Protocol message
-  BitTorrentTypeHeader            m_typeHeader;            // Stores the announced type of the next BitTorrent PeerWire Protocol message
-  bool                            m_lengthHeaderRemoved;   // Whether the length header was already removed from the m_packetBuffer field
+  uint32_t                        m_packetBufferVirtual;   // The number of bytes of virtual payload (see TcpVirtualPayloadTag) received after m_packetBuffer
 
   uint8_t*                        m_blockBuffer;           // The buffer that we use to catch PIECE payloads in, so we don't have to allocate it each time again
   uint32_t                        m_blockBufferSize;       // The size of m_blockBuffer, for dynamic adjustment
@@ -126,8 +140,8 @@ private:
   // Packet transmission members and corresponding state machine attributes
   std::list<RequestInformation>   m_requestQueue;          // The REQUESTs we have to fulfill for the other peer (NOTE: Requests are NOT automatically added here!)
 
-  std::list<Ptr<Packet> >         m_sendQueue;             // The queue that holds the packets that we want to send out, re
-  std::list<bool>                 m_sendQueuePieceMessageIndicators; // Whether the next message in m_sendQueue is a PIECE message or not
+  std::deque<SendQueueItem>       m_sendQueue;             // The queue that holds the messages that we want to send out, in the order of sending
+  EventId                         m_sendEvent;             // The pending sending of the messages queued by the current event, see ScheduleSend
 
   uint8_t*                        m_blockSendBuffer;       // The buffer that we use to send PIECE messages from
   const uint8_t*                  m_blockSendPtr;          // The last position from which we read to send out the data
@@ -344,15 +358,24 @@ public:
    */
   bool HasPiece (uint32_t pieceId) const
   {
-    try
-      {
-        uint32_t result = m_bitfield.at (pieceId / 8) & (1 << (7 - pieceId % 8));
-        return result;
-      }
-    catch (std::out_of_range oor)
+    if (pieceId / 8 >= m_bitfield.size ())
       {
         return false;
       }
+    return (m_bitfield[pieceId / 8] & (1 << (7 - pieceId % 8))) != 0;
+  }
+
+  /**
+   * \brief Get the bitfield of the remote client.
+   *
+   * The bitfield is stored in the same fashion as BITFIELD messages are organized, i.e., the high bit of the first byte
+   * corresponds to the first piece in the file. It is empty after the connection was closed.
+   *
+   * @returns a pointer to the bitfield.
+   */
+  const std::vector<uint8_t>* GetBitfield () const
+  {
+    return &m_bitfield;
   }
 
   /**
@@ -428,7 +451,7 @@ private:
   // Internal message generation methods
   void NotifyPeerOfChokeChange ();
   void NotifyPeerOfInterestedChange ();
-  void HandleCancel (Ptr<Packet> packet);
+  void HandleCancel (uint32_t pieceIndex, uint32_t blockOffSet, uint32_t blockLength);
 
   // Handling of PIECE messages
   bool HandlePiece (Ptr<Packet> packet, uint32_t packetLength);
@@ -436,6 +459,20 @@ private:
   // The main method for reading from the TCP socket's stream
   void HandleRead (Ptr<Socket> socket);
 
+  // Handle the handshake and the complete messages in the receive buffer
+  void ProcessPacketBuffer ();
+
+  // Handling of received Peer Wire messages without and with payload, see BitTorrentMessageParser
+  void HandleMessage (const BitTorrentMessageParser::Message &message);
+  void HandlePayloadMessage (const BitTorrentMessageParser::Message &message);
+
+  // Enqueue a message; prioritized messages are sent right after the PIECE message currently being sent
+  void EnqueueMessage (Ptr<Packet> message, bool prioritized);
+
+  // Send the queued messages after the current event, so that the messages queued by an event are coalesced
+  void ScheduleSend ();
+  void SendQueuedMessages ();
+
   // The main method for sending
   void HandleSend (Ptr<Socket> socket, uint32_t bytesFree);
 
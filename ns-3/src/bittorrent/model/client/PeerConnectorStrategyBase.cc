@@ -25,6 +25,7 @@
 #include "BitTorrentClient.h"
 #include "BitTorrentHttpClient.h"
 #include "BitTorrentPeer.h"
+#include "ns3/BitTorrentUdpTrackerPacket.h"
 #include "ns3/TorrentFile.h"
 
 #include "ns3/address.h"
@@ -33,15 +34,21 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/log.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 #include "ns3/random-variable.h"
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
 #include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <set>
 #include <utility>
+#include <vector>
 
 namespace ns3 {
 namespace bittorrent {
@@ -60,6 +67,13 @@ PeerConnectorStrategyBase::PeerConnectorStrategyBase (Ptr<BitTorrentClient> myCl
   m_currentClientUpdateCycle = 0;
 
   m_trackerId = m_myClient->GetPeerId ();
+
+  m_udpConnectionId = 0;
+  m_udpConnectionIdExpiry = Seconds (0);
+  m_udpTransactionId = 0;
+  m_udpEvent = REGULAR_UPDATE;
+  m_udpNumwant = 0;
+  m_udpTransactionRandom = CreateObject<UniformRandomVariable> ();
 }
 
 PeerConnectorStrategyBase::~PeerConnectorStrategyBase ()
@@ -712,6 +726,17 @@ void PeerConnectorStrategyBase::TrackerTimeout (TrackerContactReason reason, uin
 
 bool PeerConnectorStrategyBase::ContactTracker (TrackerContactReason event, uint16_t numwant, std::map<std::string, std::string> additionalParameters, bool closeCurrentConnection)
 {
+  // Trackers with a udp:// announce URL are contacted via the UDP tracker protocol
+  if (m_myClient->GetTorrent ()->GetAnnounceURL ().compare (0, 6, "udp://") == 0)
+    {
+      if (!additionalParameters.empty ())
+        {
+          NS_LOG_WARN ("PeerConnectorStrategyBase: Additional parameters are not supported by UDP trackers and are dropped.");
+        }
+
+      return ContactUdpTracker (event, numwant, closeCurrentConnection);
+    }
+
   // Step 1: Initiate a connection with the tracker, close existing ones if required
   if (closeCurrentConnection)
     {
@@ -794,10 +819,199 @@ bool PeerConnectorStrategyBase::ContactTrackerWrapper (TrackerContactReason reas
   return ContactTracker (reason, numwant, additionalParameters, closeCurrentConnection);
 }
 
+bool PeerConnectorStrategyBase::ContactUdpTracker (TrackerContactReason event, uint16_t numwant, bool closeCurrentConnection)
+{
+  // Step 1: Only one request at a time, unless the current one shall be replaced
+  if (!closeCurrentConnection && m_udpTransactionId != 0)
+    {
+      return false;
+    }
+  Simulator::Cancel (m_timeoutEvent);
+
+  // Step 2: Open the socket on first use; responses are matched by their transaction id
+  if (!m_udpTrackerSocket)
+    {
+      std::string announceURL = m_myClient->GetTorrent ()->GetAnnounceURL ();
+      size_t portPos = announceURL.find (':', 6);
+      size_t pathPos = announceURL.find ('/', 6);
+      Ipv4Address trackerAddress = Ipv4Address (announceURL.substr (6, portPos - 6).c_str ());
+      uint16_t trackerPort = BT_TRACKER_UDP_PORT;
+      if (portPos != std::string::npos)
+        {
+          trackerPort = std::atoi (announceURL.substr (portPos + 1, pathPos - portPos - 1).c_str ());
+        }
+      m_udpTrackerAddress = InetSocketAddress (trackerAddress, trackerPort);
+
+      m_udpTrackerSocket = Socket::CreateSocket (m_myClient->GetNode (), UdpSocketFactory::GetTypeId ());
+      m_udpTrackerSocket->Bind ();
+      m_udpTrackerSocket->SetRecvCallback (MakeCallback (&PeerConnectorStrategyBase::UdpTrackerResponseEvent, this));
+    }
+
+  // Step 3: Send out the connect or announce request and schedule the retransmission
+  m_udpEvent = event;
+  m_udpNumwant = numwant;
+  SendUdpTrackerRequest ();
+
+  m_timeoutEvent = Simulator::Schedule (m_timeout, &PeerConnectorStrategyBase::TrackerTimeout, this, event, numwant, true);
+
+  return true;
+}
+
+void PeerConnectorStrategyBase::SendUdpTrackerRequest ()
+{
+  m_udpTransactionId = m_udpTransactionRandom->GetInteger (1, 0xFFFFFFFE);  // 0 marks "no pending request"
+
+  Ptr<Packet> request = Create<Packet> ();
+
+  // A connection id may be used for one minute, after that a new one has to be requested first
+  if (Simulator::Now () >= m_udpConnectionIdExpiry)
+    {
+      request->AddHeader (BitTorrentUdpTrackerRequestHeader (BT_TRACKER_UDP_PROTOCOL_ID, BitTorrentUdpTrackerRequestHeader::CONNECT, m_udpTransactionId));
+      m_udpTrackerSocket->SendTo (request, 0, m_udpTrackerAddress);
+      return;
+    }
+
+  BitTorrentUdpTrackerAnnounceRequest announce;
+  announce.SetInfoHash (reinterpret_cast<const uint8_t*> (m_myClient->GetTorrent ()->GetByteValueInfoHash ()));
+
+  uint8_t peerId[20];
+  std::memset (peerId, 0, 20);
+  std::memcpy (peerId, m_trackerId.c_str (), std::min (static_cast<size_t> (20), m_trackerId.size ()));
+  announce.SetPeerId (peerId);
+
+  announce.SetDownloaded (m_myClient->GetBytesCompleted ());
+  announce.SetLeft (m_myClient->GetTorrent ()->GetFileLength () - m_myClient->GetBytesCompleted ());
+  announce.SetUploaded (0);       // TODO: Keep track of the amount of bytes uploaded!
+  switch (m_udpEvent)
+    {
+    case STARTED:
+      announce.SetEvent (BitTorrentUdpTrackerAnnounceRequest::STARTED);
+      break;
+    case STOPPED:
+      announce.SetEvent (BitTorrentUdpTrackerAnnounceRequest::STOPPED);
+      break;
+    case COMPLETED:
+      announce.SetEvent (BitTorrentUdpTrackerAnnounceRequest::COMPLETED);
+      break;
+    default:
+      announce.SetEvent (BitTorrentUdpTrackerAnnounceRequest::NONE);
+      break;
+    }
+  announce.SetIp (m_myClient->GetIp ().Get ());
+  announce.SetKey (m_myClient->GetIp ().Get ());
+  announce.SetNumWant ((m_udpNumwant == 0) ? 50 : m_udpNumwant);
+  announce.SetPort (m_myClient->GetPort ());
+
+  request->AddHeader (announce);
+  request->AddHeader (BitTorrentUdpTrackerRequestHeader (m_udpConnectionId, BitTorrentUdpTrackerRequestHeader::ANNOUNCE, m_udpTransactionId));
+  m_udpTrackerSocket->SendTo (request, 0, m_udpTrackerAddress);
+}
+
+void PeerConnectorStrategyBase::UdpTrackerResponseEvent (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      if (packet->GetSize () < 8)
+        {
+          continue;
+        }
+
+      BitTorrentUdpTrackerResponseHeader response;
+      packet->RemoveHeader (response);
+
+      // Ignore responses to requests that were cancelled or replaced
+      if (m_udpTransactionId == 0 || response.GetTransactionId () != m_udpTransactionId)
+        {
+          continue;
+        }
+
+      switch (response.GetAction ())
+        {
+        case BitTorrentUdpTrackerRequestHeader::CONNECT:
+          {
+            if (packet->GetSize () < 8)
+              {
+                break;
+              }
+
+            // Step 1: Store the connection id and send out the actual announce
+            BitTorrentUdpTrackerConnectResponse connect;
+            packet->RemoveHeader (connect);
+            m_udpConnectionId = connect.GetConnectionId ();
+            m_udpConnectionIdExpiry = Simulator::Now () + Seconds (BT_TRACKER_UDP_CONNECTION_ID_LIFETIME);
+
+            SendUdpTrackerRequest ();
+            break;
+          }
+        case BitTorrentUdpTrackerRequestHeader::ANNOUNCE:
+          {
+            if (packet->GetSize () < 12)
+              {
+                break;
+              }
+
+            m_udpTransactionId = 0;
+            Simulator::Cancel (m_timeoutEvent);
+
+            // Step 2: Read the response, just as ParseResponse does for HTTP trackers
+            BitTorrentUdpTrackerAnnounceResponse announce;
+            packet->RemoveHeader (announce);
+
+            if (!m_myClient->GetConnectionToCloudSuspended ())
+              {
+                m_reannouncementInterval = Seconds (announce.GetInterval ());
+
+                // A mini heuristic against dead (inactive) peers in the set of potential peers
+                if (m_currentClientUpdateCycle == m_clientUpdateCycles - 1)
+                  {
+                    m_potentialClients.clear ();
+                  }
+                m_currentClientUpdateCycle = (m_currentClientUpdateCycle + 1) % m_clientUpdateCycles;
+
+                // The compact peer list: 4 bytes of IP address and 2 bytes of port per peer
+                uint32_t peerLen = packet->GetSize () - packet->GetSize () % 6;
+                std::vector<uint8_t> peers (peerLen + 1);
+                packet->CopyData (&peers[0], peerLen);
+                for (uint32_t i = 0; i < peerLen; i += 6)
+                  {
+                    std::pair<uint32_t, uint16_t> peer;
+                    peer.first = (peers[i] << 24) | (peers[i + 1] << 16) | (peers[i + 2] << 8) | peers[i + 3];
+                    peer.second = (peers[i + 4] << 8) | peers[i + 5];
+
+                    // Skip own IP
+                    if (peer.first == m_myClient->GetIp ().Get ())
+                      {
+                        continue;
+                      }
+
+                    m_potentialClients.insert (peer);
+                  }
+              }
+
+            m_myClient->TrackerResponseReceivedEvent ();
+            break;
+          }
+        default:
+          {
+            // An error; request a new connection id with the next contact, in case the current one was rejected
+            m_udpTransactionId = 0;
+            m_udpConnectionIdExpiry = Seconds (0);
+            Simulator::Cancel (m_timeoutEvent);
+
+            NS_LOG_INFO ("PeerConnectorStrategyBase: Received error from UDP tracker.");
+            break;
+          }
+        }
+    }
+}
+
 void PeerConnectorStrategyBase::CancelCurrentTrackerRequest ()
 {
   Simulator::Cancel (m_timeoutEvent);
   m_httpCC.CloseAndReInit ();
+  m_udpTransactionId = 0;
 }
 
 void PeerConnectorStrategyBase::ProcessPeerConnectionEstablishedEvent (Ptr<Peer> peer)
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef PIECEAVAILABILITY_H_
+#define PIECEAVAILABILITY_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+namespace bittorrent {
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief Per-piece availability counters of a swarm, with the pieces bucketed by rarity.
+ *
+ * The class counts how many peers announced each piece and keeps all pieces in one array,
+ * sorted by bucket: bucket r (0 <= r <= max availability) holds the needed pieces announced
+ * by r peers (or more, if the count exceeds the max availability), and the last bucket holds
+ * the completed pieces. A change of a counter by one moves the piece to the adjacent bucket
+ * by swapping it with the first or last piece of its bucket, i.e., in O(1).
+ *
+ * The announcements of a peer are kept by the caller as a dense bitfield of 64-bit words
+ * (bit i % 64 of word i / 64 is piece i), see ToWords. Update compares the announced with the
+ * already-counted words of the peer and only touches the counters of the pieces that changed,
+ * so BITFIELD messages, HAVE messages and closed connections are all handled as deltas.
+ */
+class PieceAvailability
+{
+public:
+  typedef std::vector<uint64_t> Words;
+
+  PieceAvailability ();
+
+  /**
+   * \brief Reset all counters to zero and mark all pieces as needed.
+   */
+  void Initialize (uint32_t numberOfPieces, uint16_t maxAvailability);
+
+  /**
+   * \brief Change the number of rarity buckets, keeping the counters. Counts above the new
+   * maximum are put into the bucket of the maximum.
+   */
+  void SetMaxAvailability (uint16_t maxAvailability);
+
+  uint16_t GetMaxAvailability () const
+  {
+    return m_maxAvailability;
+  }
+
+  uint32_t GetNumberOfPieces () const
+  {
+    return m_counts.size ();
+  }
+
+  /**
+   * \brief Convert a bitfield in the wire format (high bit of the first byte is the first piece)
+   * into words. Spare bits after the last piece are ignored.
+   */
+  void ToWords (const std::vector<uint8_t> &bitfield, Words &words) const;
+
+  /**
+   * \brief Count the announcements that are in announced but not in counted, uncount the ones
+   * that are in counted but not in announced, and set counted to announced.
+   *
+   * An empty announced uncounts everything, e.g., when the connection to the peer is closed.
+   */
+  void Update (Words &counted, const Words &announced);
+
+  /**
+   * \brief Count a single announcement (HAVE message), unless it is already in counted.
+   *
+   * @returns false, if the announcement was already counted or the piece index is invalid.
+   */
+  bool Add (Words &counted, uint32_t pieceIndex);
+
+  /**
+   * \brief Move a piece into the bucket of completed pieces. Its counter is kept.
+   */
+  void SetCompleted (uint32_t pieceIndex);
+
+  bool IsCompleted (uint32_t pieceIndex) const
+  {
+    return m_completed[pieceIndex];
+  }
+
+  /**
+   * @returns the number of peers that announced the piece.
+   */
+  uint16_t GetAvailability (uint32_t pieceIndex) const
+  {
+    return m_counts[pieceIndex];
+  }
+
+  /**
+   * @returns the bucket of a piece, GetMaxAvailability () + 1 for completed pieces.
+   */
+  uint16_t GetBucket (uint32_t pieceIndex) const;
+
+  /**
+   * @returns the number of pieces in the bucket.
+   */
+  uint32_t GetBucketSize (uint16_t bucket) const
+  {
+    return m_bucketStarts[bucket + 1] - m_bucketStarts[bucket];
+  }
+
+  /**
+   * @returns the i-th piece of the bucket, i < GetBucketSize (bucket).
+   */
+  uint32_t GetPiece (uint16_t bucket, uint32_t i) const
+  {
+    return m_pieces[m_bucketStarts[bucket] + i];
+  }
+
+  /**
+   * @returns the number of set bits in the words.
+   */
+  static uint32_t Count (const Words &words);
+
+private:
+  void Increment (uint32_t pieceIndex);
+  void Decrement (uint32_t pieceIndex);
+  void MoveUp (uint32_t pieceIndex, uint16_t bucket);
+  void MoveDown (uint32_t pieceIndex, uint16_t bucket);
+  void Swap (uint32_t pieceIndex, uint32_t position);
+  void Rebuild ();
+
+  uint16_t m_maxAvailability;
+  std::vector<uint16_t> m_counts;       // The number of announcements of each piece
+  std::vector<bool> m_completed;        // Whether a piece is available locally
+  std::vector<uint32_t> m_pieces;       // All pieces, sorted by bucket
+  std::vector<uint32_t> m_positions;    // The position of each piece in m_pieces
+  std::vector<uint32_t> m_bucketStarts; // The first position of each bucket in m_pieces, plus the end of the last bucket
+};
+
+} // ns bittorrent
+} // ns ns3
+
+#endif /* PIECEAVAILABILITY_H_ */
@@ -22,9 +22,9 @@
 #define RFPARTSELECTIONSTRATEGY_H_
 
 #include "ns3/PartSelectionStrategyBase.h"
+#include "ns3/PieceAvailability.h"
 
-#include <set>
-#include <vector>
+#include <map>
 
 namespace ns3 {
 namespace bittorrent {
@@ -44,12 +44,14 @@ class Peer;
  * that first tries to download missing blocks of a piece already requested from a peer (to complete that piece)
  * and only then selects the pieces for download according to the rarest-first scheme.
  *
+ * The availability of the pieces is kept in a PieceAvailability instance, which is updated with the
+ * differences between the pieces announced by a peer and the pieces already counted for this peer.
  */
 class RarestFirstPartSelectionStrategy : public PartSelectionStrategyBase {
 // Fields
 protected:
-	std::set<uint32_t> *m_piecesByRarity;
-	std::vector<uint16_t> m_raritiesByPiece;
+	PieceAvailability m_availability;
+	std::map<Ptr<Peer>, PieceAvailability::Words> m_announcedPieces;  // The pieces counted in m_availability for each peer
 
 // Constructors etc.
 public:
@@ -70,6 +72,8 @@ public:
 
 	/**
 	 * \brief Reacts to an announced bitfield by shifting the availability of all pieces announced by the peer up by one.
+	 *
+	 * Pieces already announced by the peer (e.g., by preceding HAVE messages) are not counted twice.
 	 */
 	virtual void ProcessPeerBitfieldReceivedEvent(Ptr<Peer> peer);
 
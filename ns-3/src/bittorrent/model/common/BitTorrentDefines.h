@@ -58,6 +58,11 @@
 
 #define BT_PROTOCOL_LISTENER_PORT 6881
 
+#define BT_TRACKER_UDP_PROTOCOL_ID 0x41727101980ULL // Magic constant of UDP tracker connect requests (BEP 15)
+#define BT_TRACKER_UDP_PORT 6969 // Default port of UDP trackers
+#define BT_TRACKER_UDP_CONNECTION_ID_LIFETIME 60 // In seconds; connection ids may be used by clients for one minute (BEP 15)
+#define BT_TRACKER_UDP_NUMWANT_DEFAULT 50 // Number of peers returned for num_want = -1; the same as for HTTP announces without numwant
+
 #define BT_PEER_CONNECTOR_CONNECTION_ACCEPTANCE_DELAY 10000 // In milliseconds; Usually, 10 seconds should be enough
 
 #endif /* BITTORRENTCLIENT_DEFINES_H_ */
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "BitTorrentUdpTrackerPacket.h"
+
+#include <cstring>
+
+namespace ns3 {
+namespace bittorrent {
+
+/************************************************************************************************/
+/********************************* BitTorrentUdpTrackerRequestHeader ****************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentUdpTrackerRequestHeader);
+
+BitTorrentUdpTrackerRequestHeader::BitTorrentUdpTrackerRequestHeader ()
+  : m_connectionId (0),
+    m_action (0),
+    m_transactionId (0)
+{
+}
+
+BitTorrentUdpTrackerRequestHeader::BitTorrentUdpTrackerRequestHeader (uint64_t connectionId, uint32_t action, uint32_t transactionId)
+  : m_connectionId (connectionId),
+    m_action (action),
+    m_transactionId (transactionId)
+{
+}
+
+BitTorrentUdpTrackerRequestHeader::~BitTorrentUdpTrackerRequestHeader ()
+{
+}
+
+void BitTorrentUdpTrackerRequestHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU64 (m_connectionId);
+  start.WriteHtonU32 (m_action);
+  start.WriteHtonU32 (m_transactionId);
+}
+
+uint32_t BitTorrentUdpTrackerRequestHeader::Deserialize (Buffer::Iterator start)
+{
+  m_connectionId = start.ReadNtohU64 ();
+  m_action = start.ReadNtohU32 ();
+  m_transactionId = start.ReadNtohU32 ();
+  return 16;
+}
+
+TypeId BitTorrentUdpTrackerRequestHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentUdpTrackerRequestHeader").SetParent<Header> ()
+    .AddConstructor<BitTorrentUdpTrackerRequestHeader> ();
+
+  return tid;
+}
+
+/************************************************************************************************/
+/******************************** BitTorrentUdpTrackerAnnounceRequest ***************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentUdpTrackerAnnounceRequest);
+
+BitTorrentUdpTrackerAnnounceRequest::BitTorrentUdpTrackerAnnounceRequest ()
+  : m_downloaded (0),
+    m_left (0),
+    m_uploaded (0),
+    m_event (NONE),
+    m_ip (0),
+    m_key (0),
+    m_numWant (-1),
+    m_port (0)
+{
+  std::memset (m_infoHash, 0, 20);
+  std::memset (m_peerId, 0, 20);
+}
+
+BitTorrentUdpTrackerAnnounceRequest::~BitTorrentUdpTrackerAnnounceRequest ()
+{
+}
+
+void BitTorrentUdpTrackerAnnounceRequest::Serialize (Buffer::Iterator start) const
+{
+  start.Write (m_infoHash, 20);
+  start.Write (m_peerId, 20);
+  start.WriteHtonU64 (m_downloaded);
+  start.WriteHtonU64 (m_left);
+  start.WriteHtonU64 (m_uploaded);
+  start.WriteHtonU32 (m_event);
+  start.WriteHtonU32 (m_ip);
+  start.WriteHtonU32 (m_key);
+  start.WriteHtonU32 (static_cast<uint32_t> (m_numWant));
+  start.WriteHtonU16 (m_port);
+}
+
+uint32_t BitTorrentUdpTrackerAnnounceRequest::Deserialize (Buffer::Iterator start)
+{
+  start.Read (m_infoHash, 20);
+  start.Read (m_peerId, 20);
+  m_downloaded = start.ReadNtohU64 ();
+  m_left = start.ReadNtohU64 ();
+  m_uploaded = start.ReadNtohU64 ();
+  m_event = start.ReadNtohU32 ();
+  m_ip = start.ReadNtohU32 ();
+  m_key = start.ReadNtohU32 ();
+  m_numWant = static_cast<int32_t> (start.ReadNtohU32 ());
+  m_port = start.ReadNtohU16 ();
+  return 82;
+}
+
+TypeId BitTorrentUdpTrackerAnnounceRequest::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentUdpTrackerAnnounceRequest").SetParent<Header> ()
+    .AddConstructor<BitTorrentUdpTrackerAnnounceRequest> ();
+
+  return tid;
+}
+
+/************************************************************************************************/
+/******************************** BitTorrentUdpTrackerResponseHeader ****************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentUdpTrackerResponseHeader);
+
+BitTorrentUdpTrackerResponseHeader::BitTorrentUdpTrackerResponseHeader ()
+  : m_action (0),
+    m_transactionId (0)
+{
+}
+
+BitTorrentUdpTrackerResponseHeader::BitTorrentUdpTrackerResponseHeader (uint32_t action, uint32_t transactionId)
+  : m_action (action),
+    m_transactionId (transactionId)
+{
+}
+
+BitTorrentUdpTrackerResponseHeader::~BitTorrentUdpTrackerResponseHeader ()
+{
+}
+
+void BitTorrentUdpTrackerResponseHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_action);
+  start.WriteHtonU32 (m_transactionId);
+}
+
+uint32_t BitTorrentUdpTrackerResponseHeader::Deserialize (Buffer::Iterator start)
+{
+  m_action = start.ReadNtohU32 ();
+  m_transactionId = start.ReadNtohU32 ();
+  return 8;
+}
+
+TypeId BitTorrentUdpTrackerResponseHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentUdpTrackerResponseHeader").SetParent<Header> ()
+    .AddConstructor<BitTorrentUdpTrackerResponseHeader> ();
+
+  return tid;
+}
+
+/************************************************************************************************/
+/******************************* BitTorrentUdpTrackerConnectResponse ****************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentUdpTrackerConnectResponse);
+
+BitTorrentUdpTrackerConnectResponse::BitTorrentUdpTrackerConnectResponse ()
+  : m_connectionId (0)
+{
+}
+
+BitTorrentUdpTrackerConnectResponse::BitTorrentUdpTrackerConnectResponse (uint64_t connectionId)
+  : m_connectionId (connectionId)
+{
+}
+
+BitTorrentUdpTrackerConnectResponse::~BitTorrentUdpTrackerConnectResponse ()
+{
+}
+
+void BitTorrentUdpTrackerConnectResponse::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU64 (m_connectionId);
+}
+
+uint32_t BitTorrentUdpTrackerConnectResponse::Deserialize (Buffer::Iterator start)
+{
+  m_connectionId = start.ReadNtohU64 ();
+  return 8;
+}
+
+TypeId BitTorrentUdpTrackerConnectResponse::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentUdpTrackerConnectResponse").SetParent<Header> ()
+    .AddConstructor<BitTorrentUdpTrackerConnectResponse> ();
+
+  return tid;
+}
+
+/************************************************************************************************/
+/******************************* BitTorrentUdpTrackerAnnounceResponse ***************************/
+/************************************************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (BitTorrentUdpTrackerAnnounceResponse);
+
+BitTorrentUdpTrackerAnnounceResponse::BitTorrentUdpTrackerAnnounceResponse ()
+  : m_interval (0),
+    m_leechers (0),
+    m_seeders (0)
+{
+}
+
+BitTorrentUdpTrackerAnnounceResponse::BitTorrentUdpTrackerAnnounceResponse (uint32_t interval, uint32_t leechers, uint32_t seeders)
+  : m_interval (interval),
+    m_leechers (leechers),
+    m_seeders (seeders)
+{
+}
+
+BitTorrentUdpTrackerAnnounceResponse::~BitTorrentUdpTrackerAnnounceResponse ()
+{
+}
+
+void BitTorrentUdpTrackerAnnounceResponse::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_interval);
+  start.WriteHtonU32 (m_leechers);
+  start.WriteHtonU32 (m_seeders);
+}
+
+uint32_t BitTorrentUdpTrackerAnnounceResponse::Deserialize (Buffer::Iterator start)
+{
+  m_interval = start.ReadNtohU32 ();
+  m_leechers = start.ReadNtohU32 ();
+  m_seeders = start.ReadNtohU32 ();
+  return 12;
+}
+
+TypeId BitTorrentUdpTrackerAnnounceResponse::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::bittorrent::BitTorrentUdpTrackerAnnounceResponse").SetParent<Header> ()
+    .AddConstructor<BitTorrentUdpTrackerAnnounceResponse> ();
+
+  return tid;
+}
+
+} // ns bittorrent
+} // ns ns3
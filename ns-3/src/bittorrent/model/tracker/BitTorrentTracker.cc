@@ -22,6 +22,7 @@
 
 #include "BitTorrentHttpServer.h"
 
+#include "ns3/BitTorrentDefines.h"
 #include "ns3/BitTorrentUtilities.h"
 #include "ns3/GlobalMetricsGatherer.h"
 #include "ns3/Torrent.h"
@@ -34,14 +35,17 @@
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/socket.h"
 #include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-socket-factory.h"
 
 #include <algorithm>
 #include <map>
 #include <set>
 #include <string>
+#include <time.h>
 
 namespace ns3 {
 namespace bittorrent {
@@ -49,12 +53,29 @@ namespace bittorrent {
 NS_LOG_COMPONENT_DEFINE ("BitTorrentTracker");
 NS_OBJECT_ENSURE_REGISTERED (BitTorrentTracker);
 
+// Reads a clock, in nanoseconds; used to measure the processing cost of the tracker
+static int64_t ReadClockNs (clockid_t clock)
+{
+  struct timespec ts;
+  clock_gettime (clock, &ts);
+  return static_cast<int64_t> (ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
 BitTorrentTracker::BitTorrentTracker ()
 {
   m_announcePath = "/announce";
   m_scrapePath = "/scrape";
   m_updateInterval = "60";
 
+  m_udpEnabled = false;
+  m_udpPort = BT_TRACKER_UDP_PORT;
+  m_udpSecret = 0;
+  m_udpSecretRandom = CreateObject<UniformRandomVariable> ();
+
+  m_requestsHandled = 0;
+  m_processingCpuNs = 0;
+  m_processingWallNs = 0;
+
   m_handleStartListening = MakeCallback (&BitTorrentHttpServer::StartListening, &HttpCS);
   m_handleStopListening = MakeCallback (&BitTorrentHttpServer::StopListening, &HttpCS);
   m_handleConnectionCreation = MakeCallback (&BitTorrentTracker::ConnectionCreation, this);
@@ -83,16 +104,37 @@ void BitTorrentTracker::StartApplication (void)
 {
   // Start the BitTorrentHttpServer component
   m_handleStartListening (GetNode (), TcpSocketFactory::GetTypeId (), m_handleConnectionCreation);
+
+  // Open the UDP tracker, if enabled
+  if (m_udpEnabled && !m_udpSocket)
+    {
+      // Two draws of 32 bits each (GetInteger cannot return the full 32-bit range)
+      m_udpSecret = static_cast<uint64_t> (m_udpSecretRandom->GetValue (0, 4294967296.0)) << 32;
+      m_udpSecret |= static_cast<uint64_t> (m_udpSecretRandom->GetValue (0, 4294967296.0));
+
+      m_udpSocket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+      m_udpSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_udpPort));
+      m_udpSocket->SetRecvCallback (MakeCallback (&BitTorrentTracker::HandleUdpRead, this));
+    }
 }
 
 void BitTorrentTracker::StopApplication (void)
 {
   // Stop the BitTorrentHttpServer component
   m_handleStopListening ();
+
+  if (m_udpSocket)
+    {
+      m_udpSocket->Close ();
+      m_udpSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_udpSocket = 0;
+    }
 }
 
 void BitTorrentTracker::DoDispose (void)
 {
+  m_udpSocket = 0;
+  m_udpSecretRandom = 0;
   Application::DoDispose ();
 }
 
@@ -121,6 +163,16 @@ std::string BitTorrentTracker::GetAnnounceURL () const
   std::stringstream buffer;
   Ptr<Ipv4> ipInterface = GetNode ()->GetObject<Ipv4> ();
 
+  if (m_udpEnabled)
+    {
+      buffer << "udp://";
+      ipInterface->GetAddress (1,0).GetLocal ().Print (buffer);
+      buffer << ":" << m_udpPort;
+      buffer << m_announcePath;
+
+      return buffer.str ();
+    }
+
   buffer << "http://";
   ipInterface->GetAddress (1,0).GetLocal ().Print (buffer);
   buffer << ":80";
@@ -155,13 +207,53 @@ void BitTorrentTracker::SetUpdateInterval (Time updateInterval)
     }
 }
 
+bool BitTorrentTracker::GetUdpEnabled () const
+{
+  return m_udpEnabled;
+}
+
+void BitTorrentTracker::SetUdpEnabled (bool udpEnabled)
+{
+  m_udpEnabled = udpEnabled;
+}
+
+uint16_t BitTorrentTracker::GetUdpPort () const
+{
+  return m_udpPort;
+}
+
+void BitTorrentTracker::SetUdpPort (uint16_t udpPort)
+{
+  m_udpPort = udpPort;
+}
+
+int64_t BitTorrentTracker::AssignStreams (int64_t stream)
+{
+  m_udpSecretRandom->SetStream (stream);
+  return 1;
+}
+
+uint64_t BitTorrentTracker::GetRequestsHandled () const
+{
+  return m_requestsHandled;
+}
+
+Time BitTorrentTracker::GetProcessingCpuTime () const
+{
+  return NanoSeconds (m_processingCpuNs);
+}
+
+Time BitTorrentTracker::GetProcessingWallTime () const
+{
+  return NanoSeconds (m_processingWallNs);
+}
+
 Ptr<Torrent> BitTorrentTracker::AddTorrent (std::string path, std::string file)
 {
   Ptr<Torrent> torrent = CreateObject<Torrent> ();
   torrent->ReadTorrentFile (file);
   torrent->SetDataPath (path);
-  std::string info_hash = torrent->GetInfoHash ();
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
+  std::string info_hash (torrent->GetByteValueInfoHash (), 20);
   AddInfoHash (info_hash);
   torrent->SetAnnounceURL (GetAnnounceURL ());
   (*m_cloudInfo.find (info_hash)).second.m_completed = 0;
@@ -170,8 +262,7 @@ Ptr<Torrent> BitTorrentTracker::AddTorrent (std::string path, std::string file)
 
 void BitTorrentTracker::PrepareForManyClients (Ptr<Torrent> torrent, uint32_t expectedClients)
 {
-  std::string info_hash = torrent->GetInfoHash ();
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
+  std::string info_hash (torrent->GetByteValueInfoHash (), 20);
 
   std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt;
   cloudInfoIt = m_cloudInfo.find (info_hash);
@@ -183,15 +274,13 @@ void BitTorrentTracker::PrepareForManyClients (Ptr<Torrent> torrent, uint32_t ex
 
 void BitTorrentTracker::IgnoreTorrent (Ptr<Torrent> torrent)
 {
-  std::string info_hash = torrent->GetInfoHash ();
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
+  std::string info_hash (torrent->GetByteValueInfoHash (), 20);
   RemoveInfoHash (info_hash);
 }
 
 void BitTorrentTracker::AcceptTorrent (Ptr<Torrent> torrent)
 {
-  std::string info_hash = torrent->GetInfoHash ();
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
+  std::string info_hash (torrent->GetByteValueInfoHash (), 20);
   AddInfoHash (info_hash);
 }
 
@@ -203,8 +292,13 @@ void BitTorrentTracker::ConnectionCreation (Ptr<Socket> socket, const Address &a
 
 void BitTorrentTracker::ReceiveReq (Ptr<Socket> socket)
 {
+  int64_t cpuStartNs = ReadClockNs (CLOCK_THREAD_CPUTIME_ID);
+  int64_t wallStartNs = ReadClockNs (CLOCK_MONOTONIC);
+
   // Receive the request from the client by calling the receive request method in the servrer
   m_handleReceiveRequest (socket, m_handleDataCreater, m_handleErrorOccurance);
+
+  AccountProcessingTime (cpuStartNs, wallStartNs);
 }
 
 void BitTorrentTracker::ErrorOccurance (Ptr<Socket> socket, std::string ErrorCode, const Address& fromAddress)
@@ -215,6 +309,8 @@ void BitTorrentTracker::ErrorOccurance (Ptr<Socket> socket, std::string ErrorCod
 
 void BitTorrentTracker::DataCreater (std::string path, Ptr<Socket> socket, const Address& fromAddress)
 {
+  ++m_requestsHandled;
+
   // Only act if announce/scrape URL was correctly submitted
   if ((path.find (GetAnnouncePath () + '?') != 0) && (path.find (GetScrapePath () + '?') != 0))
     {
@@ -275,14 +371,13 @@ void BitTorrentTracker::DataCreater (std::string path, Ptr<Socket> socket, const
           peer_id = (*clientInfo.find ("peer_id")).second;
         }
 
+      // The clouds are indexed by the binary info hash (unescaped by ExtractInfoFromClientMessage)
       std::string info_hash = (*clientInfo.find ("info_hash")).second;
-      std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
-      clientInfo["info_hash"] = info_hash;
 
       if (m_cloudInfo.find (info_hash) == m_cloudInfo.end ())
         {
           m_handleErrorOccurance (socket, "404", fromAddress);
-          NS_LOG_WARN ("BitTorrentTracker: Could not find shared file with info hash " << info_hash << ".");
+          NS_LOG_WARN ("BitTorrentTracker: Could not find shared file with info hash " << Utilities::EscapeHex (info_hash) << ".");
           return;
         }
 
@@ -293,72 +388,316 @@ void BitTorrentTracker::DataCreater (std::string path, Ptr<Socket> socket, const
 
       clientInfoIt = clientInfo.find ("event");
 
-      if (clientInfoIt == clientInfo.end ())
+      if ((clientInfoIt != clientInfo.end () && (*clientInfoIt).second == "scrape") || ProcessAnnounce (clientInfo))
         {
-          UpdateClient (clientInfo);
           response = GenerateResponseForPeer (clientInfo);
         }
       else
         {
-          std::string eventType = (*clientInfoIt).second;
-          if (eventType.compare ("started") == 0)
-            {
-              if (
-                clientInfo.find ("port") == clientInfo.end ()
-                || clientInfo.find ("uploaded") == clientInfo.end ()
-                || clientInfo.find ("downloaded") == clientInfo.end ()
-                || clientInfo.find ("left") == clientInfo.end ()
-                )
-                {
-                  NS_LOG_WARN ("BitTorrentTracker: A needed argument for a \"started\" message is missing from client " <<  (*clientInfo.find ("ip")).second << ".");
+          m_handleErrorOccurance (socket, "400", fromAddress);
+          return;
+        }
 
-                  m_handleErrorOccurance (socket, "400", fromAddress);
-                  return;
-                }
+      uint8_t* responsePtr = new uint8_t[response.size ()];
+      response.copy (reinterpret_cast<char*> (responsePtr), response.size ());
 
-              AddClient (clientInfo);
-              response = GenerateResponseForPeer (clientInfo);
+      m_handleSendData (socket, responsePtr, response.size (), "200");
+      delete[] responsePtr;
+    }
+}
 
-              GlobalMetricsGatherer::GetInstance ()->WriteToFile("start-announced", peer_id, true);
-            }
-          else if (eventType.compare ("completed") == 0)
-            {
-              (*m_cloudInfo.find (info_hash)).second.m_completed++;
-              AddClient (clientInfo);
-              SetClientToSeeder (clientInfo);
-              response = GenerateResponseForPeer (clientInfo);
+void BitTorrentTracker::HandleUdpRead (Ptr<Socket> socket)
+{
+  int64_t cpuStartNs = ReadClockNs (CLOCK_THREAD_CPUTIME_ID);
+  int64_t wallStartNs = ReadClockNs (CLOCK_MONOTONIC);
 
-              GlobalMetricsGatherer::GetInstance ()->WriteToFile("completion-announced", peer_id, true);
+  Ptr<Packet> packet;
+  Address fromAddress;
+  while ((packet = socket->RecvFrom (fromAddress)))
+    {
+      ++m_requestsHandled;
 
-              // Announce the completion of an external client to the global metrics gatherer.
-              if (peer_id.find ("VODSim") == std::string::npos)
-                {
-                  GlobalMetricsGatherer::GetInstance ()->AnnounceFinishedExternalClient ();
-                }
-            }
-          else if (eventType.compare ("stopped") == 0)
-            {
-              RemoveClient (clientInfo);
-              response = GenerateResponseForPeer (clientInfo);
-            }
-          else if (eventType.compare ("scrape") == 0)
+      if (packet->GetSize () < 16)
+        {
+          NS_LOG_WARN ("BitTorrentTracker: Received a too short UDP tracker request.");
+          continue;
+        }
+
+      BitTorrentUdpTrackerRequestHeader request;
+      packet->RemoveHeader (request);
+
+      // Connect requests carry the protocol id, all other requests a connection id handed out before
+      if (request.GetAction () == BitTorrentUdpTrackerRequestHeader::CONNECT)
+        {
+          if (request.GetConnectionId () == BT_TRACKER_UDP_PROTOCOL_ID)
             {
-              response = GenerateResponseForPeer (clientInfo);
+              HandleUdpConnect (request, fromAddress);
             }
-          else
-            {
-              NS_LOG_INFO ("BitTorrentTracker: Registered unknown event from peer " << (*clientInfo.find ("ip")).second << ": \"" << eventType << "\".");
+          continue;
+        }
 
-              m_handleErrorOccurance (socket, "400", fromAddress);
-              return;
-            }
+      uint64_t period = static_cast<uint64_t> (Simulator::Now ().GetSeconds ()) / BT_TRACKER_UDP_CONNECTION_ID_LIFETIME;
+      if (request.GetConnectionId () != GetUdpConnectionId (fromAddress, period)
+          && (period == 0 || request.GetConnectionId () != GetUdpConnectionId (fromAddress, period - 1)))
+        {
+          SendUdpError (request.GetTransactionId (), "Connection ID mismatch", fromAddress);
+          continue;
         }
 
-      uint8_t* responsePtr = new uint8_t[response.size ()];
-      response.copy (reinterpret_cast<char*> (responsePtr), response.size ());
+      switch (request.GetAction ())
+        {
+        case BitTorrentUdpTrackerRequestHeader::ANNOUNCE:
+          HandleUdpAnnounce (request, packet, fromAddress);
+          break;
+        case BitTorrentUdpTrackerRequestHeader::SCRAPE:
+          HandleUdpScrape (request, packet, fromAddress);
+          break;
+        default:
+          SendUdpError (request.GetTransactionId (), "Unknown action", fromAddress);
+          break;
+        }
+    }
 
-      m_handleSendData (socket, responsePtr, response.size (), "200");
-      delete[] responsePtr;
+  AccountProcessingTime (cpuStartNs, wallStartNs);
+}
+
+void BitTorrentTracker::AccountProcessingTime (int64_t cpuStartNs, int64_t wallStartNs)
+{
+  m_processingCpuNs += ReadClockNs (CLOCK_THREAD_CPUTIME_ID) - cpuStartNs;
+  m_processingWallNs += ReadClockNs (CLOCK_MONOTONIC) - wallStartNs;
+}
+
+void BitTorrentTracker::HandleUdpConnect (const BitTorrentUdpTrackerRequestHeader& request, const Address& fromAddress)
+{
+  uint64_t period = static_cast<uint64_t> (Simulator::Now ().GetSeconds ()) / BT_TRACKER_UDP_CONNECTION_ID_LIFETIME;
+
+  Ptr<Packet> response = Create<Packet> ();
+  response->AddHeader (BitTorrentUdpTrackerConnectResponse (GetUdpConnectionId (fromAddress, period)));
+  response->AddHeader (BitTorrentUdpTrackerResponseHeader (BitTorrentUdpTrackerRequestHeader::CONNECT, request.GetTransactionId ()));
+
+  m_udpSocket->SendTo (response, 0, fromAddress);
+}
+
+void BitTorrentTracker::HandleUdpAnnounce (const BitTorrentUdpTrackerRequestHeader& request, Ptr<Packet> packet, const Address& fromAddress)
+{
+  if (packet->GetSize () < 82)
+    {
+      SendUdpError (request.GetTransactionId (), "Malformed announce", fromAddress);
+      return;
+    }
+
+  BitTorrentUdpTrackerAnnounceRequest announce;
+  packet->RemoveHeader (announce);
+
+  // Step 1: Look up the cloud by the binary info hash
+  std::string info_hash (reinterpret_cast<const char*> (announce.GetInfoHash ()), 20);
+  std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt = m_cloudInfo.find (info_hash);
+  if (cloudInfoIt == m_cloudInfo.end ())
+    {
+      NS_LOG_WARN ("BitTorrentTracker: Could not find shared file with info hash " << Utilities::EscapeHex (info_hash) << ".");
+      SendUdpError (request.GetTransactionId (), "Unknown info hash", fromAddress);
+      return;
+    }
+
+  // Step 2: Convert the announce into the structure used to store client information (see ExtractInfoFromClientMessage)
+  const char* peerId = reinterpret_cast<const char*> (announce.GetPeerId ());
+  std::string peer_id (peerId, std::find (peerId, peerId + 20, '\0'));     // Peer ids shorter than 20 bytes are padded with zeros
+
+  std::stringstream ip;
+  if (announce.GetIp () != 0)
+    {
+      ip << Ipv4Address (announce.GetIp ());
+    }
+  else
+    {
+      ip << InetSocketAddress::ConvertFrom (fromAddress).GetIpv4 ();
+    }
+
+  uint32_t numwant = announce.GetNumWant () < 0 ? BT_TRACKER_UDP_NUMWANT_DEFAULT : announce.GetNumWant ();
+
+  BTDict clientInfo;
+  clientInfo["info_hash"] = info_hash;
+  clientInfo["peer_id"] = peer_id;
+  clientInfo["ip"] = ip.str ();
+  clientInfo["port"] = lexical_cast<std::string> (announce.GetPort ());
+  clientInfo["uploaded"] = lexical_cast<std::string> (announce.GetUploaded ());
+  clientInfo["downloaded"] = lexical_cast<std::string> (announce.GetDownloaded ());
+  clientInfo["left"] = lexical_cast<std::string> (announce.GetLeft ());
+  clientInfo["numwant"] = lexical_cast<std::string> (numwant);
+  switch (announce.GetEvent ())
+    {
+    case BitTorrentUdpTrackerAnnounceRequest::STARTED:
+      clientInfo["event"] = "started";
+      break;
+    case BitTorrentUdpTrackerAnnounceRequest::COMPLETED:
+      clientInfo["event"] = "completed";
+      break;
+    case BitTorrentUdpTrackerAnnounceRequest::STOPPED:
+      clientInfo["event"] = "stopped";
+      break;
+    default:
+      break;
+    }
+
+  // Step 3: Apply the announce, just as for HTTP announces
+  if (!ProcessAnnounce (clientInfo))
+    {
+      SendUdpError (request.GetTransactionId (), "Invalid announce", fromAddress);
+      return;
+    }
+
+  // Step 4: Create the response with a compact peer list of random swarm members
+  const BitTorrentTrackerCloudInfo& cloudInfo = (*cloudInfoIt).second;
+  std::vector<const BTDict*> clients;
+  SelectRandomClients (cloudInfo, numwant, clients);
+
+  std::string peers;
+  peers.reserve (6 * clients.size ());
+  for (std::vector<const BTDict*>::const_iterator it = clients.begin (); it != clients.end (); ++it)
+    {
+      if ((*(*it)->find ("peer_id")).second != peer_id)
+        {
+          peers += (*(*it)->find ("compact")).second;
+        }
+    }
+
+  Ptr<Packet> response = Create<Packet> (reinterpret_cast<const uint8_t*> (peers.data ()), peers.size ());
+  response->AddHeader (BitTorrentUdpTrackerAnnounceResponse (lexical_cast<uint32_t> (m_updateInterval),
+                                                             cloudInfo.m_clients.size () - cloudInfo.m_seeders.size (),
+                                                             cloudInfo.m_seeders.size ()));
+  response->AddHeader (BitTorrentUdpTrackerResponseHeader (BitTorrentUdpTrackerRequestHeader::ANNOUNCE, request.GetTransactionId ()));
+
+  m_udpSocket->SendTo (response, 0, fromAddress);
+}
+
+void BitTorrentTracker::HandleUdpScrape (const BitTorrentUdpTrackerRequestHeader& request, Ptr<Packet> packet, const Address& fromAddress)
+{
+  // The request contains a list of info hashes, the response seeders, completed and leechers for each of them (zero for unknown ones)
+  uint32_t hashes = packet->GetSize () / 20;
+  std::vector<uint8_t> infoHashes (20 * hashes + 1);
+  packet->CopyData (&infoHashes[0], 20 * hashes);
+
+  Buffer statistics;
+  statistics.AddAtStart (12 * hashes);
+  Buffer::Iterator it = statistics.Begin ();
+  for (uint32_t i = 0; i < hashes; ++i)
+    {
+      std::string info_hash (reinterpret_cast<const char*> (&infoHashes[20 * i]), 20);
+      std::map<std::string, BitTorrentTrackerCloudInfo>::const_iterator cloudInfoIt = m_cloudInfo.find (info_hash);
+      if (cloudInfoIt == m_cloudInfo.end ())
+        {
+          it.WriteU32 (0);
+          it.WriteU32 (0);
+          it.WriteU32 (0);
+          continue;
+        }
+
+      it.WriteHtonU32 ((*cloudInfoIt).second.m_seeders.size ());
+      it.WriteHtonU32 ((*cloudInfoIt).second.m_completed);
+      it.WriteHtonU32 ((*cloudInfoIt).second.m_clients.size () - (*cloudInfoIt).second.m_seeders.size ());
+    }
+
+  Ptr<Packet> response = Create<Packet> (statistics.PeekData (), statistics.GetSize ());
+  response->AddHeader (BitTorrentUdpTrackerResponseHeader (BitTorrentUdpTrackerRequestHeader::SCRAPE, request.GetTransactionId ()));
+
+  m_udpSocket->SendTo (response, 0, fromAddress);
+}
+
+void BitTorrentTracker::SendUdpError (uint32_t transactionId, std::string message, const Address& fromAddress)
+{
+  NS_LOG_INFO ("BitTorrentTracker: Answering UDP tracker request with error \"" << message << "\".");
+
+  Ptr<Packet> response = Create<Packet> (reinterpret_cast<const uint8_t*> (message.data ()), message.size ());
+  response->AddHeader (BitTorrentUdpTrackerResponseHeader (BitTorrentUdpTrackerRequestHeader::ERROR, transactionId));
+
+  m_udpSocket->SendTo (response, 0, fromAddress);
+}
+
+uint64_t BitTorrentTracker::GetUdpConnectionId (const Address& fromAddress, uint64_t period) const
+{
+  InetSocketAddress address = InetSocketAddress::ConvertFrom (fromAddress);
+  uint64_t id = (static_cast<uint64_t> (address.GetIpv4 ().Get ()) << 16) | address.GetPort ();
+
+  // A simple keyed mix of the client's address and the period, so the ids are not predictable by other clients
+  id ^= m_udpSecret + period * 0x9E3779B97F4A7C15ULL;
+  id ^= id >> 31;
+  id *= 0xBF58476D1CE4E5B9ULL;
+  id ^= id >> 27;
+
+  return id;
+}
+
+bool BitTorrentTracker::ProcessAnnounce (BTDict& clientInfo)
+{
+  std::string peer_id = (*clientInfo.find ("peer_id")).second;
+  BTDict::iterator clientInfoIt = clientInfo.find ("event");
+
+  if (clientInfoIt == clientInfo.end ())
+    {
+      UpdateClient (clientInfo);
+      return true;
+    }
+
+  std::string eventType = (*clientInfoIt).second;
+  if (eventType.compare ("started") == 0)
+    {
+      if (
+        clientInfo.find ("port") == clientInfo.end ()
+        || clientInfo.find ("uploaded") == clientInfo.end ()
+        || clientInfo.find ("downloaded") == clientInfo.end ()
+        || clientInfo.find ("left") == clientInfo.end ()
+        )
+        {
+          NS_LOG_WARN ("BitTorrentTracker: A needed argument for a \"started\" message is missing from client " <<  (*clientInfo.find ("ip")).second << ".");
+          return false;
+        }
+
+      AddClient (clientInfo);
+
+      GlobalMetricsGatherer::GetInstance ()->WriteToFile("start-announced", peer_id, true);
+    }
+  else if (eventType.compare ("completed") == 0)
+    {
+      (*m_cloudInfo.find ((*clientInfo.find ("info_hash")).second)).second.m_completed++;
+      AddClient (clientInfo);
+      SetClientToSeeder (clientInfo);
+
+      GlobalMetricsGatherer::GetInstance ()->WriteToFile("completion-announced", peer_id, true);
+
+      // Announce the completion of an external client to the global metrics gatherer.
+      if (peer_id.find ("VODSim") == std::string::npos)
+        {
+          GlobalMetricsGatherer::GetInstance ()->AnnounceFinishedExternalClient ();
+        }
+    }
+  else if (eventType.compare ("stopped") == 0)
+    {
+      RemoveClient (clientInfo);
+    }
+  else
+    {
+      NS_LOG_INFO ("BitTorrentTracker: Registered unknown event from peer " << (*clientInfo.find ("ip")).second << ": \"" << eventType << "\".");
+      return false;
+    }
+
+  return true;
+}
+
+void BitTorrentTracker::SelectRandomClients (const BitTorrentTrackerCloudInfo& cloudInfo, uint32_t numwant, std::vector<const BTDict*>& result) const
+{
+  std::set<uint32_t> indices = Utilities::GetRandomSampleF2 (numwant, cloudInfo.m_clients.size ());   // Gets random numbers from >>1<< to m_clients.size() => Be sure to always subtract 1 when using these as indices!
+
+  BTDoubleDict::const_iterator clientsIt = cloudInfo.m_clients.begin ();
+  uint32_t curPos = 0;
+  for (std::set<uint32_t>::const_iterator indexIt = indices.begin (); indexIt != indices.end (); ++indexIt)
+    {
+      while (curPos < (*indexIt) - 1)
+        {
+          ++curPos;
+          ++clientsIt;
+        }
+
+      result.push_back (&((*clientsIt).second));
     }
 }
 
@@ -367,7 +706,6 @@ std::string BitTorrentTracker::GenerateResponseForPeer (const BTDict& clientInfo
   std::string result;
 
   std::string info_hash = (*(clientInfo.find ("info_hash"))).second;
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
 
   std::map<std::string, BitTorrentTrackerCloudInfo>::const_iterator cloudInfoIt;
   cloudInfoIt = m_cloudInfo.find (info_hash);
@@ -387,23 +725,13 @@ std::string BitTorrentTracker::GenerateResponseForPeer (const BTDict& clientInfo
       // Step 2: Get a random selection of peers and pass it to the client -->
       result += "5:peersl";
 
-      std::set<uint32_t> indices = Utilities::GetRandomSampleF2 (
-          lexical_cast<uint32_t> ((*(clientInfo.find ("numwant"))).second),
-          (*cloudInfoIt).second.m_clients.size ()
-          );   // Gets random numbers from >>1<< to m_clients.size() => Be sure to always subtract 1 when using these as indices!
+      std::vector<const BTDict*> clients;
+      SelectRandomClients ((*cloudInfoIt).second, lexical_cast<uint32_t> ((*(clientInfo.find ("numwant"))).second), clients);
 
-      BTDoubleDict::const_iterator clientsIt = (*cloudInfoIt).second.m_clients.begin ();
-      uint32_t curPos = 0;
       std::string curStr;
-      for (std::set<uint32_t>::const_iterator indexIt = indices.begin (); indexIt != indices.end (); ++indexIt)
+      for (std::vector<const BTDict*>::const_iterator clientIt = clients.begin (); clientIt != clients.end (); ++clientIt)
         {
-          while (curPos < (*indexIt) - 1)
-            {
-              ++curPos;
-              ++clientsIt;
-            }
-
-          BTDict curClient = (*clientsIt).second;
+          const BTDict& curClient = **clientIt;
           if ((*curClient.find ("peer_id")).second != (*(clientInfo.find ("peer_id"))).second)
             {
               result += "d";
@@ -428,19 +756,9 @@ std::string BitTorrentTracker::GenerateResponseForPeer (const BTDict& clientInfo
 
       if (cloudInfoIt != m_cloudInfo.end ())
         {
-          // Step 1: Create a dictionary for the supplied info_hash with the hash converted into binary as the key
-          std::string binInfoHash;
-          char tmpVal;
-          for (size_t j = 0; j < info_hash.size (); j++)
-            {
-              tmpVal = Utilities::GetValueOfHexChar (info_hash[j]) * 16;
-              j++;
-              tmpVal += Utilities::GetValueOfHexChar (info_hash[j]);
-              binInfoHash.push_back (tmpVal);
-            }
-
+          // Step 1: Create a dictionary for the supplied info_hash with the binary hash as the key
           result += "d20:";
-          result += binInfoHash;
+          result += info_hash;
           result += "d";
 
           // Step 2: Add other information to the dictionary
@@ -496,15 +814,7 @@ BTDict BitTorrentTracker::ExtractInfoFromClientMessage (std::string path)
       // Insert first part of GET request
       key = path.substr (questionmarkPos + 1, equalPos - questionmarkPos - 1);
       value = path.substr (equalPos + 1, ampersandPos - equalPos - 1);
-      if (key == "info_hash")
-        {
-          value = Utilities::DecodeInfoHash (value);
-          std::transform (value.begin (), value.end (), value.begin (), toupper);
-        }
-      else
-        {
-          value = Utilities::UnescapeHex (value);
-        }
+      value = Utilities::UnescapeHex (value);
       result.insert (std::pair<std::string, std::string> (key, value));
 
       // Insert the rest
@@ -524,15 +834,7 @@ BTDict BitTorrentTracker::ExtractInfoFromClientMessage (std::string path)
                 }
 
               value = path.substr (equalPos + 1, ampersandPos - equalPos - 1);
-              if (key == "info_hash")
-                {
-                  value = Utilities::DecodeInfoHash (value);
-                  std::transform (value.begin (), value.end (), value.begin (), toupper);
-                }
-              else
-                {
-                  value = Utilities::UnescapeHex (value);
-                }
+              value = Utilities::UnescapeHex (value);
 
               result.insert (std::pair<std::string, std::string> (key, value));
             }
@@ -542,15 +844,7 @@ BTDict BitTorrentTracker::ExtractInfoFromClientMessage (std::string path)
     {
       key = path.substr (questionmarkPos + 1, equalPos - questionmarkPos - 1);
       value = path.substr (equalPos + 1, path.size () - equalPos);
-      if (key == "info_hash")
-        {
-          value = Utilities::DecodeInfoHash (value);
-          std::transform (value.begin (), value.end (), value.begin (), toupper);
-        }
-      else
-        {
-          value = Utilities::UnescapeHex (value);
-        }
+      value = Utilities::UnescapeHex (value);
       result.insert (std::pair<std::string, std::string> (key, value));
     }
 
@@ -559,30 +853,40 @@ BTDict BitTorrentTracker::ExtractInfoFromClientMessage (std::string path)
 
 void BitTorrentTracker::AddInfoHash (std::string info_hash)
 {
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
-
   BitTorrentTrackerCloudInfo btci;
   m_cloudInfo.insert (std::pair<std::string, BitTorrentTrackerCloudInfo> (info_hash, btci));
-  NS_LOG_INFO ("BitTorrentTracker: Now accepting torrents with info hash " << info_hash << ".");
+  NS_LOG_INFO ("BitTorrentTracker: Now accepting torrents with info hash " << Utilities::EscapeHex (info_hash) << ".");
 }
 
 void BitTorrentTracker::RemoveInfoHash (std::string info_hash)
 {
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
-
   m_cloudInfo.erase (info_hash);
-  NS_LOG_INFO ("BitTorrentTracker: Will not accept torrents with info hash " << info_hash << " from now on.");
+  NS_LOG_INFO ("BitTorrentTracker: Will not accept torrents with info hash " << Utilities::EscapeHex (info_hash) << " from now on.");
 }
 
 void BitTorrentTracker::AddClient (BTDict& clientInfo)
 {
   std::string info_hash = (*(clientInfo.find ("info_hash"))).second;
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
   std::string peer_id = (*(clientInfo.find ("peer_id"))).second;
   std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt;
 
   cloudInfoIt = m_cloudInfo.find (info_hash);
 
+  // Keep the compact (6-byte) representation of the client's address for the compact peer lists of the UDP tracker
+  if (clientInfo.find ("compact") == clientInfo.end ())
+    {
+      uint8_t compact[6];
+      uint32_t ip = Ipv4Address ((*clientInfo.find ("ip")).second.c_str ()).Get ();
+      uint16_t port = lexical_cast<uint16_t> ((*clientInfo.find ("port")).second);
+      compact[0] = (ip >> 24) & 0xff;
+      compact[1] = (ip >> 16) & 0xff;
+      compact[2] = (ip >> 8) & 0xff;
+      compact[3] = ip & 0xff;
+      compact[4] = (port >> 8) & 0xff;
+      compact[5] = port & 0xff;
+      clientInfo["compact"] = std::string (reinterpret_cast<const char*> (compact), 6);
+    }
+
   (*cloudInfoIt).second.m_clients.insert (std::pair<std::string, BTDict> (peer_id, clientInfo));
 
   NS_LOG_INFO ("BitTorrentTracker: Clients in cloud: " <<  (*cloudInfoIt).second.m_clients.size () );
@@ -591,7 +895,6 @@ void BitTorrentTracker::AddClient (BTDict& clientInfo)
 void BitTorrentTracker::UpdateClient (BTDict& clientInfo)
 {
   std::string info_hash = (*(clientInfo.find ("info_hash"))).second;
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
   std::string peer_id = (*(clientInfo.find ("peer_id"))).second;
   std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt;
   BTDoubleDict::iterator clientsIt;
@@ -627,7 +930,6 @@ void BitTorrentTracker::UpdateClient (BTDict& clientInfo)
 void BitTorrentTracker::SetClientToSeeder (BTDict& clientInfo)
 {
   std::string info_hash = (*(clientInfo.find ("info_hash"))).second;
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
   std::string peer_id = (*(clientInfo.find ("peer_id"))).second;
   std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt;
 
@@ -639,7 +941,6 @@ void BitTorrentTracker::SetClientToSeeder (BTDict& clientInfo)
 void BitTorrentTracker::RemoveClient (const BTDict& clientInfo)
 {
   std::string info_hash = (*(clientInfo.find ("info_hash"))).second;
-  std::transform (info_hash.begin (), info_hash.end (), info_hash.begin (), toupper);
   std::string peer_id = (*(clientInfo.find ("peer_id"))).second;
   std::map<std::string, BitTorrentTrackerCloudInfo>::iterator cloudInfoIt;
   BTDoubleDict::iterator clientsIt;
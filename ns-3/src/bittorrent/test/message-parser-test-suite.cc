@@ -0,0 +1,397 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/BitTorrentPacket.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::bittorrent;
+
+typedef BitTorrentTypeHeader::BitTorrentMessageType MessageType;
+
+// Appends a Peer Wire message in wire format: length header, type and the given 32-bit fields
+static void
+AppendMessage (std::vector<uint8_t> &stream, MessageType type, const std::vector<uint32_t> &fields,
+               uint32_t payloadLength = 0)
+{
+  uint32_t length = 1 + 4 * fields.size () + payloadLength;
+  for (int shift = 24; shift >= 0; shift -= 8)
+    {
+      stream.push_back (static_cast<uint8_t> (length >> shift));
+    }
+  stream.push_back (static_cast<uint8_t> (type));
+  for (uint32_t i = 0; i < fields.size (); ++i)
+    {
+      for (int shift = 24; shift >= 0; shift -= 8)
+        {
+          stream.push_back (static_cast<uint8_t> (fields[i] >> shift));
+        }
+    }
+  for (uint32_t i = 0; i < payloadLength; ++i)
+    {
+      stream.push_back (static_cast<uint8_t> (i));
+    }
+}
+
+static void
+AppendKeepAlive (std::vector<uint8_t> &stream)
+{
+  stream.insert (stream.end (), 4, 0);
+}
+
+// PORT is the only message with a 16-bit field
+static void
+AppendPort (std::vector<uint8_t> &stream, uint16_t port)
+{
+  const uint8_t message[] = { 0, 0, 0, 3, BitTorrentTypeHeader::PORT,
+                              static_cast<uint8_t> (port >> 8), static_cast<uint8_t> (port) };
+  stream.insert (stream.end (), message, message + sizeof (message));
+}
+
+static std::vector<uint32_t>
+Fields (uint32_t a)
+{
+  return std::vector<uint32_t> (1, a);
+}
+
+static std::vector<uint32_t>
+Fields (uint32_t a, uint32_t b)
+{
+  std::vector<uint32_t> fields (1, a);
+  fields.push_back (b);
+  return fields;
+}
+
+static std::vector<uint32_t>
+Fields (uint32_t a, uint32_t b, uint32_t c)
+{
+  std::vector<uint32_t> fields;
+  fields.push_back (a);
+  fields.push_back (b);
+  fields.push_back (c);
+  return fields;
+}
+
+static Ptr<Packet>
+ToPacket (const std::vector<uint8_t> &stream, uint32_t begin, uint32_t end)
+{
+  return Create<Packet> (stream.empty () ? 0 : &stream[0] + begin, end - begin);
+}
+
+/**
+ * Feeds the parser concatenated messages, received at once: keep-alive, HAVE, REQUEST, CANCEL, PORT and the start of a PIECE.
+ */
+class MessageParserConcatenatedTestCase : public TestCase
+{
+public:
+  MessageParserConcatenatedTestCase ();
+  virtual void DoRun (void);
+};
+
+MessageParserConcatenatedTestCase::MessageParserConcatenatedTestCase ()
+  : TestCase ("Parse concatenated messages without payload up to a PIECE")
+{
+}
+
+void
+MessageParserConcatenatedTestCase::DoRun (void)
+{
+  std::vector<uint8_t> stream;
+  AppendKeepAlive (stream);
+  AppendMessage (stream, BitTorrentTypeHeader::HAVE, Fields (7));
+  AppendMessage (stream, BitTorrentTypeHeader::REQUEST, Fields (1, 16384, 16384));
+  AppendMessage (stream, BitTorrentTypeHeader::CANCEL, Fields (2, 0, 8192));
+  AppendPort (stream, 6881);
+  uint32_t withoutPayload = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::PIECE, Fields (1, 16384), 100);
+
+  // Everything but the last 10 bytes of the PIECE
+  Ptr<Packet> packet = ToPacket (stream, 0, stream.size () - 10);
+  BitTorrentMessageParser parser;
+  uint32_t consumed = packet->PeekHeader (parser);
+
+  NS_TEST_ASSERT_MSG_EQ (consumed, withoutPayload, "Consumed bytes differ from the messages without payload");
+  NS_TEST_ASSERT_MSG_EQ (consumed, 4 + 9 + 17 + 17 + 7, "Wrong consumed byte count");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetSerializedSize (), consumed, "Serialized size differs from consumed bytes");
+
+  const std::vector<BitTorrentMessageParser::Message> &messages = parser.GetMessages ();
+  NS_TEST_ASSERT_MSG_EQ (messages.size (), 5, "Wrong number of messages");
+  NS_TEST_ASSERT_MSG_EQ (messages[0].m_type, BitTorrentTypeHeader::KEEP_ALIVE, "Keep-alive not recognized");
+  NS_TEST_ASSERT_MSG_EQ (messages[0].m_length, 0, "Wrong keep-alive length");
+  NS_TEST_ASSERT_MSG_EQ (messages[1].m_type, BitTorrentTypeHeader::HAVE, "HAVE not recognized");
+  NS_TEST_ASSERT_MSG_EQ (messages[1].m_fields[0], 7, "Wrong piece index of HAVE");
+  NS_TEST_ASSERT_MSG_EQ (messages[2].m_type, BitTorrentTypeHeader::REQUEST, "REQUEST not recognized");
+  NS_TEST_ASSERT_MSG_EQ (messages[2].m_length, 13, "Wrong REQUEST length");
+  NS_TEST_ASSERT_MSG_EQ (messages[2].m_fields[0], 1, "Wrong piece index of REQUEST");
+  NS_TEST_ASSERT_MSG_EQ (messages[2].m_fields[1], 16384, "Wrong block offset of REQUEST");
+  NS_TEST_ASSERT_MSG_EQ (messages[2].m_fields[2], 16384, "Wrong block length of REQUEST");
+  NS_TEST_ASSERT_MSG_EQ (messages[3].m_type, BitTorrentTypeHeader::CANCEL, "CANCEL not recognized");
+  NS_TEST_ASSERT_MSG_EQ (messages[3].m_fields[2], 8192, "Wrong block length of CANCEL");
+  NS_TEST_ASSERT_MSG_EQ (messages[4].m_type, BitTorrentTypeHeader::PORT, "PORT not recognized");
+  NS_TEST_ASSERT_MSG_EQ (messages[4].m_fields[0], 6881, "Wrong listen port of PORT");
+
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), true, "Length and type of the PIECE were received");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), false, "PIECE is not complete");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetNextMessage ().m_type, BitTorrentTypeHeader::PIECE, "Next message is a PIECE");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetNextMessage ().m_length, 1 + 8 + 100, "Wrong PIECE length");
+
+  // The parser only peeks
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), stream.size () - 10, "Parsing modified the packet");
+}
+
+/**
+ * Feeds the parser a PIECE split across reads, as the receiver does: parse, remove the messages without payload, and remove
+ * the message with payload once it is complete.
+ */
+class MessageParserSplitPieceTestCase : public TestCase
+{
+public:
+  MessageParserSplitPieceTestCase ();
+  virtual void DoRun (void);
+};
+
+MessageParserSplitPieceTestCase::MessageParserSplitPieceTestCase ()
+  : TestCase ("Parse a PIECE split across reads")
+{
+}
+
+void
+MessageParserSplitPieceTestCase::DoRun (void)
+{
+  std::vector<uint8_t> stream;
+  AppendMessage (stream, BitTorrentTypeHeader::HAVE, Fields (3));
+  uint32_t pieceStart = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::PIECE, Fields (3, 0), 1000);
+  uint32_t pieceEnd = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::CHOKE, std::vector<uint32_t> ());
+
+  BitTorrentMessageParser parser;
+
+  // Read 1: the HAVE and the first bytes of the PIECE
+  Ptr<Packet> buffer = ToPacket (stream, 0, pieceStart + 10);
+  uint32_t consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, pieceStart, "Only the HAVE is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 1, "Only the HAVE is complete");
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), true, "Length and type of the PIECE were received");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), false, "PIECE is not complete after read 1");
+  buffer->RemoveAtStart (consumed);
+
+  // Read 2: more of the PIECE, but not all of it
+  buffer->AddAtEnd (ToPacket (stream, pieceStart + 10, pieceEnd - 1));
+  consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, 0, "Nothing to consume at the start of a PIECE");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 0, "No messages before the PIECE");
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), true, "Length and type of the PIECE were received");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), false, "PIECE lacks its last byte after read 2");
+
+  // Read 3: the last byte of the PIECE and the CHOKE
+  buffer->AddAtEnd (ToPacket (stream, pieceEnd - 1, stream.size ()));
+  consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, 0, "Nothing to consume at the start of a PIECE");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), true, "PIECE is complete after read 3");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetNextMessage ().m_length, pieceEnd - pieceStart - 4, "Wrong PIECE length");
+  buffer->RemoveAtStart (4 + parser.GetNextMessage ().m_length);
+
+  consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, 5, "The CHOKE is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 1, "Only the CHOKE is left");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ()[0].m_type, BitTorrentTypeHeader::CHOKE, "CHOKE not recognized");
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), false, "No message follows the CHOKE");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetSize (), consumed, "The buffer ends with the CHOKE");
+}
+
+/**
+ * Feeds the parser truncated length prefixes and a truncated REQUEST, which must not be consumed.
+ */
+class MessageParserTruncatedTestCase : public TestCase
+{
+public:
+  MessageParserTruncatedTestCase ();
+  virtual void DoRun (void);
+};
+
+MessageParserTruncatedTestCase::MessageParserTruncatedTestCase ()
+  : TestCase ("Stop at truncated length prefixes and messages")
+{
+}
+
+void
+MessageParserTruncatedTestCase::DoRun (void)
+{
+  std::vector<uint8_t> stream;
+  AppendKeepAlive (stream);
+  uint32_t requestStart = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::REQUEST, Fields (5, 0, 16384));
+
+  BitTorrentMessageParser parser;
+  uint32_t consumed = ToPacket (stream, 0, 2)->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, 0, "Half a length prefix is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 0, "Half a length prefix is a message");
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), false, "Half a length prefix has a type");
+
+  // Every truncation of the REQUEST after the keep-alive: in its length prefix, before its type, in its fields
+  for (uint32_t end = requestStart + 1; end < stream.size (); ++end)
+    {
+      consumed = ToPacket (stream, 0, end)->PeekHeader (parser);
+      NS_TEST_ASSERT_MSG_EQ (consumed, 4, "Only the keep-alive is consumed with " << end << " bytes");
+      NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 1, "Only the keep-alive is complete with " << end << " bytes");
+      NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ()[0].m_type, BitTorrentTypeHeader::KEEP_ALIVE, "Keep-alive not recognized");
+      NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), false, "Truncated REQUEST is complete with " << end << " bytes");
+    }
+
+  consumed = ToPacket (stream, 0, stream.size ())->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, stream.size (), "The complete REQUEST is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 2, "The REQUEST is complete");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ()[1].m_fields[0], 5, "Wrong piece index of REQUEST");
+}
+
+/**
+ * Feeds the parser a BITFIELD, which is handed to the receiver as the next message, between two HAVE messages.
+ */
+class MessageParserBitfieldTestCase : public TestCase
+{
+public:
+  MessageParserBitfieldTestCase ();
+  virtual void DoRun (void);
+};
+
+MessageParserBitfieldTestCase::MessageParserBitfieldTestCase ()
+  : TestCase ("Stop at a BITFIELD and continue after it")
+{
+}
+
+void
+MessageParserBitfieldTestCase::DoRun (void)
+{
+  std::vector<uint8_t> stream;
+  AppendMessage (stream, BitTorrentTypeHeader::HAVE, Fields (0));
+  uint32_t bitfieldStart = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::BITFIELD, std::vector<uint32_t> (), 3);
+  uint32_t bitfieldEnd = stream.size ();
+  AppendMessage (stream, BitTorrentTypeHeader::HAVE, Fields (9));
+
+  BitTorrentMessageParser parser;
+  uint32_t consumed = ToPacket (stream, 0, bitfieldEnd - 1)->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, bitfieldStart, "Only the first HAVE is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.HasNextMessage (), true, "Length and type of the BITFIELD were received");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), false, "Truncated BITFIELD is complete");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetNextMessage ().m_type, BitTorrentTypeHeader::BITFIELD, "Next message is a BITFIELD");
+
+  Ptr<Packet> buffer = ToPacket (stream, 0, stream.size ());
+  consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, bitfieldStart, "Only the first HAVE is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 1, "The BITFIELD is not among the messages without payload");
+  NS_TEST_ASSERT_MSG_EQ (parser.IsNextMessageComplete (), true, "BITFIELD is complete");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetNextMessage ().m_length, 1 + 3, "Wrong BITFIELD length");
+
+  buffer->RemoveAtStart (consumed + 4 + parser.GetNextMessage ().m_length);
+  consumed = buffer->PeekHeader (parser);
+  NS_TEST_ASSERT_MSG_EQ (consumed, stream.size () - bitfieldEnd, "The second HAVE is consumed");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ().size (), 1, "Only the second HAVE is left");
+  NS_TEST_ASSERT_MSG_EQ (parser.GetMessages ()[0].m_fields[0], 9, "Wrong piece index of the second HAVE");
+}
+
+/**
+ * Feeds the parser a mixed stream in reads of every size from one byte on, handling it as the receiver does, and checks
+ * that every message is seen exactly once and in order.
+ */
+class MessageParserReadSizesTestCase : public TestCase
+{
+public:
+  MessageParserReadSizesTestCase ();
+  virtual void DoRun (void);
+};
+
+MessageParserReadSizesTestCase::MessageParserReadSizesTestCase ()
+  : TestCase ("Parse a stream received in reads of any size")
+{
+}
+
+void
+MessageParserReadSizesTestCase::DoRun (void)
+{
+  std::vector<uint8_t> stream;
+  std::vector<MessageType> expected;
+  AppendMessage (stream, BitTorrentTypeHeader::BITFIELD, std::vector<uint32_t> (), 5);
+  expected.push_back (BitTorrentTypeHeader::BITFIELD);
+  AppendMessage (stream, BitTorrentTypeHeader::INTERESTED, std::vector<uint32_t> ());
+  expected.push_back (BitTorrentTypeHeader::INTERESTED);
+  AppendKeepAlive (stream);
+  expected.push_back (BitTorrentTypeHeader::KEEP_ALIVE);
+  AppendMessage (stream, BitTorrentTypeHeader::REQUEST, Fields (4, 0, 16384));
+  expected.push_back (BitTorrentTypeHeader::REQUEST);
+  AppendMessage (stream, BitTorrentTypeHeader::PIECE, Fields (4, 0), 64);
+  expected.push_back (BitTorrentTypeHeader::PIECE);
+  AppendPort (stream, 6881);
+  expected.push_back (BitTorrentTypeHeader::PORT);
+  AppendMessage (stream, BitTorrentTypeHeader::HAVE, Fields (4));
+  expected.push_back (BitTorrentTypeHeader::HAVE);
+
+  for (uint32_t readSize = 1; readSize <= stream.size (); ++readSize)
+    {
+      Ptr<Packet> buffer = Create<Packet> ();
+      std::vector<MessageType> seen;
+      BitTorrentMessageParser parser;
+      for (uint32_t read = 0; read < stream.size (); read += readSize)
+        {
+          buffer->AddAtEnd (ToPacket (stream, read, std::min<uint32_t> (read + readSize, stream.size ())));
+
+          bool progress = true;
+          while (progress)
+            {
+              uint32_t consumed = buffer->PeekHeader (parser);
+              for (uint32_t i = 0; i < parser.GetMessages ().size (); ++i)
+                {
+                  seen.push_back (parser.GetMessages ()[i].m_type);
+                }
+              buffer->RemoveAtStart (consumed);
+
+              progress = consumed > 0;
+              if (parser.IsNextMessageComplete ())
+                {
+                  seen.push_back (parser.GetNextMessage ().m_type);
+                  buffer->RemoveAtStart (4 + parser.GetNextMessage ().m_length);
+                  progress = true;
+                }
+            }
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (buffer->GetSize (), 0, "Bytes left over with reads of " << readSize << " bytes");
+      NS_TEST_ASSERT_MSG_EQ ((seen == expected), true, "Wrong messages with reads of " << readSize << " bytes");
+    }
+}
+
+static class MessageParserTestSuite : public TestSuite
+{
+public:
+  MessageParserTestSuite ()
+    : TestSuite ("bittorrent-message-parser", UNIT)
+  {
+    AddTestCase (new MessageParserConcatenatedTestCase ());
+    AddTestCase (new MessageParserSplitPieceTestCase ());
+    AddTestCase (new MessageParserTruncatedTestCase ());
+    AddTestCase (new MessageParserBitfieldTestCase ());
+    AddTestCase (new MessageParserReadSizesTestCase ());
+  }
+} g_messageParserTestSuite;
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/PieceAvailability.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::bittorrent;
+
+/**
+ * Drives PieceAvailability with random BITFIELD, HAVE, disconnect and max_peers changes,
+ * and after every step recounts the availability of all pieces from the announcements of
+ * the peers, checking the counters and the bucket of every piece.
+ */
+class PieceAvailabilityRecountTestCase : public TestCase
+{
+public:
+  PieceAvailabilityRecountTestCase (uint32_t numberOfPieces);
+  virtual void DoRun (void);
+
+private:
+  void Check (uint32_t step);
+
+  uint32_t m_numberOfPieces;
+  PieceAvailability m_availability;
+  std::vector<std::vector<bool> > m_announced; // Reference announcements of each peer
+  std::vector<PieceAvailability::Words> m_counted; // Counted words of each peer
+  std::vector<bool> m_completed;
+};
+
+PieceAvailabilityRecountTestCase::PieceAvailabilityRecountTestCase (uint32_t numberOfPieces)
+  : TestCase ("Check piece availability against a recount from the peers' bitfields"),
+    m_numberOfPieces (numberOfPieces)
+{
+}
+
+void
+PieceAvailabilityRecountTestCase::Check (uint32_t step)
+{
+  uint16_t maxAvailability = m_availability.GetMaxAvailability ();
+  uint32_t totalInBuckets = 0;
+  for (uint16_t bucket = 0; bucket <= maxAvailability + 1; ++bucket)
+    {
+      totalInBuckets += m_availability.GetBucketSize (bucket);
+      for (uint32_t i = 0; i < m_availability.GetBucketSize (bucket); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_availability.GetBucket (m_availability.GetPiece (bucket, i)), bucket,
+                                 "Piece listed in the wrong bucket at step " << step);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (totalInBuckets, m_numberOfPieces, "Pieces lost from the buckets at step " << step);
+
+  for (uint32_t piece = 0; piece < m_numberOfPieces; ++piece)
+    {
+      uint16_t count = 0;
+      for (uint32_t peer = 0; peer < m_announced.size (); ++peer)
+        {
+          count += m_announced[peer][piece];
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_availability.GetAvailability (piece), count,
+                             "Wrong availability of piece " << piece << " at step " << step);
+
+      uint16_t bucket = m_completed[piece] ? maxAvailability + 1 : std::min (count, maxAvailability);
+      NS_TEST_ASSERT_MSG_EQ (m_availability.GetBucket (piece), bucket,
+                             "Wrong bucket of piece " << piece << " at step " << step);
+    }
+}
+
+void
+PieceAvailabilityRecountTestCase::DoRun (void)
+{
+  const uint32_t peers = 12;
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (m_numberOfPieces);
+
+  m_availability.Initialize (m_numberOfPieces, 8);
+  m_announced.assign (peers, std::vector<bool> (m_numberOfPieces, false));
+  m_counted.assign (peers, PieceAvailability::Words ());
+  m_completed.assign (m_numberOfPieces, false);
+  Check (0);
+
+  for (uint32_t step = 1; step <= 2000; ++step)
+    {
+      uint32_t peer = rand->GetInteger (0, peers - 1);
+      switch (rand->GetInteger (0, 9))
+        {
+        case 0:
+        case 1:
+        case 2:
+          {
+            // BITFIELD in the wire format, keeping the pieces announced by HAVE before
+            std::vector<uint8_t> bitfield ((m_numberOfPieces + 7) / 8, 0);
+            for (uint32_t piece = 0; piece < m_numberOfPieces; ++piece)
+              {
+                if (rand->GetInteger (0, 1) == 1)
+                  {
+                    m_announced[peer][piece] = true;
+                  }
+                if (m_announced[peer][piece])
+                  {
+                    bitfield[piece / 8] |= 0x80 >> (piece % 8);
+                  }
+              }
+            // Spare bits must be ignored
+            if (m_numberOfPieces % 8 != 0)
+              {
+                bitfield.back () |= 0xFF >> (m_numberOfPieces % 8);
+              }
+            PieceAvailability::Words announced;
+            m_availability.ToWords (bitfield, announced);
+            m_availability.Update (m_counted[peer], announced);
+            break;
+          }
+        case 3:
+        case 4:
+        case 5:
+        case 6:
+          {
+            // HAVE, possibly repeated or with an invalid index
+            uint32_t piece = rand->GetInteger (0, m_numberOfPieces);
+            bool expected = piece < m_numberOfPieces && !m_announced[peer][piece];
+            NS_TEST_ASSERT_MSG_EQ (m_availability.Add (m_counted[peer], piece), expected,
+                                   "Wrong result of Add at step " << step);
+            if (expected)
+              {
+                m_announced[peer][piece] = true;
+              }
+            break;
+          }
+        case 7:
+          {
+            // Closed connection
+            m_availability.Update (m_counted[peer], PieceAvailability::Words ());
+            m_announced[peer].assign (m_numberOfPieces, false);
+            break;
+          }
+        case 8:
+          {
+            uint32_t piece = rand->GetInteger (0, m_numberOfPieces - 1);
+            m_availability.SetCompleted (piece);
+            m_completed[piece] = true;
+            break;
+          }
+        default:
+          {
+            // max_peers changed, both shrinking below and growing above the actual counts
+            m_availability.SetMaxAvailability (rand->GetInteger (1, peers + 2));
+            break;
+          }
+        }
+
+      Check (step);
+      uint32_t announcedByPeer = 0;
+      for (uint32_t piece = 0; piece < m_numberOfPieces; ++piece)
+        {
+          announcedByPeer += m_announced[peer][piece];
+        }
+      NS_TEST_ASSERT_MSG_EQ (PieceAvailability::Count (m_counted[peer]), announcedByPeer,
+                             "Wrong number of counted pieces of peer " << peer << " at step " << step);
+    }
+}
+
+static class PieceAvailabilityTestSuite : public TestSuite
+{
+public:
+  PieceAvailabilityTestSuite ()
+    : TestSuite ("bittorrent-piece-availability", UNIT)
+  {
+    // Word-aligned, byte-aligned and unaligned piece counts, and more than 2040 pieces
+    AddTestCase (new PieceAvailabilityRecountTestCase (64));
+    AddTestCase (new PieceAvailabilityRecountTestCase (200));
+    AddTestCase (new PieceAvailabilityRecountTestCase (2053));
+  }
+} g_pieceAvailabilityTestSuite;
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+// Schedule+invoke throughput of the simulator with and without EventPool.
+//
+// "pending" chains of events are kept in the scheduler; every event
+// reschedules itself, alternating between closures of different sizes
+// (no arguments, a Ptr and a time, four arguments), until "total"
+// events are invoked.  About 10% of the events also schedule and
+// cancel a timeout, as PIT entries and retransmission timers do.
+//
+// ./waf --run "bench-event-pool --total=10000000 --pending=1000"
+
+#include "ns3/core-module.h"
+#include "ns3/event-pool.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+class Payload : public SimpleRefCount<Payload>
+{
+};
+
+class Bench
+{
+public:
+  Bench (uint32_t total, uint32_t pending);
+  double Run (void);
+
+private:
+  void Next (void);
+  void Cb0 (void);
+  void Cb2 (Ptr<Payload> payload, Time time);
+  void Cb4 (uint32_t a, uint64_t b, double c, Ptr<Payload> d);
+  void Timeout (void);
+
+  uint32_t m_total;
+  uint32_t m_pending;
+  uint32_t m_n;
+  Ptr<Payload> m_payload;
+};
+
+Bench::Bench (uint32_t total, uint32_t pending)
+  : m_total (total),
+    m_pending (pending),
+    m_n (0),
+    m_payload (Create<Payload> ())
+{
+}
+
+double
+Bench::Run (void)
+{
+  m_n = 0;
+  for (uint32_t i = 0; i < m_pending; i++)
+    {
+      Simulator::Schedule (NanoSeconds (i), &Bench::Cb0, this);
+    }
+
+  SystemWallClockMs wallClock;
+  wallClock.Start ();
+  Simulator::Run ();
+  double seconds = wallClock.End () / 1000.0;
+  Simulator::Destroy ();
+  return seconds;
+}
+
+void
+Bench::Next (void)
+{
+  m_n++;
+  if (m_n >= m_total)
+    {
+      return;
+    }
+
+  Time delay = NanoSeconds (1 + m_n % 997);
+  switch (m_n % 3)
+    {
+    case 0:
+      Simulator::Schedule (delay, &Bench::Cb0, this);
+      break;
+    case 1:
+      Simulator::Schedule (delay, &Bench::Cb2, this, m_payload, delay);
+      break;
+    default:
+      Simulator::Schedule (delay, &Bench::Cb4, this, m_n, (uint64_t)m_n, 1.0, m_payload);
+      break;
+    }
+
+  if (m_n % 10 == 0)
+    {
+      EventId timeout = Simulator::Schedule (Seconds (1.0), &Bench::Timeout, this);
+      Simulator::Cancel (timeout);
+    }
+}
+
+void
+Bench::Cb0 (void)
+{
+  Next ();
+}
+
+void
+Bench::Cb2 (Ptr<Payload> payload, Time time)
+{
+  Next ();
+}
+
+void
+Bench::Cb4 (uint32_t a, uint64_t b, double c, Ptr<Payload> d)
+{
+  Next ();
+}
+
+void
+Bench::Timeout (void)
+{
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t total = 10000000;
+  uint32_t pending = 1000;
+  uint32_t runs = 3;
+
+  CommandLine cmd;
+  cmd.AddValue ("total", "Number of events invoked per run", total);
+  cmd.AddValue ("pending", "Number of events kept in the scheduler", pending);
+  cmd.AddValue ("runs", "Number of runs with and without the pool", runs);
+  cmd.Parse (argc, argv);
+
+  Bench bench (total, pending);
+  bool enabled[2] = { false, true };
+  for (uint32_t run = 0; run < runs; run++)
+    {
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          EventPool::Enable (enabled[i]);
+          double seconds = bench.Run ();
+          std::cout << (enabled[i] ? "pool   " : "malloc ")
+                    << "n=" << total << " time=" << seconds << "s "
+                    << total / seconds << " events/s" << std::endl;
+        }
+    }
+
+  return 0;
+}
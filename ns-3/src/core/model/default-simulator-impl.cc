@@ -30,6 +30,17 @@
 
 #include <cmath>
 
+#ifdef NS3_EVENT_PROFILER
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <time.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#endif
+
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
 // of causing recursions leading to stack overflow
@@ -63,9 +74,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+#ifdef NS3_EVENT_PROFILER
+  m_depthSampleTs = 0;
+#endif
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -99,6 +114,9 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+#ifdef NS3_EVENT_PROFILER
+  PrintProfile (std::clog);
+#endif
 }
 
 void
@@ -137,12 +155,199 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
+#ifdef NS3_EVENT_PROFILER
+  ProfileEvent (next.impl);
+#else
   next.impl->Invoke ();
+#endif
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
 }
 
+#ifdef NS3_EVENT_PROFILER
+
+// bounds the memory of the queue depth samples: when exceeded, the sample period is doubled
+static const uint32_t MAX_DEPTH_SAMPLES = 64;
+
+static uint64_t
+GetWallClockNs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static std::string
+Demangle (const char *name)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (name, 0, 0, &status);
+  if (demangled == 0)
+    {
+      return name;
+    }
+  std::string result (demangled);
+  free (demangled);
+  return result;
+}
+
+/**
+ * Readable name of a profile key: the symbol of the scheduled function, if it
+ * can be resolved, otherwise the type of the function (or of the event)
+ */
+static std::string
+GetProfileKeyName (const EventImpl::ProfileKey &key)
+{
+  uintptr_t function = reinterpret_cast<uintptr_t> (key.function);
+  // with the Itanium C++ ABI, pointers to virtual member functions hold the vtable offset + 1
+  bool isVirtual = key.member && (function & 1);
+  Dl_info info;
+  if (function != 0 && !isVirtual &&
+      dladdr (key.function, &info) != 0 && info.dli_sname != 0 && info.dli_saddr == key.function)
+    {
+      return Demangle (info.dli_sname);
+    }
+
+  std::ostringstream os;
+  os << Demangle (key.type->name ());
+  if (isVirtual)
+    {
+      os << " [virtual, vtable offset " << function - 1 << "]";
+    }
+  else if (function != 0)
+    {
+      os << " [" << key.function << "]";
+    }
+  return os.str ();
+}
+
+DefaultSimulatorImpl::ProfileEntry::ProfileEntry ()
+  : count (0),
+    totalNs (0),
+    maxNs (0)
+{
+}
+
+DefaultSimulatorImpl::DepthSample::DepthSample ()
+  : events (0),
+    depthSum (0),
+    maxDepth (0)
+{
+}
+
+void
+DefaultSimulatorImpl::ProfileEvent (EventImpl *event)
+{
+  if (m_depthSampleTs == 0)
+    {
+      // the time resolution is fixed once events are running
+      m_depthSampleTs = Seconds (1.0).GetTimeStep ();
+    }
+  while (m_currentTs / m_depthSampleTs >= MAX_DEPTH_SAMPLES)
+    {
+      for (uint32_t i = 0; i < m_depthSamples.size (); i += 2)
+        {
+          DepthSample merged = m_depthSamples[i];
+          if (i + 1 < m_depthSamples.size ())
+            {
+              merged.events += m_depthSamples[i + 1].events;
+              merged.depthSum += m_depthSamples[i + 1].depthSum;
+              merged.maxDepth = std::max (merged.maxDepth, m_depthSamples[i + 1].maxDepth);
+            }
+          m_depthSamples[i / 2] = merged;
+        }
+      m_depthSamples.resize ((m_depthSamples.size () + 1) / 2);
+      m_depthSampleTs *= 2;
+    }
+  uint64_t sample = m_currentTs / m_depthSampleTs;
+  if (sample >= m_depthSamples.size ())
+    {
+      m_depthSamples.resize (sample + 1);
+    }
+  DepthSample &depth = m_depthSamples[sample];
+  depth.events++;
+  depth.depthSum += m_unscheduledEvents;
+  depth.maxDepth = std::max (depth.maxDepth, m_unscheduledEvents);
+
+  EventImpl::ProfileKey key = event->GetProfileKey ();
+  uint64_t start = GetWallClockNs ();
+  event->Invoke ();
+  uint64_t elapsed = GetWallClockNs () - start;
+
+  ProfileEntry &entry = m_profile[key];
+  entry.count++;
+  entry.totalNs += elapsed;
+  entry.maxNs = std::max (entry.maxNs, elapsed);
+}
+
+void
+DefaultSimulatorImpl::PrintProfile (std::ostream &os) const
+{
+  // entries of one function may have been accounted under several keys (e.g.,
+  // once per shared library), so entries are merged by name before ranking
+  std::map<std::string, ProfileEntry> byName;
+  uint64_t totalNs = 0;
+  uint64_t count = 0;
+  for (Profile::const_iterator it = m_profile.begin (); it != m_profile.end (); ++it)
+    {
+      ProfileEntry &entry = byName[GetProfileKeyName (it->first)];
+      entry.count += it->second.count;
+      entry.totalNs += it->second.totalNs;
+      entry.maxNs = std::max (entry.maxNs, it->second.maxNs);
+      totalNs += it->second.totalNs;
+      count += it->second.count;
+    }
+
+  // (total time, name), most expensive first
+  std::vector<std::pair<uint64_t, std::string> > ranked;
+  for (std::map<std::string, ProfileEntry>::const_iterator it = byName.begin (); it != byName.end (); ++it)
+    {
+      ranked.push_back (std::make_pair (it->second.totalNs, it->first));
+    }
+  std::sort (ranked.rbegin (), ranked.rend ());
+
+  std::ios_base::fmtflags flags = os.flags ();
+  os << std::fixed;
+  os << "Event profile: " << count << " events, " << std::setprecision (3) << totalNs / 1e6 << " ms in event handlers" << std::endl;
+  os << std::setw (5) << "rank" << std::setw (12) << "count" << std::setw (14) << "total(ms)" << std::setw (8) << "share"
+     << std::setw (12) << "mean(us)" << std::setw (12) << "max(us)" << "  event" << std::endl;
+  for (uint32_t i = 0; i < ranked.size (); i++)
+    {
+      const ProfileEntry &entry = byName[ranked[i].second];
+      os << std::setw (5) << i + 1
+         << std::setw (12) << entry.count
+         << std::setw (14) << std::setprecision (3) << entry.totalNs / 1e6
+         << std::setw (7) << std::setprecision (1) << (totalNs > 0 ? 100.0 * entry.totalNs / totalNs : 0.0) << "%"
+         << std::setw (12) << std::setprecision (3) << entry.totalNs / 1e3 / entry.count
+         << std::setw (12) << std::setprecision (3) << entry.maxNs / 1e3
+         << "  " << ranked[i].second << std::endl;
+    }
+
+  if (!m_depthSamples.empty ())
+    {
+      double period = TimeStep (m_depthSampleTs).GetSeconds ();
+      os << "Event queue depth, per " << std::setprecision (0) << period << " s of simulated time:" << std::endl;
+      os << std::setw (12) << "time(s)" << std::setw (12) << "events" << std::setw (12) << "mean" << std::setw (12) << "max" << std::endl;
+      for (uint32_t i = 0; i < m_depthSamples.size (); i++)
+        {
+          const DepthSample &depth = m_depthSamples[i];
+          if (depth.events == 0)
+            {
+              continue;
+            }
+          os << std::setw (12) << std::setprecision (0) << i * period
+             << std::setw (12) << depth.events
+             << std::setw (12) << std::setprecision (1) << static_cast<double> (depth.depthSum) / depth.events
+             << std::setw (12) << depth.maxDepth << std::endl;
+        }
+    }
+  os.flags (flags);
+}
+
+#endif
+
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
@@ -404,4 +609,10 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 } // namespace ns3
@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "event-pool.h"
 #include "log.h"
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
@@ -60,4 +61,38 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (size_t size)
+{
+  return EventPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, size_t size)
+{
+  EventPool::Deallocate (p, size);
+}
+
+#ifdef NS3_EVENT_PROFILER
+bool
+EventImpl::ProfileKey::operator < (const ProfileKey &other) const
+{
+  if (type != other.type && *type != *other.type)
+    {
+      return type->before (*other.type);
+    }
+  return function < other.function;
+}
+
+EventImpl::ProfileKey
+EventImpl::GetProfileKey (void) const
+{
+  ProfileKey key;
+  key.type = &typeid (*this);
+  key.function = 0;
+  key.member = false;
+  return key;
+}
+#endif
+
 } // namespace ns3
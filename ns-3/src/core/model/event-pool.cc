@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "event-pool.h"
+#include "ns3/core-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#if defined (__SANITIZE_ADDRESS__)
+#define EVENT_POOL_ASAN 1
+#elif defined (__has_feature)
+#if __has_feature (address_sanitizer)
+#define EVENT_POOL_ASAN 1
+#endif
+#endif
+
+#if !defined (__GNUC__)
+// no thread-local storage: free lists are shared, so the pool is safe only
+// with single-threaded simulators and should be enabled explicitly
+#define EVENT_POOL_DEFAULT 0
+#define EVENT_POOL_THREAD_LOCAL
+#elif defined (NS3_DISABLE_EVENT_POOL) || defined (EVENT_POOL_ASAN)
+#define EVENT_POOL_DEFAULT 0
+#define EVENT_POOL_THREAD_LOCAL __thread
+#else
+#define EVENT_POOL_DEFAULT 1
+#define EVENT_POOL_THREAD_LOCAL __thread
+#endif
+
+namespace ns3 {
+
+namespace {
+
+const size_t N_CLASSES = EventPool::MAX_SIZE / EventPool::GRANULARITY;
+
+struct FreeBlock
+{
+  FreeBlock *next;
+};
+
+// Plain arrays: __thread requires static initialization
+EVENT_POOL_THREAD_LOCAL FreeBlock *g_freeLists[N_CLASSES];
+EVENT_POOL_THREAD_LOCAL size_t g_freeListLengths[N_CLASSES];
+
+// -1 until NS_EVENT_POOL is read
+int g_enabled = -1;
+
+inline size_t
+GetClass (size_t size)
+{
+  return size == 0 ? 0 : (size - 1) / EventPool::GRANULARITY;
+}
+
+} // anonymous namespace
+
+void *
+EventPool::Allocate (size_t size)
+{
+  if (size <= MAX_SIZE)
+    {
+      size_t sizeClass = GetClass (size);
+      if (IsEnabled () && g_freeLists[sizeClass] != 0)
+        {
+          FreeBlock *block = g_freeLists[sizeClass];
+          g_freeLists[sizeClass] = block->next;
+          g_freeListLengths[sizeClass]--;
+          return block;
+        }
+      // always allocate the whole class, see EventPool::Enable
+      size = (sizeClass + 1) * GRANULARITY;
+    }
+
+  void *p = malloc (size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+EventPool::Deallocate (void *p, size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+
+  if (size <= MAX_SIZE && IsEnabled ())
+    {
+      size_t sizeClass = GetClass (size);
+      if (g_freeListLengths[sizeClass] < MAX_CACHED_BYTES / ((sizeClass + 1) * GRANULARITY))
+        {
+          FreeBlock *block = static_cast<FreeBlock *> (p);
+          block->next = g_freeLists[sizeClass];
+          g_freeLists[sizeClass] = block;
+          g_freeListLengths[sizeClass]++;
+          return;
+        }
+    }
+  free (p);
+}
+
+void
+EventPool::Enable (bool enabled)
+{
+  g_enabled = enabled ? 1 : 0;
+}
+
+bool
+EventPool::IsEnabled (void)
+{
+  if (g_enabled < 0)
+    {
+      g_enabled = EVENT_POOL_DEFAULT;
+      char *envVar = getenv ("NS_EVENT_POOL");
+      if (envVar != 0)
+        {
+          g_enabled = (strcmp (envVar, "0") != 0 && strcmp (envVar, "false") != 0) ? 1 : 0;
+        }
+    }
+  return g_enabled != 0;
+}
+
+} // namespace ns3
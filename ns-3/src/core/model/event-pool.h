@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <stddef.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief size-class free lists for EventImpl objects
+ *
+ * Every scheduled event allocates an EventImpl subclass (see MakeEvent)
+ * which is deleted right after it is invoked or cancelled.  EventImpl
+ * allocates its instances here: sizes up to MAX_SIZE bytes are rounded
+ * up to a multiple of GRANULARITY bytes, and freed blocks are kept in
+ * a per-thread free list of their size class and reused by the next
+ * allocation of the same class.  Each free list keeps at most
+ * MAX_CACHED_BYTES bytes, the rest is returned to malloc, so a thread
+ * that only frees events scheduled by another thread (e.g.,
+ * RealtimeSimulatorImpl::ScheduleWithContext) does not grow without bound.
+ * Blocks cached by a thread are not released when the thread exits.
+ *
+ * Cached blocks hide use-after-free of events from memory checkers, so
+ * the pool is disabled when built with AddressSanitizer or with
+ * "./waf configure --disable-event-pool", and can be disabled at run
+ * time with the NS_EVENT_POOL=0 environment variable or EventPool::Enable.
+ */
+class EventPool
+{
+public:
+  static const size_t GRANULARITY = 16;
+  static const size_t MAX_SIZE = 256;
+  static const size_t MAX_CACHED_BYTES = 1 << 20;
+
+  /**
+   * \param size size of the object
+   * \returns memory block of at least size bytes
+   */
+  static void *Allocate (size_t size);
+  /**
+   * \param p block returned by Allocate
+   * \param size size passed to Allocate
+   */
+  static void Deallocate (void *p, size_t size);
+
+  /**
+   * \param enabled whether freed blocks are cached for reuse
+   *
+   * Can be changed at any time: blocks are always allocated with the
+   * size of their class, so blocks allocated while the pool is disabled
+   * can be cached later, and vice versa.
+   */
+  static void Enable (bool enabled);
+  /**
+   * \returns whether freed blocks are cached for reuse
+   */
+  static bool IsEnabled (void);
+};
+
+} // namespace ns3
+
+#endif /* EVENT_POOL_H */
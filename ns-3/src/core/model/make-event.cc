@@ -26,6 +26,12 @@ protected:
     {
       (*m_function)();
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
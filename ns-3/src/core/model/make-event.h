@@ -95,6 +95,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -125,6 +131,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -156,6 +168,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -189,6 +207,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -224,6 +248,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -262,6 +292,12 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -296,6 +332,12 @@ private:
     {
       (*m_function)(m_a1);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -326,6 +368,12 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -359,6 +407,12 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -394,6 +448,12 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -431,6 +491,12 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+#ifdef NS3_EVENT_PROFILER
+    virtual ProfileKey GetProfileKey (void) const
+    {
+      return MakeProfileKey (m_function);
+    }
+#endif
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -182,6 +182,10 @@ public:
    * \return the current simulation context
    */
   virtual uint32_t GetContext (void) const = 0;
+  /**
+   * \return the number of events executed so far
+   */
+  virtual uint64_t GetEventCount (void) const = 0;
 };
 
 } // namespace ns3
@@ -744,6 +744,14 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * \returns the number of events executed so far
+   *
+   * Together with a wall clock, this gives the event rate of a simulation,
+   * e.g., for benchmarking.
+   */
+  static uint64_t GetEventCount (void);
+
   /**
    * \param time delay until the event expires
    * \param event the event to schedule
@@ -22,6 +22,7 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
+#include "tcp-virtual-payload-tag.h"
 
 NS_LOG_COMPONENT_DEFINE ("TcpRxBuffer");
 
@@ -40,6 +41,11 @@ TcpRxBuffer::GetTypeId (void)
   return tid;
 }
 
+TcpRxBuffer::RxChunk::RxChunk (Ptr<Packet> packet, uint32_t size)
+  : m_packet (packet), m_size (size)
+{
+}
+
 /* A user is supposed to create a TcpSocket through a factory. In TcpSocket,
  * there are attributes SndBufSize and RcvBufSize to control the default Tx and
  * Rx window sizes respectively, with default of 128 KiByte. The attribute
@@ -156,12 +162,12 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   BufIterator i = m_data.begin ();
   while (i != m_data.end () && i->first <= tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second.m_size);
       if (lastByteSeq > headSeq)
         {
           if (i->first > headSeq && lastByteSeq < tailSeq)
             { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
+              m_size -= i->second.m_size;
               m_data.erase (i++);
               continue;
             }
@@ -182,31 +188,46 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
+  uint32_t length = tailSeq - headSeq;
+  TcpVirtualPayloadTag tag;
+  if (p->PeekPacketTag (tag))
+    { // Virtual payload is kept as a byte count only
+      p = 0;
+    }
   else
     {
       uint32_t start = headSeq - tcph.GetSequenceNumber ();
-      uint32_t length = tailSeq - headSeq;
       p = p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
+  BufIterator prev = m_data.lower_bound (headSeq);
+  if (p == 0 && prev != m_data.begin ()
+      && (--prev)->second.m_packet == 0 && prev->first + SequenceNumber32 (prev->second.m_size) == headSeq)
+    { // Merge with the virtual payload right before it
+      prev->second.m_size += length;
+      if (headSeq == m_nextRxSeq)
+        { // The merged chunk has been accounted for up to headSeq already
+          m_nextRxSeq = tailSeq;
+          m_availBytes += length;
+        }
+    }
+  else
+    {
+      m_data [ headSeq ] = RxChunk (p, length);
+    }
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << length << (p == 0 ? " (virtual)" : ""));
   // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  m_size += length;      // Occupancy
+  for (BufIterator i = m_data.lower_bound (m_nextRxSeq); i != m_data.end (); ++i)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
+      if (i->first > m_nextRxSeq)
         {
           break;
         };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      m_nextRxSeq = i->first + SequenceNumber32 (i->second.m_size);
+      m_availBytes += i->second.m_size;
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
@@ -226,16 +247,29 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  bool isVirtual = (m_data.begin ()->second.m_packet == 0);
+  uint32_t virtualSize = 0;
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
       i = m_data.begin ();
       NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      if ((i->second.m_packet == 0) != isVirtual)
+        { // Virtual payload and real data are returned separately
+          break;
+        }
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = i->second.m_size;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+          if (isVirtual)
+            {
+              virtualSize += pktSize;
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second.m_packet);
+            }
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -243,14 +277,28 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+          if (isVirtual)
+            {
+              virtualSize += extractSize;
+              m_data[i->first + SequenceNumber32 (extractSize)] = RxChunk (0, pktSize - extractSize);
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second.m_packet->CreateFragment (0, extractSize));
+              m_data[i->first + SequenceNumber32 (extractSize)] = RxChunk (i->second.m_packet->CreateFragment (extractSize, pktSize - extractSize),
+                                                                         pktSize - extractSize);
+            }
           m_data.erase (i);
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
     }
+  if (isVirtual)
+    {
+      outPkt = Create<Packet> (virtualSize);
+      outPkt->AddPacketTag (TcpVirtualPayloadTag ());
+    }
   if (outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
@@ -26,10 +26,10 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
+#include "ns3/packet.h"
 #include "ns3/tcp-header.h"
 
 namespace ns3 {
-class Packet;
 
 /**
  * \ingroup tcp
@@ -70,18 +70,39 @@ public:
   /**
    * Extract data from the head of the buffer as indicated by nextRxSeq.
    * The extracted data is going to be forwarded to the application.
+   *
+   * Virtual payload (see TcpVirtualPayloadTag) and real data are never
+   * extracted together: virtual payload is returned as a packet without
+   * payload data which is tagged with a TcpVirtualPayloadTag.
    */
   Ptr<Packet> Extract (uint32_t maxSize);
 public:
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /**
+   * \brief A part of the data in the buffer: a received packet or, if the
+   *        packet is null, m_size bytes of virtual payload
+   */
+  struct RxChunk
+  {
+    RxChunk ()
+      : m_size (0)
+    {
+    }
+
+    RxChunk (Ptr<Packet> packet, uint32_t size);
+
+    Ptr<Packet> m_packet;
+    uint32_t m_size;
+  };
+
+  typedef std::map<SequenceNumber32, RxChunk>::iterator BufIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //< Seqnum of the FIN packet
   bool m_gotFin;                             //< Did I received FIN packet?
   uint32_t m_size;                           //< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data;
-  //< Corresponding data (may be null)
+  std::map<SequenceNumber32, RxChunk> m_data;
+  //< Corresponding data (packets may be null)
 };
 
 } //namepsace ns3
@@ -27,6 +27,7 @@
 #include "ns3/log.h"
 
 #include "tcp-tx-buffer.h"
+#include "tcp-virtual-payload-tag.h"
 
 NS_LOG_COMPONENT_DEFINE ("TcpTxBuffer");
 
@@ -45,6 +46,11 @@ TcpTxBuffer::GetTypeId (void)
   return tid;
 }
 
+TcpTxBuffer::TxChunk::TxChunk (Ptr<Packet> packet, uint32_t size)
+  : m_packet (packet), m_size (size)
+{
+}
+
 /* A user is supposed to create a TcpSocket through a factory. In TcpSocket,
  * there are attributes SndBufSize and RcvBufSize to control the default Tx and
  * Rx window sizes respectively, with default of 128 KiByte. The attribute
@@ -53,7 +59,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768)
 {
 }
 
@@ -107,7 +113,19 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          TcpVirtualPayloadTag tag;
+          if (!p->PeekPacketTag (tag))
+            {
+              m_data.push_back (TxChunk (p, p->GetSize ()));
+            }
+          else if (!m_data.empty () && m_data.back ().m_packet == 0)
+            { // Virtual payload is kept as a byte count, merged with the virtual payload before it
+              m_data.back ().m_size += p->GetSize ();
+            }
+          else
+            {
+              m_data.push_back (TxChunk (0, p->GetSize ()));
+            }
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -146,53 +164,57 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
   // Extract data from the buffer and return
   uint32_t offset = seq - m_firstByteSeq.Get ();
   uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
+  uint32_t copied = 0;     // Number of bytes of the requested range found so far
+  uint32_t virtualSize = 0; // Number of bytes of virtual payload not yet appended to outPacket
   uint32_t pktSize = 0;
-  bool beginFound = false;
   int pktCount = 0;
   Ptr<Packet> outPacket;
   NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  for (BufIterator i = m_data.begin (); i != m_data.end () && copied < s; ++i)
     {
       pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
+      pktSize = i->m_size;
+      if (count + pktSize > offset)
+        {
+          uint32_t packetOffset = offset + copied - count;
+          uint32_t fragmentLength = std::min (pktSize - packetOffset, s - copied);
+          NS_LOG_LOGIC ("Copying " << fragmentLength << " bytes of packet #" << pktCount << " at buffer offset " << count
+                                   << ", packet len=" << pktSize << (i->m_packet == 0 ? " (virtual)" : ""));
+          if (i->m_packet == 0)
+            { // Virtual payload is only counted, it has no data to copy
+              virtualSize += fragmentLength;
+            }
+          else if (outPacket == 0 && virtualSize == 0)
             {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
+              outPacket = i->m_packet->CreateFragment (packetOffset, fragmentLength);
+            }
+          else
+            { // Virtual payload mixed with real data in a single segment is sent as zero-filled data
+              if (outPacket == 0)
+                {
+                  outPacket = Create<Packet> ();
                 }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
+              if (virtualSize > 0)
+                {
+                  outPacket->AddAtEnd (Create<Packet> (virtualSize));
+                  virtualSize = 0;
                 }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+              outPacket->AddAtEnd (i->m_packet->CreateFragment (packetOffset, fragmentLength));
             }
-        }
-      else if (count + pktSize >= offset + s)
-        { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-          break;
-        }
-      else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          copied += fragmentLength;
         }
       count += pktSize;
     }
+  if (outPacket == 0)
+    { // Virtual payload only: the segment does not need any payload data
+      outPacket = Create<Packet> (virtualSize);
+      outPacket->AddPacketTag (TcpVirtualPayloadTag ());
+    }
+  else if (virtualSize > 0)
+    {
+      outPacket->AddAtEnd (Create<Packet> (virtualSize));
+    }
+  NS_LOG_LOGIC ("Output packet is of size " << outPacket->GetSize ());
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
@@ -220,9 +242,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   BufIterator i = m_data.begin ();
   while (i != m_data.end ())
     {
-      if (offset > (*i)->GetSize ())
+      if (offset > i->m_size)
         { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
+          pktSize = i->m_size;
           m_size -= pktSize;
           offset -= pktSize;
           m_firstByteSeq += pktSize;
@@ -231,8 +253,12 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         }
       else if (offset > 0)
         { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
+          pktSize = i->m_size - offset;
+          if (i->m_packet != 0)
+            { // Virtual payload has no packet, only its size is changed
+              i->m_packet = i->m_packet->CreateFragment (offset, pktSize);
+            }
+          i->m_size = pktSize;
           m_size -= offset;
           m_firstByteSeq += offset;
           NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "tcp-virtual-payload-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TcpVirtualPayloadTag);
+
+TcpVirtualPayloadTag::TcpVirtualPayloadTag ()
+{
+}
+
+TypeId
+TcpVirtualPayloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpVirtualPayloadTag")
+    .SetParent<Tag> ()
+    .AddConstructor<TcpVirtualPayloadTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpVirtualPayloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpVirtualPayloadTag::GetSerializedSize (void) const
+{
+  return 0;
+}
+
+void
+TcpVirtualPayloadTag::Serialize (TagBuffer i) const
+{
+}
+
+void
+TcpVirtualPayloadTag::Deserialize (TagBuffer i)
+{
+}
+
+void
+TcpVirtualPayloadTag::Print (std::ostream &os) const
+{
+  os << "TcpVirtualPayload";
+}
+
+} // namespace ns3
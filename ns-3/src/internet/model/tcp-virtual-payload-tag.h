@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef TCP_VIRTUAL_PAYLOAD_TAG_H
+#define TCP_VIRTUAL_PAYLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks the payload of a packet as virtual, i.e., only its size is of
+ * interest, not its content.
+ *
+ * A packet passed to TcpSocketBase::Send () with this tag is kept by the
+ * TcpTxBuffer as a plain byte count, and segments consisting of virtual
+ * payload only are created without any payload data. The receiving
+ * TcpRxBuffer keeps tagged segments as byte counts as well, and returns
+ * virtual payload separately from real data, again tagged with this tag.
+ * Real data sent in between (e.g., application message headers) is
+ * delivered unchanged, so message framing remains exact. Virtual payload
+ * which shares a segment with real data is delivered as zero-filled data.
+ */
+class TcpVirtualPayloadTag : public Tag
+{
+public:
+  TcpVirtualPayloadTag ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+};
+
+} // namespace ns3
+
+#endif /* TCP_VIRTUAL_PAYLOAD_TAG_H */
@@ -46,8 +46,13 @@
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-virtual-payload-tag.h"
+#include "../model/tcp-tx-buffer.h"
+#include "../model/tcp-rx-buffer.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("TcpTestSuite");
 
@@ -425,6 +430,92 @@ TcpTestCase::AddSimpleNetDevice6 (Ptr<Node> node, Ipv6Address ipaddr, Ipv6Prefix
   return dev;
 }
 
+// Sends a stream of real data interleaved with virtual payload from a
+// TcpTxBuffer to a TcpRxBuffer, with reordered and overlapping segments
+class TcpVirtualPayloadTestCase : public TestCase
+{
+public:
+  TcpVirtualPayloadTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpVirtualPayloadTestCase::TcpVirtualPayloadTestCase ()
+  : TestCase ("Sending virtual payload through the TCP buffers")
+{
+}
+
+void
+TcpVirtualPayloadTestCase::DoRun (void)
+{
+  TcpTxBuffer txBuffer (1);
+  TcpRxBuffer rxBuffer (1);
+  txBuffer.SetMaxBufferSize (65536);
+  rxBuffer.SetMaxBufferSize (65536);
+
+  // Messages of 13 bytes of real data, each followed by virtual payload
+  std::vector<int> expected; // The value of each byte, -1 for virtual payload
+  for (uint8_t i = 0; i < 5; ++i)
+    {
+      uint8_t header[13];
+      for (uint8_t j = 0; j < 13; ++j)
+        {
+          header[j] = i * 13 + j + 1;
+          expected.push_back (header[j]);
+        }
+      txBuffer.Add (Create<Packet> (header, 13));
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<Packet> p = Create<Packet> (500 + i * 777);
+          p->AddPacketTag (TcpVirtualPayloadTag ());
+          expected.insert (expected.end (), p->GetSize (), -1);
+          txBuffer.Add (p);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), expected.size (), "Wrong size of the Tx buffer");
+
+  std::vector<std::pair<SequenceNumber32, Ptr<Packet> > > segments;
+  for (SequenceNumber32 seq (1); seq < txBuffer.TailSequence (); seq += 536)
+    {
+      segments.push_back (std::make_pair (seq, txBuffer.CopyFromSequence (536, seq)));
+    }
+  std::swap (segments[2], segments[5]);
+  segments.push_back (segments[4]);
+  segments.push_back (std::make_pair (SequenceNumber32 (301), txBuffer.CopyFromSequence (1000, SequenceNumber32 (301))));
+
+  std::vector<int> received;
+  for (uint32_t i = 0; i < segments.size (); ++i)
+    {
+      TcpHeader header;
+      header.SetSequenceNumber (segments[i].first);
+      rxBuffer.Add (segments[i].second->Copy (), header);
+      Ptr<Packet> p;
+      while ((p = rxBuffer.Extract (i % 2 ? 700 : 65536)) != 0)
+        {
+          TcpVirtualPayloadTag tag;
+          if (p->PeekPacketTag (tag))
+            {
+              received.insert (received.end (), p->GetSize (), -1);
+              continue;
+            }
+          std::vector<uint8_t> data (p->GetSize ());
+          p->CopyData (&data[0], data.size ());
+          for (uint32_t j = 0; j < data.size (); ++j)
+            { // Virtual payload sharing a segment with real data is zero-filled
+              received.push_back (data[j] == 0 ? -1 : data[j]);
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (received.size (), expected.size (), "Wrong number of bytes received");
+  NS_TEST_ASSERT_MSG_EQ ((received == expected), true, "Received data differs from the sent data");
+  NS_TEST_ASSERT_MSG_EQ (rxBuffer.Size (), 0, "Data left in the Rx buffer");
+
+  txBuffer.DiscardUpTo (SequenceNumber32 (2001));
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), expected.size () - 2000, "Wrong size of the Tx buffer after discarding data");
+  txBuffer.DiscardUpTo (txBuffer.TailSequence ());
+  NS_TEST_ASSERT_MSG_EQ (txBuffer.Size (), 0, "Data left in the Tx buffer");
+}
+
 static class TcpTestSuite : public TestSuite
 {
 public:
@@ -442,6 +533,8 @@ public:
     AddTestCase (new TcpTestCase (13, 200, 200, 200, 200, true));
     AddTestCase (new TcpTestCase (13, 1, 1, 1, 1, true));
     AddTestCase (new TcpTestCase (100000, 100, 50, 100, 20, true));
+
+    AddTestCase (new TcpVirtualPayloadTestCase ());
   }
 
 } g_tcpTestSuite;
@@ -179,26 +179,7 @@ void
 ConsumerOm::OnNack (const Ptr<const Interest> &interest, Ptr<Packet> packet)
 {
 	Consumer::OnNack (interest, packet);
-		
-	//rule out nacks with different prefixes
-	std::list<std::string>::const_iterator rhs = interest->GetName().begin();
-	bool match = true;
-	for(std::list<std::string>::iterator it = m_interestName.begin();
-			it != m_interestName.end(); it++)
-	{
-		if(rhs==interest->GetName().end()
-		|| *it!=*rhs)
-		{
-			match = false;
-			break;
-		}
-		rhs++;
-	}
-	if(!match)
-	{
-		//NS_LOG_UNCOND("mismatch app="<<m_interestName<<" nack="<<interest->GetName());
-		return;
-	}
+	//NACKs of other requesters are delivered here only for our prefix (see LocalAppRegistry)
 	
 	//update interest limit
 	if(interest->GetNack()==Interest::NACK_GIVEUP_PIT)	//NOT NACK_CONGESTION
@@ -234,25 +215,7 @@ void
 ConsumerOm::OnExtraContentObject (const Ptr<const ContentObject> &contentObject,
                    				 Ptr<Packet> payload)
 {
-	//rule out nacks with different prefixes
-	std::list<std::string>::const_iterator rhs = contentObject->GetName().begin();
-	bool match = true;
-	for(std::list<std::string>::iterator it = m_interestName.begin();
-			it != m_interestName.end(); it++)
-	{
-		if(rhs==contentObject->GetName().end()
-		|| *it!=*rhs)
-		{
-			match = false;
-			break;
-		}
-		rhs++;
-	}
-	if(!match)
-	{
-		//NS_LOG_UNCOND("mismatch app="<<m_interestName<<" nack="<<interest->GetName());
-		return;
-	}
+	//only Data under our prefix is delivered here (see LocalAppRegistry)
 	//NS_LOG_UNCOND("OnExtraContentObject@"<<Names::FindName(m_node));
 	m_data_count++;
 }
@@ -303,15 +266,9 @@ ConsumerOm::SendRandomPacket()
   packet->AddHeader (interestHeader);
   NS_LOG_DEBUG ("Interest packet size: " << packet->GetSize ());
 
-  NS_LOG_DEBUG ("Trying to add " << seq << " with " << Simulator::Now () << ". already " << m_seqTimeouts.size () << " items");
-
-  /*m_seqTimeouts.insert (SeqTimeout (seq, Simulator::Now ()));
-  m_seqFullDelay.insert (SeqTimeout (seq, Simulator::Now ()));
-
-  m_seqLastDelay.erase (seq);
-  m_seqLastDelay.insert (SeqTimeout (seq, Simulator::Now ()));
+  NS_LOG_DEBUG ("Trying to add " << seq << " with " << Simulator::Now () << ". already " << m_seqWindow.GetSize () << " items");
 
-  m_seqRetxCounts[seq] ++;
+  /*m_seqWindow.Sent (seq, Simulator::Now ());
 
   m_transmittedInterests (&interestHeader, this, m_face);
 
@@ -32,6 +32,7 @@
 #include "ns3/ndn-app-face.h"
 #include "ns3/ndn-interest.h"
 #include "ns3/ndn-content-object.h"
+#include "ns3/ndn-local-app-registry.h"
 #include "ns3/ndnSIM/utils/ndn-fw-hop-count-tag.h"
 #include "ns3/ndnSIM/utils/ndn-rtt-mean-deviation.h"
 
@@ -127,18 +128,11 @@ Consumer::CheckRetxTimeout ()
   Time rto = m_rtt->RetransmitTimeout ();
   // NS_LOG_DEBUG ("Current RTO: " << rto.ToDouble (Time::S) << "s");
 
-  while (!m_seqTimeouts.empty ())
+  // timeouts are ordered by send time, so the loop stops at the first one that has not expired
+  uint32_t seqNo;
+  while (m_seqWindow.PopExpired (now - rto, seqNo))
     {
-      SeqTimeoutsContainer::index<i_timestamp>::type::iterator entry =
-        m_seqTimeouts.get<i_timestamp> ().begin ();
-      if (entry->time + rto <= now) // timeout expired?
-        {
-          uint32_t seqNo = entry->seq;
-          m_seqTimeouts.get<i_timestamp> ().erase (entry);
-          OnTimeout (seqNo);
-        }
-      else
-        break; // nothing else to do. All later packets need not be retransmitted
+      OnTimeout (seqNo);
     }
 
   /*m_retxEvent = Simulator::Schedule (m_retxTimer,
@@ -154,6 +148,9 @@ Consumer::StartApplication () // Called at time specified by Start
   // do base stuff
   App::StartApplication ();
 
+  // receive NACKs and Data for our prefix that pass through the node on behalf of other requesters
+  LocalAppRegistry::GetOrCreate (GetNode ())->Register (m_interestName, this);
+
   ScheduleNextPacket ();
 }
 
@@ -165,6 +162,9 @@ Consumer::StopApplication () // Called at time specified by Stop
   // cancel periodic packet generation
   Simulator::Cancel (m_sendEvent);
 
+  if (m_active)
+    LocalAppRegistry::GetOrCreate (GetNode ())->Unregister (this);
+
   // cleanup base stuff
   App::StopApplication ();
 }
@@ -217,15 +217,9 @@ Consumer::SendPacket ()
   packet->AddHeader (interestHeader);
   NS_LOG_DEBUG ("Interest packet size: " << packet->GetSize ());
 
-  NS_LOG_DEBUG ("Trying to add " << seq << " with " << Simulator::Now () << ". already " << m_seqTimeouts.size () << " items");
-
-  m_seqTimeouts.insert (SeqTimeout (seq, Simulator::Now ()));
-  m_seqFullDelay.insert (SeqTimeout (seq, Simulator::Now ()));
+  NS_LOG_DEBUG ("Trying to add " << seq << " with " << Simulator::Now () << ". already " << m_seqWindow.GetSize () << " items");
 
-  m_seqLastDelay.erase (seq);
-  m_seqLastDelay.insert (SeqTimeout (seq, Simulator::Now ()));
-
-  m_seqRetxCounts[seq] ++;
+  m_seqWindow.Sent (seq, Simulator::Now ());
 
   m_transmittedInterests (&interestHeader, this, m_face);
 
@@ -267,23 +261,14 @@ Consumer::OnContentObject (const Ptr<const ContentObject> &contentObject,
       hopCount = hopCountTag.Get ();
     }
 
-  SeqTimeoutsContainer::iterator entry = m_seqLastDelay.find (seq);
-  if (entry != m_seqLastDelay.end ())
+  const SeqWindow::Entry *entry = m_seqWindow.Find (seq);
+  if (entry != 0)
     {
-      m_lastRetransmittedInterestDataDelay (this, seq, Simulator::Now () - entry->time, hopCount);
+      m_lastRetransmittedInterestDataDelay (this, seq, Simulator::Now () - entry->lastSent, hopCount);
+      m_firstInterestDataDelay (this, seq, Simulator::Now () - entry->firstSent, entry->retxCount, hopCount);
     }
 
-  entry = m_seqFullDelay.find (seq);
-  if (entry != m_seqFullDelay.end ())
-    {
-      m_firstInterestDataDelay (this, seq, Simulator::Now () - entry->time, m_seqRetxCounts[seq], hopCount);
-    }
-
-  m_seqRetxCounts.erase (seq);
-  m_seqFullDelay.erase (seq);
-  m_seqLastDelay.erase (seq);
-
-  m_seqTimeouts.erase (seq);
+  m_seqWindow.Erase (seq);
   m_retxSeqs.erase (seq);
 
   m_rtt->AckSeq (SequenceNumber32 (seq));
@@ -311,7 +296,7 @@ Consumer::OnNack (const Ptr<const Interest> &interest, Ptr<Packet> origPacket)
   m_retxSeqs.insert (seq);
   // NS_LOG_INFO ("After: " << m_retxSeqs.size ());
 
-  m_seqTimeouts.erase (seq);
+  m_seqWindow.DisarmTimer (seq);
 
   m_rtt->IncreaseMultiplier ();             // Double the next RTO ??
   ScheduleNextPacket ();
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#ifndef NDN_REPLICATION_RUNNER_H
+#define NDN_REPLICATION_RUNNER_H
+
+#include "ns3/callback.h"
+
+#include <string>
+#include <list>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to run independent replications of the same scenario in parallel
+ *
+ * Each replication is executed in a separate (forked) process, using a
+ * different ns-3 run number (RngSeedManager::SetRun).  All random decisions
+ * inside ndnSIM are taken from RandomVariableStreams, so replications are
+ * statistically independent and every one of them can be reproduced later
+ * with --RngRun=<run>.
+ *
+ * The scenario callback should build the topology, install tracers, call
+ * Simulator::Run () and Simulator::Destroy ().  Trace files should be opened
+ * under names returned by GetTraceFileName, so that every replication writes
+ * its own copy.  After all replications finish, the copies of each file
+ * registered with AddTraceFile are merged into one file, with an extra "Run"
+ * column prepended to every row.
+ *
+ * Note that nothing that touches the simulator should be done before calling
+ * Run (setting defaults with Config::SetDefault and parsing command line is fine).
+ *
+ * Example:
+ *
+ * \code
+ * void
+ * Scenario (uint32_t run)
+ * {
+ *   ...
+ *   ndn::L3RateTracer::InstallAll (ndn::ReplicationRunner::GetTraceFileName ("rate-trace.txt"), Seconds (1.0));
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * }
+ *
+ * ndn::ReplicationRunner runner;
+ * runner.SetReplications (20);
+ * runner.AddTraceFile ("rate-trace.txt");
+ * runner.Run (MakeCallback (&Scenario));
+ * \endcode
+ */
+class ReplicationRunner
+{
+public:
+  typedef Callback<void, uint32_t> ScenarioCallback;
+
+  /**
+   * @brief Default constructor (one replication, first run 1, one process per CPU)
+   */
+  ReplicationRunner ();
+
+  /**
+   * @brief Set number of replications to run
+   */
+  void
+  SetReplications (uint32_t replications);
+
+  /**
+   * @brief Set run number of the first replication (replication i uses run firstRun+i)
+   */
+  void
+  SetFirstRun (uint32_t firstRun);
+
+  /**
+   * @brief Set maximum number of replications running at the same time
+   * @param maxParallel Number of simultaneous processes (0 means number of online CPUs)
+   */
+  void
+  SetMaxParallel (uint32_t maxParallel);
+
+  /**
+   * @brief Register trace file that should be merged after all replications are finished
+   * @param file Name of the trace file, as it would be used without replications
+   */
+  void
+  AddTraceFile (const std::string &file);
+
+  /**
+   * @brief Fork and run all replications, then merge registered trace files
+   * @param scenario Callback that runs one complete simulation
+   * @returns number of replications that failed (0 on success)
+   */
+  uint32_t
+  Run (ScenarioCallback scenario);
+
+  /**
+   * @brief Get name of the trace file for the current replication
+   *
+   * Outside of ReplicationRunner::Run the name is returned unchanged, so scenarios
+   * can be run both directly and through the runner
+   */
+  static std::string
+  GetTraceFileName (const std::string &file);
+
+  /**
+   * @brief Get name of the trace file for the specified run
+   */
+  static std::string
+  GetTraceFileName (const std::string &file, uint32_t run);
+
+  /**
+   * @brief Check whether the calling code is executed inside a replication process
+   */
+  static bool
+  IsReplication ();
+
+private:
+  void
+  MergeTraceFile (const std::string &file, const std::list<uint32_t> &runs) const;
+
+private:
+  uint32_t m_replications;
+  uint32_t m_firstRun;
+  uint32_t m_maxParallel;
+  std::list<std::string> m_traceFiles;
+
+  static bool     s_isReplication;
+  static uint32_t s_currentRun;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_REPLICATION_RUNNER_H
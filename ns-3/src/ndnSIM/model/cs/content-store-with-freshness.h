@@ -43,7 +43,7 @@ public:
   GetTypeId ();
 
   virtual inline bool
-  Add (Ptr<const ContentObject> header, Ptr<const Packet> packet);
+  Add (Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet = 0);
 
 private:
   inline void
@@ -87,9 +87,9 @@ ContentStoreWithFreshness< Policy >::GetTypeId ()
 
 template<class Policy>
 inline bool
-ContentStoreWithFreshness< Policy >::Add (Ptr<const ContentObject> header, Ptr<const Packet> packet)
+ContentStoreWithFreshness< Policy >::Add (Ptr<const ContentObject> header, Ptr<const Packet> payload, Ptr<const Packet> packet/* = 0*/)
 {
-  bool ok = super::Add (header, packet);
+  bool ok = super::Add (header, payload, packet);
   if (!ok) return false;
 
   NS_LOG_DEBUG (header->GetName () << " added to cache");
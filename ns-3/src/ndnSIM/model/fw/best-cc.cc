@@ -30,8 +30,6 @@
 #include "ns3/log.h"
 
 #include <vector>
-#include <cstdlib>
-#include <ctime>
 #include <boost/foreach.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lambda/bind.hpp>
@@ -65,7 +63,6 @@ BestCC::GetTypeId (void)
 
 BestCC::BestCC ()
 {
-	srand(time(0));
 }
 
 //Dynamic Forwarding
@@ -127,7 +124,7 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
 	  	
 	  NS_ASSERT(OptimalCandidates.size()!=0);
 	  
-	  optimalFace = OptimalCandidates.at(rand()%OptimalCandidates.size());
+	  optimalFace = OptimalCandidates.at(m_rand->GetInteger (0, OptimalCandidates.size() - 1));
 	  
 	  Ptr<Limits> faceLimits = optimalFace->GetObject<Limits> ();
 	  faceLimits->BorrowLimit ();
@@ -187,7 +184,7 @@ BestCC::DoPropagateInterest (Ptr<Face> inFace,
 		  	
 		  if(totalweight<1)totalweight = 1;
 		  	
-		  double target = rand()%(int)totalweight;
+		  double target = m_rand->GetInteger (0, (uint32_t)totalweight - 1);
 		  double coin = 0;	
 		  //Step2: choose ONE face based on our congestion control strategy
 		  std::vector< Ptr<Face> > vecFaces;
@@ -32,6 +32,7 @@
 #include "ns3/ndn-face.h"
 #include "ns3/ndn-app-face.h"
 #include "ns3/ndn-app.h"
+#include "ns3/ndn-local-app-registry.h"
 
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
@@ -98,8 +99,8 @@ TypeId ForwardingStrategy::GetTypeId (void)
 }
 
 ForwardingStrategy::ForwardingStrategy ()
+  : m_rand (CreateObject<UniformRandomVariable> ())
 {
-	srand(time(0));
 }
 
 ForwardingStrategy::~ForwardingStrategy ()
@@ -125,6 +126,10 @@ ForwardingStrategy::NotifyNewAggregate ()
     {
       m_contentStore = GetObject<ContentStore> ();
     }
+  if (m_localApps == 0)
+    {
+      m_localApps = GetObject<LocalAppRegistry> ();
+    }
 
   Object::NotifyNewAggregate ();
 }
@@ -136,6 +141,7 @@ ForwardingStrategy::DoDispose ()
   m_contentStore = 0;
   m_fib = 0;
   m_fib2 = 0;
+  m_localApps = 0;
 
   Object::DoDispose ();
 }
@@ -241,13 +247,9 @@ ForwardingStrategy::OnData (Ptr<Face> inFace,
 
       if (m_cacheUnsolicitedData)
         {
-          FwHopCountTag hopCountTag;
-
-          Ptr<Packet> payloadCopy = payload->Copy ();
-          payloadCopy->RemovePacketTag (hopCountTag);
-
           // Optimistically add or update entry in the content store
-          cached = m_contentStore->Add (header, payloadCopy);
+          // (already encoded packet is stored as is, without a copy)
+          cached = m_contentStore->Add (header, payload, origPacket);
         }
       else
         {
@@ -301,20 +303,10 @@ ForwardingStrategy::OnData (Ptr<Face> inFace,
     	/////////////////////////////////////////////////////
       bool cached = false;
 
-      FwHopCountTag hopCountTag;
-      if (payload->PeekPacketTag (hopCountTag))
-        {
-          Ptr<Packet> payloadCopy = payload->Copy ();
-          payloadCopy->RemovePacketTag (hopCountTag);
-
-          // Add or update entry in the content store
-          cached = m_contentStore->Add (header, payloadCopy);
-        }
-      else
-        {
-          // Add or update entry in the content store
-          cached = m_contentStore->Add (header, payload); // no need for extra copy
-        }
+      // Add or update entry in the content store
+      // (already encoded packet is stored as is, without a copy; packet tags,
+      // such as FwHopCountTag, are stripped from cache hits by the content store)
+      cached = m_contentStore->Add (header, payload, origPacket);
 
       DidReceiveSolicitedData (inFace, header, payload, origPacket, cached);
     }
@@ -490,7 +482,7 @@ ForwardingStrategy::SatisfyPendingInterest (Ptr<Face> inFace,
 	    	
 	    		if(max_data_out)
 		    	{
-		    		uint32_t N = rand()%max_data_out;
+		    		uint32_t N = m_rand->GetInteger (0, max_data_out - 1);
 			    	if(N<=record2->GetDataOut())
 			    		NewHeader->SetCE(1);
 			    	else
@@ -535,14 +527,13 @@ ForwardingStrategy::SatisfyPendingInterest (Ptr<Face> inFace,
   	}
   }  
   //if(inFace!=0)
-  if(extra_content)
+  //copy only to applications requesting the same prefix
+  if(extra_content && m_localApps!=0)
   {
-  	//Ptr<Node> node = inFace->GetNode();
-  	NS_ASSERT(node!=0);
-  	for(uint32_t k=0; k!=node->GetNApplications(); k++)
+  	const LocalAppRegistry::AppList &apps = m_localApps->Lookup (pitEntry->GetFibEntry (), header->GetName ());
+  	for(uint32_t i = 0; i < apps.size(); i++)
   	{
-      	Ptr<App> app = DynamicCast<App>(node->GetApplication(k));
-      	if(app!=0)
+      	Ptr<App> app = apps[i];
       	{
       		//If it is already forwarded to app, don't do it again
       		bool ignore = false;
@@ -789,7 +780,10 @@ ForwardingStrategy::DidAddFibEntry (Ptr<fib::Entry> fibEntry)
 void
 ForwardingStrategy::WillRemoveFibEntry (Ptr<fib::Entry> fibEntry)
 {
-  // do nothing here
+  if (m_localApps != 0)
+    {
+      m_localApps->Forget (fibEntry);
+    }
 }
 
 void
@@ -25,6 +25,7 @@
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 namespace ndn {
@@ -45,6 +46,7 @@ namespace fib { class Entry; }
 class Fib2;
 namespace fib2 {class Entry; }
 class ContentStore;
+class LocalAppRegistry;
 
 /**
  * \ingroup ndn
@@ -492,10 +494,13 @@ protected:
   Ptr<Fib> m_fib; ///< \brief FIB
   Ptr<Fib2> m_fib2; ///< \brief FIB2, used for holding D_in
   Ptr<ContentStore> m_contentStore; ///< \brief Content store (for caching purposes only)
+  Ptr<LocalAppRegistry> m_localApps; ///< \brief Registry of local applications (aggregated when the first one registers)
 
   bool m_cacheUnsolicitedData;
   bool m_detectRetransmissions;
 
+  Ptr<UniformRandomVariable> m_rand; ///< \brief Per-node random stream (seeded from the global seed and run number)
+
   TracedCallback<Ptr<const Interest>,
                  Ptr<const Face> > m_outInterests; ///< @brief Transmitted interests trace
 
@@ -123,11 +123,11 @@ Face::Send (Ptr<Packet> packet)
     }
 
   FwHopCountTag hopCount;
-  bool tagExists = packet->RemovePacketTag (hopCount);
+  bool tagExists = packet->PeekPacketTag (hopCount);
   if (tagExists)
     {
       hopCount.Increment ();
-      packet->AddPacketTag (hopCount);
+      packet->ReplacePacketTag (hopCount);
     }
 
   bool ok = SendImpl (packet);
@@ -24,6 +24,7 @@
 #include "ndnSIM-serialization.h"
 #include "ndnSIM-pit.h"
 #include "ndnSIM-fib-entry.h"
+#include "ndnSIM-seq-window.h"
 
 namespace ns3
 {
@@ -39,6 +40,7 @@ public:
     AddTestCase (new InterestSerializationTest ());
     AddTestCase (new ContentObjectSerializationTest ());
     AddTestCase (new FibEntryTest ());
+    AddTestCase (new SeqWindowTest ());
     // AddTestCase (new PitTest ());
   }
 };
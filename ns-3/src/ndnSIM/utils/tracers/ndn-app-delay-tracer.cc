@@ -36,6 +36,8 @@
 #include <boost/make_shared.hpp>
 
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("ndn.AppDelayTracer");
 
@@ -46,7 +48,7 @@ namespace ndn {
 
 
 boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<AppDelayTracer> > >
-AppDelayTracer::InstallAll (const std::string &file)
+AppDelayTracer::InstallAll (const std::string &file, Time averagingPeriod/* = Seconds (0)*/)
 {
   using namespace boost;
   using namespace std;
@@ -65,6 +67,7 @@ AppDelayTracer::InstallAll (const std::string &file)
       NS_LOG_DEBUG ("Node: " << (*node)->GetId ());
 
       Ptr<AppDelayTracer> trace = Create<AppDelayTracer> (outputStream, *node);
+      trace->SetAveragingPeriod (averagingPeriod);
       tracers.push_back (trace);
     }
 
@@ -119,9 +122,57 @@ AppDelayTracer::Connect ()
                                  MakeCallback (&AppDelayTracer::FirstInterestDataDelay, this));
 }
 
+void
+AppDelayTracer::SetAveragingPeriod (const Time &period)
+{
+  m_period = period;
+  m_printEvent.Cancel ();
+  if (!m_period.IsZero ())
+    {
+      m_printEvent = Simulator::Schedule (m_period, &AppDelayTracer::PeriodicPrinter, this);
+    }
+}
+
+void
+AppDelayTracer::PeriodicPrinter ()
+{
+  Print (*m_os);
+  Reset ();
+
+  m_printEvent = Simulator::Schedule (m_period, &AppDelayTracer::PeriodicPrinter, this);
+}
+
+void
+AppDelayTracer::Reset ()
+{
+  for (std::map<uint32_t, app_delay::Stats>::iterator stats = m_stats.begin ();
+       stats != m_stats.end ();
+       stats++)
+    {
+      stats->second.Reset ();
+    }
+}
+
 void
 AppDelayTracer::PrintHeader (std::ostream &os) const
 {
+  if (!m_period.IsZero ())
+    {
+      os << "Time" << "\t"
+         << "Node" << "\t"
+         << "AppId" << "\t"
+
+         << "Type" << "\t"
+         << "Packets" << "\t"
+         << "MeanUS" << "\t"
+         << "P50US" << "\t"
+         << "P90US" << "\t"
+         << "P99US" << "\t"
+         << "P999US" << "\t"
+         << "MaxUS" << "";
+      return;
+    }
+
   os << "Time" << "\t"
      << "Node" << "\t"
      << "AppId" << "\t"
@@ -134,9 +185,42 @@ AppDelayTracer::PrintHeader (std::ostream &os) const
      << "HopCount"  << "";
 }
 
+#define PRINTER(printName, fieldName)                                   \
+  os << time.ToDouble (Time::S) << "\t"                                 \
+     << m_node << "\t"                                                  \
+     << stats->first << "\t"                                            \
+     << printName << "\t"                                               \
+     << stats->second.fieldName.GetCount () << "\t"                     \
+     << stats->second.fieldName.GetMean ().ToDouble (Time::US) << "\t"  \
+     << stats->second.fieldName.GetQuantile (0.5).ToDouble (Time::US) << "\t" \
+     << stats->second.fieldName.GetQuantile (0.9).ToDouble (Time::US) << "\t" \
+     << stats->second.fieldName.GetQuantile (0.99).ToDouble (Time::US) << "\t" \
+     << stats->second.fieldName.GetQuantile (0.999).ToDouble (Time::US) << "\t" \
+     << stats->second.fieldName.GetMax ().ToDouble (Time::US) << "\n";
+
+void
+AppDelayTracer::Print (std::ostream &os) const
+{
+  Time time = Simulator::Now ();
+
+  for (std::map<uint32_t, app_delay::Stats>::const_iterator stats = m_stats.begin ();
+       stats != m_stats.end ();
+       stats++)
+    {
+      PRINTER ("LastDelay", m_lastDelay);
+      PRINTER ("FullDelay", m_fullDelay);
+    }
+}
+
 void
 AppDelayTracer::LastRetransmittedInterestDataDelay (Ptr<App> app, uint32_t seqno, Time delay, int32_t hopCount)
 {
+  if (!m_period.IsZero ())
+    {
+      m_stats[app->GetId ()].m_lastDelay.Add (delay);
+      return;
+    }
+
   *m_os << Simulator::Now ().ToDouble (Time::S) << "\t"
         << m_node << "\t"
         << app->GetId () << "\t"
@@ -151,6 +235,12 @@ AppDelayTracer::LastRetransmittedInterestDataDelay (Ptr<App> app, uint32_t seqno
 void
 AppDelayTracer::FirstInterestDataDelay (Ptr<App> app, uint32_t seqno, Time delay, uint32_t retxCount, int32_t hopCount)
 {
+  if (!m_period.IsZero ())
+    {
+      m_stats[app->GetId ()].m_fullDelay.Add (delay);
+      return;
+    }
+
   *m_os << Simulator::Now ().ToDouble (Time::S) << "\t"
         << m_node << "\t"
         << app->GetId () << "\t"
@@ -162,6 +252,122 @@ AppDelayTracer::FirstInterestDataDelay (Ptr<App> app, uint32_t seqno, Time delay
         << hopCount << "\n";
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace app_delay {
+
+// Values below 2^SUB_BUCKET_BITS are counted exactly; above, every power of two is split into
+// 2^(SUB_BUCKET_BITS-1) buckets
+static const uint32_t SUB_BUCKET_BITS = 7;
+static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+static const uint32_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+DelaySketch::DelaySketch ()
+  : m_count (0)
+  , m_sum (0)
+  , m_min (0)
+  , m_max (0)
+{
+}
+
+uint32_t
+DelaySketch::GetBucket (uint64_t value)
+{
+  if (value < SUB_BUCKETS)
+    return value;
+
+  uint32_t shift = (63 - __builtin_clzll (value)) - (SUB_BUCKET_BITS - 1);
+  return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + ((value >> shift) - HALF_SUB_BUCKETS);
+}
+
+uint64_t
+DelaySketch::GetBucketValue (uint32_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+
+  uint32_t shift = (bucket - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+  uint64_t start = static_cast<uint64_t> ((bucket - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS) << shift;
+  // middle of the bucket
+  return start + ((static_cast<uint64_t> (1) << shift) - 1) / 2;
+}
+
+void
+DelaySketch::Add (const Time &delay)
+{
+  uint64_t value = std::max<int64_t> (delay.GetNanoSeconds (), 0);
+
+  uint32_t bucket = GetBucket (value);
+  if (bucket >= m_buckets.size ())
+    m_buckets.resize (bucket + 1, 0);
+  m_buckets[bucket]++;
+
+  if (m_count == 0 || value < m_min)
+    m_min = value;
+  if (value > m_max)
+    m_max = value;
+  m_count++;
+  m_sum += value;
+}
+
+void
+DelaySketch::Reset ()
+{
+  // keep the buckets allocated for the next period
+  std::fill (m_buckets.begin (), m_buckets.end (), 0);
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint64_t
+DelaySketch::GetCount () const
+{
+  return m_count;
+}
+
+Time
+DelaySketch::GetMean () const
+{
+  if (m_count == 0)
+    return Seconds (0);
+
+  return NanoSeconds (m_sum / m_count);
+}
+
+Time
+DelaySketch::GetMax () const
+{
+  return NanoSeconds (m_max);
+}
+
+Time
+DelaySketch::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    return Seconds (0);
+
+  uint64_t rank = static_cast<uint64_t> (std::ceil (q * m_count));
+  rank = std::min (std::max<uint64_t> (rank, 1), m_count);
+
+  uint64_t seen = 0;
+  for (uint32_t bucket = 0; bucket < m_buckets.size (); bucket++)
+    {
+      seen += m_buckets[bucket];
+      if (seen >= rank)
+        {
+          uint64_t value = std::min (std::max (GetBucketValue (bucket), m_min), m_max);
+          return NanoSeconds (value);
+        }
+    }
+
+  return NanoSeconds (m_max);
+}
+
+} // namespace app_delay
 
 } // namespace ndn
 } // namespace ns3
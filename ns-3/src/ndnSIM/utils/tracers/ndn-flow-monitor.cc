@@ -0,0 +1,355 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Yuanjie Li <yuanjie.li@cs.ucla.edu>
+ */
+
+#include "ndn-flow-monitor.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/node-container.h"
+#include "ns3/names.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+
+#include "ns3/ndn-app.h"
+#include "ns3/ndnSIM/apps/ndn-consumer.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-content-object.h"
+#include "ns3/ndn-face.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <fstream>
+#include <limits>
+#include <map>
+
+#define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
+
+#define ATTRIB(name) << " " # name "=\"" << flow.name << "\""
+#define ATTRIB_TIME(name) << " " # name "=\"" << flow.name.GetSeconds () << "\""
+
+NS_LOG_COMPONENT_DEFINE ("ndn.FlowMonitor");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED (FlowMonitor);
+
+TypeId
+FlowMonitor::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::FlowMonitor")
+    .SetGroupName ("Ndn")
+    .SetParent<Object> ()
+    .AddConstructor<FlowMonitor> ()
+
+    .AddAttribute ("DelayBinWidth", "The width used in the Interest-Data delay histograms (seconds)",
+                   DoubleValue (0.001),
+                   MakeDoubleAccessor (&FlowMonitor::m_delayBinWidth),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("FctBinWidth", "The width used in the flow completion time histograms (seconds)",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&FlowMonitor::m_fctBinWidth),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("GoodputBinWidth", "The width used in the goodput histograms (bits per second)",
+                   DoubleValue (1e6),
+                   MakeDoubleAccessor (&FlowMonitor::m_goodputBinWidth),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxBins", "Maximum number of bins of every histogram; larger values are counted in the last bin",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&FlowMonitor::m_maxBins),
+                   MakeUintegerChecker<uint32_t> (1))
+    ;
+  return tid;
+}
+
+FlowMonitor::FlowStats::FlowStats (double delayBinWidth)
+  : appId (0)
+  , maxSeq (std::numeric_limits<uint32_t>::max ())
+  , started (false)
+  , completed (false)
+  , interests (0)
+  , data (0)
+  , nacks (0)
+  , rxBytes (0)
+  , lastPayloadSize (0)
+  , delayHistogram (delayBinWidth)
+{
+}
+
+FlowMonitor::FlowMonitor ()
+{
+}
+
+namespace {
+
+struct PrefixStats
+{
+  PrefixStats (double fctBinWidth, double goodputBinWidth)
+    : flows (0), completed (0), fctHistogram (fctBinWidth), goodputHistogram (goodputBinWidth) { }
+
+  uint32_t flows;
+  uint32_t completed;
+  Histogram fctHistogram;     // seconds
+  Histogram goodputHistogram; // bits per second
+};
+
+} // anonymous namespace
+
+static void
+WriteFlowMonitor (Ptr<FlowMonitor> monitor, const std::string &file)
+{
+  monitor->SerializeToXmlFile (file);
+}
+
+Ptr<FlowMonitor>
+FlowMonitor::InstallAll (const std::string &file)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      monitor->Install (*node);
+    }
+
+  Simulator::ScheduleDestroy (&WriteFlowMonitor, monitor, file);
+  return monitor;
+}
+
+void
+FlowMonitor::Install (const NodeContainer &nodes)
+{
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    {
+      Install (*node);
+    }
+}
+
+void
+FlowMonitor::Install (Ptr<Node> node)
+{
+  for (uint32_t i = 0; i < node->GetNApplications (); i++)
+    {
+      Ptr<App> app = DynamicCast<App> (node->GetApplication (i));
+      if (app != 0)
+        {
+          Install (app);
+        }
+    }
+}
+
+bool
+FlowMonitor::Install (Ptr<App> app)
+{
+  if (DynamicCast<Consumer> (app) == 0)
+    return false;
+
+  uint32_t flow = m_flowStats.size ();
+  m_flowStats.push_back (FlowStats (m_delayBinWidth));
+  FlowStats &stats = m_flowStats.back ();
+
+  Ptr<Node> node = app->GetNode ();
+  stats.node = Names::FindName (node);
+  if (stats.node.empty ())
+    stats.node = boost::lexical_cast<std::string> (node->GetId ());
+
+  StringValue prefix;
+  if (app->GetAttributeFailSafe ("Prefix", prefix))
+    stats.prefix = prefix.Get ();
+
+  // MaxSeq is defined by the consumers with a bounded number of requests only
+  StringValue maxSeq;
+  if (app->GetAttributeFailSafe ("MaxSeq", maxSeq))
+    stats.maxSeq = boost::lexical_cast<uint32_t> (maxSeq.Get ());
+
+  NS_LOG_DEBUG ("Flow " << flow << ": node " << stats.node << ", prefix " << stats.prefix << ", max seq " << stats.maxSeq);
+
+  app->TraceConnectWithoutContext ("TransmittedInterests",
+                                   MakeCallback (&FlowMonitor::TransmittedInterest, this).Bind (flow));
+  app->TraceConnectWithoutContext ("ReceivedContentObjects",
+                                   MakeCallback (&FlowMonitor::ReceivedContentObject, this).Bind (flow));
+  app->TraceConnectWithoutContext ("ReceivedNacks",
+                                   MakeCallback (&FlowMonitor::ReceivedNack, this).Bind (flow));
+  app->TraceConnectWithoutContext ("FirstInterestDataDelay",
+                                   MakeCallback (&FlowMonitor::FirstInterestDataDelay, this).Bind (flow));
+  return true;
+}
+
+void
+FlowMonitor::AddValue (Histogram &histogram, double value) const
+{
+  // Histogram grows with the largest value, so clamp to keep the memory bounded
+  double maxValue = (m_maxBins - 0.5) * histogram.GetBinWidth (0);
+  histogram.AddValue (std::min (std::max (value, 0.0), maxValue));
+}
+
+void
+FlowMonitor::TransmittedInterest (uint32_t flow, Ptr<const Interest> interest, Ptr<App> app, Ptr<Face> face)
+{
+  FlowStats &stats = m_flowStats[flow];
+  if (!stats.started)
+    {
+      stats.started = true;
+      stats.timeFirstInterest = Simulator::Now ();
+      stats.appId = app->GetId ();
+    }
+  stats.interests++;
+}
+
+void
+FlowMonitor::ReceivedContentObject (uint32_t flow, Ptr<const ContentObject> contentObject, Ptr<const Packet> payload,
+                                    Ptr<App> app, Ptr<Face> face)
+{
+  // Counted in FirstInterestDataDelay, which the consumer fires for its own requests only
+  m_flowStats[flow].lastPayloadSize = payload->GetSize ();
+}
+
+void
+FlowMonitor::ReceivedNack (uint32_t flow, Ptr<const Interest> interest, Ptr<App> app, Ptr<Face> face)
+{
+  // Intra-sharing NACKs are for Interests of other consumers (see Consumer::OnNack)
+  if (interest->GetIntraSharing () == 1)
+    return;
+
+  m_flowStats[flow].nacks++;
+}
+
+void
+FlowMonitor::FirstInterestDataDelay (uint32_t flow, Ptr<App> app, uint32_t seqno, Time delay,
+                                     uint32_t retxCount, int32_t hopCount)
+{
+  FlowStats &stats = m_flowStats[flow];
+  Time now = Simulator::Now ();
+
+  if (stats.data == 0)
+    stats.timeFirstData = now;
+  stats.timeLastData = now;
+  stats.data++;
+  stats.rxBytes += stats.lastPayloadSize;
+  stats.lastPayloadSize = 0;
+
+  AddValue (stats.delayHistogram, delay.GetSeconds ());
+
+  if (!stats.completed && stats.data >= stats.maxSeq)
+    {
+      stats.completed = true;
+      stats.timeCompleted = now;
+    }
+}
+
+void
+FlowMonitor::SerializeToXmlStream (std::ostream &os, int indent) const
+{
+  std::map<std::string, PrefixStats> prefixes;
+
+  INDENT (indent); os << "<NdnFlowMonitor>\n";
+  indent += 2;
+
+  INDENT (indent); os << "<Flows>\n";
+  indent += 2;
+  for (uint32_t i = 0; i < m_flowStats.size (); i++)
+    {
+      const FlowStats &flow = m_flowStats[i];
+
+      std::map<std::string, PrefixStats>::iterator prefix = prefixes.find (flow.prefix);
+      if (prefix == prefixes.end ())
+        prefix = prefixes.insert (std::make_pair (flow.prefix, PrefixStats (m_fctBinWidth, m_goodputBinWidth))).first;
+      prefix->second.flows++;
+
+      // Goodput over the lifetime of the flow, i.e., until completion or the last Data
+      double duration = (flow.timeLastData - flow.timeFirstInterest).GetSeconds ();
+      double goodput = (duration > 0) ? flow.rxBytes * 8 / duration : 0;
+      if (flow.data > 0)
+        AddValue (prefix->second.goodputHistogram, goodput);
+
+      INDENT (indent);
+      os << "<Flow flowId=\"" << i << "\""
+        ATTRIB (node)
+        ATTRIB (appId)
+        ATTRIB (prefix)
+        ATTRIB (interests)
+        ATTRIB (data)
+        ATTRIB (nacks)
+        ATTRIB (rxBytes)
+        ATTRIB_TIME (timeFirstInterest)
+        ATTRIB_TIME (timeFirstData)
+        ATTRIB_TIME (timeLastData)
+         << " goodput=\"" << goodput << "\"";
+      if (flow.maxSeq != std::numeric_limits<uint32_t>::max ())
+        os << " maxSeq=\"" << flow.maxSeq << "\"";
+      if (flow.completed)
+        {
+          double fct = (flow.timeCompleted - flow.timeFirstInterest).GetSeconds ();
+          AddValue (prefix->second.fctHistogram, fct);
+          prefix->second.completed++;
+          os << " timeCompleted=\"" << flow.timeCompleted.GetSeconds () << "\""
+             << " fct=\"" << fct << "\"";
+        }
+      os << ">\n";
+
+      flow.delayHistogram.SerializeToXmlStream (os, indent + 2, "delayHistogram");
+
+      INDENT (indent); os << "</Flow>\n";
+    }
+  indent -= 2;
+  INDENT (indent); os << "</Flows>\n";
+
+  INDENT (indent); os << "<Prefixes>\n";
+  indent += 2;
+  for (std::map<std::string, PrefixStats>::const_iterator prefix = prefixes.begin ();
+       prefix != prefixes.end ();
+       prefix++)
+    {
+      INDENT (indent);
+      os << "<Prefix name=\"" << prefix->first << "\""
+         << " flows=\"" << prefix->second.flows << "\""
+         << " completedFlows=\"" << prefix->second.completed << "\">\n";
+
+      prefix->second.fctHistogram.SerializeToXmlStream (os, indent + 2, "fctHistogram");
+      prefix->second.goodputHistogram.SerializeToXmlStream (os, indent + 2, "goodputHistogram");
+
+      INDENT (indent); os << "</Prefix>\n";
+    }
+  indent -= 2;
+  INDENT (indent); os << "</Prefixes>\n";
+
+  indent -= 2;
+  INDENT (indent); os << "</NdnFlowMonitor>\n";
+}
+
+void
+FlowMonitor::SerializeToXmlFile (const std::string &fileName) const
+{
+  std::ofstream os (fileName.c_str (), std::ios::out | std::ios::binary);
+  if (!os.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open " << fileName);
+      return;
+    }
+
+  os << "<?xml version=\"1.0\" ?>\n";
+  SerializeToXmlStream (os, 0);
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -46,7 +46,11 @@ static struct Zeroes
 namespace ns3 {
 
 
+#ifdef NS3_MULTITHREADED
+__thread uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -18,13 +18,17 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "ns3/core-config.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("ByteTagList");
 
+#ifndef NS3_MULTITHREADED
+// the free list cannot be shared by threads
 #define USE_FREE_LIST 1
+#endif
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (2147483647)
 
@@ -53,11 +53,18 @@ public:
 
   void Add (Tag const&tag) const;
   bool Remove (Tag &tag);
+  bool Replace (Tag const&tag);
   bool Peek (Tag &tag) const;
   inline void RemoveAll (void);
 
   const struct PacketTagList::TagData *Head (void) const;
 
+  /**
+   * \returns a list with the same tags which does not share any node
+   *          with this list
+   */
+  PacketTagList CreateFullCopy (void) const;
+
 private:
 
   bool Remove (TypeId tid);
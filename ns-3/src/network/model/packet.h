@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include "ns3/core-config.h"
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -374,6 +375,17 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \returns a copy of the packet which does not share any dataset
+   *          with the original packet.
+   *
+   * The datasets shared by COW copies are not reference counted
+   * atomically, so this copy is used when a packet is handed to
+   * another thread (see MultithreadedSimulatorImpl).  The uid is
+   * preserved.  Packet metadata, if enabled, is still shared.
+   */
+  Ptr<Packet> CreateFullCopy (void) const;
+
   /**
    * A packet is allocated a new uid when it is created
    * empty or with zero-filled payload.
@@ -523,6 +535,18 @@ public:
    * Search a matching tag and call Tag::Deserialize if it is found.
    */
   bool PeekPacketTag (Tag &tag) const;
+  /**
+   * \param tag the new value of the tag
+   * \returns true if a tag of the same type was found and
+   *          overwritten, false if the tag was added.
+   *
+   * Replace the value of a tag of this packet. This has the
+   * same effect as RemovePacketTag followed by AddPacketTag,
+   * but the tag is overwritten in place: the list of packet
+   * tags is copied only if it is shared with copies of this
+   * packet, and then only up to the replaced tag.
+   */
+  bool ReplacePacketTag (const Tag &tag);
   /**
    * Remove all packet tags.
    */
@@ -534,7 +558,7 @@ public:
    * Print the list of 'packet' tags.
    *
    * \sa Packet::AddPacketTag, Packet::RemovePacketTag, Packet::PeekPacketTag,
-   *  Packet::RemoveAllPacketTags
+   *  Packet::ReplacePacketTag, Packet::RemoveAllPacketTags
    */
   void PrintPacketTags (std::ostream &os) const;
 
@@ -567,7 +591,12 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector;
 
+#ifdef NS3_MULTITHREADED
+  // per thread, the system id in the upper bits tells threads apart
+  static __thread uint32_t m_globalUid;
+#else
   static uint32_t m_globalUid;
+#endif
 };
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet);